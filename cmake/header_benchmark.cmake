@@ -0,0 +1,136 @@
+# Compile each public libembeddedhal header standalone and report compile time
+# and code size.
+#
+# Run by the header_benchmark target, see LIBEMBEDDEDHAL_HEADER_BENCHMARK in
+# CMakeLists.txt. CONFIGURATION is the path to a file generated at configure
+# time that sets the following variables:
+#
+#   SOURCE_DIRECTORY  - root of the libembeddedhal repository
+#   BINARY_DIRECTORY  - directory to place generated sources and objects
+#   COMPILER          - C++ compiler
+#   FLAGS             - list of compiler flags
+#   INCLUDES          - list of include directories
+#   NM                - nm program for the compiler's object format
+#   MAX_TIME          - compile time limit in milliseconds, 0 for no limit
+#   MAX_TEXT          - .text size limit in bytes, 0 for no limit
+#
+# For each header a translation unit including only that header is compiled.
+# Mock headers additionally construct each default constructible mock, which
+# emits its vtable and every driver function, giving the code size of a
+# representative driver for that interface.
+#
+# Each result is printed and appended to header_benchmark.csv in
+# BINARY_DIRECTORY, along with the time of the run, so results can be tracked
+# over time. Exceeding MAX_TIME or MAX_TEXT fails the run.
+
+cmake_minimum_required(VERSION 3.23)
+
+include(${CONFIGURATION})
+
+set(output_directory ${BINARY_DIRECTORY}/header_benchmark)
+set(history ${BINARY_DIRECTORY}/header_benchmark.csv)
+file(MAKE_DIRECTORY ${output_directory})
+
+set(include_flags)
+foreach(directory ${INCLUDES})
+  list(APPEND include_flags -I${directory})
+endforeach()
+
+if(NOT EXISTS ${history})
+  file(WRITE ${history} "run,header,milliseconds,text_bytes,weak_symbols\n")
+endif()
+
+file(
+  GLOB_RECURSE headers
+  RELATIVE ${SOURCE_DIRECTORY}/include
+  ${SOURCE_DIRECTORY}/include/libembeddedhal/*.hpp)
+list(FILTER headers EXCLUDE REGEX "/internal/")
+list(SORT headers)
+
+string(TIMESTAMP run "%Y-%m-%dT%H:%M:%S")
+set(failures 0)
+
+message(STATUS "header, milliseconds, .text bytes, weak symbols")
+
+foreach(header ${headers})
+  string(MAKE_C_IDENTIFIER ${header} name)
+  set(source ${output_directory}/${name}.cpp)
+  set(object ${output_directory}/${name}.o)
+
+  set(content "#include <${header}>\n")
+  if(header MATCHES "/mock\\.hpp$")
+    string(
+      APPEND
+      content
+      "#include <new>\n"
+      "#include <type_traits>\n"
+      "template<typename T>\n"
+      "void* benchmark_driver(void* p_memory)\n"
+      "{\n"
+      "  if constexpr (std::is_default_constructible_v<T>) {\n"
+      "    return new (p_memory) T;\n"
+      "  } else {\n"
+      "    return nullptr;\n"
+      "  }\n"
+      "}\n")
+    file(STRINGS ${SOURCE_DIRECTORY}/include/${header} mocks
+         REGEX "^struct [a-z_0-9]+ : public embed::")
+    foreach(mock ${mocks})
+      string(REGEX REPLACE "^struct ([a-z_0-9]+) .*" "\\1" mock ${mock})
+      string(APPEND content
+             "template void* benchmark_driver<embed::mock::${mock}>(void*);\n")
+    endforeach()
+  endif()
+  file(WRITE ${source} "${content}")
+
+  string(TIMESTAMP start "%s%f")
+  execute_process(
+    COMMAND ${COMPILER} ${FLAGS} ${include_flags} -c ${source} -o ${object}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors)
+  string(TIMESTAMP stop "%s%f")
+  math(EXPR milliseconds "(${stop} - ${start}) / 1000")
+
+  if(NOT result EQUAL 0)
+    message(SEND_ERROR "${header} does not compile standalone:\n${errors}")
+    math(EXPR failures "${failures} + 1")
+    continue()
+  endif()
+
+  # Sum the size of every code symbol and count weak symbols, which are
+  # template instantiations and inline functions emitted by this header.
+  execute_process(
+    COMMAND ${NM} --print-size --defined-only ${object}
+    OUTPUT_VARIABLE symbols
+    OUTPUT_STRIP_TRAILING_WHITESPACE)
+  string(REPLACE "\n" ";" symbols "${symbols}")
+  set(text_bytes 0)
+  set(weak_symbols 0)
+  foreach(symbol ${symbols})
+    if(symbol MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) ([TtWw]) ")
+      math(EXPR text_bytes "${text_bytes} + 0x${CMAKE_MATCH_1}")
+    endif()
+    if(symbol MATCHES "^[0-9a-fA-F]+ [0-9a-fA-F]+ [WwVvu] ")
+      math(EXPR weak_symbols "${weak_symbols} + 1")
+    endif()
+  endforeach()
+
+  message(STATUS "${header}, ${milliseconds}, ${text_bytes}, ${weak_symbols}")
+  file(APPEND ${history}
+       "${run},${header},${milliseconds},${text_bytes},${weak_symbols}\n")
+
+  if(MAX_TIME GREATER 0 AND milliseconds GREATER MAX_TIME)
+    message(SEND_ERROR "${header} took ${milliseconds}ms to compile, "
+                       "exceeding ${MAX_TIME}ms")
+    math(EXPR failures "${failures} + 1")
+  endif()
+  if(MAX_TEXT GREATER 0 AND text_bytes GREATER MAX_TEXT)
+    message(SEND_ERROR "${header} generated ${text_bytes} bytes of code, "
+                       "exceeding ${MAX_TEXT} bytes")
+    math(EXPR failures "${failures} + 1")
+  endif()
+endforeach()
+
+if(failures GREATER 0)
+  message(FATAL_ERROR "${failures} header benchmark(s) failed")
+endif()
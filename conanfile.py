@@ -11,7 +11,7 @@ class libembeddedhal_conan(ConanFile):
     topics = ("peripherals", "hardware")
     settings = "os", "compiler", "arch", "build_type"
     generators = "cmake_find_package"
-    exports_sources = "include/*", "CMakeLists.txt", "tests/*"
+    exports_sources = "include/*", "CMakeLists.txt", "cmake/*", "tests/*"
     no_copy_source = True
 
     def build(self):
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <units/isq/si/acceleration.h>
-#include <units/isq/si/prefixes.h>
+#include "../units.hpp"
 
 namespace embed {
 struct nanometre_per_second_sq
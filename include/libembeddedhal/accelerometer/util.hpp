@@ -0,0 +1,119 @@
+/**
+ * @file util.hpp
+ * @brief Provide utility functions for the accelerometer interface
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+#include "../conversion.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Convert accelerometer samples into a unit of acceleration
+ *
+ * Samples are converted with a multiply and shift computed once from the full
+ * scale, rather than an int64 multiply, division and units::quantity_cast per
+ * sample. Declaring the conversion `constexpr` folds the multiplier into the
+ * code:
+ *
+ * ```
+ * constexpr embed::acceleration_conversion to_mm_per_s2(
+ *   embed::nm_per_s2<std::int64_t>(19'613'300'000));
+ * auto x = to_mm_per_s2(sample.axis.x);
+ * ```
+ *
+ * @tparam Quantity - acceleration type to convert into. Its unit must be
+ * equal to or larger than nanometres per second squared.
+ */
+template<units::Quantity Quantity = mm_per_s2<std::int32_t>>
+class acceleration_conversion
+{
+public:
+  /// Acceleration of each axis of a sample
+  struct axis_t
+  {
+    /// Acceleration in the X-axis
+    Quantity x;
+    /// Acceleration in the Y-axis
+    Quantity y;
+    /// Acceleration in the Z-axis
+    Quantity z;
+  };
+
+  /**
+   * @brief Construct a conversion for a full scale
+   *
+   * @param p_full_scale - full scale of the samples to be converted
+   */
+  explicit constexpr acceleration_conversion(
+    embed::acceleration p_full_scale) noexcept
+    : m_scale(make_scale(p_full_scale))
+  {}
+
+  /**
+   * @brief Convert a percentage of the full scale into acceleration
+   *
+   * @param p_axis - percentage of the full scale
+   * @return constexpr Quantity - acceleration, rounded to nearest
+   */
+  [[nodiscard]] constexpr Quantity operator()(percent p_axis) const noexcept
+  {
+    return Quantity(static_cast<rep>(m_scale(p_axis.raw_value())));
+  }
+
+  /**
+   * @brief Convert each axis of a sample into acceleration
+   *
+   * The full scale of the sample is not checked against the full scale of
+   * this conversion.
+   *
+   * @param p_sample - sample to convert
+   * @return constexpr axis_t - acceleration of each axis
+   */
+  [[nodiscard]] constexpr axis_t operator()(
+    const accelerometer::sample& p_sample) const noexcept
+  {
+    return axis_t{
+      .x = (*this)(p_sample.axis.x),
+      .y = (*this)(p_sample.axis.y),
+      .z = (*this)(p_sample.axis.z),
+    };
+  }
+
+  /**
+   * @brief Convert a block of percentages of the full scale into acceleration
+   *
+   * @param p_input - percentages of the full scale
+   * @param p_output - destination for the converted values
+   * @return std::span<Quantity> - the portion of p_output that was written to
+   */
+  constexpr std::span<Quantity> process(
+    std::span<const percent> p_input,
+    std::span<Quantity> p_output) const noexcept
+  {
+    const size_t length = std::min(p_input.size(), p_output.size());
+    for (size_t i = 0; i < length; i++) {
+      p_output[i] = (*this)(p_input[i]);
+    }
+    return p_output.first(length);
+  }
+
+private:
+  using rep = typename Quantity::rep;
+
+  static constexpr scale_conversion make_scale(
+    embed::acceleration p_full_scale) noexcept
+  {
+    constexpr auto ratio = unit_ratio<Quantity, embed::acceleration>();
+    constexpr auto raw_max = static_cast<std::uint64_t>(percent::raw_max());
+    const auto full_scale = static_cast<std::uint64_t>(p_full_scale.number());
+    return scale_conversion(full_scale * ratio[0], ratio[1] * raw_max);
+  }
+
+  scale_conversion m_scale;
+};
+}  // namespace embed
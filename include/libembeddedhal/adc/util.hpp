@@ -0,0 +1,43 @@
+/**
+ * @file util.hpp
+ * @brief Provide utility functions for the adc interface
+ */
+#pragma once
+
+#include <concepts>
+#include <span>
+#include <type_traits>
+
+#include "../error.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Read a block of samples from an adc
+ *
+ * Each sample is converted from percent into the type of the buffer, which
+ * allows samples to be read directly into the sample type of a filter:
+ *
+ * ```
+ * std::array<embed::q31, 32> samples;
+ * BOOST_LEAF_CHECK(embed::read<embed::q31>(adc, samples));
+ * ```
+ *
+ * @tparam T - sample type, must be constructible from percent
+ * @param p_adc - adc to read samples from
+ * @param p_samples - buffer to fill with samples
+ * @return boost::leaf::result<std::span<T>> - p_samples filled with samples or
+ * the error returned by adc::read.
+ */
+template<typename T = percent>
+requires std::constructible_from<T, percent>
+[[nodiscard]] boost::leaf::result<std::span<T>> read(
+  adc& p_adc,
+  std::type_identity_t<std::span<T>> p_samples) noexcept
+{
+  for (auto& sample : p_samples) {
+    sample = T(BOOST_LEAF_CHECK(p_adc.read()));
+  }
+  return p_samples;
+}
+}  // namespace embed
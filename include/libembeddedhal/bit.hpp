@@ -0,0 +1,461 @@
+/**
+ * @file bit.hpp
+ * @brief Provide constexpr bit field, sign extension, byte order and bit
+ * reversal operations along with packing and unpacking of bit streams
+ *
+ * These functions are written so that compilers lower them to single
+ * instructions where the target has them. For example, on ARMv7-M,
+ * bit_extract() becomes ubfx, bit_insert() bfi, sign_extend() sbfx,
+ * byteswap() rev and reverse_bits() rbit.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <type_traits>
+
+#include "bit_limits.hpp"
+
+namespace embed {
+/**
+ * @brief Generate a mask of 1s at the LSB of a runtime width
+ *
+ * @tparam T - the type
+ * @param p_width - number of 1s in the mask
+ * @return constexpr T - mask with 1s at the LSB
+ */
+template<std::unsigned_integral T>
+[[nodiscard]] constexpr T bit_mask(size_t p_width) noexcept
+{
+  if (p_width >= std::numeric_limits<T>::digits) {
+    return std::numeric_limits<T>::max();
+  }
+  return static_cast<T>((T{ 1 } << p_width) - 1U);
+}
+
+/**
+ * @brief Extract a field of bits from a value
+ *
+ * @tparam Position - index of the lowest bit of the field
+ * @tparam Width - number of bits in the field
+ * @tparam T - the type
+ * @param p_value - value to extract the field from
+ * @return constexpr T - field shifted down to bit 0
+ */
+template<size_t Position, size_t Width, std::unsigned_integral T>
+[[nodiscard]] constexpr T bit_extract(T p_value) noexcept
+{
+  static_assert(Width > 0, "The Width cannot be 0.");
+  static_assert(Position + Width <= std::numeric_limits<T>::digits,
+                "The field exceeds the number of bits in the integer type.");
+  return static_cast<T>((p_value >> Position) &
+                        generate_field_of_ones<Width, T>());
+}
+
+/**
+ * @brief Extract a field of bits at a runtime position from a value
+ *
+ * @tparam T - the type
+ * @param p_value - value to extract the field from
+ * @param p_position - index of the lowest bit of the field
+ * @param p_width - number of bits in the field
+ * @return constexpr T - field shifted down to bit 0
+ */
+template<std::unsigned_integral T>
+[[nodiscard]] constexpr T bit_extract(T p_value,
+                                      size_t p_position,
+                                      size_t p_width) noexcept
+{
+  return static_cast<T>((p_value >> p_position) & bit_mask<T>(p_width));
+}
+
+/**
+ * @brief Replace a field of bits within a value
+ *
+ * @tparam Position - index of the lowest bit of the field
+ * @tparam Width - number of bits in the field
+ * @tparam T - the type
+ * @param p_target - value to insert the field into
+ * @param p_field - new value of the field, bits beyond Width are ignored
+ * @return constexpr T - p_target with the field replaced
+ */
+template<size_t Position, size_t Width, std::unsigned_integral T>
+[[nodiscard]] constexpr T bit_insert(T p_target,
+                                     std::type_identity_t<T> p_field) noexcept
+{
+  static_assert(Width > 0, "The Width cannot be 0.");
+  static_assert(Position + Width <= std::numeric_limits<T>::digits,
+                "The field exceeds the number of bits in the integer type.");
+  constexpr auto mask =
+    static_cast<T>(generate_field_of_ones<Width, T>() << Position);
+  return static_cast<T>((p_target & ~mask) |
+                        (static_cast<T>(p_field << Position) & mask));
+}
+
+/**
+ * @brief Replace a field of bits at a runtime position within a value
+ *
+ * @tparam T - the type
+ * @param p_target - value to insert the field into
+ * @param p_field - new value of the field, bits beyond p_width are ignored
+ * @param p_position - index of the lowest bit of the field
+ * @param p_width - number of bits in the field
+ * @return constexpr T - p_target with the field replaced
+ */
+template<std::unsigned_integral T>
+[[nodiscard]] constexpr T bit_insert(T p_target,
+                                     std::type_identity_t<T> p_field,
+                                     size_t p_position,
+                                     size_t p_width) noexcept
+{
+  const auto mask = static_cast<T>(bit_mask<T>(p_width) << p_position);
+  return static_cast<T>((p_target & ~mask) |
+                        (static_cast<T>(p_field << p_position) & mask));
+}
+
+/**
+ * @brief Sign extend a two's complement value of Width bits
+ *
+ * For example, a 12-bit ADC reading of 0xFFF is -1.
+ *
+ * @tparam Width - number of bits in the value, including the sign bit
+ * @tparam T - the type
+ * @param p_value - value to sign extend, bits beyond Width are ignored
+ * @return constexpr std::make_signed_t<T> - sign extended value
+ */
+template<size_t Width, std::integral T>
+[[nodiscard]] constexpr std::make_signed_t<T> sign_extend(T p_value) noexcept
+{
+  using unsigned_t = std::make_unsigned_t<T>;
+  using signed_t = std::make_signed_t<T>;
+  constexpr size_t shift = std::numeric_limits<unsigned_t>::digits - Width;
+  static_assert(Width > 0, "The Width cannot be 0.");
+  static_assert(Width <= std::numeric_limits<unsigned_t>::digits,
+                "The Width exceed the number of bits in the integer type.");
+
+  const auto shifted =
+    static_cast<signed_t>(static_cast<unsigned_t>(p_value) << shift);
+  return static_cast<signed_t>(shifted >> shift);
+}
+
+/**
+ * @brief Reverse the order of the bytes of a value
+ *
+ * @tparam T - the type
+ * @param p_value - value to byte swap
+ * @return constexpr T - byte swapped value
+ */
+template<std::integral T>
+[[nodiscard]] constexpr T byteswap(T p_value) noexcept
+{
+  using unsigned_t = std::make_unsigned_t<T>;
+  auto value = static_cast<unsigned_t>(p_value);
+
+  if constexpr (sizeof(T) == 1) {
+    return p_value;
+  }
+#if defined(__GNUC__)
+  else if constexpr (sizeof(T) == 2) {
+    return static_cast<T>(__builtin_bswap16(value));
+  } else if constexpr (sizeof(T) == 4) {
+    return static_cast<T>(__builtin_bswap32(value));
+  } else if constexpr (sizeof(T) == 8) {
+    return static_cast<T>(__builtin_bswap64(value));
+  }
+#endif
+  else {
+    unsigned_t result = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+      result = static_cast<unsigned_t>(result << 8U | (value & 0xFFU));
+      value = static_cast<unsigned_t>(value >> 8U);
+    }
+    return static_cast<T>(result);
+  }
+}
+
+/**
+ * @brief Convert a value between native byte order and the passed byte order
+ *
+ * The conversion is its own inverse, so it converts to and from Order.
+ *
+ * @tparam Order - byte order to convert to or from
+ * @tparam T - the type
+ * @param p_value - value to convert
+ * @return constexpr T - converted value
+ */
+template<std::endian Order, std::integral T>
+[[nodiscard]] constexpr T to_endian(T p_value) noexcept
+{
+  if constexpr (Order == std::endian::native) {
+    return p_value;
+  } else {
+    return byteswap(p_value);
+  }
+}
+
+/**
+ * @brief Assemble an integer from bytes in the passed byte order
+ *
+ * Commonly used to parse multi-byte sensor registers.
+ *
+ * @tparam T - the type
+ * @tparam Order - byte order of p_bytes
+ * @param p_bytes - bytes of the integer
+ * @return constexpr T - assembled integer
+ */
+template<std::integral T, std::endian Order = std::endian::big>
+[[nodiscard]] constexpr T from_bytes(
+  std::span<const std::byte, sizeof(T)> p_bytes) noexcept
+{
+  using unsigned_t = std::make_unsigned_t<T>;
+  unsigned_t result = 0;
+  for (size_t i = 0; i < sizeof(T); i++) {
+    const size_t index = (Order == std::endian::big) ? i : sizeof(T) - 1 - i;
+    result = static_cast<unsigned_t>(
+      static_cast<unsigned_t>(result << 8U) |
+      std::to_integer<unsigned_t>(p_bytes[index]));
+  }
+  return static_cast<T>(result);
+}
+
+/**
+ * @brief Split an integer into bytes in the passed byte order
+ *
+ * @tparam Order - byte order of p_bytes
+ * @tparam T - the type
+ * @param p_value - integer to split
+ * @param p_bytes - destination for the bytes of the integer
+ */
+template<std::endian Order = std::endian::big, std::integral T>
+constexpr void to_bytes(T p_value,
+                        std::span<std::byte, sizeof(T)> p_bytes) noexcept
+{
+  auto value = static_cast<std::make_unsigned_t<T>>(p_value);
+  for (size_t i = 0; i < sizeof(T); i++) {
+    const size_t index = (Order == std::endian::big) ? sizeof(T) - 1 - i : i;
+    p_bytes[index] = static_cast<std::byte>(value & 0xFFU);
+    value = static_cast<decltype(value)>(value >> 8U);
+  }
+}
+
+/**
+ * @brief Reverse the order of the bits of a value
+ *
+ * @tparam T - the type
+ * @param p_value - value to reverse
+ * @return constexpr T - bit reversed value
+ */
+template<std::unsigned_integral T>
+[[nodiscard]] constexpr T reverse_bits(T p_value) noexcept
+{
+#if defined(__clang__)
+  if constexpr (sizeof(T) == 1) {
+    return __builtin_bitreverse8(p_value);
+  } else if constexpr (sizeof(T) == 2) {
+    return __builtin_bitreverse16(p_value);
+  } else if constexpr (sizeof(T) == 4) {
+    return __builtin_bitreverse32(p_value);
+  } else if constexpr (sizeof(T) == 8) {
+    return __builtin_bitreverse64(p_value);
+  }
+#elif defined(__ARM_ARCH_ISA_THUMB) && __ARM_ARCH_ISA_THUMB >= 2
+  if (!std::is_constant_evaluated() && sizeof(T) <= sizeof(std::uint32_t)) {
+    const auto value = static_cast<std::uint32_t>(p_value);
+    std::uint32_t result;
+    asm("rbit %0, %1" : "=r"(result) : "r"(value));
+    return static_cast<T>(result >> (32U - std::numeric_limits<T>::digits));
+  }
+#endif
+
+  // Swap adjacent bits, then pairs, then nibbles, then bytes
+  auto value = p_value;
+  for (size_t shift = 1; shift < 8; shift <<= 1U) {
+    const auto ones = std::numeric_limits<T>::max();
+    const auto mask = static_cast<T>(
+      ones / static_cast<T>((T{ 1 } << (2 * shift)) - 1U) *
+      static_cast<T>((T{ 1 } << shift) - 1U));
+    value = static_cast<T>(((value >> shift) & mask) |
+                           static_cast<T>((value & mask) << shift));
+  }
+  return byteswap(value);
+}
+
+/// Order in which the bits of packed values are stored within each byte
+enum class bit_order
+{
+  /// The first value begins at the most significant bit of the first byte.
+  /// Typical of SPI ADCs and big endian protocols.
+  msb_first,
+  /// The first value begins at the least significant bit of the first byte.
+  /// Typical of little endian protocols and bit fields.
+  lsb_first,
+};
+
+/**
+ * @brief Unpack a stream of Width bit values packed back to back, such as a
+ * block of 12-bit ADC samples.
+ *
+ * If T is signed, each value is sign extended from Width bits. Whenever
+ * Width and 8 share a common multiple of 64 bits or fewer (for example
+ * 10, 12, 14, 16, 20 and 24), the bytes are consumed in groups with the shift
+ * of each value within the group known at compile time.
+ *
+ * ```
+ * std::array<std::int16_t, 64> samples;
+ * auto unpacked = embed::unpack_bits<12, std::int16_t>(packed, samples);
+ * ```
+ *
+ * @tparam Width - number of bits in each value
+ * @tparam T - type of the unpacked values
+ * @tparam Order - order of the bits within each byte
+ * @param p_packed - packed values
+ * @param p_output - destination for the unpacked values
+ * @return constexpr std::span<T> - the portion of p_output that was written
+ * to, the lesser of the number of complete values in p_packed and the size of
+ * p_output.
+ */
+template<size_t Width,
+         std::integral T,
+         bit_order Order = bit_order::msb_first>
+constexpr std::span<T> unpack_bits(
+  std::span<const std::byte> p_packed,
+  std::type_identity_t<std::span<T>> p_output) noexcept
+{
+  static_assert(Width > 0, "The Width cannot be 0.");
+  static_assert(Width <= 32, "The Width cannot exceed 32 bits.");
+  static_assert(Width <= std::numeric_limits<std::make_unsigned_t<T>>::digits,
+                "The Width exceed the number of bits in the output type.");
+
+  constexpr auto mask = generate_field_of_ones<Width, std::uint64_t>();
+  constexpr auto convert = [](std::uint64_t p_raw) -> T {
+    if constexpr (std::is_signed_v<T>) {
+      return static_cast<T>(sign_extend<Width>(p_raw));
+    } else {
+      return static_cast<T>(p_raw);
+    }
+  };
+
+  const size_t count = std::min(p_output.size(), p_packed.size() * 8 / Width);
+  size_t output = 0;
+  size_t input = 0;
+
+  constexpr size_t group_bits = std::lcm(Width, size_t{ 8 });
+  if constexpr (group_bits <= 64) {
+    constexpr size_t group_bytes = group_bits / 8;
+    constexpr size_t group_values = group_bits / Width;
+
+    for (; count - output >= group_values; output += group_values) {
+      std::uint64_t group = 0;
+      for (size_t i = 0; i < group_bytes; i++) {
+        const auto byte = std::to_integer<std::uint64_t>(p_packed[input + i]);
+        if constexpr (Order == bit_order::msb_first) {
+          group = group << 8U | byte;
+        } else {
+          group = group | byte << (8U * i);
+        }
+      }
+      input += group_bytes;
+
+      for (size_t i = 0; i < group_values; i++) {
+        const size_t shift = (Order == bit_order::msb_first)
+                               ? group_bits - Width * (i + 1)
+                               : Width * i;
+        p_output[output + i] = convert((group >> shift) & mask);
+      }
+    }
+  }
+
+  // Values remaining after the last complete group
+  std::uint64_t accumulator = 0;
+  size_t bits = 0;
+  for (; output < count; output++) {
+    while (bits < Width) {
+      const auto byte = std::to_integer<std::uint64_t>(p_packed[input++]);
+      if constexpr (Order == bit_order::msb_first) {
+        accumulator = accumulator << 8U | byte;
+      } else {
+        accumulator = accumulator | byte << bits;
+      }
+      bits += 8;
+    }
+
+    bits -= Width;
+    if constexpr (Order == bit_order::msb_first) {
+      p_output[output] = convert((accumulator >> bits) & mask);
+    } else {
+      p_output[output] = convert(accumulator & mask);
+      accumulator = accumulator >> Width;
+    }
+  }
+
+  return p_output.first(count);
+}
+
+/**
+ * @brief Pack values back to back as Width bit values, the inverse of
+ * unpack_bits()
+ *
+ * Bits of each value beyond Width are discarded. Unused bits of the final
+ * byte are 0.
+ *
+ * @tparam Width - number of bits in each value
+ * @tparam T - type of the values to pack
+ * @tparam Order - order of the bits within each byte
+ * @param p_input - values to pack
+ * @param p_packed - destination for the packed values
+ * @return constexpr std::span<std::byte> - the portion of p_packed that was
+ * written to. Only as many values as completely fit in p_packed are packed.
+ */
+template<size_t Width,
+         std::integral T,
+         bit_order Order = bit_order::msb_first>
+constexpr std::span<std::byte> pack_bits(
+  std::type_identity_t<std::span<const T>> p_input,
+  std::span<std::byte> p_packed) noexcept
+{
+  static_assert(Width > 0, "The Width cannot be 0.");
+  static_assert(Width <= 32, "The Width cannot exceed 32 bits.");
+
+  constexpr auto mask = generate_field_of_ones<Width, std::uint64_t>();
+  const size_t count = std::min(p_input.size(), p_packed.size() * 8 / Width);
+
+  std::uint64_t accumulator = 0;
+  size_t bits = 0;
+  size_t output = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const auto value = static_cast<std::uint64_t>(p_input[i]) & mask;
+    if constexpr (Order == bit_order::msb_first) {
+      accumulator = accumulator << Width | value;
+    } else {
+      accumulator = accumulator | value << bits;
+    }
+    bits += Width;
+
+    for (; bits >= 8; bits -= 8) {
+      if constexpr (Order == bit_order::msb_first) {
+        p_packed[output++] = static_cast<std::byte>(accumulator >> (bits - 8));
+      } else {
+        p_packed[output++] = static_cast<std::byte>(accumulator);
+        accumulator = accumulator >> 8U;
+      }
+    }
+  }
+
+  if (bits > 0) {
+    if constexpr (Order == bit_order::msb_first) {
+      p_packed[output++] = static_cast<std::byte>(accumulator << (8 - bits));
+    } else {
+      p_packed[output++] = static_cast<std::byte>(accumulator);
+    }
+  }
+
+  return p_packed.first(output);
+}
+}  // namespace embed
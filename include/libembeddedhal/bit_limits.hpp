@@ -2,6 +2,8 @@
 
 #include <concepts>
 #include <cstddef>
+#include <limits>
+#include <type_traits>
 
 namespace embed {
 /**
@@ -9,16 +11,21 @@ namespace embed {
  *
  * @tparam BitWidth - number of 1s in the mask
  * @tparam T - the type
- * @return consteval uint32_t - mask with 1s at the LSB
+ * @return consteval T - mask with 1s at the LSB
  */
 template<size_t BitWidth, std::integral T>
 [[nodiscard]] consteval T generate_field_of_ones() noexcept
 {
-  T result = 0;
-  for (size_t i = 0; i < BitWidth; i++) {
-    result |= 1 << i;
+  using unsigned_t = std::make_unsigned_t<T>;
+  constexpr size_t width = std::numeric_limits<unsigned_t>::digits;
+  static_assert(BitWidth <= width,
+                "The BitWidth exceed the number of bits in the integer type.");
+
+  if constexpr (BitWidth == width) {
+    return static_cast<T>(static_cast<unsigned_t>(~unsigned_t{ 0 }));
+  } else {
+    return static_cast<T>((unsigned_t{ 1 } << BitWidth) - 1U);
   }
-  return result;
 }
 
 /**
@@ -49,13 +56,12 @@ struct bit_limits
    */
   [[nodiscard]] static constexpr int_t max() noexcept
   {
+    using unsigned_t = std::make_unsigned_t<int_t>;
     if constexpr (std::is_signed_v<int_t>) {
-      int_t max = generate_field_of_ones<BitWidth, int_t>();
-      max = max >> 1;
-      return max;
+      return static_cast<int_t>(
+        generate_field_of_ones<BitWidth, unsigned_t>() >> 1);
     } else {
-      int_t max = generate_field_of_ones<BitWidth, int_t>();
-      return max;
+      return generate_field_of_ones<BitWidth, int_t>();
     }
   }
 
@@ -70,11 +76,8 @@ struct bit_limits
    */
   [[nodiscard]] static constexpr int_t min() noexcept
   {
-    if constexpr (BitWidth == 64) {
-      return std::numeric_limits<int_t>::min();
-    } else if constexpr (std::is_signed_v<int_t>) {
-      int_t min = (1ULL << BitWidth);
-      return min;
+    if constexpr (std::is_signed_v<int_t>) {
+      return static_cast<int_t>(-max() - 1);
     } else {
       return 0U;
     }
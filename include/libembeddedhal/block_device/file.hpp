@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Block device backed by a file on a hosted system
+ *
+ * Allows storage code, such as loggers and file systems, to run on a
+ * development machine against a disk image, and its throughput and access
+ * patterns to be measured. Blocks beyond the end of the file read as erased,
+ * 0xFF, and erasing fills blocks with 0xFF.
+ *
+ * Asynchronous operations complete before returning.
+ */
+class file_block_device : public block_device
+{
+public:
+  /// Counts of the operations performed on the device
+  struct statistics
+  {
+    /// Number of calls to read()
+    std::uint64_t reads = 0;
+    /// Number of calls to write()
+    std::uint64_t writes = 0;
+    /// Number of calls to erase()
+    std::uint64_t erases = 0;
+    /// Number of blocks read
+    std::uint64_t blocks_read = 0;
+    /// Number of blocks written
+    std::uint64_t blocks_written = 0;
+    /// Number of blocks erased
+    std::uint64_t blocks_erased = 0;
+  };
+
+  /**
+   * @brief Open or create a disk image
+   *
+   * If the file cannot be opened, every operation returns
+   * `std::errc::io_error`.
+   *
+   * @param p_path - path of the disk image, created if it does not exist
+   * @param p_properties - geometry of the device
+   */
+  file_block_device(const char* p_path, properties p_properties)
+    : m_properties(p_properties)
+  {
+    m_file = std::fopen(p_path, "r+b");
+    if (m_file == nullptr) {
+      m_file = std::fopen(p_path, "w+b");
+    }
+    if (m_file != nullptr && std::fseek(m_file, 0, SEEK_END) == 0) {
+      m_size = static_cast<std::uint64_t>(std::ftell(m_file));
+      m_position = m_size;
+    }
+  }
+
+  file_block_device(const file_block_device&) = delete;
+  file_block_device& operator=(const file_block_device&) = delete;
+
+  ~file_block_device()
+  {
+    if (m_file != nullptr) {
+      std::fclose(m_file);
+    }
+  }
+
+  /**
+   * @brief Get the counts of operations performed since construction or the
+   * last call to reset_statistics()
+   *
+   * @return const statistics& - operation counts
+   */
+  [[nodiscard]] const statistics& stats() const noexcept { return m_stats; }
+
+  /**
+   * @brief Reset the operation counts to zero
+   *
+   */
+  void reset_statistics() noexcept { m_stats = {}; }
+
+private:
+  boost::leaf::result<properties> driver_info() noexcept override
+  {
+    return m_properties;
+  }
+
+  boost::leaf::result<void> driver_read(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data) noexcept override
+  {
+    BOOST_LEAF_CHECK(seek(p_block * m_properties.block_size, direction::read));
+    const size_t bytes = std::fread(p_data.data(), 1, p_data.size(), m_file);
+    m_position += bytes;
+    if (bytes != p_data.size()) {
+      if (std::ferror(m_file) != 0) {
+        return boost::leaf::new_error(std::errc::io_error);
+      }
+      std::clearerr(m_file);
+      std::fill(p_data.begin() + static_cast<std::ptrdiff_t>(bytes),
+                p_data.end(),
+                erased);
+    }
+    m_stats.reads++;
+    m_stats.blocks_read += p_data.size() / m_properties.block_size;
+    return {};
+  }
+
+  boost::leaf::result<void> driver_write(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data) noexcept override
+  {
+    BOOST_LEAF_CHECK(seek_for_write(p_block));
+    BOOST_LEAF_CHECK(put(p_data.data(), p_data.size()));
+    m_stats.writes++;
+    m_stats.blocks_written += p_data.size() / m_properties.block_size;
+    return {};
+  }
+
+  boost::leaf::result<void> driver_erase(
+    std::uint64_t p_block,
+    std::uint64_t p_count) noexcept override
+  {
+    BOOST_LEAF_CHECK(seek_for_write(p_block));
+    BOOST_LEAF_CHECK(fill(p_count * m_properties.block_size));
+
+    m_stats.erases++;
+    m_stats.blocks_erased += p_count;
+    return {};
+  }
+
+  boost::leaf::result<void> driver_flush() noexcept override
+  {
+    if (m_file == nullptr || std::fflush(m_file) != 0) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return {};
+  }
+
+  enum class direction
+  {
+    read,
+    write,
+  };
+
+  /// Move to a byte position. The C library requires a seek between reads and
+  /// writes, otherwise seeks are skipped when already at the position so that
+  /// sequential access stays buffered.
+  boost::leaf::result<void> seek(std::uint64_t p_position,
+                                 direction p_direction) noexcept
+  {
+    if (m_file == nullptr) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    if (p_position == m_position && p_direction == m_direction) {
+      return {};
+    }
+    if (std::fseek(m_file, static_cast<long>(p_position), SEEK_SET) != 0) {
+      m_position = unknown_position;
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    m_position = p_position;
+    m_direction = p_direction;
+    return {};
+  }
+
+  /// Move to a block, first extending the file with erased bytes if the
+  /// block is beyond its end so that skipped blocks read as erased.
+  boost::leaf::result<void> seek_for_write(std::uint64_t p_block) noexcept
+  {
+    const std::uint64_t position = p_block * m_properties.block_size;
+    if (m_size < position) {
+      BOOST_LEAF_CHECK(seek(m_size, direction::write));
+      return fill(position - m_size);
+    }
+    return seek(position, direction::write);
+  }
+
+  /// Write bytes at the current position
+  boost::leaf::result<void> put(const std::byte* p_data, size_t p_size) noexcept
+  {
+    const size_t written = std::fwrite(p_data, 1, p_size, m_file);
+    m_position += written;
+    m_size = std::max(m_size, m_position);
+    if (written != p_size) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return {};
+  }
+
+  /// Write erased bytes at the current position
+  boost::leaf::result<void> fill(std::uint64_t p_bytes) noexcept
+  {
+    std::array<std::byte, 512> blank;
+    blank.fill(erased);
+    while (p_bytes > 0) {
+      const auto length =
+        static_cast<size_t>(std::min<std::uint64_t>(blank.size(), p_bytes));
+      BOOST_LEAF_CHECK(put(blank.data(), length));
+      p_bytes -= length;
+    }
+    return {};
+  }
+
+  static constexpr std::byte erased{ 0xFF };
+
+  properties m_properties;
+  statistics m_stats{};
+  static constexpr std::uint64_t unknown_position = ~std::uint64_t{ 0 };
+
+  std::FILE* m_file = nullptr;
+  std::uint64_t m_size = 0;
+  std::uint64_t m_position = unknown_position;
+  direction m_direction = direction::read;
+};
+}  // namespace embed
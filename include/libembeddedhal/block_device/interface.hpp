@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include "../error.hpp"
+
+namespace embed {
+/**
+ * @brief Block storage hardware abstraction interface.
+ *
+ * Use this interface for storage that is read and written in fixed size
+ * blocks, such as SD cards, eMMC and flash memory.
+ *
+ * Reads and writes may cover any number of consecutive blocks. Drivers should
+ * transfer ranges in as few transactions as the device allows, for example
+ * with multi-block read and write commands, so callers should pass the largest
+ * range they have available rather than one block at a time.
+ *
+ */
+class block_device
+{
+public:
+  /// Geometry of a block device
+  struct properties
+  {
+    /// Number of bytes in each block, the unit of reads and writes
+    size_t block_size = 512;
+    /// Number of blocks on the device
+    std::uint64_t block_count = 0;
+    /// Number of blocks erased at once. Erase ranges must be aligned to and a
+    /// multiple of this number of blocks.
+    std::uint64_t erase_block_count = 1;
+    /// True if blocks must be erased before they can be written again, as is
+    /// the case for raw flash memory. False for devices that manage erasure
+    /// internally, such as SD cards.
+    bool erase_before_write = false;
+
+    /**
+     * @brief Default operators for <, <=, >, >= and ==
+     *
+     * @return auto - result of the comparison
+     */
+    [[nodiscard]] constexpr auto operator<=>(const properties&) const noexcept =
+      default;
+  };
+
+  /**
+   * @brief Function called when an asynchronous operation completes.
+   *
+   * May be called from an interrupt context, or before the asynchronous
+   * function returns if the driver completes the operation immediately.
+   *
+   * p_success is false if the operation failed.
+   */
+  using completion_handler = std::function<void(bool p_success)>;
+
+  /**
+   * @brief Get the geometry of the device
+   *
+   * @return boost::leaf::result<properties> - geometry of the device or any
+   * error that occurred during this operation.
+   */
+  [[nodiscard]] boost::leaf::result<properties> info() noexcept
+  {
+    return driver_info();
+  }
+
+  /**
+   * @brief Read a range of blocks
+   *
+   * @param p_block - index of the first block to read
+   * @param p_data - destination for the blocks. Its size must be a multiple of
+   * the block size and determines the number of blocks read.
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if p_data is not a
+   * multiple of the block size or the range extends past the end of the
+   * device.
+   */
+  [[nodiscard]] boost::leaf::result<void> read(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data) noexcept
+  {
+    BOOST_LEAF_CHECK(validate(p_block, p_data.size()));
+    return driver_read(p_block, p_data);
+  }
+
+  /**
+   * @brief Write a range of blocks
+   *
+   * @param p_block - index of the first block to write
+   * @param p_data - blocks to write. Its size must be a multiple of the block
+   * size and determines the number of blocks written.
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if p_data is not a
+   * multiple of the block size or the range extends past the end of the
+   * device.
+   */
+  [[nodiscard]] boost::leaf::result<void> write(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data) noexcept
+  {
+    BOOST_LEAF_CHECK(validate(p_block, p_data.size()));
+    return driver_write(p_block, p_data);
+  }
+
+  /**
+   * @brief Erase a range of blocks
+   *
+   * The contents of erased blocks are device specific.
+   *
+   * @param p_block - index of the first block to erase
+   * @param p_count - number of blocks to erase
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if the range is not
+   * aligned to the erase block count or extends past the end of the device.
+   */
+  [[nodiscard]] boost::leaf::result<void> erase(std::uint64_t p_block,
+                                                std::uint64_t p_count) noexcept
+  {
+    const auto device = BOOST_LEAF_CHECK(driver_info());
+    if (p_block % device.erase_block_count != 0 ||
+        p_count % device.erase_block_count != 0 ||
+        p_block > device.block_count ||
+        p_count > device.block_count - p_block) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    return driver_erase(p_block, p_count);
+  }
+
+  /**
+   * @brief Commit any writes buffered or left open by the driver to the
+   * device.
+   *
+   * Drivers may keep a multi-block write open between calls to write() so
+   * that consecutive writes stream to the device. Call this before removing
+   * power or handing the device to other code.
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation.
+   */
+  [[nodiscard]] boost::leaf::result<void> flush() noexcept
+  {
+    return driver_flush();
+  }
+
+  /**
+   * @brief Start reading a range of blocks without waiting for completion
+   *
+   * Unless the driver has a non-blocking transport, the read is performed
+   * before returning and then p_on_complete is called.
+   *
+   * @param p_block - index of the first block to read
+   * @param p_data - destination for the blocks, must stay valid until
+   * p_on_complete is called. Its size must be a multiple of the block size.
+   * @param p_on_complete - called when the read completes
+   * @return boost::leaf::result<void> - any error that occurred while
+   * starting this operation. Returns `std::errc::invalid_argument` on the
+   * same conditions as read(). p_on_complete is not called if an error is
+   * returned.
+   */
+  [[nodiscard]] boost::leaf::result<void> read_async(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data,
+    completion_handler p_on_complete) noexcept
+  {
+    BOOST_LEAF_CHECK(validate(p_block, p_data.size()));
+    return driver_read_async(p_block, p_data, p_on_complete);
+  }
+
+  /**
+   * @brief Start writing a range of blocks without waiting for completion
+   *
+   * Unless the driver has a non-blocking transport, the write is performed
+   * before returning and then p_on_complete is called.
+   *
+   * @param p_block - index of the first block to write
+   * @param p_data - blocks to write, must stay valid until p_on_complete is
+   * called. Its size must be a multiple of the block size.
+   * @param p_on_complete - called when the write completes
+   * @return boost::leaf::result<void> - any error that occurred while
+   * starting this operation. Returns `std::errc::invalid_argument` on the
+   * same conditions as write(). p_on_complete is not called if an error is
+   * returned.
+   */
+  [[nodiscard]] boost::leaf::result<void> write_async(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data,
+    completion_handler p_on_complete) noexcept
+  {
+    BOOST_LEAF_CHECK(validate(p_block, p_data.size()));
+    return driver_write_async(p_block, p_data, p_on_complete);
+  }
+
+private:
+  boost::leaf::result<void> validate(std::uint64_t p_block,
+                                     size_t p_bytes) noexcept
+  {
+    const auto device = BOOST_LEAF_CHECK(driver_info());
+    const std::uint64_t count = p_bytes / device.block_size;
+    if (p_bytes % device.block_size != 0 || p_block > device.block_count ||
+        count > device.block_count - p_block) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    return {};
+  }
+
+  virtual boost::leaf::result<properties> driver_info() noexcept = 0;
+  virtual boost::leaf::result<void> driver_read(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data) noexcept = 0;
+  virtual boost::leaf::result<void> driver_write(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data) noexcept = 0;
+  virtual boost::leaf::result<void> driver_erase(
+    std::uint64_t p_block,
+    std::uint64_t p_count) noexcept = 0;
+  virtual boost::leaf::result<void> driver_flush() noexcept = 0;
+
+  // Drivers with a non-blocking transport override the following, the
+  // defaults complete the operation before returning.
+  virtual boost::leaf::result<void> driver_read_async(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data,
+    completion_handler p_on_complete) noexcept
+  {
+    p_on_complete(static_cast<bool>(driver_read(p_block, p_data)));
+    return {};
+  }
+  virtual boost::leaf::result<void> driver_write_async(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data,
+    completion_handler p_on_complete) noexcept
+  {
+    p_on_complete(static_cast<bool>(driver_write(p_block, p_data)));
+    return {};
+  }
+};
+}  // namespace embed
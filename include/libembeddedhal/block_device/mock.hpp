@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../testing.hpp"
+#include "interface.hpp"
+
+namespace embed::mock {
+/**
+ * @brief Mock block device implementation backed by memory for use in unit
+ * tests and simulations.
+ *
+ * Every read, write and erase is recorded along with its block range so that
+ * access patterns can be inspected. Erased blocks are filled with 0xFF, like
+ * flash memory. Asynchronous operations complete immediately.
+ */
+struct block_device : public embed::block_device
+{
+  /**
+   * @brief Construct a new block device
+   *
+   * @param p_properties - geometry of the device
+   */
+  block_device(properties p_properties = { .block_count = 64 })
+    : storage(p_properties.block_size * p_properties.block_count,
+              std::byte{ 0xFF })
+    , m_properties(p_properties)
+  {}
+
+  /**
+   * @brief Reset spy information for read(), write(), erase() and flush()
+   *
+   */
+  void reset()
+  {
+    spy_read.reset();
+    spy_write.reset();
+    spy_erase.reset();
+    spy_flush.reset();
+  }
+
+  /// Spy handler for embed::block_device::read(), records the first block and
+  /// number of blocks
+  spy_handler<std::uint64_t, std::uint64_t> spy_read;
+  /// Spy handler for embed::block_device::write(), records the first block and
+  /// number of blocks
+  spy_handler<std::uint64_t, std::uint64_t> spy_write;
+  /// Spy handler for embed::block_device::erase(), records the first block and
+  /// number of blocks
+  spy_handler<std::uint64_t, std::uint64_t> spy_erase;
+  /// Spy handler for embed::block_device::flush()
+  spy_handler<bool> spy_flush;
+  /// Contents of the device
+  std::vector<std::byte> storage;
+
+private:
+  boost::leaf::result<properties> driver_info() noexcept override
+  {
+    return m_properties;
+  }
+  boost::leaf::result<void> driver_read(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data) noexcept override
+  {
+    BOOST_LEAF_CHECK(spy_read.record(p_block, count(p_data.size())));
+    std::copy_n(
+      storage.begin() + offset(p_block), p_data.size(), p_data.data());
+    return {};
+  }
+  boost::leaf::result<void> driver_write(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data) noexcept override
+  {
+    BOOST_LEAF_CHECK(spy_write.record(p_block, count(p_data.size())));
+    std::copy(p_data.begin(), p_data.end(), storage.begin() + offset(p_block));
+    return {};
+  }
+  boost::leaf::result<void> driver_erase(
+    std::uint64_t p_block,
+    std::uint64_t p_count) noexcept override
+  {
+    BOOST_LEAF_CHECK(spy_erase.record(p_block, p_count));
+    std::fill_n(storage.begin() + offset(p_block),
+                offset(p_count),
+                std::byte{ 0xFF });
+    return {};
+  }
+  boost::leaf::result<void> driver_flush() noexcept override
+  {
+    return spy_flush.record(true);
+  }
+
+  std::ptrdiff_t offset(std::uint64_t p_blocks) const noexcept
+  {
+    return static_cast<std::ptrdiff_t>(p_blocks * m_properties.block_size);
+  }
+  std::uint64_t count(size_t p_bytes) const noexcept
+  {
+    return p_bytes / m_properties.block_size;
+  }
+
+  properties m_properties;
+};
+}  // namespace embed::mock
@@ -0,0 +1,865 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../bit.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Log-structured key/value record store on a block device
+ *
+ * Records are only ever appended, so small updates never rewrite a whole
+ * block or sector, which suits flash memory and SD cards alike.
+ *
+ * The device is divided into segments, each a fixed number of erase blocks.
+ * Segments are used in order around the device as a circular log, so every
+ * segment is erased equally often, which levels wear without any extra
+ * bookkeeping.
+ *
+ * Writes are batched: put() and remove() fill a block sized buffer in RAM
+ * which is written to the device when full. Records are durable once
+ * commit() returns. Each block carries a sequence number, the batch it
+ * belongs to, a commit flag and a CRC. When mounting, the log is replayed in
+ * sequence order and a batch's records are only applied once its commit
+ * block is found. A crash or power loss therefore loses at most the records
+ * written since the last commit, and never leaves a batch partly applied.
+ *
+ * Superseded records are reclaimed by compaction, which copies the live
+ * records of the oldest segment to the head of the log, commits and then
+ * erases the segment. As compaction commits, it only runs between batches:
+ * automatically when the first record of a batch finds the log down to its
+ * reserve of free segments, or in the background, for example from an idle
+ * loop, by calling compact(), which keeps the latency of put() predictable.
+ * A batch may use every free segment except the reserve, beyond which put()
+ * returns `std::errc::no_space_on_device`.
+ *
+ * The in-RAM index of keys to record locations, along with two block
+ * buffers, the segment table and the list of uncommitted records found while
+ * mounting, are allocated from the memory resource passed to the
+ * constructor, about 56 bytes per key of settings::max_keys, two blocks and
+ * 4 bytes per segment. Everything is allocated by the constructor and the
+ * first mount, so a monotonic resource such as embed::static_memory_resource
+ * is suitable.
+ *
+ * ```
+ * embed::static_memory_resource<8192> memory;
+ * embed::record_store store(sd_card, memory);
+ * BOOST_LEAF_CHECK(store.mount());
+ * BOOST_LEAF_CHECK(store.put(calibration_key, calibration_bytes));
+ * BOOST_LEAF_CHECK(store.commit());
+ * ```
+ */
+class record_store
+{
+public:
+  /// Key of a record
+  using key_t = std::uint32_t;
+
+  /// Settings for the record store
+  struct settings
+  {
+    /// Number of blocks in each segment, must be a multiple of the device's
+    /// erase block count. Larger segments reduce the number of erases but
+    /// increase the space reserved for compaction.
+    std::uint64_t segment_blocks = 8;
+    /// Maximum number of keys held in the store
+    size_t max_keys = 64;
+    /// Number of free segments kept in reserve so that compaction always has
+    /// room to copy live records into, at least 1. The device must hold at
+    /// least reserve_segments + 2 segments.
+    std::uint64_t reserve_segments = 1;
+    /// compact() reclaims segments while the number of free segments is at
+    /// or below this number.
+    std::uint64_t compaction_threshold = 2;
+  };
+
+  /// Counts of the work performed by the store since mounting
+  struct statistics
+  {
+    /// Number of calls to put() and remove()
+    std::uint64_t records_written = 0;
+    /// Number of value bytes passed to put()
+    std::uint64_t bytes_written = 0;
+    /// Number of blocks written to the device
+    std::uint64_t blocks_written = 0;
+    /// Number of blocks erased on the device
+    std::uint64_t blocks_erased = 0;
+    /// Number of segments reclaimed by compaction
+    std::uint64_t compactions = 0;
+    /// Number of live records copied by compaction
+    std::uint64_t records_moved = 0;
+  };
+
+  /**
+   * @brief Construct a new record store
+   *
+   * mount() or format() must be called before the store can be used.
+   *
+   * @param p_device - block device to store records on
+   * @param p_memory_resource - memory resource used for the index and buffers
+   * @param p_settings - store settings
+   */
+  record_store(block_device& p_device,
+               std::pmr::memory_resource& p_memory_resource,
+               settings p_settings)
+    : m_device(&p_device)
+    , m_settings(p_settings)
+    , m_index(&p_memory_resource)
+    , m_segments(&p_memory_resource)
+    , m_buffer(&p_memory_resource)
+    , m_scratch(&p_memory_resource)
+    , m_pending(&p_memory_resource)
+  {
+    m_index.reserve(m_settings.max_keys);
+    m_pending.reserve(m_settings.max_keys);
+  }
+
+  /**
+   * @brief Construct a new record store with the default settings
+   *
+   * @param p_device - block device to store records on
+   * @param p_memory_resource - memory resource used for the index and buffers
+   */
+  record_store(block_device& p_device,
+               std::pmr::memory_resource& p_memory_resource)
+    : record_store(p_device, p_memory_resource, settings{})
+  {}
+
+  /**
+   * @brief Load the records committed to the device
+   *
+   * A device that has never been formatted, or was erased, mounts as an empty
+   * store.
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if the settings do not
+   * suit the device's geometry and `std::errc::not_enough_memory` if the
+   * device holds more than settings::max_keys keys.
+   */
+  [[nodiscard]] boost::leaf::result<void> mount() noexcept
+  {
+    BOOST_LEAF_CHECK(prepare());
+
+    // The first block of a segment holds the sequence number the segment
+    // started at, giving the order of the segments in the log.
+    for (std::uint64_t segment = 0; segment < m_segments.size(); segment++) {
+      BOOST_LEAF_CHECK(m_device->read(first_block(segment), m_scratch));
+      const auto header = parse(m_scratch);
+      m_segments[segment] = header ? header->sequence : unknown_segment;
+    }
+
+    std::uint32_t last_sequence = 0;
+    std::optional<std::uint64_t> newest;
+    while (auto segment = oldest_segment_after(last_sequence)) {
+      last_sequence = BOOST_LEAF_CHECK(replay(*segment));
+      newest = segment;
+    }
+    m_pending.clear();
+
+    // Always continue in a fresh segment as the end of the newest segment
+    // may hold a block torn by power loss.
+    start(last_sequence + 1, newest.value_or(m_segments.size() - 1));
+    return {};
+  }
+
+  /**
+   * @brief Erase the device and mount it as an empty store
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation.
+   */
+  [[nodiscard]] boost::leaf::result<void> format() noexcept
+  {
+    BOOST_LEAF_CHECK(prepare());
+    for (std::uint64_t segment = 0; segment < m_segments.size(); segment++) {
+      BOOST_LEAF_CHECK(erase_segment(segment));
+      m_segments[segment] = free_segment;
+    }
+    start(1, m_segments.size() - 1);
+    return {};
+  }
+
+  /**
+   * @brief Store a value for a key, replacing any previous value
+   *
+   * The record is buffered and is not durable until commit() is called,
+   * although it is immediately visible to get().
+   *
+   * @param p_key - key of the record
+   * @param p_value - value of the record, at most max_value_size() bytes
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if the value is too
+   * large, `std::errc::not_enough_memory` if the store already holds
+   * settings::max_keys keys and `std::errc::no_space_on_device` if
+   * compaction cannot free enough space or the batch needs more than the free
+   * segments outside of the reserve.
+   */
+  [[nodiscard]] boost::leaf::result<void> put(
+    key_t p_key,
+    std::span<const std::byte> p_value) noexcept
+  {
+    if (p_value.size() > max_value_size()) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    auto entry = find(p_key);
+    if (entry == m_index.end() && m_index.size() == m_settings.max_keys) {
+      return boost::leaf::new_error(std::errc::not_enough_memory);
+    }
+
+    const auto where =
+      BOOST_LEAF_CHECK(append(p_key, record_type::value, p_value));
+    // Appending may compact, which moves index entries
+    entry = find(p_key);
+    if (entry != m_index.end() && entry->key == p_key) {
+      entry->where = where;
+    } else {
+      m_index.insert(entry, { .key = p_key, .where = where });
+    }
+
+    m_stats.records_written++;
+    m_stats.bytes_written += p_value.size();
+    return {};
+  }
+
+  /**
+   * @brief Remove a key and its value
+   *
+   * Like put(), the removal is not durable until commit() is called.
+   *
+   * @param p_key - key of the record to remove
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Removing a key that does not exist does nothing.
+   */
+  [[nodiscard]] boost::leaf::result<void> remove(key_t p_key) noexcept
+  {
+    if (!contains(p_key)) {
+      return {};
+    }
+    BOOST_LEAF_CHECK(append(p_key, record_type::tombstone, {}));
+    m_index.erase(find(p_key));
+    m_stats.records_written++;
+    return {};
+  }
+
+  /**
+   * @brief Make every record put or removed so far durable
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation.
+   */
+  [[nodiscard]] boost::leaf::result<void> commit() noexcept
+  {
+    if (batch_open()) {
+      BOOST_LEAF_CHECK(write_block(true));
+    }
+    return m_device->flush();
+  }
+
+  /**
+   * @brief Read the value of a key
+   *
+   * @param p_key - key of the record
+   * @param p_value - destination for the value
+   * @return boost::leaf::result<std::span<std::byte>> - the portion of
+   * p_value holding the value. Returns `std::errc::no_such_file_or_directory`
+   * if the key does not exist and `std::errc::no_buffer_space` if p_value is
+   * too small.
+   */
+  [[nodiscard]] boost::leaf::result<std::span<std::byte>> get(
+    key_t p_key,
+    std::span<std::byte> p_value) noexcept
+  {
+    if (!contains(p_key)) {
+      return boost::leaf::new_error(std::errc::no_such_file_or_directory);
+    }
+    const auto where = find(p_key)->where;
+    if (where.length > p_value.size()) {
+      return boost::leaf::new_error(std::errc::no_buffer_space);
+    }
+
+    std::span<const std::byte> block = m_buffer;
+    if (where.block != head_block()) {
+      BOOST_LEAF_CHECK(m_device->read(where.block, m_scratch));
+      block = m_scratch;
+    }
+    const auto value = block.subspan(where.offset + record_header_size,
+                                     where.length);
+    std::copy(value.begin(), value.end(), p_value.begin());
+    return p_value.first(where.length);
+  }
+
+  /**
+   * @brief Determine if a key exists in the store
+   *
+   * @param p_key - key to find
+   * @return true - the key has a value
+   * @return false - the key does not exist
+   */
+  [[nodiscard]] bool contains(key_t p_key) const noexcept
+  {
+    const auto entry = find(p_key);
+    return entry != m_index.end() && entry->key == p_key;
+  }
+
+  /**
+   * @brief Get the number of keys in the store
+   *
+   * @return size_t - number of keys
+   */
+  [[nodiscard]] size_t size() const noexcept { return m_index.size(); }
+
+  /**
+   * @brief Reclaim the oldest segment if free segments are at or below
+   * settings::compaction_threshold.
+   *
+   * Intended to be called when the application is idle so that put() rarely
+   * needs to compact. Does nothing while records put or removed since the
+   * last commit() are pending.
+   *
+   * @return boost::leaf::result<bool> - true if a segment was reclaimed
+   */
+  [[nodiscard]] boost::leaf::result<bool> compact() noexcept
+  {
+    const auto oldest = oldest_segment_after(0);
+    if (batch_open() ||
+        free_segments() > m_settings.compaction_threshold || !oldest ||
+        *oldest == m_head) {
+      return false;
+    }
+    BOOST_LEAF_CHECK(compact_oldest());
+    return true;
+  }
+
+  /**
+   * @brief Get the number of segments that are erased and ready for writing
+   *
+   * @return std::uint64_t - number of free segments
+   */
+  [[nodiscard]] std::uint64_t free_segments() const noexcept
+  {
+    return static_cast<std::uint64_t>(
+      std::count_if(m_segments.begin(), m_segments.end(), is_free));
+  }
+
+  /**
+   * @brief Get the largest value that can be stored
+   *
+   * @return size_t - maximum value size in bytes
+   */
+  [[nodiscard]] size_t max_value_size() const noexcept
+  {
+    return m_buffer.size() - block_header_size - record_header_size;
+  }
+
+  /**
+   * @brief Get the counts of work performed since mounting
+   *
+   * The write amplification is the bytes written to the device,
+   * blocks_written multiplied by the block size, divided by bytes_written.
+   *
+   * @return const statistics& - work counts
+   */
+  [[nodiscard]] const statistics& stats() const noexcept { return m_stats; }
+
+private:
+  struct location
+  {
+    std::uint64_t block = 0;
+    std::uint16_t offset = 0;
+    std::uint16_t length = 0;
+  };
+
+  struct index_entry
+  {
+    key_t key;
+    location where;
+  };
+
+  struct pending_record
+  {
+    key_t key;
+    location where;
+    bool tombstone;
+  };
+
+  struct block_header
+  {
+    std::uint32_t sequence;
+    std::uint32_t batch;
+    std::uint16_t used;
+    bool commit;
+  };
+
+  enum class record_type : std::uint8_t
+  {
+    value = 1,
+    tombstone = 2,
+  };
+
+  // Block layout: magic, sequence, batch, used, flags, reserved, CRC32 of the
+  // header and records.
+  static constexpr std::uint32_t magic = 0x5245'434C;
+  static constexpr size_t block_header_size = 20;
+  static constexpr size_t crc_offset = 16;
+  static constexpr std::uint8_t commit_flag = 0x01;
+  // Record layout: key, length, type, reserved, value.
+  static constexpr size_t record_header_size = 8;
+  // Segment table values for segments without records. Free segments are
+  // known to be erased, the contents of unknown segments were not recognised
+  // when mounting.
+  static constexpr std::uint32_t free_segment = 0;
+  static constexpr std::uint32_t unknown_segment =
+    std::numeric_limits<std::uint32_t>::max();
+
+  static bool is_free(std::uint32_t p_sequence) noexcept
+  {
+    return p_sequence == free_segment || p_sequence == unknown_segment;
+  }
+
+  boost::leaf::result<void> prepare() noexcept
+  {
+    const auto device = BOOST_LEAF_CHECK(m_device->info());
+    const std::uint64_t segments =
+      device.block_count /
+      std::max<std::uint64_t>(m_settings.segment_blocks, 1);
+    if (m_settings.segment_blocks == 0 || m_settings.reserve_segments == 0 ||
+        m_settings.segment_blocks % device.erase_block_count != 0 ||
+        segments < m_settings.reserve_segments + 2 ||
+        device.block_size <= block_header_size + record_header_size ||
+        device.block_size > std::numeric_limits<std::uint16_t>::max()) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    m_erase_before_write = device.erase_before_write;
+    m_segments.assign(segments, unknown_segment);
+    m_buffer.assign(device.block_size, erased);
+    m_scratch.assign(device.block_size, erased);
+    m_index.clear();
+    m_pending.clear();
+    m_stats = {};
+    return {};
+  }
+
+  /// Continue the log at the end of a segment
+  void start(std::uint32_t p_sequence, std::uint64_t p_head) noexcept
+  {
+    m_sequence = p_sequence;
+    m_batch = 0;
+    m_used = 0;
+    m_head = p_head;
+    m_head_blocks = m_settings.segment_blocks;
+  }
+
+  /// Records have been appended since the last commit
+  bool batch_open() const noexcept { return m_used > 0 || m_batch != 0; }
+
+  std::uint64_t first_block(std::uint64_t p_segment) const noexcept
+  {
+    return p_segment * m_settings.segment_blocks;
+  }
+
+  std::uint64_t head_block() const noexcept
+  {
+    return first_block(m_head) + m_head_blocks;
+  }
+
+  /// Find the segment that started earliest after the passed sequence number
+  std::optional<std::uint64_t> oldest_segment_after(
+    std::uint32_t p_sequence) const noexcept
+  {
+    std::optional<std::uint64_t> oldest;
+    for (std::uint64_t segment = 0; segment < m_segments.size(); segment++) {
+      const auto sequence = m_segments[segment];
+      if (sequence > p_sequence && !is_free(sequence) &&
+          (!oldest || sequence < m_segments[*oldest])) {
+        oldest = segment;
+      }
+    }
+    return oldest;
+  }
+
+  std::pmr::vector<index_entry>::const_iterator find(
+    key_t p_key) const noexcept
+  {
+    return std::lower_bound(m_index.begin(),
+                            m_index.end(),
+                            p_key,
+                            [](const index_entry& p_entry, key_t p_value) {
+                              return p_entry.key < p_value;
+                            });
+  }
+
+  std::pmr::vector<index_entry>::iterator find(key_t p_key) noexcept
+  {
+    return std::lower_bound(m_index.begin(),
+                            m_index.end(),
+                            p_key,
+                            [](const index_entry& p_entry, key_t p_value) {
+                              return p_entry.key < p_value;
+                            });
+  }
+
+  /// Replay the blocks of a segment into the index, returning the sequence
+  /// number of the last valid block.
+  boost::leaf::result<std::uint32_t> replay(std::uint64_t p_segment) noexcept
+  {
+    std::uint32_t expected = m_segments[p_segment];
+    for (std::uint64_t i = 0; i < m_settings.segment_blocks; i++) {
+      const std::uint64_t block = first_block(p_segment) + i;
+      BOOST_LEAF_CHECK(m_device->read(block, m_scratch));
+      const auto header = parse(m_scratch);
+      if (!header || header->sequence != expected) {
+        break;
+      }
+      expected++;
+
+      // Records of a batch that was never committed are discarded
+      if (!m_pending.empty() && m_batch != header->batch) {
+        m_pending.clear();
+      }
+      m_batch = header->batch;
+
+      // Only the last record of each key in a batch is kept, bounding the
+      // pending records by the number of keys.
+      bool overflow = false;
+      for_each_record(
+        m_scratch, *header, [&](key_t p_key,
+                                record_type p_type,
+                                std::uint16_t p_offset,
+                                std::span<const std::byte> p_value) {
+          const pending_record record{
+            .key = p_key,
+            .where = { .block = block,
+                       .offset = p_offset,
+                       .length = static_cast<std::uint16_t>(p_value.size()) },
+            .tombstone = p_type == record_type::tombstone,
+          };
+          auto existing = std::find_if(
+            m_pending.begin(), m_pending.end(), [p_key](const auto& p_record) {
+              return p_record.key == p_key;
+            });
+          if (existing != m_pending.end()) {
+            *existing = record;
+          } else if (m_pending.size() < m_settings.max_keys) {
+            m_pending.push_back(record);
+          } else {
+            overflow = true;
+          }
+        });
+      if (overflow) {
+        return boost::leaf::new_error(std::errc::not_enough_memory);
+      }
+
+      if (header->commit) {
+        BOOST_LEAF_CHECK(apply_pending());
+      }
+    }
+    return expected - 1;
+  }
+
+  boost::leaf::result<void> apply_pending() noexcept
+  {
+    for (const auto& record : m_pending) {
+      auto entry = find(record.key);
+      const bool exists = entry != m_index.end() && entry->key == record.key;
+      if (record.tombstone) {
+        if (exists) {
+          m_index.erase(entry);
+        }
+      } else if (exists) {
+        entry->where = record.where;
+      } else if (m_index.size() == m_settings.max_keys) {
+        return boost::leaf::new_error(std::errc::not_enough_memory);
+      } else {
+        m_index.insert(entry, { .key = record.key, .where = record.where });
+      }
+    }
+    m_pending.clear();
+    return {};
+  }
+
+  template<typename Callable>
+  static void for_each_record(std::span<const std::byte> p_block,
+                              const block_header& p_header,
+                              Callable p_callable) noexcept
+  {
+    const size_t end = block_header_size + p_header.used;
+    size_t offset = block_header_size;
+    while (offset + record_header_size <= end) {
+      const auto key = from_bytes<key_t, std::endian::little>(
+        p_block.subspan(offset).first<4>());
+      const auto length = from_bytes<std::uint16_t, std::endian::little>(
+        p_block.subspan(offset + 4).first<2>());
+      const auto type = static_cast<record_type>(p_block[offset + 6]);
+      if (offset + record_header_size + length > end) {
+        break;
+      }
+      p_callable(key,
+                 type,
+                 static_cast<std::uint16_t>(offset),
+                 p_block.subspan(offset + record_header_size, length));
+      offset += record_header_size + length;
+    }
+  }
+
+  static std::optional<block_header> parse(
+    std::span<const std::byte> p_block) noexcept
+  {
+    auto field = [p_block]<typename T>(size_t p_offset, T) {
+      return from_bytes<T, std::endian::little>(
+        p_block.subspan(p_offset).template first<sizeof(T)>());
+    };
+
+    const block_header header{
+      .sequence = field(4, std::uint32_t{}),
+      .batch = field(8, std::uint32_t{}),
+      .used = field(12, std::uint16_t{}),
+      .commit = (std::to_integer<std::uint8_t>(p_block[14]) & commit_flag) != 0,
+    };
+    if (field(0, std::uint32_t{}) != magic ||
+        block_header_size + header.used > p_block.size() ||
+        is_free(header.sequence) ||
+        field(crc_offset, std::uint32_t{}) != checksum(p_block, header.used)) {
+      return std::nullopt;
+    }
+    return header;
+  }
+
+  static std::uint32_t checksum(std::span<const std::byte> p_block,
+                                size_t p_used) noexcept
+  {
+    const auto crc = crc32(0, p_block.first(crc_offset));
+    return crc32(crc, p_block.subspan(block_header_size, p_used));
+  }
+
+  /// CRC-32 (IEEE 802.3) computed a nibble at a time
+  static constexpr std::uint32_t crc32(
+    std::uint32_t p_crc,
+    std::span<const std::byte> p_data) noexcept
+  {
+    constexpr std::array<std::uint32_t, 16> table{
+      0x0000'0000, 0x1DB7'1064, 0x3B6E'20C8, 0x26D9'30AC,
+      0x76DC'4190, 0x6B6B'51F4, 0x4DB2'6158, 0x5005'713C,
+      0xEDB8'8320, 0xF00F'9344, 0xD6D6'A3E8, 0xCB61'B38C,
+      0x9B64'C2B0, 0x86D3'D2D4, 0xA00A'E278, 0xBDBD'F21C,
+    };
+    std::uint32_t crc = ~p_crc;
+    for (auto byte : p_data) {
+      crc ^= std::to_integer<std::uint32_t>(byte);
+      crc = (crc >> 4U) ^ table[crc & 0xFU];
+      crc = (crc >> 4U) ^ table[crc & 0xFU];
+    }
+    return ~crc;
+  }
+
+  boost::leaf::result<location> append(
+    key_t p_key,
+    record_type p_type,
+    std::span<const std::byte> p_value) noexcept
+  {
+    if (!m_compacting && !batch_open()) {
+      BOOST_LEAF_CHECK(reclaim());
+    }
+
+    const size_t size = record_header_size + p_value.size();
+    if (block_header_size + m_used + size > m_buffer.size()) {
+      BOOST_LEAF_CHECK(write_block(false));
+    }
+    if (m_head_blocks == m_settings.segment_blocks) {
+      BOOST_LEAF_CHECK(open_segment());
+    }
+
+    const size_t offset = block_header_size + m_used;
+    auto record = std::span(m_buffer).subspan(offset);
+    to_bytes<std::endian::little>(p_key, record.first<4>());
+    to_bytes<std::endian::little>(static_cast<std::uint16_t>(p_value.size()),
+                                  record.subspan(4).first<2>());
+    record[6] = static_cast<std::byte>(p_type);
+    record[7] = erased;
+    std::copy(
+      p_value.begin(), p_value.end(), record.begin() + record_header_size);
+    m_used += size;
+
+    return location{
+      .block = head_block(),
+      .offset = static_cast<std::uint16_t>(offset),
+      .length = static_cast<std::uint16_t>(p_value.size()),
+    };
+  }
+
+  boost::leaf::result<void> write_block(bool p_commit) noexcept
+  {
+    if (m_head_blocks == m_settings.segment_blocks) {
+      BOOST_LEAF_CHECK(open_segment());
+    }
+    if (m_batch == 0) {
+      m_batch = m_sequence;
+    }
+
+    auto header = std::span(m_buffer);
+    to_bytes<std::endian::little>(magic, header.first<4>());
+    to_bytes<std::endian::little>(m_sequence, header.subspan(4).first<4>());
+    to_bytes<std::endian::little>(m_batch, header.subspan(8).first<4>());
+    to_bytes<std::endian::little>(static_cast<std::uint16_t>(m_used),
+                                  header.subspan(12).first<2>());
+    header[14] = std::byte{ p_commit ? commit_flag : std::uint8_t{ 0 } };
+    header[15] = erased;
+    std::fill(m_buffer.begin() + static_cast<std::ptrdiff_t>(
+                                   block_header_size + m_used),
+              m_buffer.end(),
+              erased);
+    to_bytes<std::endian::little>(checksum(m_buffer, m_used),
+                                  header.subspan(crc_offset).first<4>());
+
+    BOOST_LEAF_CHECK(m_device->write(head_block(), m_buffer));
+    m_stats.blocks_written++;
+    m_sequence++;
+    m_head_blocks++;
+    m_used = 0;
+    if (p_commit) {
+      m_batch = 0;
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> open_segment() noexcept
+  {
+    // The reserve is left for compaction, which cannot run until the batch
+    // is committed
+    if (!m_compacting && free_segments() <= m_settings.reserve_segments) {
+      return boost::leaf::new_error(std::errc::no_space_on_device);
+    }
+
+    for (std::uint64_t i = 1; i <= m_segments.size(); i++) {
+      const auto segment = (m_head + i) % m_segments.size();
+      if (is_free(m_segments[segment])) {
+        if (m_segments[segment] == unknown_segment && m_erase_before_write) {
+          BOOST_LEAF_CHECK(erase_segment(segment));
+        }
+        m_head = segment;
+        m_head_blocks = 0;
+        m_segments[segment] = m_sequence;
+        return {};
+      }
+    }
+    return boost::leaf::new_error(std::errc::no_space_on_device);
+  }
+
+  boost::leaf::result<void> erase_segment(std::uint64_t p_segment) noexcept
+  {
+    BOOST_LEAF_CHECK(
+      m_device->erase(first_block(p_segment), m_settings.segment_blocks));
+    m_stats.blocks_erased += m_settings.segment_blocks;
+    return {};
+  }
+
+  /// Compact before a batch starts until it can use a segment beyond the
+  /// reserve, as compacting during the batch would commit part of it.
+  boost::leaf::result<void> reclaim() noexcept
+  {
+    for (std::uint64_t i = 0;
+         i < m_segments.size() &&
+         free_segments() <= m_settings.reserve_segments;
+         i++) {
+      BOOST_LEAF_CHECK(compact_oldest());
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> compact_oldest() noexcept
+  {
+    const auto oldest = oldest_segment_after(0);
+    if (!oldest || *oldest == m_head) {
+      return boost::leaf::new_error(std::errc::no_space_on_device);
+    }
+
+    // The moved records must be durable before their originals are erased.
+    // Both steps may open segments from the reserve.
+    m_compacting = true;
+    auto result = move_live_records(*oldest);
+    if (result) {
+      result = commit();
+    }
+    m_compacting = false;
+    BOOST_LEAF_CHECK(result);
+    BOOST_LEAF_CHECK(erase_segment(*oldest));
+    m_segments[*oldest] = free_segment;
+    m_stats.compactions++;
+    return {};
+  }
+
+  boost::leaf::result<void> move_live_records(std::uint64_t p_segment) noexcept
+  {
+    std::uint32_t expected = m_segments[p_segment];
+    for (std::uint64_t i = 0; i < m_settings.segment_blocks; i++) {
+      const std::uint64_t block = first_block(p_segment) + i;
+      BOOST_LEAF_CHECK(m_device->read(block, m_scratch));
+      const auto header = parse(m_scratch);
+      if (!header || header->sequence != expected) {
+        break;
+      }
+      expected++;
+
+      size_t moved = 0;
+      // Records are appended one at a time as append() may write blocks,
+      // but never reads into the scratch buffer.
+      boost::leaf::result<void> status{};
+      for_each_record(
+        m_scratch, *header, [&](key_t p_key,
+                                record_type p_type,
+                                std::uint16_t p_offset,
+                                std::span<const std::byte> p_value) {
+          if (!status || p_type != record_type::value) {
+            return;
+          }
+          auto entry = find(p_key);
+          if (entry == m_index.end() || entry->key != p_key ||
+              entry->where.block != block || entry->where.offset != p_offset) {
+            return;
+          }
+          auto where = append(p_key, record_type::value, p_value);
+          if (!where) {
+            status = boost::leaf::result<void>(where.error());
+            return;
+          }
+          find(p_key)->where = where.value();
+          moved++;
+        });
+      BOOST_LEAF_CHECK(status);
+      m_stats.records_moved += moved;
+    }
+    return {};
+  }
+
+  static constexpr std::byte erased{ 0xFF };
+
+  block_device* m_device;
+  settings m_settings;
+  std::pmr::vector<index_entry> m_index;
+  /// Sequence number of the first block of each segment, 0 if free
+  std::pmr::vector<std::uint32_t> m_segments;
+  /// Block being filled with records
+  std::pmr::vector<std::byte> m_buffer;
+  /// Block read from the device
+  std::pmr::vector<std::byte> m_scratch;
+  /// Records of the batch being replayed while mounting
+  std::pmr::vector<pending_record> m_pending;
+  statistics m_stats{};
+  std::uint64_t m_head = 0;
+  std::uint64_t m_head_blocks = 0;
+  size_t m_used = 0;
+  std::uint32_t m_sequence = 1;
+  std::uint32_t m_batch = 0;
+  bool m_erase_before_write = false;
+  bool m_compacting = false;
+};
+}  // namespace embed
@@ -0,0 +1,500 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "../bit.hpp"
+#include "../output_pin/interface.hpp"
+#include "../spi/interface.hpp"
+#include "../spi/util.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief SD and MMC card driver using the SPI mode of the card.
+ *
+ * Supports standard capacity (SDSC), high capacity (SDHC) and extended
+ * capacity (SDXC) cards, along with MultiMediaCards (MMC) of up to 2GB, which
+ * reject the SD initialization command ACMD41 and are initialized with CMD1
+ * instead. Ranges of more than one block are transferred with a
+ * single multi-block read (CMD18) or write (CMD25) command, which avoids the
+ * per command overhead and lets the card program blocks back to back.
+ *
+ * Consecutive calls to write() stream into the same multi-block write: when a
+ * write starts at the block following the previous write, the open CMD25 is
+ * continued rather than stopped and restarted. This makes appending one block
+ * at a time, as data loggers do, nearly as fast as writing a large range. The
+ * stream is stopped by any other operation or by flush(), which must be called
+ * before the card is removed or powered down.
+ *
+ * The bus is released between calls, so other devices may share it provided
+ * they leave the clock settings to this driver.
+ */
+class sd_spi : public block_device
+{
+public:
+  /// Settings for the sd_spi driver
+  struct settings
+  {
+    /// Clock rate used while identifying the card, must be between 100kHz and
+    /// 400kHz.
+    frequency initialization_clock_rate = frequency(400'000);
+    /// Clock rate used once the card has been identified, 25MHz or less.
+    frequency clock_rate = frequency(25'000'000);
+    /// Maximum number of bytes read while waiting for the card to become
+    /// ready or to send data before giving up. At 25MHz each byte is 320ns,
+    /// making the default about 250ms, the maximum write time of an SD card.
+    std::uint32_t busy_byte_limit = 800'000;
+    /// Maximum number of attempts to bring the card out of its idle state
+    std::uint32_t initialization_attempts = 10'000;
+  };
+
+  /**
+   * @brief Construct a new sd_spi driver
+   *
+   * initialize() must be called before the card can be accessed.
+   *
+   * @param p_spi - spi bus the card is connected to
+   * @param p_chip_select - chip select pin of the card, driven low to select
+   * the card
+   * @param p_settings - driver settings
+   */
+  sd_spi(spi& p_spi, output_pin& p_chip_select, settings p_settings)
+    : m_spi(&p_spi)
+    , m_chip_select(&p_chip_select)
+    , m_settings(p_settings)
+  {}
+
+  /**
+   * @brief Construct a new sd_spi driver with the default settings
+   *
+   * @param p_spi - spi bus the card is connected to
+   * @param p_chip_select - chip select pin of the card
+   */
+  sd_spi(spi& p_spi, output_pin& p_chip_select)
+    : sd_spi(p_spi, p_chip_select, settings{})
+  {}
+
+  /**
+   * @brief Identify and initialize the card
+   *
+   * Must be called before any other operation and again if the card is
+   * replaced.
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::no_such_device` if no card responds,
+   * `std::errc::not_supported` if the card does not support 3.3V and
+   * `std::errc::timed_out` if the card does not leave its idle state.
+   */
+  [[nodiscard]] boost::leaf::result<void> initialize() noexcept
+  {
+    m_block_count = 0;
+    m_write_stream_next.reset();
+
+    BOOST_LEAF_CHECK(m_spi->configure(
+      spi::settings{ .clock_rate = m_settings.initialization_clock_rate }));
+
+    // At least 74 clock cycles with chip select high enter SPI mode
+    BOOST_LEAF_CHECK(m_chip_select->level(true));
+    std::array<std::byte, 10> wake_up;
+    wake_up.fill(std::byte{ 0xFF });
+    BOOST_LEAF_CHECK(embed::write(*m_spi, wake_up));
+
+    BOOST_LEAF_CHECK(transaction([this]() -> boost::leaf::result<void> {
+      return identify();
+    }));
+
+    return m_spi->configure(
+      spi::settings{ .clock_rate = m_settings.clock_rate });
+  }
+
+  /**
+   * @brief Determine if the card uses block addressing, which is the case for
+   * SDHC and SDXC cards.
+   *
+   * @return true - the card is SDHC or SDXC
+   * @return false - the card is SDSC or MMC, or has not been initialized
+   */
+  [[nodiscard]] bool high_capacity() const noexcept { return m_high_capacity; }
+
+private:
+  static constexpr size_t block_size = 512;
+
+  struct command
+  {
+    static constexpr std::uint8_t go_idle_state = 0;
+    static constexpr std::uint8_t send_op_cond = 1;
+    static constexpr std::uint8_t send_if_cond = 8;
+    static constexpr std::uint8_t send_csd = 9;
+    static constexpr std::uint8_t stop_transmission = 12;
+    static constexpr std::uint8_t set_blocklen = 16;
+    static constexpr std::uint8_t read_single_block = 17;
+    static constexpr std::uint8_t read_multiple_block = 18;
+    static constexpr std::uint8_t write_multiple_block = 25;
+    static constexpr std::uint8_t erase_wr_blk_start = 32;
+    static constexpr std::uint8_t erase_wr_blk_end = 33;
+    static constexpr std::uint8_t erase = 38;
+    static constexpr std::uint8_t sd_send_op_cond = 41;
+    static constexpr std::uint8_t app_cmd = 55;
+    static constexpr std::uint8_t read_ocr = 58;
+  };
+
+  struct token
+  {
+    static constexpr std::uint8_t start_block = 0xFE;
+    static constexpr std::uint8_t start_multiple_write = 0xFC;
+    static constexpr std::uint8_t stop_multiple_write = 0xFD;
+  };
+
+  static constexpr std::uint8_t r1_idle = 0x01;
+  static constexpr std::uint8_t r1_illegal_command = 0x04;
+  static constexpr std::uint8_t data_accepted = 0x05;
+  static constexpr std::uint8_t data_response_mask = 0x1F;
+
+  boost::leaf::result<properties> driver_info() noexcept override
+  {
+    return properties{
+      .block_size = block_size,
+      .block_count = m_block_count,
+      .erase_block_count = 1,
+      .erase_before_write = false,
+    };
+  }
+
+  boost::leaf::result<void> driver_read(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data) noexcept override
+  {
+    BOOST_LEAF_CHECK(stop_write_stream());
+    if (p_data.empty()) {
+      return {};
+    }
+    return transaction([this, p_block, p_data]() -> boost::leaf::result<void> {
+      if (p_data.size() == block_size) {
+        BOOST_LEAF_CHECK(
+          send_expecting(command::read_single_block, address(p_block), 0));
+        return receive_data(p_data);
+      }
+
+      BOOST_LEAF_CHECK(
+        send_expecting(command::read_multiple_block, address(p_block), 0));
+      for (size_t offset = 0; offset < p_data.size(); offset += block_size) {
+        BOOST_LEAF_CHECK(receive_data(p_data.subspan(offset, block_size)));
+      }
+      BOOST_LEAF_CHECK(send_command(command::stop_transmission, 0));
+      return wait_until_ready();
+    });
+  }
+
+  boost::leaf::result<void> driver_write(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data) noexcept override
+  {
+    if (p_data.empty()) {
+      return {};
+    }
+    if (m_write_stream_next && *m_write_stream_next != p_block) {
+      BOOST_LEAF_CHECK(stop_write_stream());
+    }
+
+    return transaction([this, p_block, p_data]() -> boost::leaf::result<void> {
+      if (!m_write_stream_next) {
+        BOOST_LEAF_CHECK(
+          send_expecting(command::write_multiple_block, address(p_block), 0));
+        m_write_stream_next = p_block;
+      }
+
+      for (size_t offset = 0; offset < p_data.size(); offset += block_size) {
+        auto result = send_data(token::start_multiple_write,
+                                p_data.subspan(offset, block_size));
+        if (!result) {
+          // The card aborts the multi-block write when it rejects a block
+          m_write_stream_next.reset();
+          return result;
+        }
+        *m_write_stream_next += 1;
+      }
+      return {};
+    });
+  }
+
+  boost::leaf::result<void> driver_erase(
+    std::uint64_t p_block,
+    std::uint64_t p_count) noexcept override
+  {
+    BOOST_LEAF_CHECK(stop_write_stream());
+    if (p_count == 0) {
+      return {};
+    }
+    return transaction([this, p_block, p_count]() -> boost::leaf::result<void> {
+      BOOST_LEAF_CHECK(
+        send_expecting(command::erase_wr_blk_start, address(p_block), 0));
+      BOOST_LEAF_CHECK(send_expecting(
+        command::erase_wr_blk_end, address(p_block + p_count - 1), 0));
+      BOOST_LEAF_CHECK(send_expecting(command::erase, 0, 0));
+      return wait_until_ready();
+    });
+  }
+
+  boost::leaf::result<void> driver_flush() noexcept override
+  {
+    return stop_write_stream();
+  }
+
+  boost::leaf::result<void> identify() noexcept
+  {
+    auto r1 = BOOST_LEAF_CHECK(send_command(command::go_idle_state, 0));
+    if (r1 != r1_idle) {
+      return boost::leaf::new_error(std::errc::no_such_device);
+    }
+
+    // Version 2.00 cards echo the check pattern of CMD8, older cards reject
+    // the command.
+    constexpr std::uint32_t voltage_2v7_to_3v6 = 0x100;
+    constexpr std::uint8_t check_pattern = 0xAA;
+    r1 = BOOST_LEAF_CHECK(
+      send_command(command::send_if_cond, voltage_2v7_to_3v6 | check_pattern));
+    const bool version_2 = (r1 & r1_illegal_command) == 0;
+    if (version_2) {
+      const auto r7 = BOOST_LEAF_CHECK(embed::read<4>(*m_spi));
+      if (std::to_integer<std::uint8_t>(r7[3]) != check_pattern) {
+        return boost::leaf::new_error(std::errc::not_supported);
+      }
+    }
+
+    constexpr std::uint32_t host_capacity_support = 1UL << 30;
+    const std::uint32_t op_cond = version_2 ? host_capacity_support : 0;
+    bool mmc = false;
+    for (std::uint32_t attempt = 0;; attempt++) {
+      if (attempt == m_settings.initialization_attempts) {
+        return boost::leaf::new_error(std::errc::timed_out);
+      }
+      if (mmc) {
+        r1 = BOOST_LEAF_CHECK(send_command(command::send_op_cond, 0));
+      } else {
+        BOOST_LEAF_CHECK(send_command(command::app_cmd, 0));
+        r1 = BOOST_LEAF_CHECK(send_command(command::sd_send_op_cond, op_cond));
+        // MMC cards do not know application commands
+        mmc = !version_2 && (r1 & r1_illegal_command) != 0;
+      }
+      if (r1 == 0) {
+        break;
+      }
+    }
+
+    m_high_capacity = false;
+    if (version_2) {
+      BOOST_LEAF_CHECK(send_expecting(command::read_ocr, 0, 0));
+      const auto ocr = BOOST_LEAF_CHECK(embed::read<4>(*m_spi));
+      constexpr std::uint32_t card_capacity_status = 1UL << 30;
+      m_high_capacity =
+        (from_bytes<std::uint32_t>(std::span(ocr)) & card_capacity_status) != 0;
+    }
+
+    if (!m_high_capacity) {
+      BOOST_LEAF_CHECK(send_expecting(command::set_blocklen, block_size, 0));
+    }
+
+    BOOST_LEAF_CHECK(send_expecting(command::send_csd, 0, 0));
+    std::array<std::byte, 16> csd;
+    BOOST_LEAF_CHECK(receive_data(csd));
+    m_block_count = block_count(csd, mmc);
+    if (m_block_count == 0) {
+      // Cards over 2GB give their size in the MMC extended CSD register
+      return boost::leaf::new_error(std::errc::not_supported);
+    }
+
+    return {};
+  }
+
+  /**
+   * @brief Compute the number of 512 byte blocks from the card specific data
+   * (CSD) register, or 0 for an MMC card over 2GB.
+   */
+  static constexpr std::uint64_t block_count(
+    std::span<const std::byte, 16> p_csd,
+    bool p_mmc) noexcept
+  {
+    // Extract bits p_msb to p_lsb of the 128-bit big endian register
+    auto field = [p_csd](size_t p_msb, size_t p_lsb) {
+      std::uint32_t value = 0;
+      for (size_t bit = p_msb + 1; bit-- > p_lsb;) {
+        const auto byte = std::to_integer<std::uint32_t>(p_csd[15 - bit / 8]);
+        value = value << 1U | ((byte >> (bit % 8)) & 1U);
+      }
+      return value;
+    };
+
+    if (p_mmc || field(127, 126) == 0) {
+      // SD CSD version 1.0 and every MMC CSD version: capacity = (C_SIZE + 1)
+      // * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN bytes
+      const std::uint64_t c_size = field(73, 62);
+      if (p_mmc && c_size == 0xFFF) {
+        return 0;
+      }
+      const std::uint64_t c_size_mult = field(49, 47);
+      const std::uint64_t read_bl_len = field(83, 80);
+      return ((c_size + 1) << (c_size_mult + 2 + read_bl_len)) / block_size;
+    }
+
+    // CSD version 2.0 and 3.0: capacity = (C_SIZE + 1) * 512KiB. Bits 75:70
+    // are reserved as 0 in version 2.0, and extend C_SIZE in version 3.0.
+    const std::uint64_t c_size = field(75, 48);
+    return (c_size + 1) * 1024;
+  }
+
+  /**
+   * @brief 7-bit CRC of a command frame, as used by CMD0 and CMD8 in SPI mode
+   */
+  static constexpr std::uint8_t crc7(std::span<const std::byte> p_data) noexcept
+  {
+    std::uint8_t crc = 0;
+    for (auto byte : p_data) {
+      auto value = std::to_integer<std::uint8_t>(byte);
+      for (int i = 0; i < 8; i++) {
+        crc = static_cast<std::uint8_t>(crc << 1U);
+        if (((value ^ crc) & 0x80U) != 0) {
+          crc = static_cast<std::uint8_t>(crc ^ 0x09U);
+        }
+        value = static_cast<std::uint8_t>(value << 1U);
+      }
+    }
+    return static_cast<std::uint8_t>(crc & 0x7FU);
+  }
+
+  std::uint32_t address(std::uint64_t p_block) const noexcept
+  {
+    if (m_high_capacity) {
+      return static_cast<std::uint32_t>(p_block);
+    }
+    return static_cast<std::uint32_t>(p_block * block_size);
+  }
+
+  template<typename Callable>
+  boost::leaf::result<void> transaction(Callable p_callable) noexcept
+  {
+    BOOST_LEAF_CHECK(m_chip_select->level(false));
+    auto result = p_callable();
+    BOOST_LEAF_CHECK(m_chip_select->level(true));
+    // The card only releases its data out line after a clock with chip select
+    // high.
+    BOOST_LEAF_CHECK(embed::read<1>(*m_spi));
+    return result;
+  }
+
+  boost::leaf::result<std::uint8_t> receive_byte() noexcept
+  {
+    const auto byte = BOOST_LEAF_CHECK(embed::read<1>(*m_spi));
+    return std::to_integer<std::uint8_t>(byte[0]);
+  }
+
+  boost::leaf::result<std::uint8_t> send_command(
+    std::uint8_t p_command,
+    std::uint32_t p_argument) noexcept
+  {
+    std::array<std::byte, 6> frame{};
+    frame[0] = static_cast<std::byte>(0x40U | p_command);
+    to_bytes(p_argument, std::span(frame).subspan<1, 4>());
+    frame[5] =
+      static_cast<std::byte>(crc7(std::span(frame).first(5)) << 1U | 1U);
+    BOOST_LEAF_CHECK(embed::write(*m_spi, frame));
+
+    if (p_command == command::stop_transmission) {
+      // Skip the stuff byte following CMD12
+      BOOST_LEAF_CHECK(receive_byte());
+    }
+
+    // The response arrives within 8 bytes and always has its MSB cleared
+    for (int i = 0; i < 8; i++) {
+      const auto r1 = BOOST_LEAF_CHECK(receive_byte());
+      if ((r1 & 0x80U) == 0) {
+        return r1;
+      }
+    }
+    return boost::leaf::new_error(std::errc::timed_out);
+  }
+
+  boost::leaf::result<void> send_expecting(std::uint8_t p_command,
+                                           std::uint32_t p_argument,
+                                           std::uint8_t p_expected) noexcept
+  {
+    const auto r1 = BOOST_LEAF_CHECK(send_command(p_command, p_argument));
+    if (r1 != p_expected) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> wait_until_ready() noexcept
+  {
+    for (std::uint32_t i = 0; i < m_settings.busy_byte_limit; i++) {
+      if (BOOST_LEAF_CHECK(receive_byte()) == 0xFF) {
+        return {};
+      }
+    }
+    return boost::leaf::new_error(std::errc::timed_out);
+  }
+
+  boost::leaf::result<void> receive_data(std::span<std::byte> p_data) noexcept
+  {
+    for (std::uint32_t i = 0; i < m_settings.busy_byte_limit; i++) {
+      const auto byte = BOOST_LEAF_CHECK(receive_byte());
+      if (byte == 0xFF) {
+        continue;
+      }
+      if (byte != token::start_block) {
+        return boost::leaf::new_error(std::errc::io_error);
+      }
+      BOOST_LEAF_CHECK(embed::read(*m_spi, p_data));
+      // Skip the CRC, which is disabled in SPI mode
+      BOOST_LEAF_CHECK(embed::read<2>(*m_spi));
+      return {};
+    }
+    return boost::leaf::new_error(std::errc::timed_out);
+  }
+
+  boost::leaf::result<void> send_data(
+    std::uint8_t p_token,
+    std::span<const std::byte> p_data) noexcept
+  {
+    const std::array<std::byte, 2> start{ std::byte{ 0xFF },
+                                          std::byte{ p_token } };
+    const std::array<std::byte, 2> crc{ std::byte{ 0xFF }, std::byte{ 0xFF } };
+    BOOST_LEAF_CHECK(embed::write(*m_spi, start));
+    BOOST_LEAF_CHECK(embed::write(*m_spi, p_data));
+    BOOST_LEAF_CHECK(embed::write(*m_spi, crc));
+
+    const auto response = BOOST_LEAF_CHECK(receive_byte());
+    if ((response & data_response_mask) != data_accepted) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return wait_until_ready();
+  }
+
+  boost::leaf::result<void> stop_write_stream() noexcept
+  {
+    if (!m_write_stream_next) {
+      return {};
+    }
+    m_write_stream_next.reset();
+
+    return transaction([this]() -> boost::leaf::result<void> {
+      const std::array<std::byte, 2> stop{
+        std::byte{ token::stop_multiple_write }, std::byte{ 0xFF }
+      };
+      BOOST_LEAF_CHECK(embed::write(*m_spi, stop));
+      return wait_until_ready();
+    });
+  }
+
+  spi* m_spi;
+  output_pin* m_chip_select;
+  settings m_settings;
+  std::uint64_t m_block_count = 0;
+  bool m_high_capacity = false;
+  /// Block following the last block of an open multi-block write, if any
+  std::optional<std::uint64_t> m_write_stream_next;
+};
+}  // namespace embed
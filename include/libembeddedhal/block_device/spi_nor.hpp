@@ -0,0 +1,435 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "../bit.hpp"
+#include "../output_pin/interface.hpp"
+#include "../spi/interface.hpp"
+#include "../spi/util.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Serial NOR flash driver for JEDEC compatible SPI flash memories such
+ * as the Winbond W25Q, Macronix MX25L, Micron MT25Q and GigaDevice GD25Q
+ * families.
+ *
+ * The device is presented as a block device with 256 byte pages as blocks and
+ * 4kB sectors as erase blocks. Flash memory can only be programmed once
+ * between erases. Erases use 64kB block erase commands where the range
+ * allows, which is several times faster than erasing each sector.
+ *
+ * Page programs are pipelined: rather than polling the status register after
+ * each program, the driver returns as soon as the last page has been sent and
+ * only waits for the flash to finish when the next command is issued. While
+ * the flash is programming, the command for the next page is prepared and
+ * the caller is free to prepare its next write. Polling holds chip select low
+ * and reads the status register repeatedly, so the read status command is
+ * only sent once per wait.
+ *
+ * Reads use the fast read command, which allows the highest clock rate, or
+ * its dual or quad output variants when the spi hardware supports multiple
+ * lanes. read_at() reads any number of bytes from any address in a single
+ * command and memory_map() maps the flash into the address space on
+ * hardware that supports it, which suits code and assets stored in the flash
+ * and executed or read in place.
+ *
+ * Devices larger than 16MB are accessed with the 4 byte address commands, so
+ * the device's address mode register is never changed.
+ */
+class spi_nor_flash : public block_device
+{
+public:
+  /// Read commands, described by the lanes used for the command, address and
+  /// data
+  enum class read_mode
+  {
+    /// Read, 1-1-1 without dummy cycles. Limited to 50MHz or less on most
+    /// devices.
+    standard,
+    /// Fast read, 1-1-1 with 8 dummy cycles
+    fast,
+    /// Fast read dual output, 1-1-2 with 8 dummy cycles
+    dual_output,
+    /// Fast read quad output, 1-1-4 with 8 dummy cycles. Requires the quad
+    /// enable bit in the status register of the flash, which is set at the
+    /// factory on most quad capable parts.
+    quad_output,
+  };
+
+  /// Settings for the spi_nor_flash driver
+  struct settings
+  {
+    /// Serial clock rate
+    frequency clock_rate = frequency(50'000'000);
+    /// Read command to use. Modes needing more lanes than the spi hardware
+    /// supports fall back to read_mode::fast.
+    read_mode read = read_mode::fast;
+    /// Maximum number of status register reads while waiting for a program or
+    /// erase to finish before giving up. At 50MHz each read is 160ns, making
+    /// the default about 3s, longer than a 64kB block erase.
+    std::uint32_t busy_poll_limit = 20'000'000;
+  };
+
+  /// Size of a page, the largest unit programmed by one command
+  static constexpr size_t page_size = 256;
+  /// Size of a sector, the smallest unit that can be erased
+  static constexpr size_t sector_size = 4096;
+  /// Size of a block, erased with a single command when the range allows
+  static constexpr size_t block_erase_size = 65536;
+
+  /**
+   * @brief Construct a new spi_nor_flash driver
+   *
+   * initialize() must be called before the flash can be accessed.
+   *
+   * @param p_spi - spi bus the flash is connected to
+   * @param p_chip_select - chip select pin of the flash, driven low to select
+   * the flash
+   * @param p_settings - driver settings
+   */
+  spi_nor_flash(spi& p_spi, output_pin& p_chip_select, settings p_settings)
+    : m_spi(&p_spi)
+    , m_chip_select(&p_chip_select)
+    , m_settings(p_settings)
+  {}
+
+  /**
+   * @brief Construct a new spi_nor_flash driver with the default settings
+   *
+   * @param p_spi - spi bus the flash is connected to
+   * @param p_chip_select - chip select pin of the flash
+   */
+  spi_nor_flash(spi& p_spi, output_pin& p_chip_select)
+    : spi_nor_flash(p_spi, p_chip_select, settings{})
+  {}
+
+  /**
+   * @brief Wake and identify the flash
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::no_such_device` if no flash responds and
+   * `std::errc::not_supported` if the capacity in the JEDEC ID is not
+   * recognized.
+   */
+  [[nodiscard]] boost::leaf::result<void> initialize() noexcept
+  {
+    m_size = 0;
+    m_busy = false;
+    BOOST_LEAF_CHECK(m_spi->configure(
+      spi::settings{ .clock_rate = m_settings.clock_rate }));
+    BOOST_LEAF_CHECK(m_chip_select->level(true));
+
+    BOOST_LEAF_CHECK(command(opcode::release_power_down));
+    const auto id = BOOST_LEAF_CHECK(read_jedec_id());
+    const auto manufacturer = std::to_integer<std::uint8_t>(id[0]);
+    if (manufacturer == 0x00 || manufacturer == 0xFF) {
+      return boost::leaf::new_error(std::errc::no_such_device);
+    }
+
+    // The capacity code is log2 of the size in bytes, except for devices of
+    // 64MB and up from some manufacturers which continue from 0x20.
+    const auto capacity = std::to_integer<std::uint8_t>(id[2]);
+    if (capacity >= 0x10 && capacity <= 0x1F) {
+      m_size = std::uint64_t{ 1 } << capacity;
+    } else if (capacity >= 0x20 && capacity <= 0x22) {
+      m_size = std::uint64_t{ 1 } << (capacity - 6U);
+    } else {
+      return boost::leaf::new_error(std::errc::not_supported);
+    }
+    m_address_bytes = m_size > (std::uint64_t{ 1 } << 24U) ? 4 : 3;
+    m_id = id;
+
+    m_read_mode = m_settings.read;
+    if (lanes_of(m_read_mode) > m_spi->capabilities().max_lanes) {
+      m_read_mode = read_mode::fast;
+    }
+    return {};
+  }
+
+  /**
+   * @brief Get the read command chosen by initialize()
+   *
+   * @return read_mode - settings::read, or read_mode::fast if the spi
+   * hardware does not have enough lanes
+   */
+  [[nodiscard]] read_mode active_read_mode() const noexcept
+  {
+    return m_read_mode;
+  }
+
+  /**
+   * @brief Get the JEDEC ID read by initialize()
+   *
+   * @return std::array<std::byte, 3> - manufacturer ID, memory type and
+   * capacity code
+   */
+  [[nodiscard]] std::array<std::byte, 3> jedec_id() const noexcept
+  {
+    return m_id;
+  }
+
+  /**
+   * @brief Get the size of the flash
+   *
+   * @return std::uint64_t - size in bytes, 0 if not initialized
+   */
+  [[nodiscard]] std::uint64_t size() const noexcept { return m_size; }
+
+  /**
+   * @brief Read bytes from any address with a single read command
+   *
+   * @param p_address - address of the first byte
+   * @param p_data - buffer to fill
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if the range is beyond
+   * the end of the flash.
+   */
+  [[nodiscard]] boost::leaf::result<void> read_at(
+    std::uint64_t p_address,
+    std::span<std::byte> p_data) noexcept
+  {
+    if (p_address > m_size || p_data.size() > m_size - p_address) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    if (p_data.empty()) {
+      return {};
+    }
+    BOOST_LEAF_CHECK(wait_until_ready());
+
+    const auto phases = read_phases(p_address);
+    return transaction([&]() -> boost::leaf::result<void> {
+      return m_spi->transfer(phases, {}, p_data);
+    });
+  }
+
+  /**
+   * @brief Map the flash into the address space using the active read command
+   *
+   * Waits for any program or erase to finish. The flash stays mapped until
+   * the next operation on the spi bus. Memory mapping hardware drives its own
+   * chip select, so the chip select pin passed to the constructor should be
+   * the one controlled by the hardware or a pin that is not connected.
+   *
+   * @return boost::leaf::result<std::span<const std::byte>> - the mapped
+   * flash. Returns `std::errc::not_supported` if the spi hardware does not
+   * support memory mapping.
+   */
+  [[nodiscard]] boost::leaf::result<std::span<const std::byte>>
+  memory_map() noexcept
+  {
+    BOOST_LEAF_CHECK(wait_until_ready());
+    return m_spi->memory_map(read_phases(0));
+  }
+
+private:
+  struct opcode
+  {
+    static constexpr std::uint8_t write_enable = 0x06;
+    static constexpr std::uint8_t read_status = 0x05;
+    static constexpr std::uint8_t read = 0x03;
+    static constexpr std::uint8_t read_4b = 0x13;
+    static constexpr std::uint8_t fast_read = 0x0B;
+    static constexpr std::uint8_t fast_read_4b = 0x0C;
+    static constexpr std::uint8_t dual_output_read = 0x3B;
+    static constexpr std::uint8_t dual_output_read_4b = 0x3C;
+    static constexpr std::uint8_t quad_output_read = 0x6B;
+    static constexpr std::uint8_t quad_output_read_4b = 0x6C;
+    static constexpr std::uint8_t page_program = 0x02;
+    static constexpr std::uint8_t page_program_4b = 0x12;
+    static constexpr std::uint8_t sector_erase = 0x20;
+    static constexpr std::uint8_t sector_erase_4b = 0x21;
+    static constexpr std::uint8_t block_erase = 0xD8;
+    static constexpr std::uint8_t block_erase_4b = 0xDC;
+    static constexpr std::uint8_t read_jedec_id = 0x9F;
+    static constexpr std::uint8_t release_power_down = 0xAB;
+  };
+
+  /// Write in progress bit of the status register
+  static constexpr std::uint8_t write_in_progress = 0x01;
+
+  boost::leaf::result<properties> driver_info() noexcept override
+  {
+    return properties{
+      .block_size = page_size,
+      .block_count = m_size / page_size,
+      .erase_block_count = sector_size / page_size,
+      .erase_before_write = true,
+    };
+  }
+
+  boost::leaf::result<void> driver_read(
+    std::uint64_t p_block,
+    std::span<std::byte> p_data) noexcept override
+  {
+    return read_at(p_block * page_size, p_data);
+  }
+
+  boost::leaf::result<void> driver_write(
+    std::uint64_t p_block,
+    std::span<const std::byte> p_data) noexcept override
+  {
+    const auto program = wide(opcode::page_program, opcode::page_program_4b);
+
+    for (size_t offset = 0; offset < p_data.size(); offset += page_size) {
+      // Prepared while the previous page is programmed
+      const auto phases = addressed(program, p_block * page_size + offset);
+      const auto page = p_data.subspan(offset, page_size);
+
+      BOOST_LEAF_CHECK(wait_until_ready());
+      BOOST_LEAF_CHECK(command(opcode::write_enable));
+      BOOST_LEAF_CHECK(transaction([&]() -> boost::leaf::result<void> {
+        return m_spi->transfer(phases, page, {});
+      }));
+      m_busy = true;
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> driver_erase(
+    std::uint64_t p_block,
+    std::uint64_t p_count) noexcept override
+  {
+    constexpr std::uint64_t pages_per_block = block_erase_size / page_size;
+    constexpr std::uint64_t pages_per_sector = sector_size / page_size;
+
+    const std::uint64_t end = p_block + p_count;
+    while (p_block < end) {
+      const bool whole_block =
+        p_block % pages_per_block == 0 && end - p_block >= pages_per_block;
+      const auto erase =
+        whole_block ? wide(opcode::block_erase, opcode::block_erase_4b)
+                    : wide(opcode::sector_erase, opcode::sector_erase_4b);
+      const auto phases = addressed(erase, p_block * page_size);
+
+      BOOST_LEAF_CHECK(wait_until_ready());
+      BOOST_LEAF_CHECK(command(opcode::write_enable));
+      BOOST_LEAF_CHECK(transaction([&]() -> boost::leaf::result<void> {
+        return m_spi->transfer(phases, {}, {});
+      }));
+      m_busy = true;
+      p_block += whole_block ? pages_per_block : pages_per_sector;
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> driver_flush() noexcept override
+  {
+    return wait_until_ready();
+  }
+
+  std::uint8_t wide(std::uint8_t p_opcode,
+                    std::uint8_t p_four_byte_opcode) const noexcept
+  {
+    return m_address_bytes == 4 ? p_four_byte_opcode : p_opcode;
+  }
+
+  spi::command_phases addressed(std::uint8_t p_opcode,
+                                std::uint64_t p_address) const noexcept
+  {
+    return spi::command_phases{
+      .command = p_opcode,
+      .address = static_cast<std::uint32_t>(p_address),
+      .address_bytes = m_address_bytes,
+    };
+  }
+
+  static spi::lanes lanes_of(read_mode p_mode) noexcept
+  {
+    switch (p_mode) {
+      case read_mode::dual_output:
+        return spi::lanes::dual;
+      case read_mode::quad_output:
+        return spi::lanes::quad;
+      default:
+        return spi::lanes::single;
+    }
+  }
+
+  spi::command_phases read_phases(std::uint64_t p_address) const noexcept
+  {
+    auto phases = addressed(wide(opcode::fast_read, opcode::fast_read_4b),
+                            p_address);
+    phases.dummy_cycles = 8;
+    phases.data_lanes = lanes_of(m_read_mode);
+
+    switch (m_read_mode) {
+      case read_mode::standard:
+        phases.command = wide(opcode::read, opcode::read_4b);
+        phases.dummy_cycles = 0;
+        break;
+      case read_mode::dual_output:
+        phases.command =
+          wide(opcode::dual_output_read, opcode::dual_output_read_4b);
+        break;
+      case read_mode::quad_output:
+        phases.command =
+          wide(opcode::quad_output_read, opcode::quad_output_read_4b);
+        break;
+      default:
+        break;
+    }
+    return phases;
+  }
+
+  template<typename Callable>
+  boost::leaf::result<void> transaction(Callable p_callable) noexcept
+  {
+    BOOST_LEAF_CHECK(m_chip_select->level(false));
+    auto result = p_callable();
+    BOOST_LEAF_CHECK(m_chip_select->level(true));
+    return result;
+  }
+
+  boost::leaf::result<void> command(std::uint8_t p_opcode) noexcept
+  {
+    return transaction([this, p_opcode]() -> boost::leaf::result<void> {
+      return embed::write(*m_spi, std::array{ std::byte{ p_opcode } });
+    });
+  }
+
+  boost::leaf::result<std::array<std::byte, 3>> read_jedec_id() noexcept
+  {
+    std::array<std::byte, 3> id{};
+    BOOST_LEAF_CHECK(transaction([this, &id]() -> boost::leaf::result<void> {
+      return write_then_read(
+        *m_spi, std::array{ std::byte{ opcode::read_jedec_id } }, id);
+    }));
+    return id;
+  }
+
+  /// Wait for the previous program or erase to finish. The status register
+  /// is output continuously for as long as chip select is held low.
+  boost::leaf::result<void> wait_until_ready() noexcept
+  {
+    if (!m_busy) {
+      return {};
+    }
+    BOOST_LEAF_CHECK(transaction([this]() -> boost::leaf::result<void> {
+      BOOST_LEAF_CHECK(
+        embed::write(*m_spi, std::array{ std::byte{ opcode::read_status } }));
+      for (std::uint32_t i = 0; i < m_settings.busy_poll_limit; i++) {
+        const auto status = BOOST_LEAF_CHECK(embed::read<1>(*m_spi));
+        if ((std::to_integer<std::uint8_t>(status[0]) & write_in_progress) ==
+            0) {
+          return {};
+        }
+      }
+      return boost::leaf::new_error(std::errc::timed_out);
+    }));
+    m_busy = false;
+    return {};
+  }
+
+  spi* m_spi;
+  output_pin* m_chip_select;
+  settings m_settings;
+  std::array<std::byte, 3> m_id{};
+  std::uint64_t m_size = 0;
+  std::uint8_t m_address_bytes = 3;
+  read_mode m_read_mode = read_mode::fast;
+  bool m_busy = false;
+};
+}  // namespace embed
@@ -1,10 +1,10 @@
 #pragma once
 
-#include <atomic>
 #include <cstdint>
 #include <memory_resource>
 #include <unordered_map>
 
+#include "../latest_value.hpp"
 #include "interface.hpp"
 
 namespace embed {
@@ -35,75 +35,52 @@ class can_network
 {
 public:
   /**
-   * @brief A can network node stores the can messages in a lock free way.
+   * @brief A can network node stores the latest can message received with its
+   * id.
    *
-   * Updating the can message data is completely lock free. Retrieving data uses
-   * atomics to poll for when the update() function has completed. This
-   * asymmetry in locking is to reduce write time, which is usually
-   * done in an interrupt context, rather than than read time, which is
-   * performed by a driver in a thread or main thread.
+   * Updating the can message is wait-free and retrieving it is lock-free, see
+   * embed::latest_value. This asymmetry is to reduce write time, which is
+   * done in an interrupt context, rather than read time, which is performed
+   * by a driver in a thread or main thread.
    *
    */
   class node_t
   {
   public:
     /**
-     * @brief Construct a new node t object
-     *
-     */
-    node_t() noexcept {}
-
-    /**
-     * @brief Node assignment operator
+     * @brief Get this node's can message
      *
-     * @param p_node the node copy
-     * @return node_t& reference to this object
+     * @return can::message_t
      */
-    node_t& operator=(const node_t& p_node) noexcept
+    [[nodiscard]] can::message_t secure_get() noexcept
     {
-      m_data = p_node.m_data;
-      m_access_counter.store(m_access_counter.load());
-      return *this;
+      return m_message.load();
     }
 
     /**
-     * @brief Construct a new node t object
+     * @brief Get the number of messages received by this node
      *
-     * @param p_node the object to copy
+     * @return latest_value<can::message_t>::version_t - number of messages
+     * received, wrapping around on overflow
      */
-    node_t(const node_t& p_node) noexcept { *this = p_node; }
+    [[nodiscard]] latest_value<can::message_t>::version_t version()
+      const noexcept
+    {
+      return m_message.version();
+    }
 
     /**
-     * @brief Get this node's can message
+     * @brief Determine if a message has been received since a version was read
      *
-     * @return can::message_t
+     * @param p_version - version previously returned by version()
+     * @return true - a new message has been received
+     * @return false - no message has been received
      */
-    [[nodiscard]] can::message_t secure_get() noexcept
+    [[nodiscard]] bool updated_since(
+      latest_value<can::message_t>::version_t p_version) const noexcept
     {
-      // Continuously check if the received CAN message is valid. NOTE: that, in
-      // general, the looping logic for this function almost never occurs as
-      // copies from RAM/cache are fast between receive_handler and GetMessage()
-      while (true) {
-        // First, atomically copy the access_counter to a variable.
-        const auto read_message_start = m_access_counter.load();
-
-        // Copy the contents of the mesage into the can_message variable.
-        const can::message_t can_message = m_data;
-
-        // Finally, atomically copy the access_counter again such that the value
-        // between the start and finish can be compared.
-        const auto read_message_finish = m_access_counter.load();
-
-        // If and only if these two values are the same, meaning that the
-        // receive_handler isn't currently modifying the node_t's data,
-        // can the message be considered valid.
-        if (read_message_start == read_message_finish) {
-          return can_message;
-        }
-      }
-
-      return {};
-    };
+      return m_message.updated_since(p_version);
+    }
 
   private:
     friend can_network;
@@ -111,35 +88,17 @@ public:
     /**
      * @brief Update can message
      *
-     * This update is performed in a lock-free way and can only be accessed by
-     * the can_network class.
+     * Can only be accessed by the can_network class.
      *
      * @param p_new_data New can message to store
      */
     void update(const can::message_t& p_new_data) noexcept
     {
-      // Atomic increment of the access counter to notify any threads that are
-      // using GetMesage() that the value of this node is changing.
-      m_access_counter++;
-
-      // Copy the contents of the new message into the map.
-      m_data = p_new_data;
-
-      // Another atomic increment of the access counter to notify any thread
-      // using GetMessage() that the value of this node has finished changing.
-      // For GetMessage to be valid, the function must save the access_counter,
-      // copy the message data, then check the access_counter again to make sure
-      // it has not changed. If it has changed, then GetMessage() should
-      // continue polling the map node until access_counter is the same between
-      // copies.
-      m_access_counter++;
+      m_message.store(p_new_data);
     }
 
     /// Holds the latest received can message
-    can::message_t m_data = {};
-
-    /// Used to indicate when the data field is being accessed
-    std::atomic<int> m_access_counter = 0;
+    latest_value<can::message_t> m_message{};
   };
 
   /**
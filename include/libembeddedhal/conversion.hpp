@@ -0,0 +1,183 @@
+/**
+ * @file conversion.hpp
+ * @brief Provide multiply-shift conversions between integer units
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+
+#include "units.hpp"
+
+namespace embed {
+/**
+ * @brief Scale integers by a fixed ratio using a multiply and shift
+ *
+ * Converting between integer units, for example nanometres per second squared
+ * to millimetres per second squared, generally requires a 64-bit division per
+ * value. On 32-bit targets without a 64-bit divide instruction this becomes a
+ * call into a software division routine. This class computes, once, a 32-bit
+ * multiplier and a shift such that:
+ *
+ *     (value * multiplier) >> shift ~= value * numerator / denominator
+ *
+ * After which each conversion is two 32x32-bit to 64-bit multiplies, which
+ * form the 96-bit product, an add for rounding and a shift. When constructed
+ * within a constant expression, the multiplier and shift are folded into the
+ * code at compile time.
+ *
+ * The multiplier is normalized to use all 32-bits, which bounds the error of
+ * the result, before rounding, to the magnitude of the result divided by 2^32.
+ * Results that fit within 32-bits are within 1 of the exactly rounded result.
+ *
+ */
+class scale_conversion
+{
+public:
+  /**
+   * @brief Construct a conversion that computes
+   * `value * p_numerator / p_denominator + p_offset`
+   *
+   * Ratios of 2^32 or above saturate the multiplier.
+   *
+   * @param p_numerator - numerator of the scaling ratio
+   * @param p_denominator - denominator of the scaling ratio, must not be zero
+   * @param p_offset - value added to the result after scaling
+   */
+  constexpr scale_conversion(std::uint64_t p_numerator,
+                             std::uint64_t p_denominator,
+                             std::int64_t p_offset = 0) noexcept
+    : m_offset(p_offset)
+  {
+    constexpr std::uint64_t limit = std::uint64_t{ 1 } << 32;
+
+    std::uint64_t quotient = p_numerator / p_denominator;
+    std::uint64_t remainder = p_numerator % p_denominator;
+
+    if (quotient >= limit) {
+      m_multiplier = limit - 1;
+      return;
+    }
+
+    // Binary long division, producing one more bit of the quotient each
+    // iteration until the multiplier uses all 32-bits.
+    while (m_shift < 94) {
+      const bool bit = remainder >= p_denominator - remainder;
+      const std::uint64_t next = (quotient << 1) | (bit ? 1U : 0U);
+      if (next >= limit) {
+        break;
+      }
+      quotient = next;
+      remainder =
+        bit ? remainder - (p_denominator - remainder) : remainder << 1;
+      m_shift++;
+    }
+
+    // Round the multiplier to nearest
+    if (remainder >= p_denominator - remainder && quotient + 1 < limit) {
+      quotient++;
+    }
+    m_multiplier = quotient;
+
+    if (m_shift > 32) {
+      m_half_upper = std::int64_t{ 1 } << (m_shift - 33);
+    } else if (m_shift > 0) {
+      m_half_lower = std::uint64_t{ 1 } << (m_shift - 1);
+    }
+  }
+
+  /**
+   * @brief Convert a value
+   *
+   * @param p_value - value to convert
+   * @return constexpr std::int64_t - scaled value, rounded to nearest
+   */
+  [[nodiscard]] constexpr std::int64_t operator()(
+    std::int64_t p_value) const noexcept
+  {
+    constexpr std::uint64_t low_mask = 0xFFFF'FFFF;
+
+    // p_value * m_multiplier == (upper << 32) + lower
+    const std::uint64_t low_product =
+      (static_cast<std::uint64_t>(p_value) & low_mask) * m_multiplier;
+    const std::int64_t upper =
+      (p_value >> 32) * static_cast<std::int64_t>(m_multiplier) +
+      static_cast<std::int64_t>(low_product >> 32);
+    const std::uint64_t lower = low_product & low_mask;
+
+    // Add half of 2^m_shift to round to nearest. Only the lower word can carry
+    // into the upper word.
+    const auto carry = static_cast<std::int64_t>((lower + m_half_lower) >> 32);
+    const std::int64_t rounded = upper + carry + m_half_upper;
+
+    if (m_shift >= 32) {
+      return (rounded >> (m_shift - 32)) + m_offset;
+    }
+
+    const std::uint64_t remaining = (lower + m_half_lower) & low_mask;
+    return rounded * (std::int64_t{ 1 } << (32 - m_shift)) +
+           static_cast<std::int64_t>(remaining >> m_shift) + m_offset;
+  }
+
+  /**
+   * @brief Get the multiplier applied to each value
+   *
+   * @return constexpr std::uint64_t - multiplier, always less than 2^32
+   */
+  [[nodiscard]] constexpr std::uint64_t multiplier() const noexcept
+  {
+    return m_multiplier;
+  }
+
+  /**
+   * @brief Get the number of bits the product is shifted right by
+   *
+   * @return constexpr std::uint32_t - shift amount
+   */
+  [[nodiscard]] constexpr std::uint32_t shift() const noexcept
+  {
+    return m_shift;
+  }
+
+private:
+  std::uint64_t m_multiplier = 0;
+  std::uint32_t m_shift = 0;
+  std::uint64_t m_half_lower = 0;
+  std::int64_t m_half_upper = 0;
+  std::int64_t m_offset = 0;
+};
+
+/**
+ * @brief Determine the ratio between the units of two quantities
+ *
+ * The ratio is found by converting 10^18 units of From into To with
+ * units::quantity_cast and reducing the result. The unit of To must be a
+ * power of ten multiple of the unit of From that is equal or larger in size,
+ * such as nanometres into millimetres.
+ *
+ * @tparam To - quantity type to convert into
+ * @tparam From - quantity type to convert from
+ * @return constexpr std::array<std::uint64_t, 2> - numerator and denominator
+ * of the number of To units in one From unit
+ */
+template<units::Quantity To, units::Quantity From>
+[[nodiscard]] constexpr std::array<std::uint64_t, 2> unit_ratio() noexcept
+{
+  constexpr std::int64_t reference = 1'000'000'000'000'000'000;
+  using from_t = units::quantity<typename From::dimension,
+                                 typename From::unit,
+                                 std::int64_t>;
+  using to_t =
+    units::quantity<typename To::dimension, typename To::unit, std::int64_t>;
+
+  constexpr auto numerator = static_cast<std::uint64_t>(
+    units::quantity_cast<to_t>(from_t(reference)).number());
+  static_assert(numerator != 0,
+                "The unit of To must not be smaller than 10^-18 of From");
+  constexpr auto denominator = static_cast<std::uint64_t>(reference);
+  constexpr auto divisor = std::gcd(numerator, denominator);
+
+  return { numerator / divisor, denominator / divisor };
+}
+}  // namespace embed
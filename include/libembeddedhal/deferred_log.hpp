@@ -0,0 +1,554 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "error.hpp"
+#include "serial/interface.hpp"
+
+namespace embed {
+/**
+ * @brief Compile time string used as a template parameter for deferred log
+ * calls.
+ *
+ * @tparam N - length of the string including the null terminator
+ */
+template<size_t N>
+struct log_format
+{
+  /**
+   * @brief Construct a log format from a string literal
+   *
+   * @param p_string - string literal
+   */
+  consteval log_format(const char (&p_string)[N]) noexcept
+  {
+    std::copy_n(p_string, N, data.begin());
+  }
+
+  /**
+   * @brief Get the format string without its null terminator
+   *
+   * @return constexpr std::string_view - the format string
+   */
+  [[nodiscard]] constexpr std::string_view view() const noexcept
+  {
+    return std::string_view(data.data(), N - 1);
+  }
+
+  /// Storage for the string including its null terminator
+  std::array<char, N> data{};
+};
+
+/**
+ * @brief Generate the 32-bit identifier for a log format string.
+ *
+ * The identifier is the FNV-1a hash of the string. Targets emit this value in
+ * place of the string itself and host side decoders use it to look up the
+ * string in their dictionary.
+ *
+ * @param p_format - the format string
+ * @return constexpr std::uint32_t - the identifier for the format string
+ */
+[[nodiscard]] constexpr std::uint32_t log_format_id(
+  std::string_view p_format) noexcept
+{
+  std::uint32_t hash = 2166136261U;
+  for (const char character : p_format) {
+    hash ^= static_cast<std::uint8_t>(character);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+/// Type tag stored in front of each argument of a deferred log record
+enum class log_argument : std::uint8_t
+{
+  boolean = 0,
+  int8,
+  int16,
+  int32,
+  int64,
+  uint8,
+  uint16,
+  uint32,
+  uint64,
+  float32,
+  float64,
+};
+
+/// Types that can be passed as arguments to a deferred log call
+template<typename T>
+concept loggable = std::integral<T> || std::floating_point<T> ||
+                   std::is_enum_v<T>;
+
+/**
+ * @brief Get the type tag for a loggable type
+ *
+ * @tparam T - loggable type
+ * @return consteval log_argument - the type tag for T
+ */
+template<loggable T>
+[[nodiscard]] consteval log_argument log_argument_of() noexcept
+{
+  if constexpr (std::is_enum_v<T>) {
+    return log_argument_of<std::underlying_type_t<T>>();
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return log_argument::boolean;
+  } else if constexpr (std::floating_point<T>) {
+    return (sizeof(T) == 4) ? log_argument::float32 : log_argument::float64;
+  } else if constexpr (std::is_signed_v<T>) {
+    switch (sizeof(T)) {
+      case 1:
+        return log_argument::int8;
+      case 2:
+        return log_argument::int16;
+      case 4:
+        return log_argument::int32;
+      default:
+        return log_argument::int64;
+    }
+  } else {
+    switch (sizeof(T)) {
+      case 1:
+        return log_argument::uint8;
+      case 2:
+        return log_argument::uint16;
+      case 4:
+        return log_argument::uint32;
+      default:
+        return log_argument::uint64;
+    }
+  }
+}
+
+/**
+ * @brief Get the number of payload bytes for an argument type tag
+ *
+ * @param p_argument - argument type tag
+ * @return constexpr size_t - size of the argument's value in bytes, 0 if the
+ * tag is unknown
+ */
+[[nodiscard]] constexpr size_t log_argument_size(
+  log_argument p_argument) noexcept
+{
+  switch (p_argument) {
+    case log_argument::boolean:
+    case log_argument::int8:
+    case log_argument::uint8:
+      return 1;
+    case log_argument::int16:
+    case log_argument::uint16:
+      return 2;
+    case log_argument::int32:
+    case log_argument::uint32:
+    case log_argument::float32:
+      return 4;
+    case log_argument::int64:
+    case log_argument::uint64:
+    case log_argument::float64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/// Number of bytes at the start of each record used for the record's payload
+/// length.
+inline constexpr size_t log_record_header_size = 1;
+/// Number of bytes used for the format string identifier
+inline constexpr size_t log_record_id_size = sizeof(std::uint32_t);
+
+/**
+ * @brief Deferred logger that stores log records in a binary format rather than
+ * formatting them into strings on the device.
+ *
+ * Each call to log() writes the 32-bit identifier of the format string,
+ * computed at compile time, along with the raw bytes of each argument into a
+ * lock free ring buffer. Formatting is left to a host side log_decoder.
+ *
+ * The record format is as follows:
+ *
+ *     [length: u8] [format id: u32 LE] ([type: u8] [value: LE bytes])...
+ *
+ * Where `length` is the number of bytes in the record after the length byte.
+ *
+ * log() may be called from a single producer context (an interrupt or the main
+ * thread) while drain() is called from a single consumer context. Use one
+ * deferred_log per interrupt priority level when logging from multiple levels.
+ *
+ * Example usage:
+ *
+ *     // log_formats.hpp, shared between the firmware and the host decoder
+ *     constexpr embed::log_format adc_log = "adc={} temp={}";
+ *
+ *     // firmware
+ *     embed::deferred_log<1024> log;
+ *     log.log<adc_log>(adc_value, temperature);
+ *     // elsewhere in the main loop
+ *     log.drain(uart);
+ *
+ *     // host, reading the bytes received from the uart into `stream`
+ *     embed::log_decoder decoder;
+ *     decoder.add(adc_log.view());
+ *     std::array<char, 256> text;
+ *     while (auto record = decoder.decode(stream, text)) {
+ *       std::puts(std::string(record.value().text).c_str());
+ *       stream = stream.subspan(record.value().consumed);
+ *     }
+ *
+ * @tparam Capacity - size of the ring buffer in bytes. Must be a power of two.
+ */
+template<size_t Capacity>
+class deferred_log
+{
+public:
+  static_assert(std::has_single_bit(Capacity),
+                "Capacity must be a power of two.");
+
+  /**
+   * @brief Append a log record to the buffer
+   *
+   * @tparam Format - format string, where `{}` is replaced by each argument
+   * @tparam Args - loggable argument types
+   * @param p_args - arguments to log
+   * @return true - the record was stored
+   * @return false - the buffer did not have enough space and the record was
+   * dropped
+   */
+  template<log_format Format, loggable... Args>
+  bool log(Args... p_args) noexcept
+  {
+    constexpr std::uint32_t id = log_format_id(Format.view());
+    constexpr size_t payload_size =
+      log_record_id_size +
+      (0 + ... + (1 + log_argument_size(log_argument_of<Args>())));
+    constexpr size_t record_size = log_record_header_size + payload_size;
+
+    static_assert(payload_size <= 255, "Too many arguments for a log record.");
+    static_assert(record_size <= Capacity, "Log record exceeds capacity.");
+
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+
+    if (Capacity - (head - tail) < record_size) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    size_t position = head;
+    push(position, static_cast<std::uint8_t>(payload_size));
+    push(position, id);
+    (push_argument(position, p_args), ...);
+
+    m_head.store(position, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Write all buffered log records to a serial port
+   *
+   * The buffered bytes are written in up to two parts when they wrap around
+   * the end of the ring buffer. Each part is released as soon as it is
+   * written, so if the second write fails, the next call resumes after the
+   * first part rather than sending it again.
+   *
+   * @param p_serial - serial port to write records to
+   * @return boost::leaf::result<size_t> - number of bytes written or an error
+   * from the serial port.
+   */
+  [[nodiscard]] boost::leaf::result<size_t> drain(serial& p_serial) noexcept
+  {
+    const size_t head = m_head.load(std::memory_order_acquire);
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t length = head - tail;
+    const size_t start = tail & mask;
+    const size_t first_length = std::min(length, Capacity - start);
+
+    BOOST_LEAF_CHECK(p_serial.write(
+      std::span<const std::byte>(m_buffer.data() + start, first_length)));
+    m_tail.store(tail + first_length, std::memory_order_release);
+
+    if (first_length < length) {
+      BOOST_LEAF_CHECK(p_serial.write(
+        std::span<const std::byte>(m_buffer.data(), length - first_length)));
+      m_tail.store(head, std::memory_order_release);
+    }
+
+    return length;
+  }
+
+  /**
+   * @brief Get the number of bytes waiting to be drained
+   *
+   * @return size_t - number of buffered bytes
+   */
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return m_head.load(std::memory_order_acquire) -
+           m_tail.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the number of records dropped due to a full buffer
+   *
+   * @return size_t - number of dropped records
+   */
+  [[nodiscard]] size_t dropped() const noexcept
+  {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t mask = Capacity - 1;
+
+  template<std::integral T>
+  void push(size_t& p_position, T p_value) noexcept
+  {
+    using unsigned_t = std::make_unsigned_t<T>;
+    auto value = static_cast<unsigned_t>(p_value);
+    for (size_t i = 0; i < sizeof(T); i++) {
+      m_buffer[p_position & mask] = static_cast<std::byte>(value & 0xFF);
+      if constexpr (sizeof(T) > 1) {
+        value = static_cast<unsigned_t>(value >> 8);
+      }
+      p_position++;
+    }
+  }
+
+  template<loggable T>
+  void push_argument(size_t& p_position, T p_value) noexcept
+  {
+    push(p_position, static_cast<std::uint8_t>(log_argument_of<T>()));
+    if constexpr (std::is_enum_v<T>) {
+      push(p_position, static_cast<std::underlying_type_t<T>>(p_value));
+    } else if constexpr (std::is_same_v<T, bool>) {
+      push(p_position, static_cast<std::uint8_t>(p_value));
+    } else if constexpr (std::is_same_v<T, float>) {
+      push(p_position, std::bit_cast<std::uint32_t>(p_value));
+    } else if constexpr (std::floating_point<T>) {
+      const auto value = static_cast<double>(p_value);
+      push(p_position, std::bit_cast<std::uint64_t>(value));
+    } else {
+      push(p_position, p_value);
+    }
+  }
+
+  std::array<std::byte, Capacity> m_buffer{};
+  std::atomic<size_t> m_head = 0;
+  std::atomic<size_t> m_tail = 0;
+  std::atomic<size_t> m_dropped = 0;
+};
+
+/**
+ * @brief Host side decoder for records generated by deferred_log.
+ *
+ * The decoder uses a dictionary of format strings to convert records back into
+ * text. The simplest way to build the dictionary is to declare each format
+ * string as a `constexpr embed::log_format` in a header shared between the
+ * firmware and the host tool.
+ *
+ * @tparam MaxFormats - maximum number of format strings in the dictionary
+ */
+template<size_t MaxFormats = 256>
+class log_decoder
+{
+public:
+  /**
+   * @brief Result of decoding a single record
+   *
+   */
+  struct decoded_t
+  {
+    /// Number of bytes consumed from the input stream
+    size_t consumed;
+    /// Formatted text written to the output buffer
+    std::string_view text;
+  };
+
+  /**
+   * @brief Add a format string to the dictionary
+   *
+   * Adding a format string that is already in the dictionary has no effect.
+   *
+   * @param p_format - format string as it appears in the log call
+   * @return boost::leaf::result<void> - `std::errc::not_enough_memory` if the
+   * dictionary is full and `std::errc::invalid_argument` if a different format
+   * string in the dictionary has the same id, as records of the two could not
+   * be told apart.
+   */
+  [[nodiscard]] boost::leaf::result<void> add(
+    std::string_view p_format) noexcept
+  {
+    const std::uint32_t id = log_format_id(p_format);
+    if (const auto* existing = find(id)) {
+      if (existing->format != p_format) {
+        return boost::leaf::new_error(std::errc::invalid_argument);
+      }
+      return {};
+    }
+    if (m_count >= MaxFormats) {
+      return boost::leaf::new_error(std::errc::not_enough_memory);
+    }
+    m_dictionary[m_count] = { id, p_format };
+    m_count++;
+    return {};
+  }
+
+  /**
+   * @brief Decode the first record in a stream of records into text
+   *
+   * @param p_stream - bytes received from deferred_log::drain()
+   * @param p_output - buffer to write the formatted text into. Text that does
+   * not fit is truncated.
+   * @return boost::leaf::result<decoded_t> - the decoded text and the number
+   * of bytes consumed. Returns `std::errc::resource_unavailable_try_again` if
+   * the stream does not yet contain a full record and
+   * `std::errc::invalid_argument` if the record's format id is not in the
+   * dictionary, an argument's type tag is unknown or the record is malformed.
+   */
+  [[nodiscard]] boost::leaf::result<decoded_t> decode(
+    std::span<const std::byte> p_stream,
+    std::span<char> p_output) const noexcept
+  {
+    if (p_stream.empty()) {
+      return boost::leaf::new_error(std::errc::resource_unavailable_try_again);
+    }
+
+    const size_t payload_size = std::to_integer<size_t>(p_stream[0]);
+    const size_t record_size = log_record_header_size + payload_size;
+
+    if (p_stream.size() < record_size) {
+      return boost::leaf::new_error(std::errc::resource_unavailable_try_again);
+    }
+
+    auto record = p_stream.subspan(log_record_header_size, payload_size);
+    if (record.size() < log_record_id_size) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    const auto id = static_cast<std::uint32_t>(pop(record, log_record_id_size));
+    const auto* entry = find(id);
+    if (entry == nullptr) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    auto format = entry->format;
+    size_t length = 0;
+
+    while (!format.empty()) {
+      const auto placeholder = format.find("{}");
+      const auto literal = format.substr(0, placeholder);
+      length += copy(literal, p_output.subspan(length));
+
+      if (placeholder == std::string_view::npos) {
+        break;
+      }
+      format.remove_prefix(placeholder + 2);
+
+      if (record.empty()) {
+        return boost::leaf::new_error(std::errc::invalid_argument);
+      }
+      const auto type = static_cast<log_argument>(pop(record, 1));
+      const auto size = log_argument_size(type);
+      if (size == 0 || record.size() < size) {
+        return boost::leaf::new_error(std::errc::invalid_argument);
+      }
+      length += print(type, pop(record, size), p_output.subspan(length));
+    }
+
+    return decoded_t{
+      .consumed = record_size,
+      .text = std::string_view(p_output.data(), length),
+    };
+  }
+
+private:
+  struct entry_t
+  {
+    std::uint32_t id = 0;
+    std::string_view format{};
+  };
+
+  [[nodiscard]] const entry_t* find(std::uint32_t p_id) const noexcept
+  {
+    for (size_t i = 0; i < m_count; i++) {
+      if (m_dictionary[i].id == p_id) {
+        return &m_dictionary[i];
+      }
+    }
+    return nullptr;
+  }
+
+  static std::uint64_t pop(std::span<const std::byte>& p_record,
+                           size_t p_size) noexcept
+  {
+    std::uint64_t value = 0;
+    for (size_t i = 0; i < p_size; i++) {
+      value |= std::to_integer<std::uint64_t>(p_record[i]) << (i * 8);
+    }
+    p_record = p_record.subspan(p_size);
+    return value;
+  }
+
+  static size_t copy(std::string_view p_text, std::span<char> p_output) noexcept
+  {
+    const size_t length = std::min(p_text.size(), p_output.size());
+    std::copy_n(p_text.begin(), length, p_output.begin());
+    return length;
+  }
+
+  static size_t print(log_argument p_type,
+                      std::uint64_t p_raw,
+                      std::span<char> p_output) noexcept
+  {
+    std::array<char, 32> buffer{};
+    auto* first = buffer.data();
+    auto* last = buffer.data() + buffer.size();
+    std::to_chars_result result{ first, std::errc{} };
+
+    switch (p_type) {
+      case log_argument::boolean:
+        return copy((p_raw != 0) ? "true" : "false", p_output);
+      case log_argument::int8:
+        result = std::to_chars(first, last, static_cast<std::int8_t>(p_raw));
+        break;
+      case log_argument::int16:
+        result = std::to_chars(first, last, static_cast<std::int16_t>(p_raw));
+        break;
+      case log_argument::int32:
+        result = std::to_chars(first, last, static_cast<std::int32_t>(p_raw));
+        break;
+      case log_argument::int64:
+        result = std::to_chars(first, last, static_cast<std::int64_t>(p_raw));
+        break;
+      case log_argument::float32:
+        result = std::to_chars(
+          first,
+          last,
+          std::bit_cast<float>(static_cast<std::uint32_t>(p_raw)));
+        break;
+      case log_argument::float64:
+        result = std::to_chars(first, last, std::bit_cast<double>(p_raw));
+        break;
+      default:
+        result = std::to_chars(first, last, p_raw);
+        break;
+    }
+
+    return copy(std::string_view(first, result.ptr), p_output);
+  }
+
+  std::array<entry_t, MaxFormats> m_dictionary{};
+  size_t m_count = 0;
+};
+}  // namespace embed
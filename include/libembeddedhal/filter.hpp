@@ -0,0 +1,588 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#include "fixed_point.hpp"
+
+namespace embed {
+/**
+ * @brief Sample types supported by the filters in this file.
+ *
+ * Floating point samples are best for processors with an FPU. fixed_point
+ * samples only require integer instructions.
+ */
+template<typename T>
+concept filter_sample = std::floating_point<T> || is_fixed_point_v<T>;
+
+/// Accumulator used to sum the products of filter samples. Floating point
+/// samples accumulate in their own type and fixed point samples accumulate
+/// their raw values in a 64-bit integer.
+template<filter_sample T>
+using filter_accumulator_t =
+  std::conditional_t<std::floating_point<T>, T, std::int64_t>;
+
+/**
+ * @brief Add the product of two samples to an accumulator.
+ *
+ * For fixed point samples of 16-bits or less, products are accumulated at full
+ * precision and rounded once by filter_result(). 32-bit products are rounded
+ * individually in order to keep headroom in the accumulator. This matches the
+ * behavior of dot_product() and the multiply-accumulate instructions found on
+ * DSP capable microcontrollers.
+ *
+ * @tparam T - sample type
+ * @param p_accumulator - accumulator to add the product to
+ * @param p_lhs - left hand side of the product
+ * @param p_rhs - right hand side of the product
+ */
+template<filter_sample T>
+constexpr void multiply_accumulate(filter_accumulator_t<T>& p_accumulator,
+                                   T p_lhs,
+                                   T p_rhs) noexcept
+{
+  if constexpr (std::floating_point<T>) {
+    p_accumulator += p_lhs * p_rhs;
+  } else {
+    const std::int64_t product =
+      std::int64_t{ p_lhs.raw_value() } * p_rhs.raw_value();
+    if constexpr (sizeof(typename T::int_t) <= 2) {
+      p_accumulator += product;
+    } else {
+      p_accumulator += T::round_shift(product);
+    }
+  }
+}
+
+/**
+ * @brief Convert an accumulator of products back into a sample.
+ *
+ * @tparam T - sample type
+ * @param p_accumulator - accumulator filled by multiply_accumulate()
+ * @return constexpr T - the accumulated value, rounded and saturated for fixed
+ * point samples.
+ */
+template<filter_sample T>
+[[nodiscard]] constexpr T filter_result(
+  filter_accumulator_t<T> p_accumulator) noexcept
+{
+  if constexpr (std::floating_point<T>) {
+    return p_accumulator;
+  } else if constexpr (sizeof(typename T::int_t) <= 2) {
+    return T::from_raw(T::saturate(T::round_shift(p_accumulator)));
+  } else {
+    return T::from_raw(T::saturate(p_accumulator));
+  }
+}
+
+/**
+ * @brief Moving average filter with a constant cost per sample.
+ *
+ * Keeps a running sum of the last Length samples, thus each sample costs one
+ * addition, one subtraction and one division by Length regardless of the
+ * length of the window. Use a power of two Length to turn the division into a
+ * shift.
+ *
+ * @tparam T - sample type
+ * @tparam Length - number of samples to average
+ */
+template<filter_sample T, size_t Length>
+class moving_average
+{
+public:
+  static_assert(Length > 0, "Length must be greater than 0.");
+
+  /**
+   * @brief Add a sample to the window and get the new average
+   *
+   * @param p_sample - new sample
+   * @return constexpr T - average of the last Length samples. Samples before
+   * the first Length samples are treated as 0.
+   */
+  constexpr T update(T p_sample) noexcept
+  {
+    m_sum += to_sum(p_sample) - to_sum(m_window[m_index]);
+    m_window[m_index] = p_sample;
+    m_index = (m_index + 1 == Length) ? 0 : m_index + 1;
+    return value();
+  }
+
+  /**
+   * @brief Filter a block of samples
+   *
+   * @param p_input - samples to filter
+   * @param p_output - destination of the filtered samples, may alias p_input
+   * @return constexpr std::span<T> - portion of p_output written, which is the
+   * size of the smallest of the two spans.
+   */
+  constexpr std::span<T> process(std::span<const T> p_input,
+                                 std::span<T> p_output) noexcept
+  {
+    const size_t size = std::min(p_input.size(), p_output.size());
+    for (size_t i = 0; i < size; i++) {
+      p_output[i] = update(p_input[i]);
+    }
+    return p_output.first(size);
+  }
+
+  /**
+   * @brief Get the current average
+   *
+   * @return constexpr T - average of the last Length samples
+   */
+  [[nodiscard]] constexpr T value() const noexcept
+  {
+    if constexpr (std::floating_point<T>) {
+      return m_sum / static_cast<T>(Length);
+    } else {
+      const auto length = static_cast<std::int64_t>(Length);
+      return T::from_raw(T::saturate(m_sum / length));
+    }
+  }
+
+  /**
+   * @brief Clear the window back to 0
+   *
+   */
+  constexpr void reset() noexcept
+  {
+    m_window.fill(T{});
+    m_sum = {};
+    m_index = 0;
+  }
+
+private:
+  static constexpr filter_accumulator_t<T> to_sum(T p_sample) noexcept
+  {
+    if constexpr (std::floating_point<T>) {
+      return p_sample;
+    } else {
+      return p_sample.raw_value();
+    }
+  }
+
+  std::array<T, Length> m_window{};
+  filter_accumulator_t<T> m_sum{};
+  size_t m_index = 0;
+};
+
+/**
+ * @brief Finite impulse response (FIR) filter
+ *
+ * Computes y[n] = h[0] * x[n] + h[1] * x[n - 1] + ... + h[Taps - 1] * x[n -
+ * Taps + 1].
+ *
+ * Each sample is stored twice in a history buffer of length 2 * Taps, so the
+ * last Taps samples are always contiguous in memory. The inner loop is a
+ * straight multiply-accumulate over two arrays without any modulo or
+ * branches, allowing it to be unrolled and vectorized by the compiler or
+ * mapped to the dual multiply-accumulate instructions of Cortex-M DSP
+ * extensions.
+ *
+ * @tparam T - sample type
+ * @tparam Taps - number of coefficients
+ */
+template<filter_sample T, size_t Taps>
+class fir
+{
+public:
+  static_assert(Taps > 0, "Taps must be greater than 0.");
+
+  /**
+   * @brief Construct a new fir object
+   *
+   * @param p_coefficients - filter coefficients h[0] to h[Taps - 1]
+   */
+  explicit constexpr fir(std::array<T, Taps> p_coefficients) noexcept
+    : m_coefficients(p_coefficients)
+  {}
+
+  /**
+   * @brief Filter a single sample
+   *
+   * @param p_sample - new sample x[n]
+   * @return constexpr T - filter output y[n]
+   */
+  constexpr T update(T p_sample) noexcept
+  {
+    m_index = (m_index == 0) ? Taps - 1 : m_index - 1;
+    m_history[m_index] = p_sample;
+    m_history[m_index + Taps] = p_sample;
+
+    // window[k] = x[n - k]
+    const T* window = &m_history[m_index];
+    filter_accumulator_t<T> accumulator{};
+    for (size_t k = 0; k < Taps; k++) {
+      multiply_accumulate(accumulator, m_coefficients[k], window[k]);
+    }
+    return filter_result<T>(accumulator);
+  }
+
+  /**
+   * @brief Filter a block of samples
+   *
+   * @param p_input - samples to filter
+   * @param p_output - destination of the filtered samples, may alias p_input
+   * @return constexpr std::span<T> - portion of p_output written, which is the
+   * size of the smallest of the two spans.
+   */
+  constexpr std::span<T> process(std::span<const T> p_input,
+                                 std::span<T> p_output) noexcept
+  {
+    const size_t size = std::min(p_input.size(), p_output.size());
+    for (size_t i = 0; i < size; i++) {
+      p_output[i] = update(p_input[i]);
+    }
+    return p_output.first(size);
+  }
+
+  /**
+   * @brief Clear the history of the filter back to 0
+   *
+   */
+  constexpr void reset() noexcept
+  {
+    m_history.fill(T{});
+    m_index = 0;
+  }
+
+private:
+  std::array<T, Taps> m_coefficients;
+  std::array<T, Taps * 2> m_history{};
+  size_t m_index = 0;
+};
+
+/**
+ * @brief Second order infinite impulse response (IIR) filter section
+ *
+ * Implemented in direct form I:
+ *
+ *    y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
+ *
+ * Direct form I is used as it cannot overflow internally when used with fixed
+ * point samples. Coefficients commonly have magnitudes up to 2.0, so fixed
+ * point biquads should use a format with at least 2 integer bits such as
+ * `fixed_point<std::int32_t, 28>`.
+ *
+ * @tparam T - sample type
+ */
+template<filter_sample T>
+class biquad
+{
+public:
+  /// Coefficients of a biquad section, a0 is normalized to 1.0
+  struct coefficients
+  {
+    /// Feed forward coefficient of x[n]
+    T b0{};
+    /// Feed forward coefficient of x[n-1]
+    T b1{};
+    /// Feed forward coefficient of x[n-2]
+    T b2{};
+    /// Feedback coefficient of y[n-1]
+    T a1{};
+    /// Feedback coefficient of y[n-2]
+    T a2{};
+  };
+
+  /**
+   * @brief Construct a new biquad object that passes samples unmodified
+   *
+   * b0 is 1.0, which fixed point formats without an integer bit, such as q15,
+   * cannot represent. It saturates to their largest value, so these scale each
+   * sample by 1 - 2^-fractional_bits, changing it by at most one least
+   * significant bit.
+   */
+  constexpr biquad() noexcept
+    : biquad(coefficients{ .b0 = T(1.0) })
+  {}
+
+  /**
+   * @brief Construct a new biquad object
+   *
+   * @param p_coefficients - filter coefficients
+   */
+  explicit constexpr biquad(coefficients p_coefficients) noexcept
+    : m_b0(p_coefficients.b0)
+    , m_b1(p_coefficients.b1)
+    , m_b2(p_coefficients.b2)
+    , m_negative_a1(-p_coefficients.a1)
+    , m_negative_a2(-p_coefficients.a2)
+  {}
+
+  /**
+   * @brief Filter a single sample
+   *
+   * @param p_sample - new sample x[n]
+   * @return constexpr T - filter output y[n]
+   */
+  constexpr T update(T p_sample) noexcept
+  {
+    filter_accumulator_t<T> accumulator{};
+    multiply_accumulate(accumulator, m_b0, p_sample);
+    multiply_accumulate(accumulator, m_b1, m_x1);
+    multiply_accumulate(accumulator, m_b2, m_x2);
+    multiply_accumulate(accumulator, m_negative_a1, m_y1);
+    multiply_accumulate(accumulator, m_negative_a2, m_y2);
+    const T output = filter_result<T>(accumulator);
+
+    m_x2 = m_x1;
+    m_x1 = p_sample;
+    m_y2 = m_y1;
+    m_y1 = output;
+
+    return output;
+  }
+
+  /**
+   * @brief Filter a block of samples
+   *
+   * @param p_input - samples to filter
+   * @param p_output - destination of the filtered samples, may alias p_input
+   * @return constexpr std::span<T> - portion of p_output written, which is the
+   * size of the smallest of the two spans.
+   */
+  constexpr std::span<T> process(std::span<const T> p_input,
+                                 std::span<T> p_output) noexcept
+  {
+    const size_t size = std::min(p_input.size(), p_output.size());
+    for (size_t i = 0; i < size; i++) {
+      p_output[i] = update(p_input[i]);
+    }
+    return p_output.first(size);
+  }
+
+  /**
+   * @brief Clear the state of the filter back to 0
+   *
+   */
+  constexpr void reset() noexcept
+  {
+    m_x1 = m_x2 = m_y1 = m_y2 = T{};
+  }
+
+private:
+  T m_b0;
+  T m_b1;
+  T m_b2;
+  T m_negative_a1;
+  T m_negative_a2;
+  T m_x1{};
+  T m_x2{};
+  T m_y1{};
+  T m_y2{};
+};
+
+/**
+ * @brief Series of biquad sections where the output of each section is the
+ * input of the next.
+ *
+ * Higher order IIR filters should be implemented as a cascade of biquads
+ * rather than a single high order section in order to remain numerically
+ * stable.
+ *
+ * @tparam T - sample type
+ * @tparam Sections - number of biquad sections
+ */
+template<filter_sample T, size_t Sections>
+class biquad_cascade
+{
+public:
+  static_assert(Sections > 0, "Sections must be greater than 0.");
+
+  /// Coefficients of each section
+  using coefficients = typename biquad<T>::coefficients;
+
+  /**
+   * @brief Construct a new biquad cascade object
+   *
+   * @param p_coefficients - coefficients of each section in order
+   */
+  explicit constexpr biquad_cascade(
+    const std::array<coefficients, Sections>& p_coefficients) noexcept
+  {
+    for (size_t i = 0; i < Sections; i++) {
+      m_sections[i] = biquad<T>(p_coefficients[i]);
+    }
+  }
+
+  /**
+   * @brief Filter a single sample through every section
+   *
+   * @param p_sample - new sample x[n]
+   * @return constexpr T - output of the last section y[n]
+   */
+  constexpr T update(T p_sample) noexcept
+  {
+    for (auto& section : m_sections) {
+      p_sample = section.update(p_sample);
+    }
+    return p_sample;
+  }
+
+  /**
+   * @brief Filter a block of samples
+   *
+   * Each section processes the entire block before the next, keeping the
+   * coefficients and state of a section in registers for the whole block.
+   *
+   * @param p_input - samples to filter
+   * @param p_output - destination of the filtered samples, may alias p_input
+   * @return constexpr std::span<T> - portion of p_output written, which is the
+   * size of the smallest of the two spans.
+   */
+  constexpr std::span<T> process(std::span<const T> p_input,
+                                 std::span<T> p_output) noexcept
+  {
+    auto output = m_sections[0].process(p_input, p_output);
+    for (size_t i = 1; i < Sections; i++) {
+      m_sections[i].process(output, output);
+    }
+    return output;
+  }
+
+  /**
+   * @brief Clear the state of every section back to 0
+   *
+   */
+  constexpr void reset() noexcept
+  {
+    for (auto& section : m_sections) {
+      section.reset();
+    }
+  }
+
+private:
+  std::array<biquad<T>, Sections> m_sections{};
+};
+
+/**
+ * @brief Cascaded integrator-comb (CIC) decimator
+ *
+ * Low pass filters and reduces the sample rate of a stream of integer samples
+ * by a factor of Decimation using only additions and subtractions. CIC
+ * decimators are commonly used to turn a high rate, low resolution stream,
+ * such as an oversampled ADC, into a lower rate, higher resolution stream.
+ *
+ * The output has a gain of Decimation^Order. Integrators are allowed to wrap
+ * around, the modular arithmetic of the comb stages recovers the correct
+ * result as long as the output fits within 64-bits.
+ *
+ * @tparam Order - number of integrator and comb stages
+ * @tparam Decimation - sample rate reduction factor
+ */
+template<size_t Order, size_t Decimation>
+class cic_decimator
+{
+public:
+  static_assert(Order > 0, "Order must be greater than 0.");
+  static_assert(Decimation > 0, "Decimation must be greater than 0.");
+
+  /**
+   * @brief Get the gain of the filter
+   *
+   * @return constexpr std::uint64_t - Decimation^Order
+   */
+  [[nodiscard]] static constexpr std::uint64_t gain() noexcept
+  {
+    std::uint64_t result = 1;
+    for (size_t i = 0; i < Order; i++) {
+      result *= Decimation;
+    }
+    return result;
+  }
+
+  static_assert(gain() <= (std::uint64_t{ 1 } << 31),
+                "Decimation^Order must not exceed 2^31 for 32-bit inputs.");
+
+  /// Result of filtering a block of samples
+  struct decimated_t
+  {
+    /// Number of input samples consumed, the rest were not filtered
+    size_t consumed;
+    /// Portion of the output buffer written
+    std::span<std::int64_t> output;
+  };
+
+  /**
+   * @brief Filter a single sample
+   *
+   * @param p_sample - new input sample
+   * @return constexpr std::optional<std::int64_t> - an output sample for every
+   * Decimation input samples, otherwise std::nullopt.
+   */
+  constexpr std::optional<std::int64_t> update(std::int32_t p_sample) noexcept
+  {
+    std::uint64_t value = static_cast<std::uint64_t>(p_sample);
+    for (auto& integrator : m_integrators) {
+      integrator += value;
+      value = integrator;
+    }
+
+    m_count++;
+    if (m_count < Decimation) {
+      return std::nullopt;
+    }
+    m_count = 0;
+
+    for (auto& delay : m_combs) {
+      const std::uint64_t difference = value - delay;
+      delay = value;
+      value = difference;
+    }
+
+    return static_cast<std::int64_t>(value);
+  }
+
+  /**
+   * @brief Filter and decimate a block of samples
+   *
+   * Processing stops as soon as p_output is full, right after the input
+   * sample that produced the last output. The remaining input samples have
+   * not been filtered and should be passed to the next call.
+   *
+   * @param p_input - samples to filter
+   * @param p_output - destination of the decimated samples
+   * @return constexpr decimated_t - number of input samples consumed and the
+   * portion of p_output written
+   */
+  constexpr decimated_t process(std::span<const std::int32_t> p_input,
+                                std::span<std::int64_t> p_output) noexcept
+  {
+    size_t consumed = 0;
+    size_t written = 0;
+    for (; consumed < p_input.size() && written < p_output.size();
+         consumed++) {
+      if (auto output = update(p_input[consumed])) {
+        p_output[written++] = *output;
+      }
+    }
+    return decimated_t{
+      .consumed = consumed,
+      .output = p_output.first(written),
+    };
+  }
+
+  /**
+   * @brief Clear the state of the filter back to 0
+   *
+   */
+  constexpr void reset() noexcept
+  {
+    m_integrators.fill(0);
+    m_combs.fill(0);
+    m_count = 0;
+  }
+
+private:
+  std::array<std::uint64_t, Order> m_integrators{};
+  std::array<std::uint64_t, Order> m_combs{};
+  size_t m_count = 0;
+};
+}  // namespace embed
@@ -0,0 +1,725 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "math.hpp"
+#include "percent.hpp"
+#include "units.hpp"
+
+namespace embed {
+/**
+ * @brief Signed fixed point number in Q format.
+ *
+ * A Q format number stores a real number as an integer with an implied binary
+ * point FractionalBits from the right. For example, Q15 holds values within
+ * [-1.0, 1.0) in a 16-bit integer where the raw value 16384 is 0.5. Fixed
+ * point arithmetic only requires integer instructions, making it suitable for
+ * filters and control loops on processors without an FPU.
+ *
+ * All arithmetic saturates to the minimum and maximum representable values
+ * rather than wrapping around. Types of 16-bits or less perform all arithmetic
+ * using 32-bit integers.
+ *
+ * @tparam IntT - signed integer type holding the raw value
+ * @tparam FractionalBits - number of bits to the right of the binary point
+ */
+template<std::signed_integral IntT, size_t FractionalBits>
+class fixed_point
+{
+public:
+  static_assert(sizeof(IntT) <= sizeof(std::int32_t),
+                "fixed_point supports up to 32-bit representations.");
+  static_assert(FractionalBits < sizeof(IntT) * CHAR_BIT,
+                "FractionalBits must leave room for the sign bit.");
+
+  /// Integer type holding the raw value
+  using int_t = IntT;
+  /// Integer type large enough to hold the product of two int_t values
+  using overflow_t =
+    std::conditional_t<(sizeof(int_t) <= 2), std::int32_t, std::int64_t>;
+
+  /// Number of bits to the right of the binary point
+  static constexpr size_t fractional_bits = FractionalBits;
+  /// Number of bits to the left of the binary point, excluding the sign bit
+  static constexpr size_t integer_bits =
+    (sizeof(int_t) * CHAR_BIT) - 1 - fractional_bits;
+
+  /**
+   * @brief Get the largest representable value
+   *
+   * @return constexpr fixed_point - largest representable value
+   */
+  [[nodiscard]] static constexpr fixed_point max() noexcept
+  {
+    return from_raw(std::numeric_limits<int_t>::max());
+  }
+
+  /**
+   * @brief Get the smallest (most negative) representable value
+   *
+   * @return constexpr fixed_point - smallest representable value
+   */
+  [[nodiscard]] static constexpr fixed_point min() noexcept
+  {
+    return from_raw(std::numeric_limits<int_t>::min());
+  }
+
+  /**
+   * @brief Construct a fixed point number from its raw representation
+   *
+   * @param p_raw - raw integer value
+   * @return constexpr fixed_point - fixed point number with the raw value
+   */
+  [[nodiscard]] static constexpr fixed_point from_raw(int_t p_raw) noexcept
+  {
+    fixed_point result;
+    result.m_value = p_raw;
+    return result;
+  }
+
+  /**
+   * @brief Construct a fixed point number from an integer value
+   *
+   * @tparam T - integral type of the value
+   * @param p_value - integer value, saturated to the representable range
+   * @return constexpr fixed_point - fixed point number equal to p_value
+   */
+  template<std::integral T>
+  [[nodiscard]] static constexpr fixed_point from_integer(T p_value) noexcept
+  {
+    constexpr std::int64_t maximum =
+      std::numeric_limits<int_t>::max() >> fractional_bits;
+    constexpr std::int64_t minimum =
+      std::numeric_limits<int_t>::min() >> fractional_bits;
+
+    std::int64_t value = 0;
+    if constexpr (std::is_unsigned_v<T>) {
+      value = static_cast<std::int64_t>(
+        std::min<std::uint64_t>(p_value, static_cast<std::uint64_t>(maximum)));
+    } else {
+      value = std::clamp<std::int64_t>(p_value, minimum, maximum);
+    }
+
+    return from_raw(static_cast<int_t>(value << fractional_bits));
+  }
+
+  /**
+   * @brief Construct a fixed point number with a value of 0
+   *
+   */
+  constexpr fixed_point() noexcept = default;
+
+  /**
+   * @brief Construct a fixed point number from a floating point value
+   *
+   * @param p_value - floating point value, rounded to the nearest
+   * representable value and saturated to the representable range.
+   */
+  constexpr fixed_point(std::floating_point auto p_value) noexcept
+  {
+    using float_t = decltype(p_value);
+
+    constexpr auto scale = static_cast<float_t>(overflow_t{ 1 }
+                                                << fractional_bits);
+    constexpr auto max = static_cast<float_t>(raw_max);
+    constexpr auto min = static_cast<float_t>(raw_min);
+    constexpr float_t half = 0.5;
+
+    float_t scaled = std::clamp(p_value * scale, min, max);
+    scaled += (scaled >= 0) ? half : -half;
+    m_value = saturate(static_cast<overflow_t>(scaled));
+  }
+
+  /**
+   * @brief Construct a fixed point number from a percent.
+   *
+   * The raw value of the percent is treated as a Q format number with all of
+   * its magnitude bits as fractional bits and shifted into place. The result
+   * is within one least significant bit of the percent value.
+   *
+   * @tparam U - integer type of the percent
+   * @param p_percent - percent to convert, saturated to the representable
+   * range.
+   */
+  template<std::signed_integral U>
+  explicit constexpr fixed_point(basic_percent<U> p_percent) noexcept
+  {
+    constexpr int shift = static_cast<int>(fractional_bits) -
+                          static_cast<int>(sizeof(U) * CHAR_BIT - 1);
+    std::int64_t raw = p_percent.raw_value();
+
+    if constexpr (shift >= 0) {
+      raw = raw << shift;
+    } else {
+      raw = (raw + (std::int64_t{ 1 } << (-shift - 1))) >> -shift;
+    }
+
+    m_value = saturate(raw);
+  }
+
+  /**
+   * @brief Convert to a percent, saturated to -100% and 100%
+   *
+   * @tparam U - integer type of the percent
+   * @return constexpr basic_percent<U> - the value as a percent
+   */
+  template<std::signed_integral U = std::int32_t>
+  [[nodiscard]] constexpr basic_percent<U> to_percent() const noexcept
+  {
+    constexpr size_t width = sizeof(U) * CHAR_BIT;
+    constexpr int shift =
+      static_cast<int>(width - 1) - static_cast<int>(fractional_bits);
+    std::int64_t raw = m_value;
+
+    if constexpr (shift >= 0) {
+      raw = raw << shift;
+    } else {
+      raw = (raw + (std::int64_t{ 1 } << (-shift - 1))) >> -shift;
+    }
+
+    raw = std::clamp<std::int64_t>(
+      raw, basic_percent<U>::raw_min(), basic_percent<U>::raw_max());
+    return basic_percent<U>::template convert<width>(static_cast<U>(raw));
+  }
+
+  /**
+   * @brief Get raw integral value
+   *
+   * @return constexpr int_t - raw value
+   */
+  [[nodiscard]] constexpr int_t raw_value() const noexcept { return m_value; }
+
+  /**
+   * @brief Convert to a floating point representation
+   *
+   * @tparam T - floating point type
+   * @return constexpr T - floating point representation of the value
+   */
+  template<std::floating_point T>
+  [[nodiscard]] constexpr T to() const noexcept
+  {
+    constexpr auto scale = static_cast<T>(overflow_t{ 1 } << fractional_bits);
+    return static_cast<T>(m_value) / scale;
+  }
+
+  /**
+   * @brief explicit cast to float.
+   *
+   * @return float - float representation of the value
+   */
+  [[nodiscard]] explicit operator float() const noexcept { return to<float>(); }
+
+  /**
+   * @brief explicit cast to double.
+   *
+   * @return double - double representation of the value
+   */
+  [[nodiscard]] explicit operator double() const noexcept
+  {
+    return to<double>();
+  }
+
+  /**
+   * @brief Default operators for <, <=, >, >= and ==
+   *
+   * @return auto - result of the comparison
+   */
+  [[nodiscard]] constexpr auto operator<=>(const fixed_point&) const noexcept =
+    default;
+
+  /**
+   * @brief Saturating negation
+   *
+   * @param p_value - value to negate
+   * @return constexpr fixed_point - -p_value, min() negates to max()
+   */
+  [[nodiscard]] friend constexpr fixed_point operator-(
+    fixed_point p_value) noexcept
+  {
+    return from_raw(saturate(-overflow_t{ p_value.m_value }));
+  }
+
+  /**
+   * @brief Saturating addition
+   *
+   * @param p_lhs - left hand side
+   * @param p_rhs - right hand side
+   * @return constexpr fixed_point - sum saturated to the representable range
+   */
+  [[nodiscard]] friend constexpr fixed_point operator+(
+    fixed_point p_lhs,
+    fixed_point p_rhs) noexcept
+  {
+    return from_raw(
+      saturate(overflow_t{ p_lhs.m_value } + overflow_t{ p_rhs.m_value }));
+  }
+
+  /**
+   * @brief Saturating subtraction
+   *
+   * @param p_lhs - left hand side
+   * @param p_rhs - right hand side
+   * @return constexpr fixed_point - difference saturated to the representable
+   * range
+   */
+  [[nodiscard]] friend constexpr fixed_point operator-(
+    fixed_point p_lhs,
+    fixed_point p_rhs) noexcept
+  {
+    return from_raw(
+      saturate(overflow_t{ p_lhs.m_value } - overflow_t{ p_rhs.m_value }));
+  }
+
+  /**
+   * @brief Saturating multiplication, rounded to the nearest representable
+   * value.
+   *
+   * @param p_lhs - left hand side
+   * @param p_rhs - right hand side
+   * @return constexpr fixed_point - product saturated to the representable
+   * range
+   */
+  [[nodiscard]] friend constexpr fixed_point operator*(
+    fixed_point p_lhs,
+    fixed_point p_rhs) noexcept
+  {
+    const overflow_t product =
+      overflow_t{ p_lhs.m_value } * overflow_t{ p_rhs.m_value };
+    return from_raw(saturate(round_shift(product)));
+  }
+
+  /**
+   * @brief Scale an integral value by a fixed point value.
+   *
+   * Similar to percent, `1000 * q15(0.25)` results in 250. Integers of up
+   * to 32 bits are multiplied in 64 bits and 64-bit integers, such as the
+   * representation of embed::acceleration, in embed::uint128_t.
+   *
+   * @tparam T - type of the integral value to be scaled
+   * @param p_value - value to be scaled
+   * @param p_scale - value scalar
+   * @return constexpr T - p_value * p_scale rounded to the nearest integer and
+   * saturated to the range of T
+   */
+  template<std::integral T>
+  requires(sizeof(T) <= sizeof(std::int64_t))
+  [[nodiscard]] friend constexpr T operator*(T p_value,
+                                             fixed_point p_scale) noexcept
+  {
+    if constexpr (sizeof(T) <= sizeof(std::int32_t)) {
+      const std::int64_t product =
+        static_cast<std::int64_t>(p_value) * p_scale.m_value;
+      return static_cast<T>(
+        std::clamp<std::int64_t>(round_shift(product),
+                                 std::numeric_limits<T>::min(),
+                                 std::numeric_limits<T>::max()));
+    } else {
+      return wide_scale(p_value, p_scale.m_value);
+    }
+  }
+
+  /**
+   * @brief Same as `operator*(T p_value, fixed_point p_scale)`
+   *
+   * @tparam T - see other operator*
+   * @param p_scale - see other operator*
+   * @param p_value - see other operator*
+   * @return constexpr T - see other operator*
+   */
+  template<std::integral T>
+  requires(sizeof(T) <= sizeof(std::int64_t))
+  [[nodiscard]] friend constexpr T operator*(fixed_point p_scale,
+                                             T p_value) noexcept
+  {
+    return p_value * p_scale;
+  }
+
+  /**
+   * @brief Saturating add and assign
+   *
+   * @param p_rhs - value to add
+   * @return constexpr fixed_point& - reference to this object
+   */
+  constexpr fixed_point& operator+=(fixed_point p_rhs) noexcept
+  {
+    return *this = *this + p_rhs;
+  }
+
+  /**
+   * @brief Saturating subtract and assign
+   *
+   * @param p_rhs - value to subtract
+   * @return constexpr fixed_point& - reference to this object
+   */
+  constexpr fixed_point& operator-=(fixed_point p_rhs) noexcept
+  {
+    return *this = *this - p_rhs;
+  }
+
+  /**
+   * @brief Saturating multiply and assign
+   *
+   * @param p_rhs - value to multiply by
+   * @return constexpr fixed_point& - reference to this object
+   */
+  constexpr fixed_point& operator*=(fixed_point p_rhs) noexcept
+  {
+    return *this = *this * p_rhs;
+  }
+
+  /**
+   * @brief Saturate a value to the range of int_t
+   *
+   * @tparam T - integral type of the value
+   * @param p_value - value to saturate
+   * @return constexpr int_t - p_value clamped to the range of int_t
+   */
+  template<std::signed_integral T>
+  [[nodiscard]] static constexpr int_t saturate(T p_value) noexcept
+  {
+    return static_cast<int_t>(
+      std::clamp(p_value, static_cast<T>(raw_min), static_cast<T>(raw_max)));
+  }
+
+  /**
+   * @brief Shift the product of two fixed point raw values back down to
+   * fractional_bits, rounding to the nearest value.
+   *
+   * @tparam T - integral type of the product
+   * @param p_product - product of two raw values
+   * @return constexpr T - p_product / 2^fractional_bits rounded
+   */
+  template<std::signed_integral T>
+  [[nodiscard]] static constexpr T round_shift(T p_product) noexcept
+  {
+    if constexpr (fractional_bits == 0) {
+      return p_product;
+    } else {
+      constexpr T half = T{ 1 } << (fractional_bits - 1);
+      return (p_product + half) >> fractional_bits;
+    }
+  }
+
+private:
+  /// Scale a 64-bit integer, multiplying the magnitudes in 128 bits and
+  /// rounding the same way as round_shift()
+  template<std::integral T>
+  [[nodiscard]] static constexpr T wide_scale(T p_value, int_t p_raw) noexcept
+  {
+    const bool negative_value = std::cmp_less(p_value, 0);
+    const bool negative = negative_value != (p_raw < 0);
+
+    auto value_magnitude = static_cast<std::uint64_t>(p_value);
+    if (negative_value) {
+      value_magnitude = 0 - value_magnitude;
+    }
+    auto raw_magnitude = static_cast<std::uint64_t>(p_raw);
+    if (p_raw < 0) {
+      raw_magnitude = 0 - raw_magnitude;
+    }
+
+    uint128_t magnitude = uint128_t{ value_magnitude } * raw_magnitude;
+    if constexpr (fractional_bits > 0) {
+      // Halves round up, so towards zero for negative results
+      constexpr auto half = std::uint64_t{ 1 } << (fractional_bits - 1);
+      magnitude += negative ? half - 1 : half;
+      magnitude >>= fractional_bits;
+    }
+
+    constexpr auto max =
+      static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    if (!negative) {
+      if (magnitude > uint128_t{ max }) {
+        return std::numeric_limits<T>::max();
+      }
+      return static_cast<T>(static_cast<std::uint64_t>(magnitude));
+    }
+
+    constexpr std::uint64_t min_magnitude = std::is_signed_v<T> ? max + 1 : 0;
+    if (magnitude > uint128_t{ min_magnitude }) {
+      return std::numeric_limits<T>::min();
+    }
+    return static_cast<T>(0 - static_cast<std::uint64_t>(magnitude));
+  }
+
+  static constexpr overflow_t raw_max = std::numeric_limits<int_t>::max();
+  static constexpr overflow_t raw_min = std::numeric_limits<int_t>::min();
+
+  int_t m_value = 0;
+};
+
+/// Determine if a type is a specialization of fixed_point
+template<typename T>
+inline constexpr bool is_fixed_point_v = false;
+
+/// Determine if a type is a specialization of fixed_point
+template<std::signed_integral IntT, size_t FractionalBits>
+inline constexpr bool is_fixed_point_v<fixed_point<IntT, FractionalBits>> =
+  true;
+
+/// Q15 fixed point number within [-1.0, 1.0) with a resolution of 2^-15
+using q15 = fixed_point<std::int16_t, 15>;
+/// Q31 fixed point number within [-1.0, 1.0) with a resolution of 2^-31
+using q31 = fixed_point<std::int32_t, 31>;
+/// Q16.16 fixed point number within [-32768.0, 32768.0)
+using q16_16 = fixed_point<std::int32_t, 16>;
+
+/**
+ * @brief Approximate the reciprocal (1 / p_value) of a fixed point number.
+ *
+ * Computed without division using three Newton-Raphson iterations on a
+ * normalized value, giving a result accurate to ~30 bits before the result is
+ * rounded to the fractional bits of the type.
+ *
+ * @tparam IntT - see fixed_point
+ * @tparam FractionalBits - see fixed_point
+ * @param p_value - value to compute the reciprocal of
+ * @return constexpr fixed_point<IntT, FractionalBits> - 1 / p_value saturated
+ * to the representable range. The reciprocal of 0 is max().
+ */
+template<std::signed_integral IntT, size_t FractionalBits>
+[[nodiscard]] constexpr fixed_point<IntT, FractionalBits> reciprocal(
+  fixed_point<IntT, FractionalBits> p_value) noexcept
+{
+  using fixed_t = fixed_point<IntT, FractionalBits>;
+
+  const std::int64_t raw = p_value.raw_value();
+  if (raw == 0) {
+    return fixed_t::max();
+  }
+
+  // Normalize the magnitude to x within [0.5, 1.0) as an unsigned Q0.32
+  const auto magnitude = static_cast<std::uint64_t>((raw < 0) ? -raw : raw);
+  const auto width = static_cast<int>(std::bit_width(magnitude));
+  const std::uint64_t x = magnitude << (32 - width);
+
+  // Initial estimate y = 48/17 - 32/17 * x in Q2.30, max error of 1/17
+  constexpr std::uint64_t c48_17 = 3031741620;
+  constexpr std::uint64_t c32_17 = 2021161080;
+  std::uint64_t y = c48_17 - ((c32_17 * x) >> 32);
+
+  // y = y * (2 - x * y), each iteration doubles the number of correct bits
+  constexpr std::uint64_t two = std::uint64_t{ 1 } << 31;
+  for (int i = 0; i < 3; i++) {
+    const std::uint64_t error = (x * y) >> 32;
+    y = (y * (two - error)) >> 30;
+  }
+
+  // y is 1 / x in Q2.30 and 1 / p_value = y * 2^(2F - width - 30)
+  const int shift = static_cast<int>(2 * FractionalBits) - width - 30;
+  std::uint64_t result = 0;
+  if (shift >= 0) {
+    result = y << shift;
+  } else {
+    result = (y + (std::uint64_t{ 1 } << (-shift - 1))) >> -shift;
+  }
+
+  const auto saturated = static_cast<std::int64_t>(std::min<std::uint64_t>(
+    result, static_cast<std::uint64_t>(std::numeric_limits<IntT>::max())));
+  return fixed_t::from_raw(
+    fixed_t::saturate((raw < 0) ? -saturated : saturated));
+}
+
+/**
+ * @brief Compute the square root of a fixed point number.
+ *
+ * Computed without division using the binary digit-by-digit method, rounded to
+ * the nearest representable value.
+ *
+ * @tparam IntT - see fixed_point
+ * @tparam FractionalBits - see fixed_point
+ * @param p_value - value to compute the square root of
+ * @return constexpr fixed_point<IntT, FractionalBits> - square root of
+ * p_value. Negative values return 0.
+ */
+template<std::signed_integral IntT, size_t FractionalBits>
+[[nodiscard]] constexpr fixed_point<IntT, FractionalBits> square_root(
+  fixed_point<IntT, FractionalBits> p_value) noexcept
+{
+  using fixed_t = fixed_point<IntT, FractionalBits>;
+  using unsigned_t = std::make_unsigned_t<typename fixed_t::overflow_t>;
+
+  if (p_value.raw_value() <= 0) {
+    return fixed_t{};
+  }
+
+  // sqrt(raw / 2^F) * 2^F = sqrt(raw * 2^F)
+  unsigned_t operand = static_cast<unsigned_t>(p_value.raw_value())
+                       << FractionalBits;
+  unsigned_t root = 0;
+  unsigned_t bit = unsigned_t{ 1 } << (sizeof(unsigned_t) * CHAR_BIT - 2);
+
+  while (bit > operand) {
+    bit >>= 2;
+  }
+
+  while (bit != 0) {
+    if (operand >= root + bit) {
+      operand -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  if (operand > root) {
+    root++;
+  }
+
+  return fixed_t::from_raw(fixed_t::saturate(
+    static_cast<typename fixed_t::overflow_t>(std::min<unsigned_t>(
+      root, static_cast<unsigned_t>(std::numeric_limits<IntT>::max())))));
+}
+
+/**
+ * @brief Element-wise saturating addition of two spans.
+ *
+ * Span kernels are written as simple loops without branches so that the
+ * compiler can vectorize them on targets with SIMD instructions. The fixed
+ * point type is not deduced so that arrays and vectors convert implicitly,
+ * for example: `add<q15>(a, b, output)`.
+ *
+ * @tparam Fixed - fixed point type
+ * @param p_lhs - left hand side values
+ * @param p_rhs - right hand side values
+ * @param p_output - destination of the sums, may alias p_lhs or p_rhs
+ * @return constexpr std::span<Fixed> - portion of p_output written, which is
+ * the size of the smallest of the three spans.
+ */
+template<typename Fixed>
+requires is_fixed_point_v<Fixed>
+constexpr std::span<Fixed> add(
+  std::type_identity_t<std::span<const Fixed>> p_lhs,
+  std::type_identity_t<std::span<const Fixed>> p_rhs,
+  std::type_identity_t<std::span<Fixed>> p_output) noexcept
+{
+  const size_t size =
+    std::min({ p_lhs.size(), p_rhs.size(), p_output.size() });
+  for (size_t i = 0; i < size; i++) {
+    p_output[i] = p_lhs[i] + p_rhs[i];
+  }
+  return p_output.first(size);
+}
+
+/**
+ * @brief Element-wise saturating multiplication of two spans.
+ *
+ * @tparam Fixed - fixed point type
+ * @param p_lhs - left hand side values
+ * @param p_rhs - right hand side values
+ * @param p_output - destination of the products, may alias p_lhs or p_rhs
+ * @return constexpr std::span<Fixed> - portion of p_output written, which is
+ * the size of the smallest of the three spans.
+ */
+template<typename Fixed>
+requires is_fixed_point_v<Fixed>
+constexpr std::span<Fixed> multiply(
+  std::type_identity_t<std::span<const Fixed>> p_lhs,
+  std::type_identity_t<std::span<const Fixed>> p_rhs,
+  std::type_identity_t<std::span<Fixed>> p_output) noexcept
+{
+  const size_t size =
+    std::min({ p_lhs.size(), p_rhs.size(), p_output.size() });
+  for (size_t i = 0; i < size; i++) {
+    p_output[i] = p_lhs[i] * p_rhs[i];
+  }
+  return p_output.first(size);
+}
+
+/**
+ * @brief Multiply every value of a span by a gain.
+ *
+ * @tparam Fixed - fixed point type
+ * @param p_input - values to scale
+ * @param p_gain - gain to multiply each value by
+ * @param p_output - destination of the scaled values, may alias p_input
+ * @return constexpr std::span<Fixed> - portion of p_output written, which is
+ * the size of the smallest of the two spans.
+ */
+template<typename Fixed>
+requires is_fixed_point_v<Fixed>
+constexpr std::span<Fixed> scale(
+  std::type_identity_t<std::span<const Fixed>> p_input,
+  std::type_identity_t<Fixed> p_gain,
+  std::type_identity_t<std::span<Fixed>> p_output) noexcept
+{
+  const size_t size = std::min(p_input.size(), p_output.size());
+  for (size_t i = 0; i < size; i++) {
+    p_output[i] = p_input[i] * p_gain;
+  }
+  return p_output.first(size);
+}
+
+/**
+ * @brief Compute the dot product of two spans.
+ *
+ * Products are summed in a 64-bit accumulator and saturated once at the end,
+ * like the multiply-accumulate instructions of a DSP. Products of 16-bit and
+ * smaller types are accumulated at full precision and rounded once, 32-bit
+ * products are rounded individually to keep headroom in the accumulator.
+ *
+ * @tparam Fixed - fixed point type
+ * @param p_lhs - left hand side values
+ * @param p_rhs - right hand side values
+ * @return constexpr Fixed - sum of the products of each pair of values within
+ * the size of the smallest span.
+ */
+template<typename Fixed>
+requires is_fixed_point_v<Fixed>
+[[nodiscard]] constexpr Fixed dot_product(
+  std::type_identity_t<std::span<const Fixed>> p_lhs,
+  std::type_identity_t<std::span<const Fixed>> p_rhs) noexcept
+{
+  const size_t size = std::min(p_lhs.size(), p_rhs.size());
+  std::int64_t accumulator = 0;
+  for (size_t i = 0; i < size; i++) {
+    const std::int64_t product =
+      std::int64_t{ p_lhs[i].raw_value() } * p_rhs[i].raw_value();
+    if constexpr (sizeof(typename Fixed::int_t) <= 2) {
+      accumulator += product;
+    } else {
+      // 32-bit products would leave no headroom in the accumulator
+      accumulator += Fixed::round_shift(product);
+    }
+  }
+  if constexpr (sizeof(typename Fixed::int_t) <= 2) {
+    accumulator = Fixed::round_shift(accumulator);
+  }
+  return Fixed::from_raw(Fixed::saturate(accumulator));
+}
+
+/**
+ * @brief Scale a units quantity by a fixed point value.
+ *
+ * @tparam Quantity - units quantity type
+ * @tparam IntT - see fixed_point
+ * @tparam FractionalBits - see fixed_point
+ * @param p_quantity - quantity to scale
+ * @param p_scale - value scalar
+ * @return constexpr Quantity - p_quantity * p_scale in the same units
+ */
+template<units::Quantity Quantity,
+         std::signed_integral IntT,
+         size_t FractionalBits>
+[[nodiscard]] constexpr Quantity scale(
+  const Quantity& p_quantity,
+  fixed_point<IntT, FractionalBits> p_scale) noexcept
+{
+  using rep = typename Quantity::rep;
+  if constexpr (std::integral<rep>) {
+    return Quantity(p_quantity.number() * p_scale);
+  } else {
+    return Quantity(p_quantity.number() * p_scale.template to<rep>());
+  }
+}
+}  // namespace embed
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
 #include <chrono>
+#include <initializer_list>
 #include <cinttypes>
 #include <limits>
 #include <ratio>
@@ -141,8 +143,6 @@ public:
     // std::chrono::nanoseconds::period::num == 1
     // std::chrono::nanoseconds::period::den == 1,000,000,000
 
-    using uint128_t = math::wide_integer::uint128_t;
-
     constexpr uint128_t numerator = decltype(p_duration)::period::num;
     constexpr uint128_t denominator = decltype(p_duration)::period::den;
     // Storing 64-bit value in a uint128_t for later computation, no truncation
@@ -225,8 +225,6 @@ public:
     //   |period| =  | ---------------------------|
     //                \ frequency_hz * ratio_num /
     //
-    using uint128_t = math::wide_integer::uint128_t;
-
     uint128_t numerator = BOOST_LEAF_CHECK(multiply_with_overflow_detection(
       uint128_t{ p_cycles }, uint128_t{ std::nano::den }));
 
@@ -338,6 +336,107 @@ private:
 /// Default clock rate for serial communication protocols
 constexpr frequency default_clock_rate = frequency(100'000);
 
+/// Limits of a two stage clock divider, a prescaler followed by a period
+/// counter, as found in timer and PWM peripherals
+struct divider_limits
+{
+  /// Largest prescaler division supported
+  std::uint32_t max_prescaler = 1;
+  /// Largest number of prescaled cycles in one period
+  std::uint32_t max_period = 65'536;
+  /// The prescaler only supports powers of two
+  bool power_of_two_prescaler = false;
+};
+
+/// Prescaler and period that divide an input clock down to a target frequency
+struct divider_pair
+{
+  /// Division of the prescaler, 0 if the target cannot be reached
+  std::uint32_t prescaler = 0;
+  /// Number of prescaled cycles in one period of the output
+  std::uint32_t period = 0;
+
+  /**
+   * @brief Default operators for <, <=, >, >= and ==
+   *
+   * @return auto - result of the comparison
+   */
+  [[nodiscard]] constexpr auto operator<=>(const divider_pair&) const noexcept =
+    default;
+};
+
+/**
+ * @brief Find the prescaler and period that come closest to dividing the
+ * input clock down to the target frequency
+ *
+ * The total divide is p_input.divide(p_target), which is then factored into a
+ * prescaler and period within the limits. Of the pairs with the smallest
+ * error, the one with the longest period, and so the finest duty cycle
+ * resolution, is chosen.
+ *
+ * Each candidate prescaler costs one division, starting from the smallest that
+ * can come close to the target and stopping at the first exact factorization.
+ * For a constant target this should be evaluated at compile time:
+ *
+ *     constexpr auto dividers = solve_divider(48_MHz, 2_kHz, limits);
+ *
+ * At run time, prefer power of two prescalers or a fixed prescaler when
+ * retuning frequently.
+ *
+ * @param p_input - frequency of the clock feeding the prescaler
+ * @param p_target - target output frequency
+ * @param p_limits - limits of the prescaler and period
+ * @return constexpr divider_pair - the closest pair, or a prescaler of 0 if
+ * the target is higher than the input or too low to reach within the limits.
+ */
+[[nodiscard]] constexpr divider_pair solve_divider(
+  frequency p_input,
+  frequency p_target,
+  const divider_limits& p_limits) noexcept
+{
+  const std::uint64_t divide = p_input.divide(p_target);
+  if (divide == 0 || p_limits.max_period == 0) {
+    return {};
+  }
+
+  const std::uint64_t max_period = p_limits.max_period;
+  // A prescaler one step below the smallest that can reach the divide may
+  // still come closer with the largest period
+  std::uint64_t prescaler = std::max<std::uint64_t>(divide / max_period, 1);
+  if (p_limits.power_of_two_prescaler) {
+    prescaler = std::bit_floor(prescaler);
+  }
+
+  divider_pair best{};
+  std::uint64_t best_error = std::numeric_limits<std::uint64_t>::max();
+  while (prescaler <= p_limits.max_prescaler) {
+    const std::uint64_t below = divide / prescaler;
+    if (below == 0) {
+      break;
+    }
+    // The periods either side of the divide, the longer first so that it
+    // wins a tie
+    for (const std::uint64_t period : { below + 1, below }) {
+      if (period > max_period) {
+        continue;
+      }
+      const std::uint64_t product = prescaler * period;
+      const std::uint64_t error =
+        product > divide ? product - divide : divide - product;
+      if (error < best_error) {
+        best_error = error;
+        best = { .prescaler = static_cast<std::uint32_t>(prescaler),
+                 .period = static_cast<std::uint32_t>(period) };
+      }
+    }
+    if (best_error == 0) {
+      break;
+    }
+    prescaler = p_limits.power_of_two_prescaler ? prescaler * 2 : prescaler + 1;
+  }
+  return best;
+}
+
 namespace literals {
 /**
  * @brief user defined literals for making frequencies: 1337_Hz
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "../error.hpp"
+#include "../frequency.hpp"
+
+namespace embed {
+/**
+ * @brief Input capture hardware abstraction for measuring the frequency,
+ * period and duty cycle of a digital signal, such as a PWM input or a
+ * tachometer.
+ *
+ * Measurements use reciprocal counting: the number of whole periods of the
+ * signal is counted over a gate time and divided by the exact time those
+ * periods took, as measured by a reference clock, rather than counting edges
+ * over a fixed time. The error of a measurement is at most one cycle of the
+ * reference clock over the whole gate, regardless of the signal frequency.
+ *
+ * Measurements are taken continuously in the background once configured.
+ */
+class input_capture
+{
+public:
+  /// Generic settings for input capture devices
+  struct settings
+  {
+    /// Minimum time over which periods are counted for each measurement. A
+    /// measurement completes on the first rising edge after the gate time has
+    /// elapsed, so it takes at least one period of the signal. Signals with a
+    /// period longer than the gate time are measured as 0Hz.
+    std::chrono::nanoseconds gate_time = std::chrono::milliseconds(100);
+    /// Capture falling edges as well as rising edges in order to measure the
+    /// duty cycle. Disabling this may halve the rate of captures, raising the
+    /// highest frequency that can be measured.
+    bool duty_cycle = true;
+
+    /**
+     * @brief Default operators for <, <=, >, >= and ==
+     *
+     * @return auto - result of the comparison
+     */
+    [[nodiscard]] constexpr auto operator<=>(const settings&) const noexcept =
+      default;
+  };
+
+  /// Result of a single gate
+  struct measurement
+  {
+    /// Average frequency of the signal over the gate, rounded to the nearest
+    /// Hz
+    embed::frequency frequency{ 0 };
+    /// Average period of the signal over the gate, 0 if no period completed
+    std::chrono::nanoseconds period{ 0 };
+    /// Total time the signal spent HIGH and LOW over the gate, in cycles of
+    /// the reference clock. Convert to embed::percent for the ratio. Both are 0
+    /// if duty cycle capture is disabled.
+    embed::duty_cycle duty_cycle{};
+    /// Number of whole periods (rising edge to rising edge) in the gate
+    std::uint32_t pulses = 0;
+  };
+
+  /**
+   * @brief Configure the input capture to match the settings supplied and
+   * start measuring
+   *
+   * Discards any previous measurement.
+   *
+   * @param p_settings - settings to apply to the input capture
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Will return `std::errc::invalid_argument` if the gate time
+   * cannot be measured by the reference clock.
+   */
+  [[nodiscard]] boost::leaf::result<void> configure(
+    const settings& p_settings) noexcept
+  {
+    return driver_configure(p_settings);
+  }
+
+  /**
+   * @brief Get the most recent measurement
+   *
+   * @return boost::leaf::result<measurement> - the last completed gate, or a
+   * 0Hz measurement if no rising edge has occurred for longer than the gate
+   * time. Returns `std::errc::resource_unavailable_try_again` if the first
+   * gate since configure() has not yet completed.
+   */
+  [[nodiscard]] boost::leaf::result<measurement> measure() noexcept
+  {
+    return driver_measure();
+  }
+
+private:
+  virtual boost::leaf::result<void> driver_configure(
+    const settings& p_settings) noexcept = 0;
+  virtual boost::leaf::result<measurement> driver_measure() noexcept = 0;
+};
+}  // namespace embed
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+#include "../counter/interface.hpp"
+#include "../error.hpp"
+#include "../interrupt_pin/interface.hpp"
+#include "../latest_value.hpp"
+#include "../math.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Input capture implemented by timestamping the edges of a signal on
+ * an interrupt pin with a counter.
+ *
+ * For devices without input capture hardware, or with too few channels. The
+ * counter is the reference clock, so a faster counter gives finer resolution.
+ *
+ * The interrupt handler reads the counter once per edge and only adds and
+ * compares counts; the division into frequency and period is done in
+ * measure(). The highest frequency that can be measured is set by the time
+ * the handler takes: with duty cycle capture there are two interrupts per
+ * period, otherwise one. Edges that arrive while the handler is still running
+ * for the previous edge are merged by the interrupt controller, which causes
+ * the signal to read low. With duty cycle capture enabled this is detected at
+ * the end of the gate by checking the pin level and the gate is discarded.
+ *
+ * The counter must not overflow more than once between two edges or during a
+ * gate, so the gate time may be at most half the counter's overflow period.
+ */
+class software_input_capture : public input_capture
+{
+public:
+  /**
+   * @brief Construct a new software input capture object
+   *
+   * @param p_pin - interrupt pin connected to the signal
+   * @param p_counter - counter used to timestamp each edge
+   */
+  software_input_capture(interrupt_pin& p_pin, counter& p_counter) noexcept
+    : m_pin(&p_pin)
+    , m_counter(&p_counter)
+  {}
+
+private:
+  struct gate
+  {
+    std::uint32_t pulses = 0;
+    std::uint32_t cycles = 0;
+    std::uint32_t high = 0;
+  };
+
+  boost::leaf::result<void> driver_configure(
+    const settings& p_settings) noexcept override
+  {
+    BOOST_LEAF_CHECK(m_pin->detach_interrupt());
+
+    const auto [clock, now] = BOOST_LEAF_CHECK(m_counter->uptime());
+    const auto gate_cycles =
+      BOOST_LEAF_CHECK(clock.cycles_per(p_settings.gate_time));
+    if (gate_cycles == 0 ||
+        gate_cycles > std::numeric_limits<std::int32_t>::max()) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    m_gate_cycles = static_cast<std::uint32_t>(gate_cycles);
+    m_duty_cycle = p_settings.duty_cycle;
+    m_level = BOOST_LEAF_CHECK(m_pin->level());
+    m_gate_open = false;
+    m_last_rising.store(now);
+    m_configured_version = m_latest.version();
+
+    auto handler = [this]() { capture(); };
+    return m_pin->attach_interrupt(handler,
+                                   m_duty_cycle
+                                     ? interrupt_pin::trigger_edge::both
+                                     : interrupt_pin::trigger_edge::rising);
+  }
+
+  boost::leaf::result<measurement> driver_measure() noexcept override
+  {
+    // Read before the counter so that a newer edge cannot appear to be in the
+    // future
+    const std::uint32_t last_rising = m_last_rising.load();
+    const auto [clock, now] = BOOST_LEAF_CHECK(m_counter->uptime());
+
+    if (static_cast<std::uint32_t>(now - last_rising) > m_gate_cycles) {
+      measurement stopped{};
+      if (m_duty_cycle) {
+        const bool level = BOOST_LEAF_CHECK(m_pin->level());
+        stopped.duty_cycle = { .high = level, .low = !level };
+      }
+      return stopped;
+    }
+
+    const auto [latest, version] = m_latest.read();
+    if (version == m_configured_version) {
+      return boost::leaf::new_error(std::errc::resource_unavailable_try_again);
+    }
+
+    const std::uint64_t clock_rate = clock.cycles_per_second();
+    const std::uint64_t pulses = latest.pulses;
+    const std::uint64_t cycles = latest.cycles;
+    measurement result{
+      .frequency = frequency(static_cast<std::uint32_t>(
+        rounding_division(pulses * clock_rate, cycles))),
+      .period = std::chrono::nanoseconds(static_cast<std::int64_t>(
+        rounding_division(cycles * 1'000'000'000, pulses * clock_rate))),
+      .pulses = latest.pulses,
+    };
+    if (m_duty_cycle) {
+      result.duty_cycle = { .high = latest.high,
+                            .low = latest.cycles - latest.high };
+    }
+    return result;
+  }
+
+  void capture() noexcept
+  {
+    auto uptime = m_counter->uptime();
+    if (!uptime) {
+      return;
+    }
+    const std::uint32_t now = uptime.value().count;
+    const std::uint32_t last_rising = m_last_rising.load();
+
+    if (m_duty_cycle) {
+      m_level = !m_level;
+      if (!m_level) {
+        m_high += now - last_rising;
+        return;
+      }
+    }
+
+    m_last_rising.store(now);
+    if (!m_gate_open) {
+      start_gate(now);
+      return;
+    }
+
+    m_pulses++;
+    if (now - m_gate_start < m_gate_cycles) {
+      return;
+    }
+
+    if (m_duty_cycle) {
+      // A missed edge inverts every edge after it, which is only visible by
+      // comparing against the pin. The gate is discarded and capture resumes
+      // from the next rising edge.
+      auto level = m_pin->level();
+      if (!level || !level.value()) {
+        m_level = false;
+        m_gate_open = false;
+        return;
+      }
+    }
+
+    m_latest.store({ .pulses = m_pulses,
+                     .cycles = now - m_gate_start,
+                     .high = m_high });
+
+    start_gate(now);
+  }
+
+  void start_gate(std::uint32_t p_now) noexcept
+  {
+    m_gate_open = true;
+    m_gate_start = p_now;
+    m_pulses = 0;
+    m_high = 0;
+  }
+
+  interrupt_pin* m_pin;
+  counter* m_counter;
+  std::uint32_t m_gate_cycles = 0;
+  bool m_duty_cycle = false;
+  latest_value<gate>::version_t m_configured_version = 0;
+  // State below is only modified by the interrupt handler once attached
+  bool m_level = false;
+  bool m_gate_open = false;
+  std::uint32_t m_gate_start = 0;
+  std::uint32_t m_pulses = 0;
+  std::uint32_t m_high = 0;
+  std::atomic<std::uint32_t> m_last_rising = 0;
+  latest_value<gate> m_latest{};
+};
+}  // namespace embed
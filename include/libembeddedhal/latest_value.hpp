@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace embed {
+/**
+ * @brief Latest value of a sensor or message, shared between a single writer
+ * and any number of readers without locks
+ *
+ * Useful for handing the most recent accelerometer sample, adc reading,
+ * encoder position or can message from an interrupt to a task, where only the
+ * newest value matters and a queue of older values is not wanted.
+ *
+ * Protected by a sequence lock: the writer makes the sequence odd, copies the
+ * value in and makes the sequence even again, so store() is wait-free and
+ * never delayed by readers. A reader copies the value out and retries if the
+ * sequence was odd or changed while it copied. When the writer is an
+ * interrupt, it always completes before the reader resumes, so a read retries
+ * at most once per interrupt.
+ *
+ * The version counts the number of stores, allowing readers to detect a new
+ * value without comparing values.
+ *
+ * Only one context may call store(). read() must not be called from a context
+ * that can preempt the writer, such as a higher priority interrupt, as it
+ * would never see the store complete.
+ *
+ * @tparam T - type of the value, must be trivially copyable
+ */
+template<typename T>
+class latest_value
+{
+public:
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable to be copied while written");
+
+  /// Number of stores, wrapping around on overflow
+  using version_t = std::uint32_t;
+
+  /// A value along with the version it was stored as
+  struct snapshot
+  {
+    /// The value
+    T value;
+    /// Version of the value, 0 if it has never been stored
+    version_t version;
+  };
+
+  /**
+   * @brief Construct with a value initialized T and a version of 0
+   *
+   */
+  latest_value() noexcept = default;
+
+  /**
+   * @brief Construct with an initial value and a version of 0
+   *
+   * @param p_value - initial value
+   */
+  explicit latest_value(const T& p_value) noexcept
+    : m_value(p_value)
+  {}
+
+  /**
+   * @brief Construct with a copy of another's value and a version of 0
+   *
+   * @param p_other - object to copy the value of
+   */
+  latest_value(const latest_value& p_other) noexcept
+    : m_value(p_other.load())
+  {}
+
+  /**
+   * @brief Store a copy of another's value, counting as a store
+   *
+   * @param p_other - object to copy the value of
+   * @return latest_value& - reference to this object
+   */
+  latest_value& operator=(const latest_value& p_other) noexcept
+  {
+    store(p_other.load());
+    return *this;
+  }
+
+  /**
+   * @brief Replace the value and increment the version
+   *
+   * Wait-free. Must only be called by the writer.
+   *
+   * @param p_value - new value
+   */
+  void store(const T& p_value) noexcept
+  {
+    const std::uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_value = p_value;
+    m_sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Get a consistent copy of the value along with its version
+   *
+   * @return snapshot - the value and version of the latest completed store
+   */
+  [[nodiscard]] snapshot read() const noexcept
+  {
+    while (true) {
+      const std::uint32_t start = m_sequence.load(std::memory_order_acquire);
+      const T value = m_value;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const std::uint32_t finish = m_sequence.load(std::memory_order_relaxed);
+
+      if (start == finish && (start & 1) == 0) {
+        return { .value = value, .version = start / 2 };
+      }
+    }
+  }
+
+  /**
+   * @brief Get a consistent copy of the value
+   *
+   * @return T - the value of the latest completed store
+   */
+  [[nodiscard]] T load() const noexcept { return read().value; }
+
+  /**
+   * @brief Get the version of the latest completed store
+   *
+   * @return version_t - number of completed stores
+   */
+  [[nodiscard]] version_t version() const noexcept
+  {
+    return m_sequence.load(std::memory_order_acquire) / 2;
+  }
+
+  /**
+   * @brief Determine if a store has completed since a version was read
+   *
+   * @param p_version - version previously returned by read() or version()
+   * @return true - a newer value is available
+   * @return false - the value is unchanged
+   */
+  [[nodiscard]] bool updated_since(version_t p_version) const noexcept
+  {
+    return version() != p_version;
+  }
+
+private:
+  T m_value{};
+  // Twice the version, plus one while a store is in progress
+  std::atomic<std::uint32_t> m_sequence = 0;
+};
+}  // namespace embed
@@ -1,20 +1,48 @@
 #pragma once
 
 #include <concepts>
+#include <limits>
 #include <optional>
+#include <type_traits>
 
 #include "error.hpp"
 
+// Use the compiler's native 128-bit integer when it has one, unless the
+// portable uintwide_t implementation is requested by defining
+// LIBEMBEDDEDHAL_WIDE_INTEGER_UINT128.
+#if defined(__SIZEOF_INT128__) && !defined(LIBEMBEDDEDHAL_WIDE_INTEGER_UINT128)
+namespace embed {
+/// Unsigned 128-bit integer used for intermediate results that exceed 64-bits
+__extension__ using uint128_t = unsigned __int128;
+/// True if embed::uint128_t is a builtin integer type
+inline constexpr bool native_uint128 = true;
+}  // namespace embed
+#else
 #define WIDE_INTEGER_DISABLE_IOSTREAM
 #include "internal/third_party/uintwide_t.h"
 #undef WIDE_INTEGER_DISABLE_IOSTREAM
 
+namespace embed {
+/// Unsigned 128-bit integer used for intermediate results that exceed 64-bits
+using uint128_t = math::wide_integer::uint128_t;
+/// True if embed::uint128_t is a builtin integer type
+inline constexpr bool native_uint128 = false;
+}  // namespace embed
+#endif
+
 namespace embed {
 /**
  * @brief Perform multiply operation and return an error code
  * `std::errc::result_out_of_range` if the two values when multiplied would
  * overflow the containing value.
  *
+ * Builtin integer types, including a native embed::uint128_t, use the
+ * compiler's overflow checking multiply which compiles down to a multiply
+ * followed by a check of the overflow flag or the upper half of a widening
+ * multiply. Wide integer types, such as math::wide_integer::uint128_t, skip the
+ * overflow check when both operands fit within half of the bit width, and only
+ * fall back to verifying the product with a division when they do not.
+ *
  * @tparam T - integer arithmetic type
  * @param p_lhs - left hand side integer
  * @param p_rhs - right hand side integer
@@ -22,20 +50,42 @@ namespace embed {
  * `std::errc::result_out_of_range`
  */
 template<typename T>
-[[nodiscard]] boost::leaf::result<T> multiply_with_overflow_detection(T p_lhs,
-                                                                      T p_rhs)
+[[nodiscard]] boost::leaf::result<T> multiply_with_overflow_detection(
+  T p_lhs,
+  T p_rhs) noexcept
 {
-  if (p_lhs == 0 || p_rhs == 0) {
-    return T{ 0 };
-  }
+  constexpr bool builtin_integer =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+    (native_uint128 && std::is_same_v<T, uint128_t>);
 
-  T result = p_lhs * p_rhs;
+  if constexpr (builtin_integer) {
+    T result{};
+    if (__builtin_mul_overflow(p_lhs, p_rhs, &result)) {
+      return boost::leaf::new_error(std::errc::result_out_of_range);
+    }
+    return result;
+  } else {
+    if (p_lhs == 0 || p_rhs == 0) {
+      return T{ 0 };
+    }
 
-  if (p_lhs != result / p_rhs) {
-    return boost::leaf::new_error(std::errc::result_out_of_range);
-  }
+    T result = p_lhs * p_rhs;
 
-  return result;
+    if constexpr (!std::numeric_limits<T>::is_signed) {
+      constexpr auto half_width = std::numeric_limits<T>::digits / 2;
+      // The product of two values that fit within half of the bit width can
+      // never overflow.
+      if ((p_lhs >> half_width) == 0 && (p_rhs >> half_width) == 0) {
+        return result;
+      }
+    }
+
+    if (p_lhs != result / p_rhs) {
+      return boost::leaf::new_error(std::errc::result_out_of_range);
+    }
+
+    return result;
+  }
 }
 
 /**
@@ -0,0 +1,318 @@
+/**
+ * @file mmio.hpp
+ * @brief Provide typed access to memory mapped registers for driver authors
+ */
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#include "bit.hpp"
+#include "bit_limits.hpp"
+
+namespace embed {
+/**
+ * @brief A contiguous range of bits within a register
+ *
+ * Fields are declared as types so that masks and shifts are compile time
+ * constants:
+ *
+ * ```
+ * struct control
+ * {
+ *   using enable = embed::bit_field<0>;
+ *   using mode = embed::bit_field<4, 2>;
+ * };
+ * ```
+ *
+ * @tparam Position - index of the lowest bit of the field
+ * @tparam Width - number of bits in the field
+ */
+template<size_t Position, size_t Width = 1>
+struct bit_field
+{
+  static_assert(Width > 0, "A bit field must contain at least one bit");
+
+  /// Index of the lowest bit of the field
+  static constexpr size_t position = Position;
+  /// Number of bits in the field
+  static constexpr size_t width = Width;
+
+  /**
+   * @brief Value to be written to this field
+   *
+   */
+  struct value_t
+  {
+    /// Value of the field, before being shifted into position
+    std::uint64_t value;
+  };
+
+  /**
+   * @brief Get the mask of this field within a register
+   *
+   * @tparam T - register type
+   * @return constexpr T - mask with 1s for each bit of the field
+   */
+  template<std::unsigned_integral T>
+  [[nodiscard]] static constexpr T mask() noexcept
+  {
+    static_assert(Position + Width <= sizeof(T) * 8,
+                  "The bit field does not fit within the register type");
+    return static_cast<T>(generate_field_of_ones<Width, T>() << Position);
+  }
+
+  /**
+   * @brief Pair a value with this field, for use with the register functions
+   * that accept multiple fields.
+   *
+   * Bits of p_value beyond the width of the field are discarded.
+   *
+   * @param p_value - value of the field
+   * @return constexpr value_t - field value
+   */
+  [[nodiscard]] static constexpr value_t value(std::uint64_t p_value) noexcept
+  {
+    return value_t{ p_value };
+  }
+};
+
+/// Satisfied by embed::bit_field types
+template<typename T>
+concept bit_field_type = requires
+{
+  T::position;
+  T::width;
+  typename T::value_t;
+};
+
+/**
+ * @brief Combined mask of multiple fields
+ *
+ * @tparam T - register type
+ * @tparam Fields - fields to combine
+ * @return constexpr T - mask with 1s for each bit of each field
+ */
+template<std::unsigned_integral T, bit_field_type... Fields>
+[[nodiscard]] constexpr T field_mask() noexcept
+{
+  return static_cast<T>((T{ 0 } | ... | Fields::template mask<T>()));
+}
+
+/**
+ * @brief Extract a field from a register value
+ *
+ * @tparam Field - field to extract
+ * @tparam T - register type
+ * @param p_register - register value
+ * @return constexpr T - value of the field shifted down to bit 0
+ */
+template<bit_field_type Field, std::unsigned_integral T>
+[[nodiscard]] constexpr T extract(T p_register) noexcept
+{
+  return bit_extract<Field::position, Field::width>(p_register);
+}
+
+/**
+ * @brief Insert the values of multiple fields into a register value
+ *
+ * Bits outside of the fields are preserved.
+ *
+ * @tparam T - register type
+ * @tparam Fields - fields to insert
+ * @param p_register - register value
+ * @param p_values - values of each field
+ * @return constexpr T - register value with the fields replaced
+ */
+template<std::unsigned_integral T, bit_field_type... Fields>
+[[nodiscard]] constexpr T insert(
+  T p_register,
+  typename Fields::value_t... p_values) noexcept
+{
+  const auto values = static_cast<T>(
+    (T{ 0 } | ... |
+     (static_cast<T>(p_values.value << Fields::position) &
+      Fields::template mask<T>())));
+  return static_cast<T>((p_register & ~field_mask<T, Fields...>()) | values);
+}
+
+/**
+ * @brief Offsets of alias registers that set or clear the bits of a register
+ * that are written as 1s
+ *
+ * Many microcontrollers provide such aliases so that bits can be set or
+ * cleared with a single store rather than a read-modify-write, which also
+ * makes the update atomic with respect to interrupts. An offset of zero means
+ * the alias does not exist.
+ */
+struct register_aliases
+{
+  /// Byte offset from the register of its set alias
+  std::ptrdiff_t set = 0;
+  /// Byte offset from the register of its clear alias
+  std::ptrdiff_t clear = 0;
+};
+
+/**
+ * @brief Volatile access to a memory mapped register
+ *
+ * Each function performs the minimum number of volatile accesses: write()
+ * a single store, modify() a single load and store, and set() and clear() a
+ * single store when the register has the matching alias. The masks and values
+ * of fields known at compile time are folded into constants.
+ *
+ * ```
+ * embed::mmio_register<std::uint32_t> control(0x4000'0000);
+ * // One load and one store, regardless of the number of fields
+ * control.modify<control::enable, control::mode>(1, 3);
+ * auto mode = control.get<control::mode>();
+ * ```
+ *
+ * The address may point at ordinary memory, which allows drivers to be tested
+ * on a host machine.
+ *
+ * @tparam T - register type
+ * @tparam Aliases - set and clear aliases of the register, if any
+ */
+template<std::unsigned_integral T,
+         register_aliases Aliases = register_aliases{}>
+class mmio_register
+{
+public:
+  /**
+   * @brief Construct a register from a pointer
+   *
+   * @param p_address - address of the register
+   */
+  explicit constexpr mmio_register(volatile T* p_address) noexcept
+    : m_address(p_address)
+  {}
+
+  /**
+   * @brief Construct a register from an address
+   *
+   * @param p_address - address of the register
+   */
+  explicit mmio_register(std::uintptr_t p_address) noexcept
+    : m_address(reinterpret_cast<volatile T*>(p_address))
+  {}
+
+  /**
+   * @brief Read the register
+   *
+   * @return T - value of the register
+   */
+  [[nodiscard]] T read() const noexcept { return *m_address; }
+
+  /**
+   * @brief Write the register
+   *
+   * @param p_value - value to write to the register
+   */
+  void write(T p_value) noexcept { *m_address = p_value; }
+
+  /**
+   * @brief Read a field of the register
+   *
+   * @tparam Field - field to read
+   * @return T - value of the field shifted down to bit 0
+   */
+  template<bit_field_type Field>
+  [[nodiscard]] T get() const noexcept
+  {
+    return extract<Field>(read());
+  }
+
+  /**
+   * @brief Write fields of the register, all other bits are written as 0
+   *
+   * Performs a single store without reading the register.
+   *
+   * @tparam Fields - fields to write
+   * @param p_values - value of each field
+   */
+  template<bit_field_type... Fields>
+  requires(sizeof...(Fields) > 0) void write(
+    std::integral auto... p_values) noexcept
+  {
+    static_assert(sizeof...(Fields) == sizeof...(p_values),
+                  "A value is required for each field");
+    write(insert<T, Fields...>(
+      T{ 0 },
+      typename Fields::value_t{ static_cast<std::uint64_t>(p_values) }...));
+  }
+
+  /**
+   * @brief Update fields of the register, leaving all other bits unchanged
+   *
+   * Performs a single read-modify-write for all of the fields.
+   *
+   * @tparam Fields - fields to update
+   * @param p_values - value of each field
+   */
+  template<bit_field_type... Fields>
+  void modify(std::integral auto... p_values) noexcept
+  {
+    static_assert(sizeof...(Fields) == sizeof...(p_values),
+                  "A value is required for each field");
+    write(insert<T, Fields...>(
+      read(),
+      typename Fields::value_t{ static_cast<std::uint64_t>(p_values) }...));
+  }
+
+  /**
+   * @brief Set every bit of the fields to 1
+   *
+   * Uses a single store to the set alias if the register has one, otherwise
+   * performs a read-modify-write.
+   *
+   * @tparam Fields - fields to set
+   */
+  template<bit_field_type... Fields>
+  void set() noexcept
+  {
+    constexpr T mask = field_mask<T, Fields...>();
+    if constexpr (Aliases.set != 0) {
+      *alias(Aliases.set) = mask;
+    } else {
+      write(static_cast<T>(read() | mask));
+    }
+  }
+
+  /**
+   * @brief Clear every bit of the fields to 0
+   *
+   * Uses a single store to the clear alias if the register has one, otherwise
+   * performs a read-modify-write.
+   *
+   * @tparam Fields - fields to clear
+   */
+  template<bit_field_type... Fields>
+  void clear() noexcept
+  {
+    constexpr T mask = field_mask<T, Fields...>();
+    if constexpr (Aliases.clear != 0) {
+      *alias(Aliases.clear) = mask;
+    } else {
+      write(static_cast<T>(read() & ~mask));
+    }
+  }
+
+  /**
+   * @brief Get the address of the register
+   *
+   * @return volatile T* - address of the register
+   */
+  [[nodiscard]] volatile T* address() const noexcept { return m_address; }
+
+private:
+  volatile T* alias(std::ptrdiff_t p_offset) const noexcept
+  {
+    auto* bytes = reinterpret_cast<volatile std::byte*>(m_address);
+    return reinterpret_cast<volatile T*>(bytes + p_offset);
+  }
+
+  volatile T* m_address;
+};
+}  // namespace embed
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "bit_limits.hpp"
 
 namespace embed {
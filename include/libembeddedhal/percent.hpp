@@ -1,16 +1,16 @@
 #pragma once
 
 #include <algorithm>
-#include <charconv>
+#include <array>
 #include <climits>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <span>
 #include <type_traits>
 
 #include "math.hpp"
-#include "to_array.hpp"
 
 namespace embed {
 /**
@@ -99,18 +99,29 @@ template<std::integral T, size_t SourceWidth, std::integral U>
  * class will preserve that 50% value proportional value but within a 32-bit
  * integer.
  *
+ * The width of the representation is selectable in order to reduce the memory
+ * used by large tables of percentages such as waveforms and sample logs. The
+ * 8-bit and 16-bit variants perform all of their arithmetic using 32-bit
+ * integers, which avoids 64-bit multiplication on 32-bit processors.
+ *
+ * @tparam IntT - signed integer type used to hold the percentage
  */
-class percent
+template<std::signed_integral IntT>
+class basic_percent
 {
 public:
+  static_assert(sizeof(IntT) <= sizeof(std::int32_t),
+                "basic_percent supports up to 32-bit representations.");
+
   /// The representation of the percentage will be contained within this type
-  using int_t = std::int32_t;
+  using int_t = IntT;
   /// The overflow type must be 2x the size of int_t in order to perform
   /// multiplication against two int_t value and not lose any data.
-  using overflow_t = std::int64_t;
+  using overflow_t =
+    std::conditional_t<(sizeof(int_t) <= 2), std::int32_t, std::int64_t>;
 
-  static_assert(sizeof(overflow_t) >= sizeof(int_t),
-                "Overflow integer type must be equal to or greater ");
+  static_assert(sizeof(overflow_t) >= 2 * sizeof(int_t),
+                "Overflow integer type must be at least 2x the size of int_t");
   /**
    * @brief Get the 100% value in its raw representation
    *
@@ -145,7 +156,7 @@ public:
    * @brief Construct 0% percent object
    *
    */
-  constexpr percent() noexcept
+  constexpr basic_percent() noexcept
     : m_value(0)
   {}
 
@@ -156,18 +167,35 @@ public:
    * clamped between 0.0 and 1.0. For signed numbers it is clamped between -1.0
    * to 1.0.
    */
-  constexpr percent(std::floating_point auto p_ratio) noexcept
+  constexpr basic_percent(std::floating_point auto p_ratio) noexcept
   {
     *this = p_ratio;
   }
 
+  /**
+   * @brief Construct a percent from a percent of a different width.
+   *
+   * Widening conversions scale the value up using bit replication, see
+   * upscale_integer(). Narrowing conversions drop the least significant bits
+   * and must be explicit as they lose resolution. Positive and negative values
+   * are scaled by their magnitude so that +100% and -100% remain symmetric.
+   *
+   * @tparam U - integer type of the other percent
+   * @param p_other - the percent to convert
+   */
+  template<std::signed_integral U>
+  explicit(sizeof(U) > sizeof(IntT)) constexpr basic_percent(
+    basic_percent<U> p_other) noexcept
+    : m_value(resize(p_other.raw_value()))
+  {}
+
   /**
    * @brief Default operators for <, <=, >, >= and ==
    *
    * @return auto - result of the comparison
    */
-  [[nodiscard]] constexpr auto operator<=>(const percent&) const noexcept =
-    default;
+  [[nodiscard]] constexpr auto operator<=>(
+    const basic_percent&) const noexcept = default;
 
   /**
    * @brief Assignment operator for a percent object based on a floating point
@@ -176,17 +204,17 @@ public:
    * @param p_ratio - floating point ratio value. For signed numbers this is
    * clamped between 0.0 and 1.0. For signed numbers it is clamped between -1.0
    * to 1.0.
-   * @return constexpr percent& - integer percent object based on the floating
-   * point percent value.
+   * @return constexpr basic_percent& - integer percent object based on the
+   * floating point percent value.
    */
-  constexpr percent& operator=(std::floating_point auto p_ratio) noexcept
+  constexpr basic_percent& operator=(std::floating_point auto p_ratio) noexcept
   {
     using float_t = decltype(p_ratio);
 
     constexpr float_t max = 1.0;
     constexpr float_t min = -1.0;
     p_ratio = std::clamp(p_ratio, min, max);
-    m_value = static_cast<int_t>(p_ratio * raw_max());
+    m_value = static_cast<int_t>(p_ratio * static_cast<float_t>(raw_max()));
 
     return *this;
   }
@@ -195,17 +223,30 @@ public:
    * @brief Convert a fixed width integer value into a percentage based on its
    * distance to the end of its bit width.
    *
+   * If the value does not fit within the magnitude bits of a narrower int_t,
+   * it is first converted to a 32-bit percent and then narrowed.
+   *
    * @tparam BitWidth - The bit width of the input value
    * @tparam T - integral type of input value
    * @param p_value - the value of the number
-   * @return constexpr percent - the percent type based on the input value's
-   * distance to the end of the bit width.
+   * @return constexpr basic_percent - the percent type based on the input
+   * value's distance to the end of the bit width.
    */
   template<size_t BitWidth, std::integral T>
-  [[nodiscard]] static constexpr percent convert(T p_value) noexcept
+  [[nodiscard]] static constexpr basic_percent convert(T p_value) noexcept
   {
-    const int_t up_scaled_value = upscale_integer<int_t, BitWidth, T>(p_value);
-    return percent(up_scaled_value);
+    constexpr size_t magnitude_width =
+      (std::is_signed_v<T>) ? BitWidth - 1 : BitWidth;
+    constexpr size_t width = sizeof(int_t) * CHAR_BIT;
+
+    if constexpr (width < 32 && magnitude_width > width - 1) {
+      return basic_percent(
+        basic_percent<std::int32_t>::template convert<BitWidth, T>(p_value));
+    } else {
+      const int_t up_scaled_value =
+        upscale_integer<int_t, BitWidth, T>(p_value);
+      return basic_percent(up_scaled_value);
+    }
   }
 
   /**
@@ -232,17 +273,21 @@ public:
    * @param p_maximum - the absolute maximum value of the ratio and the
    * indicator of 100% and -100% progress. Can consider this value as a
    * denominator of a ration number.
-   * @return constexpr percent
+   * @return constexpr basic_percent
    */
   template<std::integral T>
-  [[nodiscard]] static constexpr percent from_ratio(T p_progress,
-                                                    T p_maximum) noexcept
+  [[nodiscard]] static constexpr basic_percent from_ratio(T p_progress,
+                                                          T p_maximum) noexcept
   {
-    overflow_t result = p_progress;
-    result = (result * raw_max()) / absolute_value(p_maximum);
-    result = std::clamp(result, raw_min(), raw_max());
-
-    return percent(static_cast<int_t>(result));
+    using container_t = product_t<T>;
+    container_t result = p_progress;
+    result = (result * static_cast<container_t>(raw_max())) /
+             absolute_value(p_maximum);
+    result = std::clamp(result,
+                        static_cast<container_t>(raw_min()),
+                        static_cast<container_t>(raw_max()));
+
+    return basic_percent(static_cast<int_t>(result));
   }
 
   /**
@@ -293,6 +338,9 @@ public:
    * the following operation: `100 * percent_50_percent` is equivalent to `100 *
    * 0.5f`.
    *
+   * The arithmetic is performed using 32-bit integers whenever the product of
+   * p_value and the raw percent value fits within 32-bits.
+   *
    * @tparam T - type of the integral value to be scaled
    * @param p_value - value to be scaled
    * @param p_scale - value scalar
@@ -300,16 +348,18 @@ public:
    */
   template<std::integral T>
   [[nodiscard]] friend constexpr auto operator*(T p_value,
-                                                percent p_scale) noexcept
+                                                basic_percent p_scale) noexcept
   {
-    overflow_t arith_container = p_value;
+    using container_t = product_t<T>;
+    container_t arith_container = p_value;
     arith_container = arith_container * p_scale.raw_value();
-    arith_container = rounding_division(arith_container, raw_max());
+    arith_container = rounding_division(
+      arith_container, static_cast<container_t>(raw_max()));
     return static_cast<T>(arith_container);
   }
 
   /**
-   * @brief Same as `operator*(U p_value, percent p_scale)`
+   * @brief Same as `operator*(U p_value, basic_percent p_scale)`
    *
    * @tparam T - see other operator*
    * @param p_scale - see other operator*
@@ -317,96 +367,255 @@ public:
    * @return constexpr auto - see other operator*
    */
   template<std::integral T>
-  [[nodiscard]] friend constexpr auto operator*(percent p_scale,
+  [[nodiscard]] friend constexpr auto operator*(basic_percent p_scale,
                                                 T p_value) noexcept
   {
     return p_value * p_scale;
   }
 
+  /// Maximum number of decimal digits supported by to_chars(). Digits beyond
+  /// the resolution of int_t carry no information: ~4.66e-10 for 32-bits,
+  /// ~3.05e-5 for 16-bits and ~7.87e-3 for 8-bits.
+  static constexpr size_t max_precision = (sizeof(int_t) >= 4)   ? 9
+                                          : (sizeof(int_t) >= 2) ? 5
+                                                                 : 3;
+
   /**
-   * @brief convert this percentage value into a string from -1.0 to +1.0
+   * @brief Get the number of characters to_chars() will write for a given
+   * precision.
+   *
+   * @param p_precision - number of decimal digits
+   * @return constexpr size_t - number of characters written by to_chars()
+   */
+  [[nodiscard]] static constexpr size_t chars_length(
+    size_t p_precision = max_precision) noexcept
+  {
+    p_precision = std::min(p_precision, max_precision);
+    // sign + whole number + decimal point (only if there are decimal digits)
+    return 2 + ((p_precision > 0) ? p_precision + 1 : 0);
+  }
+
+  /**
+   * @brief Write this percentage as a decimal number from -1.0 to +1.0
+   * directly into a character buffer.
    *
-   * Strings are computed using integer arithmetic only.
+   * Characters are computed using integer arithmetic only, with a single
+   * division of overflow_t width and a lookup table that converts two digits
+   * at a time.
    *
-   * The format of the string will follow these rules:
+   * The format of the characters follows these rules:
    *   - Will always have a leading + or - sign
-   *   - Will always be 13 characters where the last character is the '\0'
    *   - Will start with either a '1' or a '0' character
+   *   - Will have exactly p_precision decimal digits, rounded to the nearest
+   *     digit. The decimal point is omitted when p_precision is 0.
+   *   - Will NOT be null terminated
    *
-   * Example string:
+   * Example output with a precision of 3:
    *
-   *   - +1.000000000
-   *   - +0.250000000
-   *   - +0.125000000
-   *   - -0.333333333
-   *   - -0.111111111
-   *   - -0.666666667
+   *   - +1.000
+   *   - +0.250
+   *   - -0.333
+   *   - -0.667
    *
-   * @return auto - string representation of the percent.
+   * @param p_buffer - buffer to write the characters into
+   * @param p_precision - number of decimal digits, clamped to max_precision
+   * @return constexpr std::span<char> - the characters written to p_buffer or
+   * an empty span if p_buffer is smaller than chars_length(p_precision).
    */
-  [[nodiscard]] auto to_string() const noexcept
+  constexpr std::span<char> to_chars(
+    std::span<char> p_buffer,
+    size_t p_precision = max_precision) const noexcept
   {
-    constexpr int_t fixed_percent_scalar = 1000000000;
-    // Based on the number of characters needed to hold "fixed_percent_scalar"
-    // as well as a '.' and a '-' sign
-    constexpr size_t scalar_length = 12;
-
-    if (raw_value() >= raw_max() - 2) {
-      return to_array<scalar_length>("+1.000000000");
-    } else if (raw_value() <= raw_min() + 2) {
-      return to_array<scalar_length>("-1.000000000");
+    using unsigned_t = std::make_unsigned_t<overflow_t>;
+
+    p_precision = std::min(p_precision, max_precision);
+    const size_t length = chars_length(p_precision);
+
+    if (p_buffer.size() < length) {
+      return p_buffer.first(0);
     }
 
-    // Make a copy of the percent value
-    percent absolute_percent = *this;
-    // Check and save if the number is negative
-    bool negative = absolute_percent.raw_value() < 0;
-    // If negative absolute, make the percent positive
-    if (negative) {
-      absolute_percent.m_value = absolute_percent.raw_value() * -1;
+    unsigned_t scalar = 1;
+    for (size_t i = 0; i < p_precision; i++) {
+      scalar *= 10;
     }
 
-    // +1 for a '\0' at the end
-    std::array<char, scalar_length + 1> buffer{ '\0' };
-    // +2 for a '.' and a '\0' character at the end
-    std::array<char, scalar_length + 1> percent_string{ '\0' };
+    const bool negative = m_value < 0;
+    const unsigned_t magnitude =
+      static_cast<unsigned_t>(absolute_value(overflow_t{ m_value }));
+    const unsigned_t product = magnitude * scalar;
+    const unsigned_t maximum = raw_max();
+    unsigned_t decimal = product / maximum;
+
+    // Round up if the remainder is greater than or equal to half of the
+    // maximum.
+    if (product - (decimal * maximum) >= maximum / 2) {
+      decimal++;
+    }
 
-    // Scale "fixed_percent_scalar" by the absolute_percent value
-    int_t decimal_percent = absolute_percent * fixed_percent_scalar;
+    // For 32-bit percentages, values within 2 of the maximum are treated as
+    // 100% in order to compensate for the bit replication error of
+    // upscale_integer().
+    constexpr overflow_t band = (sizeof(int_t) >= 4) ? 2 : 0;
+    const bool whole = decimal >= scalar || m_value >= raw_max() - band ||
+                       m_value <= raw_min() + band;
 
-    // Convert to characters
-    auto char_conversion_result =
-      std::to_chars(buffer.begin(), buffer.end(), decimal_percent);
+    if (whole) {
+      decimal = 0;
+    }
 
-    size_t string_length = char_conversion_result.ptr - buffer.data();
-    size_t leading_zeros = scalar_length - string_length;
+    p_buffer[0] = (negative) ? '-' : '+';
+    p_buffer[1] = (whole) ? '1' : '0';
 
-    // Add the leading +/- sign
-    percent_string[0] = (negative) ? '-' : '+';
+    if (p_precision == 0) {
+      return p_buffer.first(length);
+    }
 
-    // Add the '0' and '.'. We know that the value must be below 1.0 and above
-    // -1.0 because if the values were 1.0 or -1.0 then we would have returned
-    // them at the start of the function.
-    percent_string[1] = '0';
-    percent_string[2] = '.';
+    p_buffer[2] = '.';
+
+    // Write digits from right to left, two digits at a time
+    size_t position = length;
+    size_t remaining = p_precision;
+    while (remaining >= 2) {
+      const size_t pair = static_cast<size_t>(decimal % 100) * 2;
+      decimal /= 100;
+      p_buffer[--position] = digit_pairs[pair + 1];
+      p_buffer[--position] = digit_pairs[pair];
+      remaining -= 2;
+    }
 
-    // Add any leading zeros into the percent string array
-    for (size_t i = 3; i < leading_zeros; i++) {
-      percent_string[i] = '0';
+    if (remaining > 0) {
+      p_buffer[--position] = static_cast<char>('0' + (decimal % 10));
     }
-    // Now copy the contents of the character buffer into the percent string
-    // offset by the number of leading zeros.
-    std::copy_n(
-      buffer.begin(), string_length, percent_string.begin() + leading_zeros);
 
+    return p_buffer.first(length);
+  }
+
+  /**
+   * @brief convert this percentage value into a string from -1.0 to +1.0
+   *
+   * Strings are computed using integer arithmetic only, see to_chars().
+   *
+   * The format of the string will follow these rules:
+   *   - Will always have a leading + or - sign
+   *   - Will always have max_precision decimal digits followed by a '\0',
+   *     thus a 32-bit percent string is always 13 characters
+   *   - Will start with either a '1' or a '0' character
+   *
+   * Example string:
+   *
+   *   - +1.000000000
+   *   - +0.250000000
+   *   - +0.125000000
+   *   - -0.333333333
+   *   - -0.111111111
+   *   - -0.666666667
+   *
+   * @return auto - string representation of the percent.
+   */
+  [[nodiscard]] constexpr auto to_string() const noexcept
+  {
+    // +1 for a '\0' at the end
+    std::array<char, chars_length() + 1> percent_string{ '\0' };
+    to_chars(percent_string);
     return percent_string;
   }
 
 private:
-  constexpr percent(int_t p_value) noexcept
+  /// Integer type large enough to hold the product of a T and an int_t. Uses
+  /// 32-bit integers when possible to avoid 64-bit multiplication.
+  template<std::integral T>
+  using product_t =
+    std::conditional_t<(sizeof(T) + sizeof(int_t) <= sizeof(std::int32_t)),
+                       std::int32_t,
+                       std::int64_t>;
+
+  constexpr basic_percent(int_t p_value) noexcept
     : m_value(p_value)
   {}
 
+  template<std::signed_integral U>
+  [[nodiscard]] static constexpr int_t resize(U p_value) noexcept
+  {
+    constexpr size_t source_width = sizeof(U) * CHAR_BIT;
+    constexpr size_t width = sizeof(int_t) * CHAR_BIT;
+
+    // Clamp to -100% so the magnitude of the value is always representable
+    constexpr U minimum = std::numeric_limits<U>::min() + 1;
+    const bool negative = p_value < 0;
+    const U magnitude =
+      static_cast<U>(absolute_value(std::max(p_value, minimum)));
+
+    int_t result = 0;
+    if constexpr (width >= source_width) {
+      result = upscale_integer<int_t, source_width, U>(magnitude);
+    } else {
+      result = static_cast<int_t>(magnitude >> (source_width - width));
+    }
+
+    return (negative) ? static_cast<int_t>(-result) : result;
+  }
+
+  /// Lookup table of the characters for every number from "00" to "99"
+  static constexpr std::array<char, 200> digit_pairs = []() {
+    std::array<char, 200> table{};
+    for (size_t i = 0; i < 100; i++) {
+      table[i * 2] = static_cast<char>('0' + (i / 10));
+      table[i * 2 + 1] = static_cast<char>('0' + (i % 10));
+    }
+    return table;
+  }();
+
   int_t m_value = 0;
 };
+
+/// 32-bit percent, the default representation used throughout the library
+using percent = basic_percent<std::int32_t>;
+/// 16-bit percent, halves the storage of percent with a resolution of ~3e-5
+using percent16 = basic_percent<std::int16_t>;
+/// 8-bit percent, quarters the storage of percent with a resolution of ~8e-3
+using percent8 = basic_percent<std::int8_t>;
+
+/**
+ * @brief Write a sequence of percentages into a character buffer separated by
+ * a separator character.
+ *
+ * Each percentage is formatted with basic_percent::to_chars(). Formatting
+ * stops at the last percentage that fits completely within the buffer.
+ *
+ * IntT is not deduced so that arrays and vectors of percents convert
+ * implicitly. Specify it for percents narrower than 32-bits, for example:
+ * `to_chars<std::int16_t>(samples, buffer)`.
+ *
+ * @tparam IntT - integer type of the percents
+ * @param p_values - percentages to format
+ * @param p_buffer - buffer to write the characters into
+ * @param p_precision - number of decimal digits for each percentage
+ * @param p_separator - character placed between each percentage
+ * @return constexpr std::span<char> - the characters written to p_buffer
+ */
+template<std::signed_integral IntT = std::int32_t>
+constexpr std::span<char> to_chars(
+  std::type_identity_t<std::span<const basic_percent<IntT>>> p_values,
+  std::span<char> p_buffer,
+  size_t p_precision = basic_percent<IntT>::max_precision,
+  char p_separator = ',') noexcept
+{
+  const size_t length = basic_percent<IntT>::chars_length(p_precision);
+  size_t position = 0;
+
+  for (size_t i = 0; i < p_values.size(); i++) {
+    const size_t separator_length = (i > 0) ? 1 : 0;
+    if (p_buffer.size() - position < separator_length + length) {
+      break;
+    }
+    if (i > 0) {
+      p_buffer[position++] = p_separator;
+    }
+    position += p_values[i].to_chars(p_buffer.subspan(position), p_precision)
+                  .size();
+  }
+
+  return p_buffer.first(position);
+}
 }  // namespace embed
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <span>
+
+#include "error.hpp"
+#include "suspendable/interface.hpp"
+#include "time.hpp"
+
+namespace embed {
+/**
+ * @brief Suspend peripherals while they are idle and resume them ahead of
+ * scheduled activity
+ *
+ * The manager is given a set of domains, each a suspendable driver along with
+ * when it is needed:
+ *
+ *   - On demand: use() resumes the driver if needed and marks it as active.
+ *     Once it has not been used for its idle timeout, poll() suspends it.
+ *   - Scheduled: a driver with a period is resumed by poll() its wake lead
+ *     before each activity window starts and kept active until the window
+ *     ends, after which the idle timeout applies.
+ *
+ * Both can be combined, such as a sensor bus read every second that is also
+ * used on demand. poll() should be called from the main loop and
+ * next_due() gives the uptime by which poll() next needs to be called,
+ * allowing the processor to sleep in between.
+ *
+ * The time each domain spends active and suspended, and the number of
+ * transitions, are recorded in its statistics, which are current as of the
+ * last call to poll() or use().
+ *
+ * ```
+ * std::array domains{
+ *   embed::power_manager::domain{
+ *     .device = &spi_bus,
+ *     .idle_timeout = 5ms,
+ *   },
+ *   embed::power_manager::domain{
+ *     .device = &adc,
+ *     .period = 1s,
+ *     .window = 2ms,
+ *     .wake_lead = 100us,
+ *   },
+ * };
+ * embed::power_manager manager(domains, embed::to_uptime(uptime));
+ *
+ * while (true) {
+ *   BOOST_LEAF_CHECK(manager.poll());
+ *   // ...
+ *   BOOST_LEAF_CHECK(manager.use(0));
+ *   BOOST_LEAF_CHECK(embed::write(spi_bus, data));
+ * }
+ * ```
+ */
+class power_manager
+{
+public:
+  /// Time spent in each state and the number of transitions
+  struct statistics
+  {
+    /// Time spent active
+    std::chrono::nanoseconds active{ 0 };
+    /// Time spent suspended
+    std::chrono::nanoseconds suspended{ 0 };
+    /// Number of calls to suspend()
+    size_t suspends = 0;
+    /// Number of calls to resume()
+    size_t resumes = 0;
+  };
+
+  /// A suspendable driver and when it is needed
+  struct domain
+  {
+    /// Driver to suspend and resume, assumed to be active to begin with
+    suspendable* device = nullptr;
+    /// Time without activity after which the driver is suspended
+    std::chrono::nanoseconds idle_timeout{ 0 };
+    /// Period of scheduled activity windows, zero if there are none
+    std::chrono::nanoseconds period{ 0 };
+    /// Length of each activity window
+    std::chrono::nanoseconds window{ 0 };
+    /// Time to resume the driver ahead of a window, covering its wake up time
+    std::chrono::nanoseconds wake_lead{ 0 };
+    /// Uptime at which the next window starts, managed by the manager
+    std::chrono::nanoseconds next_window{ 0 };
+    /// Uptime of the last activity, managed by the manager
+    std::chrono::nanoseconds last_activity{ 0 };
+    /// Whether the driver is suspended, managed by the manager
+    bool suspended = false;
+    /// Time in each state, managed by the manager
+    statistics stats{};
+    /// Uptime to which stats has been accounted, managed by the manager
+    std::chrono::nanoseconds accounted{ 0 };
+  };
+
+  /**
+   * @brief Construct a new power manager
+   *
+   * @param p_domains - domains to manage, must outlive the manager
+   * @param p_uptime - uptime used to measure inactivity and schedule windows
+   */
+  power_manager(std::span<domain> p_domains,
+                std::function<uptime_function> p_uptime)
+    : m_domains(p_domains)
+    , m_uptime(p_uptime)
+  {}
+
+  /**
+   * @brief Resume a domain's driver if it is suspended and mark it as active
+   *
+   * Call before each use of the driver.
+   *
+   * @param p_domain - index of the domain
+   * @return boost::leaf::result<void> - any error from uptime or resuming the
+   * driver.
+   */
+  [[nodiscard]] boost::leaf::result<void> use(size_t p_domain) noexcept
+  {
+    const auto now = BOOST_LEAF_CHECK(current_uptime());
+    auto& domain = m_domains[p_domain];
+    account(domain, now);
+    if (domain.suspended) {
+      BOOST_LEAF_CHECK(resume(domain));
+    }
+    domain.last_activity = now;
+    return {};
+  }
+
+  /**
+   * @brief Suspend idle drivers and resume drivers with an upcoming window
+   *
+   * Windows missed because poll() was not called in time are skipped.
+   *
+   * @return boost::leaf::result<void> - any error from uptime or suspending
+   * or resuming a driver. Domains after the one that failed are handled by
+   * the next call.
+   */
+  [[nodiscard]] boost::leaf::result<void> poll() noexcept
+  {
+    const auto now = BOOST_LEAF_CHECK(current_uptime());
+    for (auto& domain : m_domains) {
+      account(domain, now);
+
+      bool scheduled = false;
+      if (domain.period > std::chrono::nanoseconds(0)) {
+        const auto window_end = domain.next_window + domain.window;
+        if (now >= window_end) {
+          // Skip every window that ended before now
+          const auto missed = (now - window_end) / domain.period + 1;
+          domain.next_window += missed * domain.period;
+        }
+        scheduled = now + domain.wake_lead >= domain.next_window;
+      }
+
+      if (scheduled) {
+        domain.last_activity = now;
+        if (domain.suspended) {
+          BOOST_LEAF_CHECK(resume(domain));
+        }
+      } else if (!domain.suspended &&
+                 now - domain.last_activity >= domain.idle_timeout) {
+        BOOST_LEAF_CHECK(domain.device->suspend());
+        domain.suspended = true;
+        domain.stats.suspends++;
+      }
+    }
+    return {};
+  }
+
+  /**
+   * @brief Get the uptime by which poll() next needs to be called
+   *
+   * @return std::chrono::nanoseconds - uptime of the next idle timeout or
+   * wake up, std::chrono::nanoseconds::max() if every driver is suspended and
+   * none have a schedule.
+   */
+  [[nodiscard]] std::chrono::nanoseconds next_due() const noexcept
+  {
+    auto deadline = std::chrono::nanoseconds::max();
+    for (const auto& domain : m_domains) {
+      const bool periodic = domain.period > std::chrono::nanoseconds(0);
+      if (domain.suspended) {
+        if (periodic) {
+          deadline = std::min(deadline, domain.next_window - domain.wake_lead);
+        }
+        continue;
+      }
+      auto idle = domain.last_activity + domain.idle_timeout;
+      if (periodic && domain.last_activity + domain.wake_lead >=
+                        domain.next_window) {
+        // Within a window, the idle timeout runs from its end
+        idle = domain.next_window + domain.window + domain.idle_timeout;
+      }
+      deadline = std::min(deadline, idle);
+    }
+    return deadline;
+  }
+
+private:
+  boost::leaf::result<std::chrono::nanoseconds> current_uptime() noexcept
+  {
+    const auto now = BOOST_LEAF_CHECK(m_uptime());
+    if (!m_started) {
+      // Time before the first call is not attributed to either state
+      for (auto& domain : m_domains) {
+        domain.accounted = now;
+        domain.last_activity = std::max(domain.last_activity, now);
+      }
+      m_started = true;
+    }
+    return now;
+  }
+
+  static void account(domain& p_domain, std::chrono::nanoseconds p_now) noexcept
+  {
+    auto& bucket =
+      p_domain.suspended ? p_domain.stats.suspended : p_domain.stats.active;
+    bucket += p_now - p_domain.accounted;
+    p_domain.accounted = p_now;
+  }
+
+  static boost::leaf::result<void> resume(domain& p_domain) noexcept
+  {
+    BOOST_LEAF_CHECK(p_domain.device->resume());
+    p_domain.suspended = false;
+    p_domain.stats.resumes++;
+    return {};
+  }
+
+  std::span<domain> m_domains;
+  std::function<uptime_function> m_uptime;
+  bool m_started = false;
+};
+}  // namespace embed
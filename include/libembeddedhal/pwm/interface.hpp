@@ -54,10 +54,42 @@ public:
     return driver_duty_cycle(p_duty_cycle);
   }
 
+  /**
+   * @brief Change the frequency of a running pwm
+   *
+   * Unlike configure(), which may stop the channel and restart its period, the
+   * new frequency takes effect at the end of the current period and the duty
+   * cycle percentage is kept. This allows buzzers, motor drives and other
+   * outputs to be retuned continuously without truncated or stretched pulses.
+   *
+   * Drivers that cannot do this return `std::errc::not_supported` and leave
+   * the channel untouched. Callers can then use configure() followed by
+   * duty_cycle(), accepting the restarted period.
+   *
+   * @param p_frequency - the new channel PWM frequency
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Will return embed::error::invalid_settings if the frequency
+   * could not be achieved and `std::errc::not_supported` if the driver cannot
+   * change the frequency of a running channel.
+   */
+  [[nodiscard]] boost::leaf::result<void> frequency(
+    embed::frequency p_frequency) noexcept
+  {
+    return driver_frequency(p_frequency);
+  }
+
 private:
   virtual boost::leaf::result<void> driver_configure(
     const settings& p_settings) noexcept = 0;
   virtual boost::leaf::result<void> driver_duty_cycle(
     percent p_duty_cycle) noexcept = 0;
+
+  // Drivers that can retune a running channel override the following, the
+  // default reports that they cannot.
+  virtual boost::leaf::result<void> driver_frequency(
+    [[maybe_unused]] embed::frequency p_frequency) noexcept
+  {
+    return boost::leaf::new_error(std::errc::not_supported);
+  }
 };
 }  // namespace embed
@@ -4,25 +4,29 @@
 namespace embed::mock {
 /**
  * @brief Mock pwm implementation for use in unit tests and simulations with spy
- * functions for configure() and duty_cycle().
+ * functions for configure(), duty_cycle() and frequency().
  *
  */
 struct pwm : public embed::pwm
 {
   /**
-   * @brief Reset spy information for both configure() and duty_cycle()
+   * @brief Reset spy information for configure(), duty_cycle() and
+   * frequency()
    *
    */
   void reset()
   {
     spy_configure.reset();
     spy_duty_cycle.reset();
+    spy_frequency.reset();
   }
 
   /// Spy handler for embed::pwm::configure()
   spy_handler<settings> spy_configure;
   /// Spy handler for embed::pwm::duty_cycle()
   spy_handler<percent> spy_duty_cycle;
+  /// Spy handler for embed::pwm::frequency()
+  spy_handler<embed::frequency> spy_frequency;
 
 private:
   boost::leaf::result<void> driver_configure(
@@ -35,5 +39,10 @@ private:
   {
     return spy_duty_cycle.record(p_duty_cycle);
   };
+  boost::leaf::result<void> driver_frequency(
+    embed::frequency p_frequency) noexcept override
+  {
+    return spy_frequency.record(p_frequency);
+  };
 };
 }  // namespace embed::mock
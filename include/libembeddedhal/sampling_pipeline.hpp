@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <span>
+
+#include "error.hpp"
+#include "frequency.hpp"
+#include "spsc_queue.hpp"
+#include "time.hpp"
+
+namespace embed {
+/**
+ * @brief A value paired with the time it was sampled
+ *
+ * @tparam T - type of the sampled value
+ */
+template<typename T>
+struct timestamped
+{
+  /// Uptime at which the value was sampled
+  std::chrono::nanoseconds timestamp{};
+  /// Sampled value
+  T value{};
+};
+
+/**
+ * @brief Sample sensors across multiple buses at individual rates
+ *
+ * The pipeline is given a schedule of tasks, each with the rate at which it
+ * should be sampled and the bus it is read over. Each call to poll() performs
+ * the reads that are due, grouped by bus. Before the first due read on a bus,
+ * that bus's begin handler is called and after the last, its end handler.
+ * These are the place to acquire a shared bus once for all of its reads, start
+ * a batched or DMA transfer, or power the bus. Compared to each driver
+ * acquiring the bus for its own transaction on every loop, the bus is acquired
+ * once per poll and only for sensors that are due.
+ *
+ * Each read is passed the uptime at which it was started, which is generally
+ * pushed, along with the value, into a lock-free queue for consumption by
+ * another context. See embed::sample_into().
+ *
+ * ```
+ * embed::spsc_queue<embed::timestamped<embed::percent>, 32> adc_samples;
+ * std::array schedule{
+ *   embed::sampling_pipeline::task{
+ *     .bus = 0,
+ *     .rate = embed::frequency(100),
+ *     .read = embed::sample_into(adc, adc_samples),
+ *   },
+ *   // ...
+ * };
+ * embed::sampling_pipeline pipeline(schedule, embed::to_uptime(uptime));
+ *
+ * while (true) {
+ *   BOOST_LEAF_CHECK(pipeline.poll());
+ * }
+ * ```
+ *
+ */
+class sampling_pipeline
+{
+public:
+  /// Perform a read of a sensor sampled at the passed uptime
+  using read_function = std::function<boost::leaf::result<void>(
+    std::chrono::nanoseconds p_timestamp)>;
+  /// Called before the first and after the last read on a bus within a poll
+  using bus_function = std::function<boost::leaf::result<void>()>;
+
+  /// A sensor to be sampled at a fixed rate
+  struct task
+  {
+    /// Index of the bus the sensor is read over
+    size_t bus = 0;
+    /// Rate at which to sample the sensor
+    embed::frequency rate = embed::frequency(1);
+    /// Function that reads the sensor
+    read_function read{};
+    /// Uptime at which the next read is due, managed by the pipeline
+    std::chrono::nanoseconds due{ 0 };
+    /// Number of successful reads
+    size_t reads = 0;
+    /// Number of reads that returned an error
+    size_t failures = 0;
+  };
+
+  /// Handlers called around the group of reads performed on a bus
+  struct bus_handlers
+  {
+    /// Called before the first due read on the bus
+    bus_function begin{};
+    /// Called after the last due read on the bus
+    bus_function end{};
+  };
+
+  /**
+   * @brief Construct a new sampling pipeline
+   *
+   * @param p_tasks - schedule of sensors to sample. The tasks are reordered by
+   * bus and must outlive the pipeline.
+   * @param p_uptime - uptime used to schedule and timestamp reads
+   * @param p_buses - handlers for each bus, indexed by task::bus. Buses
+   * without an entry have no handlers.
+   */
+  sampling_pipeline(std::span<task> p_tasks,
+                    std::function<uptime_function> p_uptime,
+                    std::span<bus_handlers> p_buses = {})
+    : m_tasks(p_tasks)
+    , m_uptime(p_uptime)
+    , m_buses(p_buses)
+  {
+    std::stable_sort(
+      m_tasks.begin(), m_tasks.end(), [](const task& p_lhs, const task& p_rhs) {
+        return p_lhs.bus < p_rhs.bus;
+      });
+  }
+
+  /**
+   * @brief Perform every read that is due
+   *
+   * A task whose read fails has its failures incremented and is retried at its
+   * next period, without affecting the other tasks. If a task falls behind by
+   * more than a period, missed reads are skipped rather than performed back to
+   * back.
+   *
+   * @return boost::leaf::result<size_t> - number of reads performed or an
+   * error from uptime or a bus handler. A bus whose begin handler succeeded
+   * always has its end handler called, even if a later step fails.
+   */
+  [[nodiscard]] boost::leaf::result<size_t> poll() noexcept
+  {
+    const auto now = BOOST_LEAF_CHECK(m_uptime());
+    size_t performed = 0;
+
+    for (auto group = m_tasks.begin(); group != m_tasks.end();) {
+      const size_t bus = group->bus;
+      const auto group_end =
+        std::find_if(group, m_tasks.end(), [bus](const task& p_task) {
+          return p_task.bus != bus;
+        });
+
+      const bool any_due =
+        std::any_of(group, group_end, [now](const task& p_task) {
+          return p_task.due <= now;
+        });
+
+      if (any_due) {
+        const bus_handlers* handlers =
+          (bus < m_buses.size()) ? &m_buses[bus] : nullptr;
+
+        if (handlers && handlers->begin) {
+          BOOST_LEAF_CHECK(handlers->begin());
+        }
+
+        // The bus is always ended once begun, so that it is not left
+        // acquired, and the first error is returned afterwards
+        auto status = service_due(group, group_end, now, performed);
+        auto ended = (handlers && handlers->end) ? handlers->end()
+                                                 : boost::leaf::result<void>{};
+        BOOST_LEAF_CHECK(status);
+        BOOST_LEAF_CHECK(ended);
+      }
+
+      group = group_end;
+    }
+
+    return performed;
+  }
+
+  /**
+   * @brief Get the uptime at which the next read is due
+   *
+   * Useful for sleeping until there is work for poll() to do.
+   *
+   * @return std::chrono::nanoseconds - earliest due time of all tasks
+   */
+  [[nodiscard]] std::chrono::nanoseconds next_due() const noexcept
+  {
+    auto earliest = std::chrono::nanoseconds::max();
+    for (const auto& current : m_tasks) {
+      earliest = std::min(earliest, current.due);
+    }
+    return earliest;
+  }
+
+private:
+  boost::leaf::result<void> service_due(std::span<task>::iterator p_begin,
+                                        std::span<task>::iterator p_end,
+                                        std::chrono::nanoseconds p_now,
+                                        size_t& p_performed) noexcept
+  {
+    for (auto current = p_begin; current != p_end; current++) {
+      if (current->due <= p_now) {
+        BOOST_LEAF_CHECK(service(*current, p_now));
+        p_performed++;
+      }
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> service(task& p_task,
+                                    std::chrono::nanoseconds p_now) noexcept
+  {
+    const auto period = BOOST_LEAF_CHECK(p_task.rate.duration_from_cycles(1));
+    // Reads on a bus are performed one after the other, so each is stamped
+    // with the uptime at which it started rather than the start of the poll,
+    // which would be late by the duration of every read before it.
+    const auto timestamp = BOOST_LEAF_CHECK(m_uptime());
+
+    if (p_task.read(timestamp)) {
+      p_task.reads++;
+    } else {
+      p_task.failures++;
+    }
+
+    p_task.due += period;
+    if (p_task.due <= p_now) {
+      p_task.due = p_now + period;
+    }
+
+    return {};
+  }
+
+  std::span<task> m_tasks;
+  std::function<uptime_function> m_uptime;
+  std::span<bus_handlers> m_buses;
+};
+
+/**
+ * @brief Create a read function that pushes timestamped samples from a sensor
+ * into a queue
+ *
+ * The sensor may be any type with a read() function returning a
+ * boost::leaf::result, such as embed::adc, embed::accelerometer or
+ * embed::temperature_sensor.
+ *
+ * @tparam Sensor - type of the sensor
+ * @tparam T - type of the sample stored in the queue
+ * @tparam Capacity - capacity of the queue
+ * @param p_sensor - sensor to read, must outlive the returned function
+ * @param p_queue - queue to push samples into, must outlive the returned
+ * function
+ * @return sampling_pipeline::read_function - read function that returns
+ * `std::errc::no_buffer_space` if the queue is full, otherwise the error from
+ * the sensor's read(), if any.
+ */
+template<typename Sensor, typename T, size_t Capacity>
+sampling_pipeline::read_function sample_into(
+  Sensor& p_sensor,
+  spsc_queue<timestamped<T>, Capacity>& p_queue)
+{
+  return [&p_sensor, &p_queue](
+           std::chrono::nanoseconds p_timestamp) -> boost::leaf::result<void> {
+    auto value = BOOST_LEAF_CHECK(p_sensor.read());
+    if (!p_queue.push({ .timestamp = p_timestamp, .value = value })) {
+      return boost::leaf::new_error(std::errc::no_buffer_space);
+    }
+    return {};
+  };
+}
+}  // namespace embed
@@ -0,0 +1,438 @@
+/**
+ * @file baud_rate.hpp
+ * @brief Provide baud rate detection and negotiation for the serial interface
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <span>
+
+#include "../counter/interface.hpp"
+#include "../error.hpp"
+#include "../interrupt_pin/interface.hpp"
+#include "../math.hpp"
+#include "../time.hpp"
+#include "interface.hpp"
+#include "util.hpp"
+
+namespace embed {
+/// Commonly supported baud rates ordered from lowest to highest
+inline constexpr std::array<std::uint32_t, 14> standard_baud_rates{
+  1200,   2400,   4800,   9600,    19200,   38400,   57600,
+  115200, 230400, 460800, 921600, 1000000, 2000000, 3000000,
+};
+
+/**
+ * @brief Find the standard baud rate closest to a measured baud rate.
+ *
+ * @param p_measured - the measured baud rate in bits per second
+ * @param p_tolerance - maximum allowed deviation from a standard baud rate
+ * before the measured value is returned unmodified.
+ * @return constexpr std::uint32_t - the nearest standard baud rate or
+ * p_measured if no standard rate is within the tolerance.
+ */
+[[nodiscard]] constexpr std::uint32_t nearest_standard_baud_rate(
+  std::uint32_t p_measured,
+  percent p_tolerance = percent::from_ratio(3, 100)) noexcept
+{
+  for (const auto standard : standard_baud_rates) {
+    const std::uint32_t allowed_error = standard * p_tolerance;
+    const std::uint32_t difference =
+      (p_measured > standard) ? p_measured - standard : standard - p_measured;
+    if (difference <= allowed_error) {
+      return standard;
+    }
+  }
+  return p_measured;
+}
+
+/**
+ * @brief Estimate the baud rate of a serial signal from the counter values
+ * captured on each of its edges.
+ *
+ * The shortest interval between two edges is used as an initial estimate of a
+ * single bit time. Every interval is then divided into a whole number of bit
+ * times and the total is averaged across all of the intervals, reducing the
+ * error introduced by the resolution of the counter and interrupt latency.
+ *
+ * For best results, the transmitter should send a byte with many single bit
+ * transitions like 0x55 ('U').
+ *
+ * @param p_frequency - operating frequency of the counter that captured edges
+ * @param p_edges - counter values captured on each edge of the signal. Counter
+ * overflow between two consecutive edges is handled correctly.
+ * @return std::uint32_t - the estimated baud rate in bits per second or 0 if
+ * there are less than 2 edges.
+ */
+[[nodiscard]] constexpr std::uint32_t estimate_baud_rate(
+  frequency p_frequency,
+  std::span<const std::uint32_t> p_edges) noexcept
+{
+  if (p_edges.size() < 2) {
+    return 0;
+  }
+
+  std::uint32_t shortest = std::numeric_limits<std::uint32_t>::max();
+  for (size_t i = 1; i < p_edges.size(); i++) {
+    const std::uint32_t interval = p_edges[i] - p_edges[i - 1];
+    if (interval != 0) {
+      shortest = std::min(shortest, interval);
+    }
+  }
+
+  std::uint64_t total_cycles = 0;
+  std::uint64_t total_bits = 0;
+  for (size_t i = 1; i < p_edges.size(); i++) {
+    const std::uint32_t interval = p_edges[i] - p_edges[i - 1];
+    total_cycles += interval;
+    total_bits += rounding_division(interval, shortest);
+  }
+
+  if (total_cycles == 0) {
+    return 0;
+  }
+
+  std::uint64_t cycles_per_second = p_frequency.cycles_per_second();
+  return static_cast<std::uint32_t>(
+    rounding_division(cycles_per_second * total_bits, total_cycles));
+}
+
+/**
+ * @brief Measure the baud rate of an incoming serial signal by timestamping
+ * the edges of the receive line.
+ *
+ * Connect an interrupt pin to the serial receive line and have the other end
+ * transmit a sync byte such as 0x55. The detector captures the counter value
+ * on every edge until its capture buffer is full, at which point the baud rate
+ * can be computed.
+ *
+ * The interrupt handler does no arithmetic, only a counter read and store, in
+ * order to keep the latency between edges as small and consistent as possible.
+ *
+ * @tparam EdgeCount - number of edges to capture. 0x55 with one start bit and
+ * one stop bit produces 10 edges.
+ */
+template<size_t EdgeCount = 10>
+class baud_rate_detector
+{
+public:
+  static_assert(EdgeCount >= 2, "At least 2 edges are required.");
+
+  /**
+   * @brief Construct a new baud rate detector object
+   *
+   * @param p_receive_pin - interrupt pin connected to the receive line
+   * @param p_counter - counter used to timestamp each edge
+   */
+  baud_rate_detector(interrupt_pin& p_receive_pin, counter& p_counter) noexcept
+    : m_receive_pin(&p_receive_pin)
+    , m_counter(&p_counter)
+  {}
+
+  /**
+   * @brief Reset captured edges and start capturing edges on the receive line
+   *
+   * @return boost::leaf::result<void> - any error that occurred when attaching
+   * the interrupt.
+   */
+  [[nodiscard]] boost::leaf::result<void> start() noexcept
+  {
+    m_captured = 0;
+    auto handler = [this]() { capture(); };
+    return m_receive_pin->attach_interrupt(handler,
+                                           interrupt_pin::trigger_edge::both);
+  }
+
+  /**
+   * @brief Determine if all edges have been captured
+   *
+   * @return true - all edges have been captured
+   * @return false - still waiting on edges
+   */
+  [[nodiscard]] bool done() const noexcept { return m_captured >= EdgeCount; }
+
+  /**
+   * @brief Stop capturing edges on the receive line
+   *
+   * @return boost::leaf::result<void> - any error that occurred when detaching
+   * the interrupt.
+   */
+  [[nodiscard]] boost::leaf::result<void> stop() noexcept
+  {
+    return m_receive_pin->detach_interrupt();
+  }
+
+  /**
+   * @brief Compute the baud rate from the captured edges
+   *
+   * @return boost::leaf::result<std::uint32_t> - the measured baud rate
+   * snapped to the nearest standard baud rate, if one is close enough. Returns
+   * `std::errc::resource_unavailable_try_again` if not all edges have been
+   * captured or the error returned by the counter if a counter read failed.
+   */
+  [[nodiscard]] boost::leaf::result<std::uint32_t> baud_rate() noexcept
+  {
+    if (!done()) {
+      return boost::leaf::new_error(
+        std::errc::resource_unavailable_try_again);
+    }
+    const auto uptime = BOOST_LEAF_CHECK(m_counter->uptime());
+    const auto measured = estimate_baud_rate(uptime.frequency, m_edges);
+    return nearest_standard_baud_rate(measured);
+  }
+
+  /**
+   * @brief Get the edges captured so far
+   *
+   * @return std::span<const std::uint32_t> - counter values for each edge
+   */
+  [[nodiscard]] std::span<const std::uint32_t> edges() const noexcept
+  {
+    return std::span<const std::uint32_t>(m_edges.data(), m_captured.load());
+  }
+
+private:
+  void capture() noexcept
+  {
+    const size_t index = m_captured.load();
+    if (index >= EdgeCount) {
+      return;
+    }
+    auto uptime = m_counter->uptime();
+    if (uptime) {
+      m_edges[index] = uptime.value().count;
+      m_captured.store(index + 1);
+    }
+  }
+
+  interrupt_pin* m_receive_pin;
+  counter* m_counter;
+  std::array<std::uint32_t, EdgeCount> m_edges{};
+  std::atomic<size_t> m_captured = 0;
+};
+
+/**
+ * @brief Block until a sync byte has been received and return the serial
+ * settings with the detected baud rate applied.
+ *
+ * NOTE: If no signal arrives on the receive line this will loop forever.
+ *
+ * @tparam EdgeCount - see baud_rate_detector
+ * @param p_receive_pin - interrupt pin connected to the receive line
+ * @param p_counter - counter used to timestamp each edge
+ * @param p_settings - settings to copy into the result with the detected baud
+ * rate
+ * @return boost::leaf::result<serial::settings> - settings with the detected
+ * baud rate or an error from the interrupt pin or counter.
+ */
+template<size_t EdgeCount = 10>
+[[nodiscard]] boost::leaf::result<serial::settings> detect_baud_rate(
+  interrupt_pin& p_receive_pin,
+  counter& p_counter,
+  serial::settings p_settings = {}) noexcept
+{
+  baud_rate_detector<EdgeCount> detector(p_receive_pin, p_counter);
+  BOOST_LEAF_CHECK(detector.start());
+  while (!detector.done()) {
+    continue;
+  }
+  BOOST_LEAF_CHECK(detector.stop());
+  p_settings.baud_rate = BOOST_LEAF_CHECK(detector.baud_rate());
+  return p_settings;
+}
+
+/// Start byte of the frame used to propose and acknowledge baud rates between
+/// two serial ports. The start byte is followed by the 32-bit baud rate in
+/// little endian order. A baud rate of 0 rejects a proposal.
+inline constexpr std::byte baud_rate_frame_start{ 0xB5 };
+/// Length of the frame used to propose and acknowledge baud rates
+inline constexpr size_t baud_rate_frame_size = 5;
+
+/**
+ * @brief Propose each baud rate to the other end of the serial port until one
+ * is accepted and confirmed, then leave the port at that baud rate.
+ *
+ * The other end of the port must respond using accept_baud_rate(). Baud rates
+ * are proposed in the order given, so list them from highest to lowest to end
+ * up at the highest common rate. Proposals stop at the current baud rate, or
+ * the end of the list, and negotiation always ends with a proposal to stay at
+ * the current baud rate, which the other end accepts, so that both ends know
+ * negotiation is over.
+ *
+ * Once a proposal is accepted, both ends switch to the new baud rate and the
+ * proposal is sent again as a confirmation, which the other end echoes. If the
+ * echo does not arrive within the timeout, the link does not work at that
+ * rate: both ends return to the current baud rate and the next proposal is
+ * sent after waiting half of the timeout, giving the other end time to fall
+ * back first.
+ *
+ * NOTE: If the echo of a confirmation is lost after the other end has received
+ * the confirmation, the other end stays at the new baud rate and the next
+ * proposal fails with `std::errc::timed_out`.
+ *
+ * @param p_serial - serial port to negotiate with
+ * @param p_settings - the settings the port is currently configured with
+ * @param p_baud_rates - baud rates to propose in order of preference
+ * @param p_uptime - uptime used to measure timeouts
+ * @param p_timeout - maximum amount of time to wait for each response
+ * @return boost::leaf::result<serial::settings> - the settings now in use by
+ * the port. If no baud rate was accepted, this is equal to p_settings. Returns
+ * `std::errc::io_error` if the final proposal is not acknowledged and
+ * `std::errc::timed_out` if the other end stops responding at the current
+ * baud rate.
+ */
+[[nodiscard]] inline boost::leaf::result<serial::settings> negotiate_baud_rate(
+  serial& p_serial,
+  serial::settings p_settings,
+  std::span<const std::uint32_t> p_baud_rates,
+  std::function<uptime_function> p_uptime,
+  std::chrono::nanoseconds p_timeout) noexcept
+{
+  using frame_t = std::array<std::byte, baud_rate_frame_size>;
+
+  auto exchange = [&](const frame_t& p_frame) -> boost::leaf::result<bool> {
+    BOOST_LEAF_CHECK(write(p_serial, p_frame));
+    auto response = BOOST_LEAF_CHECK(
+      read<baud_rate_frame_size>(p_serial, p_uptime, p_timeout));
+    return response == p_frame;
+  };
+
+  auto confirm = [&](const frame_t& p_frame) -> boost::leaf::result<bool> {
+    return boost::leaf::try_handle_some(
+      [&]() { return exchange(p_frame); },
+      [](boost::leaf::match<std::errc, std::errc::timed_out>)
+        -> boost::leaf::result<bool> { return false; });
+  };
+
+  for (const auto baud_rate : p_baud_rates) {
+    if (baud_rate == p_settings.baud_rate) {
+      break;
+    }
+
+    const frame_t proposal{
+      baud_rate_frame_start,
+      static_cast<std::byte>(baud_rate >> 0),
+      static_cast<std::byte>(baud_rate >> 8),
+      static_cast<std::byte>(baud_rate >> 16),
+      static_cast<std::byte>(baud_rate >> 24),
+    };
+    if (!BOOST_LEAF_CHECK(exchange(proposal))) {
+      continue;
+    }
+
+    auto proposed = p_settings;
+    proposed.baud_rate = baud_rate;
+    BOOST_LEAF_CHECK(p_serial.configure(proposed));
+    if (BOOST_LEAF_CHECK(confirm(proposal))) {
+      return proposed;
+    }
+
+    BOOST_LEAF_CHECK(p_serial.configure(p_settings));
+    BOOST_LEAF_CHECK(p_serial.flush());
+    const auto resume = BOOST_LEAF_CHECK(p_uptime()) + p_timeout / 2;
+    while (BOOST_LEAF_CHECK(p_uptime()) < resume) {
+      continue;
+    }
+  }
+
+  const auto current = p_settings.baud_rate;
+  const frame_t final_proposal{
+    baud_rate_frame_start,
+    static_cast<std::byte>(current >> 0),
+    static_cast<std::byte>(current >> 8),
+    static_cast<std::byte>(current >> 16),
+    static_cast<std::byte>(current >> 24),
+  };
+  if (!BOOST_LEAF_CHECK(exchange(final_proposal))) {
+    return boost::leaf::new_error(std::errc::io_error);
+  }
+  return p_settings;
+}
+
+/**
+ * @brief Respond to the baud rate proposals of negotiate_baud_rate() until
+ * one is accepted and confirmed, and leave the port at that baud rate.
+ *
+ * Proposals that are not supported are rejected. A proposal of the current
+ * baud rate is always accepted, as it ends a negotiation in which nothing
+ * else was accepted.
+ *
+ * After accepting a new baud rate, the port switches to it and waits for the
+ * confirmation from the other end, which it echoes. If no valid confirmation
+ * arrives within the timeout, the port returns to the current baud rate and
+ * waits for the next proposal.
+ *
+ * @param p_serial - serial port to negotiate with
+ * @param p_settings - the settings the port is currently configured with
+ * @param p_baud_rates - baud rates supported by this end of the port
+ * @param p_uptime - uptime used to measure timeouts
+ * @param p_timeout - maximum amount of time to wait for each proposal and
+ * confirmation
+ * @return boost::leaf::result<serial::settings> - the settings now in use by
+ * the port. If the current baud rate was accepted, this is equal to
+ * p_settings. Returns `std::errc::timed_out` if no proposal arrives in time.
+ */
+[[nodiscard]] inline boost::leaf::result<serial::settings> accept_baud_rate(
+  serial& p_serial,
+  serial::settings p_settings,
+  std::span<const std::uint32_t> p_baud_rates,
+  std::function<uptime_function> p_uptime,
+  std::chrono::nanoseconds p_timeout) noexcept
+{
+  while (true) {
+    auto proposal = BOOST_LEAF_CHECK(
+      read<baud_rate_frame_size>(p_serial, p_uptime, p_timeout));
+
+    std::uint32_t baud_rate = 0;
+    for (size_t i = 1; i < proposal.size(); i++) {
+      baud_rate |= std::to_integer<std::uint32_t>(proposal[i])
+                   << ((i - 1) * 8);
+    }
+
+    const bool valid = proposal[0] == baud_rate_frame_start;
+    const bool current = baud_rate == p_settings.baud_rate;
+    const bool supported =
+      std::find(p_baud_rates.begin(), p_baud_rates.end(), baud_rate) !=
+      p_baud_rates.end();
+
+    if (!valid || (!current && !supported)) {
+      constexpr std::array<std::byte, baud_rate_frame_size> reject{
+        baud_rate_frame_start
+      };
+      BOOST_LEAF_CHECK(write(p_serial, reject));
+      continue;
+    }
+
+    BOOST_LEAF_CHECK(write(p_serial, proposal));
+    if (current) {
+      return p_settings;
+    }
+
+    auto accepted = p_settings;
+    accepted.baud_rate = baud_rate;
+    BOOST_LEAF_CHECK(p_serial.configure(accepted));
+    const bool confirmed = BOOST_LEAF_CHECK(boost::leaf::try_handle_some(
+      [&]() -> boost::leaf::result<bool> {
+        auto confirmation = BOOST_LEAF_CHECK(
+          read<baud_rate_frame_size>(p_serial, p_uptime, p_timeout));
+        return confirmation == proposal;
+      },
+      [](boost::leaf::match<std::errc, std::errc::timed_out>)
+        -> boost::leaf::result<bool> { return false; }));
+
+    if (confirmed) {
+      BOOST_LEAF_CHECK(write(p_serial, proposal));
+      return accepted;
+    }
+
+    BOOST_LEAF_CHECK(p_serial.configure(p_settings));
+    BOOST_LEAF_CHECK(p_serial.flush());
+  }
+}
+}  // namespace embed
@@ -37,6 +37,34 @@ namespace embed {
   return {};
 }
 
+/**
+ * @brief Delay execution until the serial buffer has reached a specific number
+ * of buffered bytes or the timeout has elapsed.
+ *
+ * @param p_serial - serial port to wait for
+ * @param p_length - the number of bytes that need to be buffered before this
+ * function returns.
+ * @param p_uptime - uptime used to measure the timeout
+ * @param p_timeout - maximum amount of time to wait for the bytes
+ * @return boost::leaf::result<void> - return an error if a call to
+ * serial::bytes_available or p_uptime returns an error, or
+ * `std::errc::timed_out` if the bytes did not arrive in time.
+ */
+[[nodiscard]] inline boost::leaf::result<void> delay(
+  serial& p_serial,
+  size_t p_length,
+  const std::function<uptime_function>& p_uptime,
+  std::chrono::nanoseconds p_timeout) noexcept
+{
+  const auto deadline = BOOST_LEAF_CHECK(p_uptime()) + p_timeout;
+  while (BOOST_LEAF_CHECK(p_serial.bytes_available()) < p_length) {
+    if (BOOST_LEAF_CHECK(p_uptime()) >= deadline) {
+      return boost::leaf::new_error(std::errc::timed_out);
+    }
+  }
+  return {};
+}
+
 /**
  * @brief Write bytes to a serial port
  *
@@ -93,6 +121,30 @@ template<size_t BytesToRead>
   return buffer;
 }
 
+/**
+ * @brief Read bytes from a serial port and return an array, giving up if the
+ * bytes do not arrive in time.
+ *
+ * @tparam BytesToRead - the number of bytes to be read from the serial port.
+ * @param p_serial - the serial port to be read from
+ * @param p_uptime - uptime used to measure the timeout
+ * @param p_timeout - maximum amount of time to wait for the bytes
+ * @return boost::leaf::result<std::array<std::byte, BytesToRead>> - return an
+ * error if a call to serial::read or delay() returns an error, including
+ * `std::errc::timed_out`, or an array of read bytes.
+ */
+template<size_t BytesToRead>
+[[nodiscard]] boost::leaf::result<std::array<std::byte, BytesToRead>> read(
+  serial& p_serial,
+  const std::function<uptime_function>& p_uptime,
+  std::chrono::nanoseconds p_timeout) noexcept
+{
+  std::array<std::byte, BytesToRead> buffer;
+  BOOST_LEAF_CHECK(delay(p_serial, BytesToRead, p_uptime, p_timeout));
+  BOOST_LEAF_CHECK(p_serial.read(buffer));
+  return buffer;
+}
+
 /**
  * @brief Perform a write then read transaction over serial.
  *
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <span>
@@ -35,6 +36,75 @@ public:
       default;
   };
 
+  /// Number of data lines used to transfer a phase of a command transfer
+  enum class lanes : std::uint8_t
+  {
+    /// Standard SPI, data out on MOSI and data in on MISO
+    single = 1,
+    /// Two bidirectional data lines
+    dual = 2,
+    /// Four bidirectional data lines, also known as QSPI
+    quad = 4,
+    /// Eight bidirectional data lines
+    octal = 8,
+  };
+
+  /**
+   * @brief Description of a command transfer as used by serial memories and
+   * displays: a command, an address and dummy cycles followed by the data.
+   *
+   * Each phase can use a different number of lanes, for example the fast read
+   * quad output command of a serial flash is written as 1-1-4: a single lane
+   * command and address then quad lane data.
+   *
+   * Phases with a size of zero are skipped.
+   */
+  struct command_phases
+  {
+    /// Command, or instruction, sent first. Two byte commands, used by octal
+    /// devices, are sent most significant byte first.
+    std::uint16_t command = 0;
+    /// Number of command bytes, 0 to 2
+    std::uint8_t command_bytes = 1;
+    /// Lanes used to send the command
+    lanes command_lanes = lanes::single;
+    /// Address sent after the command, most significant byte first
+    std::uint32_t address = 0;
+    /// Number of address bytes, 0 to 4
+    std::uint8_t address_bytes = 0;
+    /// Lanes used to send the address
+    lanes address_lanes = lanes::single;
+    /// Number of clock cycles between the address and the data
+    std::uint8_t dummy_cycles = 0;
+    /// Lanes used to transfer the data
+    lanes data_lanes = lanes::single;
+
+    /**
+     * @brief Default operators for <, <=, >, >= and ==
+     *
+     * @return auto - result of the comparison
+     */
+    [[nodiscard]] constexpr auto operator<=>(const command_phases&) const
+      noexcept = default;
+  };
+
+  /// Features of the spi hardware beyond standard SPI
+  struct capabilities_t
+  {
+    /// Largest number of lanes usable in a command transfer
+    lanes max_lanes = lanes::single;
+    /// Whether memory_map() is supported
+    bool memory_mapped = false;
+
+    /**
+     * @brief Default operators for <, <=, >, >= and ==
+     *
+     * @return auto - result of the comparison
+     */
+    [[nodiscard]] constexpr auto operator<=>(const capabilities_t&) const
+      noexcept = default;
+  };
+
   /// Default filler data placed on the bus in place of actual write data when
   /// the write buffer has been exhausted.
   static constexpr std::byte default_filler = std::byte{ 0xFF };
@@ -78,6 +148,68 @@ public:
     return driver_transfer(p_data_out, p_data_in, p_filler);
   }
 
+  /**
+   * @brief Get the features of the spi hardware beyond standard SPI
+   *
+   * @return capabilities_t - supported features. Drivers without multi-lane
+   * support report a single lane and no memory mapping.
+   */
+  [[nodiscard]] capabilities_t capabilities() noexcept
+  {
+    return driver_capabilities();
+  }
+
+  /**
+   * @brief Perform a command transfer with the selected device. This function
+   * will block until the entire transfer is finished.
+   *
+   * Transfers with more than one data lane are half duplex, so at most one of
+   * p_data_out and p_data_in may be used. Drivers without multi-lane support
+   * send the command, address and dummy bytes with a standard transfer, which
+   * requires single lanes and a multiple of 8 dummy cycles.
+   *
+   * @param p_phases - command, address and dummy cycles to send before the
+   * data and the lanes used for each phase
+   * @param p_data_out - data to write after the dummy cycles
+   * @param p_data_in - buffer to fill with data read after the dummy cycles
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Returns `std::errc::invalid_argument` if the phases are not
+   * valid or both buffers are used with more than one data lane, and
+   * `std::errc::not_supported` if the hardware cannot perform the transfer.
+   */
+  [[nodiscard]] boost::leaf::result<void> transfer(
+    const command_phases& p_phases,
+    std::span<const std::byte> p_data_out,
+    std::span<std::byte> p_data_in) noexcept
+  {
+    if (p_phases.command_bytes > 2 || p_phases.address_bytes > 4 ||
+        (p_phases.data_lanes != lanes::single && !p_data_out.empty() &&
+         !p_data_in.empty())) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    return driver_command_transfer(p_phases, p_data_out, p_data_in);
+  }
+
+  /**
+   * @brief Map the memory of the selected device into the address space
+   *
+   * The hardware issues the read command described by p_read_phases whenever
+   * the returned memory is accessed, with the address phase holding the
+   * offset into the memory, allowing code to be executed in place. The
+   * memory stays mapped until the next call to configure() or transfer().
+   *
+   * @param p_read_phases - read command used to access the memory, the
+   * address is ignored
+   * @return boost::leaf::result<std::span<const std::byte>> - the mapped
+   * memory. Returns `std::errc::not_supported` if the hardware does not
+   * support memory mapping.
+   */
+  [[nodiscard]] boost::leaf::result<std::span<const std::byte>> memory_map(
+    const command_phases& p_read_phases) noexcept
+  {
+    return driver_memory_map(p_read_phases);
+  }
+
 private:
   virtual boost::leaf::result<void> driver_configure(
     const settings& p_settings) noexcept = 0;
@@ -85,5 +217,51 @@ private:
     std::span<const std::byte> p_data_out,
     std::span<std::byte> p_data_in,
     std::byte p_filler) noexcept = 0;
+
+  // Multi-lane drivers override the following, the defaults provide command
+  // transfers on standard SPI hardware.
+  virtual capabilities_t driver_capabilities() noexcept { return {}; }
+
+  virtual boost::leaf::result<void> driver_command_transfer(
+    const command_phases& p_phases,
+    std::span<const std::byte> p_data_out,
+    std::span<std::byte> p_data_in) noexcept
+  {
+    if (p_phases.command_lanes != lanes::single ||
+        p_phases.address_lanes != lanes::single ||
+        p_phases.data_lanes != lanes::single ||
+        p_phases.dummy_cycles % 8 != 0) {
+      return boost::leaf::new_error(std::errc::not_supported);
+    }
+
+    // Command, address and up to 255 dummy cycles
+    std::array<std::byte, 2 + 4 + 32> header;
+    header.fill(default_filler);
+    size_t length = 0;
+    for (size_t i = p_phases.command_bytes; i > 0; i--) {
+      header[length++] =
+        static_cast<std::byte>(p_phases.command >> (8 * (i - 1)));
+    }
+    for (size_t i = p_phases.address_bytes; i > 0; i--) {
+      header[length++] =
+        static_cast<std::byte>(p_phases.address >> (8 * (i - 1)));
+    }
+    length += p_phases.dummy_cycles / 8U;
+
+    if (length > 0) {
+      BOOST_LEAF_CHECK(driver_transfer(
+        std::span(header).first(length), {}, default_filler));
+    }
+    if (p_data_out.empty() && p_data_in.empty()) {
+      return {};
+    }
+    return driver_transfer(p_data_out, p_data_in, default_filler);
+  }
+
+  virtual boost::leaf::result<std::span<const std::byte>> driver_memory_map(
+    [[maybe_unused]] const command_phases& p_read_phases) noexcept
+  {
+    return boost::leaf::new_error(std::errc::not_supported);
+  }
 };
 }  // namespace embed
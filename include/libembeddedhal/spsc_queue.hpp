@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace embed {
+/**
+ * @brief Fixed capacity, lock-free, single producer single consumer queue
+ *
+ * One context, such as an interrupt or a sampling loop, may push() while
+ * another context pops(). Neither operation blocks or allocates. If the queue
+ * is full, push() fails and the value is dropped, leaving the values already
+ * in the queue untouched for the consumer.
+ *
+ * @tparam T - type of the values stored in the queue
+ * @tparam Capacity - maximum number of values held by the queue
+ */
+template<typename T, size_t Capacity>
+class spsc_queue
+{
+public:
+  static_assert(Capacity > 0, "Capacity must be greater than zero");
+
+  /**
+   * @brief Add a value to the back of the queue
+   *
+   * Must only be called by the producer.
+   *
+   * @param p_value - value to add to the queue
+   * @return true - value was added to the queue
+   * @return false - the queue is full and the value was dropped
+   */
+  [[nodiscard]] bool push(const T& p_value) noexcept
+  {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t next = increment(tail);
+
+    if (next == m_head.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    m_buffer[tail] = p_value;
+    m_tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Remove the value at the front of the queue
+   *
+   * Must only be called by the consumer.
+   *
+   * @return std::optional<T> - the value at the front of the queue or
+   * std::nullopt if the queue is empty.
+   */
+  [[nodiscard]] std::optional<T> pop() noexcept
+  {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+
+    if (head == m_tail.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+
+    T value = m_buffer[head];
+    m_head.store(increment(head), std::memory_order_release);
+    return value;
+  }
+
+  /**
+   * @brief Get the number of values in the queue
+   *
+   * The result is only a snapshot if called while the other context is
+   * modifying the queue.
+   *
+   * @return size_t - number of values in the queue
+   */
+  [[nodiscard]] size_t size() const noexcept
+  {
+    const size_t head = m_head.load(std::memory_order_acquire);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    return (tail >= head) ? tail - head : tail + m_buffer.size() - head;
+  }
+
+  /**
+   * @brief Determine if the queue is empty
+   *
+   * @return true - the queue has no values
+   * @return false - the queue has at least one value
+   */
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  /**
+   * @brief Get the maximum number of values the queue can hold
+   *
+   * @return constexpr size_t - capacity of the queue
+   */
+  [[nodiscard]] static constexpr size_t capacity() noexcept
+  {
+    return Capacity;
+  }
+
+private:
+  static constexpr size_t increment(size_t p_index) noexcept
+  {
+    return (p_index + 1 == Capacity + 1) ? 0 : p_index + 1;
+  }
+
+  // One extra slot distinguishes a full queue from an empty queue
+  std::array<T, Capacity + 1> m_buffer{};
+  std::atomic<size_t> m_head = 0;
+  std::atomic<size_t> m_tail = 0;
+};
+}  // namespace embed
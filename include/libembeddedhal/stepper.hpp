@@ -0,0 +1,693 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+
+#include "error.hpp"
+#include "math.hpp"
+#include "output_pin/interface.hpp"
+#include "timer/interface.hpp"
+
+namespace embed {
+/**
+ * @brief Step timing for a stepper motor move with a trapezoidal or S-curve
+ * velocity profile
+ *
+ * A move accelerates from the start rate to the maximum rate, cruises and then
+ * decelerates back to the start rate. With a jerk limit, the acceleration
+ * itself ramps up and down (S-curve), otherwise it changes instantly
+ * (trapezoidal). Moves too short to reach the maximum rate peak at the highest
+ * rate that still leaves room to decelerate.
+ *
+ * The time of each step is found exactly, with integer arithmetic only, by
+ * inverting the closed form position of the profile over time. The times of
+ * the steps while accelerating are stored in a buffer supplied by the caller.
+ * Deceleration mirrors acceleration and cruising steps are a 32.32 fixed
+ * point interval, so the buffer only needs to hold the acceleration, which is
+ * about max_rate^2 / (2 * acceleration) steps for a trapezoidal profile.
+ *
+ * Intervals are in nanoseconds for embed::timer. For a pulse train peripheral,
+ * convert them to its clock with frequency::cycles_per().
+ */
+class step_profile
+{
+public:
+  /// Limits of the velocity profile
+  struct settings
+  {
+    /// Step rate at the start and end of each move in steps per second. A
+    /// stepper can start and stop instantly below its pull-in rate.
+    std::uint32_t start_rate = 0;
+    /// Maximum step rate in steps per second
+    std::uint32_t max_rate = 1'000;
+    /// Maximum acceleration in steps per second squared
+    std::uint32_t acceleration = 1'000;
+    /// Maximum jerk in steps per second cubed, 0 for a trapezoidal profile
+    std::uint32_t jerk = 0;
+
+    /**
+     * @brief Default operators for <, <=, >, >= and ==
+     *
+     * @return auto - result of the comparison
+     */
+    [[nodiscard]] constexpr auto operator<=>(const settings&) const noexcept =
+      default;
+  };
+
+  /// Highest supported max_rate, which bounds intermediate results
+  static constexpr std::uint32_t max_rate_limit = 1 << 22;
+
+  /**
+   * @brief Sequential access to the intervals of a profile using only 32 and
+   * 64-bit additions, for use in an interrupt
+   */
+  class cursor
+  {
+  public:
+    /**
+     * @brief Get the interval before the next step and advance
+     *
+     * Must not be called more than steps() times.
+     *
+     * @return std::chrono::nanoseconds - time from the previous step, or the
+     * start of the move, to the next step
+     */
+    [[nodiscard]] std::chrono::nanoseconds next() noexcept
+    {
+      const auto& profile = *m_profile;
+      const std::uint32_t step = m_step++;
+      const std::uint32_t ramp = profile.m_ramp_steps;
+      if (step < ramp) {
+        return profile.ramp_interval(step);
+      }
+      if (step >= profile.m_steps - ramp) {
+        return profile.ramp_interval(profile.m_steps - 1 - step);
+      }
+      const std::uint64_t time = m_fraction + (step == ramp
+                                                 ? profile.m_first_cruise
+                                                 : profile.m_cruise);
+      m_fraction = time & fraction_mask;
+      return std::chrono::nanoseconds(time >> 32);
+    }
+
+  private:
+    friend class step_profile;
+
+    explicit cursor(const step_profile& p_profile) noexcept
+      : m_profile(&p_profile)
+    {}
+
+    const step_profile* m_profile;
+    std::uint32_t m_step = 0;
+    std::uint64_t m_fraction = 0;
+  };
+
+  /**
+   * @brief Construct a new step profile object
+   *
+   * @param p_ramp - buffer for the time of each step while accelerating, must
+   * outlive the profile
+   */
+  explicit step_profile(std::span<std::uint32_t> p_ramp) noexcept
+    : m_ramp(p_ramp)
+  {}
+
+  /**
+   * @brief Compute the step timing of a move
+   *
+   * @param p_settings - limits of the velocity profile
+   * @param p_steps - number of steps in the move
+   * @return boost::leaf::result<void> - `std::errc::invalid_argument` if
+   * max_rate or acceleration are 0, start_rate exceeds max_rate, max_rate
+   * exceeds max_rate_limit or accelerating takes 2^32ns (~4.3s) or more.
+   * `std::errc::no_buffer_space` if the buffer cannot hold the steps while
+   * accelerating, in which case reduce max_rate or increase acceleration.
+   */
+  [[nodiscard]] boost::leaf::result<void> plan(const settings& p_settings,
+                                               std::uint32_t p_steps) noexcept
+  {
+    m_steps = 0;
+    m_ramp_steps = 0;
+    if (p_settings.max_rate == 0 || p_settings.acceleration == 0 ||
+        p_settings.start_rate > p_settings.max_rate ||
+        p_settings.max_rate > max_rate_limit) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    auto ramp = make_ramp(p_settings, p_settings.max_rate);
+    if (ramp.duration() > std::numeric_limits<std::uint32_t>::max()) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    // Short moves: find the highest peak rate that leaves room to decelerate
+    const uint128_t move_distance = uint128_t{ p_steps } * step_scale;
+    if (2 * ramp.distance > move_distance) {
+      std::uint32_t low = std::max<std::uint32_t>(p_settings.start_rate, 1);
+      std::uint32_t high = p_settings.max_rate;
+      while (low < high) {
+        const std::uint32_t middle = low + (high - low + 1) / 2;
+        if (2 * make_ramp(p_settings, middle).distance <= move_distance) {
+          low = middle;
+        } else {
+          high = middle - 1;
+        }
+      }
+      ramp = make_ramp(p_settings, low);
+    }
+
+    const auto ramp_steps =
+      std::min(static_cast<std::uint32_t>(ramp.distance / step_scale),
+               p_steps / 2);
+    if (ramp_steps > m_ramp.size()) {
+      return boost::leaf::new_error(std::errc::no_buffer_space);
+    }
+
+    // Step times while accelerating. Intervals never grow as the rate rises,
+    // which bounds each search by the previous interval.
+    std::uint64_t previous = 0;
+    std::uint64_t previous_interval = ramp.duration();
+    for (std::uint32_t step = 1; step <= ramp_steps; step++) {
+      const uint128_t target = uint128_t{ step } * step_scale;
+      std::uint64_t low = previous;
+      std::uint64_t high =
+        std::min(previous + previous_interval + 1, ramp.duration());
+      if (ramp.position(high) < target) {
+        high = ramp.duration();
+      }
+      while (low + 1 < high) {
+        const std::uint64_t middle = low + (high - low) / 2;
+        if (ramp.position(middle) >= target) {
+          high = middle;
+        } else {
+          low = middle;
+        }
+      }
+      m_ramp[step - 1] = static_cast<std::uint32_t>(high);
+      previous_interval = high - previous;
+      previous = high;
+    }
+
+    // Cruise at the rate the ramp ends at, as a 32.32 fixed point interval.
+    // The first cruising step is offset from the end of the ramp by the part
+    // of a step left over from accelerating.
+    const uint128_t velocity = 3 * ramp.end_velocity;
+    const uint128_t offset =
+      uint128_t{ ramp_steps + 1 } * step_scale - ramp.distance;
+    m_cruise = static_cast<std::uint64_t>(
+      rounding_division(step_scale << 32, velocity));
+    m_first_cruise = static_cast<std::uint64_t>(
+      (uint128_t{ ramp.duration() - previous } << 32) +
+      rounding_division(offset << 32, velocity));
+    m_peak_rate = static_cast<std::uint32_t>(
+      rounding_division(ramp.end_velocity, uint128_t{ velocity_scale }));
+    m_ramp_steps = ramp_steps;
+    m_steps = p_steps;
+    return {};
+  }
+
+  /**
+   * @brief Get the number of steps in the planned move
+   *
+   * @return std::uint32_t - number of steps
+   */
+  [[nodiscard]] std::uint32_t steps() const noexcept { return m_steps; }
+
+  /**
+   * @brief Get the number of steps spent accelerating, which is also the
+   * number spent decelerating
+   *
+   * @return std::uint32_t - number of steps
+   */
+  [[nodiscard]] std::uint32_t ramp_steps() const noexcept
+  {
+    return m_ramp_steps;
+  }
+
+  /**
+   * @brief Get the step rate reached by the planned move
+   *
+   * @return std::uint32_t - step rate while cruising in steps per second
+   */
+  [[nodiscard]] std::uint32_t peak_rate() const noexcept { return m_peak_rate; }
+
+  /**
+   * @brief Get the interval before a step
+   *
+   * Gives the same intervals as a cursor, for when they are not needed in
+   * order such as when filling a pulse train buffer.
+   *
+   * @param p_step - index of the step, less than steps()
+   * @return std::chrono::nanoseconds - time from the previous step, or the
+   * start of the move, to this step
+   */
+  [[nodiscard]] std::chrono::nanoseconds interval(
+    std::uint32_t p_step) const noexcept
+  {
+    if (p_step < m_ramp_steps) {
+      return ramp_interval(p_step);
+    }
+    if (p_step >= m_steps - m_ramp_steps) {
+      return ramp_interval(m_steps - 1 - p_step);
+    }
+    const std::uint32_t cruising = p_step - m_ramp_steps;
+    if (cruising == 0) {
+      return std::chrono::nanoseconds(m_first_cruise >> 32);
+    }
+    const uint128_t start =
+      m_first_cruise + uint128_t{ cruising - 1 } * m_cruise;
+    const uint128_t end = start + m_cruise;
+    return std::chrono::nanoseconds(
+      static_cast<std::int64_t>((end >> 32) - (start >> 32)));
+  }
+
+  /**
+   * @brief Get a cursor at the first step of the planned move
+   *
+   * @return cursor - cursor over the intervals of the move
+   */
+  [[nodiscard]] cursor begin() const noexcept { return cursor(*this); }
+
+private:
+  // Positions are in units of 1 / 6e27 steps and velocities in units of
+  // 1 / 2e18 steps per second, with time in nanoseconds, making every term of
+  // the closed form position an integer.
+  static constexpr uint128_t step_scale =
+    uint128_t{ 6'000'000'000 } * 1'000'000'000'000'000'000;
+  static constexpr std::uint64_t velocity_scale = 2'000'000'000'000'000'000;
+  static constexpr std::uint64_t fraction_mask = 0xFFFF'FFFF;
+
+  /// Acceleration from one rate to another in three phases: jerk up,
+  /// constant acceleration, jerk down
+  struct ramp
+  {
+    std::uint64_t jerk = 0;
+    /// Acceleration in units of 1e-9 steps per second squared
+    std::uint64_t acceleration = 0;
+    std::uint64_t jerk_time = 0;
+    std::uint64_t acceleration_time = 0;
+    uint128_t start_velocity = 0;
+    uint128_t jerk_velocity = 0;
+    uint128_t acceleration_velocity = 0;
+    uint128_t end_velocity = 0;
+    uint128_t jerk_distance = 0;
+    uint128_t acceleration_distance = 0;
+    uint128_t distance = 0;
+
+    [[nodiscard]] std::uint64_t duration() const noexcept
+    {
+      return 2 * jerk_time + acceleration_time;
+    }
+
+    [[nodiscard]] uint128_t position(std::uint64_t p_time) const noexcept
+    {
+      uint128_t time = p_time;
+      if (time <= jerk_time) {
+        return 3 * start_velocity * time + jerk * time * time * time;
+      }
+      time -= jerk_time;
+      if (time <= acceleration_time) {
+        return jerk_distance + 3 * jerk_velocity * time +
+               3 * uint128_t{ acceleration } * time * time;
+      }
+      time = std::min<uint128_t>(time - acceleration_time, jerk_time);
+      return acceleration_distance + 3 * acceleration_velocity * time +
+             3 * uint128_t{ acceleration } * time * time -
+             jerk * time * time * time;
+    }
+  };
+
+  [[nodiscard]] static constexpr std::uint64_t square_root(
+    std::uint64_t p_value) noexcept
+  {
+    std::uint64_t root = 0;
+    std::uint64_t bit = std::uint64_t{ 1 } << 62;
+    while (bit > p_value) {
+      bit >>= 2;
+    }
+    while (bit != 0) {
+      if (p_value >= root + bit) {
+        p_value -= root + bit;
+        root = (root >> 1) + bit;
+      } else {
+        root >>= 1;
+      }
+      bit >>= 2;
+    }
+    return root;
+  }
+
+  [[nodiscard]] static ramp make_ramp(const settings& p_settings,
+                                      std::uint32_t p_rate) noexcept
+  {
+    constexpr std::uint64_t nanoseconds = 1'000'000'000;
+    const std::uint64_t rate_change = p_rate - p_settings.start_rate;
+    const std::uint64_t acceleration = p_settings.acceleration;
+    const std::uint64_t jerk = p_settings.jerk;
+
+    ramp result;
+    if (jerk != 0) {
+      // Without room to reach the acceleration limit, the acceleration peaks
+      // at sqrt(rate_change * jerk)
+      const bool reaches_limit = uint128_t{ rate_change } * jerk >=
+                                 uint128_t{ acceleration } * acceleration;
+      const std::uint64_t peak =
+        reaches_limit ? acceleration : square_root(rate_change * jerk);
+      result.jerk = jerk;
+      result.jerk_time = rounding_division(peak * nanoseconds, jerk);
+      result.acceleration = jerk * result.jerk_time;
+      if (reaches_limit) {
+        const std::uint64_t total =
+          rounding_division(rate_change * nanoseconds, acceleration);
+        result.acceleration_time = total - std::min(total, result.jerk_time);
+      }
+    }
+    // A jerk limit too high to last a nanosecond is no limit at all
+    if (result.jerk_time == 0) {
+      result.jerk = 0;
+      result.acceleration = acceleration * nanoseconds;
+      result.acceleration_time =
+        rounding_division(rate_change * nanoseconds, acceleration);
+    }
+
+    const uint128_t jerk_time = result.jerk_time;
+    const uint128_t acceleration_time = result.acceleration_time;
+    const uint128_t jerk_change = jerk * jerk_time * jerk_time;
+    const uint128_t jerk_travel = jerk_change * jerk_time;
+
+    result.start_velocity =
+      uint128_t{ p_settings.start_rate } * velocity_scale;
+    result.jerk_velocity = result.start_velocity + jerk_change;
+    result.acceleration_velocity =
+      result.jerk_velocity + 2 * result.acceleration * acceleration_time;
+    result.end_velocity = result.acceleration_velocity +
+                          2 * result.acceleration * jerk_time - jerk_change;
+
+    result.jerk_distance = 3 * result.start_velocity * jerk_time + jerk_travel;
+    result.acceleration_distance =
+      result.jerk_distance + 3 * result.jerk_velocity * acceleration_time +
+      3 * uint128_t{ result.acceleration } * acceleration_time *
+        acceleration_time;
+    result.distance = result.position(result.duration());
+    return result;
+  }
+
+  [[nodiscard]] std::chrono::nanoseconds ramp_interval(
+    std::uint32_t p_step) const noexcept
+  {
+    const std::uint32_t previous = (p_step == 0) ? 0 : m_ramp[p_step - 1];
+    return std::chrono::nanoseconds(m_ramp[p_step] - previous);
+  }
+
+  std::span<std::uint32_t> m_ramp;
+  std::uint32_t m_steps = 0;
+  std::uint32_t m_ramp_steps = 0;
+  std::uint32_t m_peak_rate = 0;
+  std::uint64_t m_first_cruise = 0;
+  std::uint64_t m_cruise = 0;
+};
+
+/**
+ * @brief Generate step and direction signals for one or more stepper motor
+ * drivers from a timer interrupt
+ *
+ * Each move is a straight line: the axis with the most steps follows the
+ * step_profile and the other axes step in proportion to it, spread evenly
+ * with Bresenham's algorithm, so every axis starts and finishes together.
+ * The profile's rates therefore apply to the axis with the most steps.
+ *
+ * Each step takes two timer interrupts: the first raises the step pin of each
+ * axis that steps and the second, one pulse width later, lowers them. Each
+ * interrupt schedules the next before touching the pins, so the time spent in
+ * the interrupt does not add to the intervals. Set the pulse width to the
+ * longest minimum HIGH time of the drivers; the profile must leave at least
+ * as long again between pulses for the minimum LOW time.
+ *
+ * ```
+ * std::array<std::uint32_t, 512> ramp;
+ * embed::step_profile profile(ramp);
+ * std::array axes{
+ *   embed::step_generator::axis{ .step = &x_step, .direction = &x_dir },
+ *   embed::step_generator::axis{ .step = &y_step, .direction = &y_dir },
+ * };
+ * embed::step_generator generator(axes, timer, profile);
+ *
+ * BOOST_LEAF_CHECK(generator.move(std::array{ 1600, -400 }, settings));
+ * while (!BOOST_LEAF_CHECK(generator.done())) {
+ *   continue;
+ * }
+ * ```
+ */
+class step_generator
+{
+public:
+  /// Step and direction pins of a stepper motor driver
+  struct axis
+  {
+    /// Pin pulsed HIGH once per step
+    output_pin* step = nullptr;
+    /// Pin selecting the direction of rotation
+    output_pin* direction = nullptr;
+    /// Level of the direction pin for positive steps
+    bool positive_level = true;
+    /// Position in steps, updated as steps are generated
+    std::int64_t position = 0;
+    /// Steps in the current move, managed by the generator
+    std::uint32_t delta = 0;
+    /// Bresenham error term, managed by the generator
+    std::uint32_t error = 0;
+    /// Whether the current move is positive, managed by the generator
+    bool positive = true;
+    /// Whether the step pin may be HIGH, managed by the generator
+    bool stepped = false;
+  };
+
+  /// Default width of the step pulse, enough for most stepper motor drivers
+  static constexpr std::chrono::nanoseconds default_pulse_width =
+    std::chrono::microseconds(2);
+
+  /**
+   * @brief Construct a new step generator
+   *
+   * @param p_axes - axes to drive, must outlive the generator
+   * @param p_timer - timer used to schedule each step
+   * @param p_profile - profile planned for each move, must outlive the
+   * generator
+   * @param p_pulse_width - time the step pins are held HIGH for each step
+   */
+  step_generator(
+    std::span<axis> p_axes,
+    timer& p_timer,
+    step_profile& p_profile,
+    std::chrono::nanoseconds p_pulse_width = default_pulse_width) noexcept
+    : m_axes(p_axes)
+    , m_timer(&p_timer)
+    , m_profile(&p_profile)
+    , m_cursor(p_profile.begin())
+    , m_pulse_width(p_pulse_width)
+  {}
+
+  // The timer callback refers to this object
+  step_generator(const step_generator&) = delete;
+  step_generator& operator=(const step_generator&) = delete;
+  step_generator(step_generator&&) = delete;
+  step_generator& operator=(step_generator&&) = delete;
+
+  /**
+   * @brief Start a move
+   *
+   * @param p_steps - signed number of steps for each axis
+   * @param p_settings - limits of the velocity profile of the axis with the
+   * most steps
+   * @return boost::leaf::result<void> - `std::errc::invalid_argument` if the
+   * number of steps does not match the number of axes or the maximum rate
+   * leaves less than two pulse widths per step,
+   * `std::errc::resource_unavailable_try_again` if a move is in progress, any
+   * error from step_profile::plan() or from the direction pins or timer.
+   */
+  [[nodiscard]] boost::leaf::result<void> move(
+    std::span<const std::int32_t> p_steps,
+    const step_profile::settings& p_settings) noexcept
+  {
+    if (p_steps.size() != m_axes.size()) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    if (m_running.load()) {
+      return boost::leaf::new_error(std::errc::resource_unavailable_try_again);
+    }
+
+    std::uint32_t longest = 0;
+    for (size_t i = 0; i < m_axes.size(); i++) {
+      auto& axis = m_axes[i];
+      axis.positive = p_steps[i] >= 0;
+      axis.delta = static_cast<std::uint32_t>(
+        axis.positive ? p_steps[i] : -static_cast<std::int64_t>(p_steps[i]));
+      longest = std::max(longest, axis.delta);
+    }
+
+    constexpr std::chrono::nanoseconds second = std::chrono::seconds(1);
+    if (2 * m_pulse_width * p_settings.max_rate > second) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+
+    BOOST_LEAF_CHECK(m_profile->plan(p_settings, longest));
+    m_failed.store(false);
+    m_step = 0;
+    m_raise = true;
+    if (longest == 0) {
+      return {};
+    }
+
+    for (auto& axis : m_axes) {
+      axis.error = longest / 2;
+      if (axis.delta != 0) {
+        const bool level = axis.positive == axis.positive_level;
+        BOOST_LEAF_CHECK(axis.direction->level(level));
+      }
+    }
+
+    m_cursor = m_profile->begin();
+    m_running.store(true);
+    auto scheduled = m_timer->schedule(m_callback, m_cursor.next());
+    if (!scheduled) {
+      m_running.store(false);
+    }
+    return scheduled;
+  }
+
+  /**
+   * @brief Determine if the last move has finished
+   *
+   * @return boost::leaf::result<bool> - true if the move has finished,
+   * `std::errc::io_error` if it was stopped early because the timer or a step
+   * pin returned an error.
+   */
+  [[nodiscard]] boost::leaf::result<bool> done() const noexcept
+  {
+    if (m_running.load()) {
+      return false;
+    }
+    if (m_failed.load()) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Stop the current move immediately, without decelerating
+   *
+   * Positions remain accurate, but a motor moving faster than its pull-in
+   * rate may lose steps. Every step pin left HIGH is lowered, even if
+   * lowering another fails.
+   *
+   * @return boost::leaf::result<void> - any error from the timer,
+   * `std::errc::io_error` if a step pin could not be lowered.
+   */
+  [[nodiscard]] boost::leaf::result<void> stop() noexcept
+  {
+    BOOST_LEAF_CHECK(m_timer->clear());
+    m_running.store(false);
+    if (!lower_step_pins()) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return {};
+  }
+
+private:
+  void step() noexcept
+  {
+    if (m_raise) {
+      raise();
+    } else {
+      lower();
+    }
+  }
+
+  void raise() noexcept
+  {
+    if (!m_timer->schedule(m_callback, m_pulse_width)) {
+      fail();
+      return;
+    }
+    m_raise = false;
+
+    const std::uint32_t steps = m_profile->steps();
+    bool success = true;
+    for (auto& axis : m_axes) {
+      axis.error += axis.delta;
+      if (axis.error >= steps) {
+        axis.error -= steps;
+        axis.stepped = true;
+        if (axis.step->level(true)) {
+          axis.position += axis.positive ? 1 : -1;
+        } else {
+          success = false;
+        }
+      }
+    }
+
+    if (!success) {
+      (void)lower_step_pins();
+      fail();
+    }
+  }
+
+  void lower() noexcept
+  {
+    m_step++;
+    if (m_step < m_profile->steps()) {
+      // Keep the LOW time at least as long as the pulse
+      const auto delay = std::max(m_cursor.next() - m_pulse_width,
+                                  m_pulse_width);
+      if (!m_timer->schedule(m_callback, delay)) {
+        fail();
+        return;
+      }
+      m_raise = true;
+    }
+
+    if (!lower_step_pins()) {
+      fail();
+    } else if (m_step >= m_profile->steps()) {
+      m_running.store(false);
+    }
+  }
+
+  bool lower_step_pins() noexcept
+  {
+    bool success = true;
+    for (auto& axis : m_axes) {
+      if (axis.stepped) {
+        if (axis.step->level(false)) {
+          axis.stepped = false;
+        } else {
+          success = false;
+        }
+      }
+    }
+    return success;
+  }
+
+  void fail() noexcept
+  {
+    (void)m_timer->clear();
+    m_failed.store(true);
+    m_running.store(false);
+  }
+
+  std::span<axis> m_axes;
+  timer* m_timer;
+  step_profile* m_profile;
+  step_profile::cursor m_cursor;
+  std::chrono::nanoseconds m_pulse_width;
+  std::function<void(void)> m_callback = [this]() { step(); };
+  std::uint32_t m_step = 0;
+  bool m_raise = true;
+  std::atomic<bool> m_failed = false;
+  std::atomic<bool> m_running = false;
+};
+}  // namespace embed
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include "../error.hpp"
+#include "../frequency.hpp"
+#include "../percent.hpp"
+
+namespace embed {
+/**
+ * @brief Streaming Digital to Analog Converter (DAC) hardware abstraction
+ * interface.
+ *
+ * Use this interface for DACs that can output blocks of samples at a fixed
+ * sample rate without the involvement of the CPU per sample, usually by way of
+ * a timer triggered DMA. This is suitable for generating audio and arbitrary
+ * waveforms where calling embed::dac::write() for every sample would require
+ * an interrupt per sample.
+ *
+ * Samples are streamed from a circular buffer split into two halves. While the
+ * DAC outputs one half, the application fills the other. Each time a half has
+ * been completely output, the refill callback is called with that half. If the
+ * callback does not finish before the other half has been output, the DAC will
+ * output stale samples, which is known as an underflow.
+ *
+ */
+class stream_dac
+{
+public:
+  /// Generic settings for streaming DACs
+  struct settings
+  {
+    /// Rate at which samples are output
+    embed::frequency sample_rate = embed::frequency(8'000);
+
+    /**
+     * @brief Default operators for <, <=, >, >= and ==
+     *
+     * @return auto - result of the comparison
+     */
+    [[nodiscard]] constexpr auto operator<=>(const settings&) const noexcept =
+      default;
+  };
+
+  /**
+   * @brief Function called with the half of the buffer that has just been
+   * output and is ready to be refilled.
+   *
+   * This is generally called from an interrupt context.
+   */
+  using refill_handler = std::function<void(std::span<percent> p_drained)>;
+
+  /**
+   * @brief Configure the streaming DAC to match the settings supplied
+   *
+   * @param p_settings - settings to apply to the streaming DAC
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Will return `std::errc::invalid_argument` if the sample rate
+   * cannot be achieved.
+   */
+  [[nodiscard]] boost::leaf::result<void> configure(
+    const settings& p_settings) noexcept
+  {
+    return driver_configure(p_settings);
+  }
+
+  /**
+   * @brief Start continuously outputting samples from a double buffer
+   *
+   * The buffer should be filled with the first two halves of samples before
+   * calling this function. Output starts at the beginning of the buffer, wraps
+   * around at the end and continues until stop() is called.
+   *
+   * The buffer must stay valid until stop() is called.
+   *
+   * @param p_buffer - circular buffer of samples, split into two halves. Must
+   * have an even number of samples.
+   * @param p_refill - called each time a half of the buffer has been output
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation. Will return `std::errc::invalid_argument` if the buffer is
+   * empty or has an odd number of samples.
+   */
+  [[nodiscard]] boost::leaf::result<void> start(
+    std::span<percent> p_buffer,
+    refill_handler p_refill) noexcept
+  {
+    if (p_buffer.empty() || p_buffer.size() % 2 != 0) {
+      return boost::leaf::new_error(std::errc::invalid_argument);
+    }
+    return driver_start(p_buffer, p_refill);
+  }
+
+  /**
+   * @brief Stop outputting samples
+   *
+   * Does nothing if the DAC is not streaming. The refill handler will not be
+   * called after this returns.
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation.
+   */
+  [[nodiscard]] boost::leaf::result<void> stop() noexcept
+  {
+    return driver_stop();
+  }
+
+private:
+  virtual boost::leaf::result<void> driver_configure(
+    const settings& p_settings) noexcept = 0;
+  virtual boost::leaf::result<void> driver_start(
+    std::span<percent> p_buffer,
+    refill_handler p_refill) noexcept = 0;
+  virtual boost::leaf::result<void> driver_stop() noexcept = 0;
+};
+}  // namespace embed
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "../testing.hpp"
+#include "interface.hpp"
+
+namespace embed::mock {
+/**
+ * @brief Mock streaming dac implementation for use in unit tests and
+ * simulations with spy functions for configure(), start() and stop().
+ *
+ * The mock does not output samples on its own. Call output() to simulate the
+ * DAC draining halves of the buffer. Each drained half is appended to
+ * samples() and the refill handler is called and timed. A refill that takes
+ * longer than the time it takes the DAC to output the other half of the buffer
+ * is counted as an underflow. This allows the headroom of a waveform generator
+ * to be measured on a host machine.
+ *
+ */
+struct stream_dac : public embed::stream_dac
+{
+  /// Function returning the current time, used to time refill handlers
+  using clock_function = std::function<std::chrono::nanoseconds(void)>;
+
+  /**
+   * @brief Construct a new stream dac object
+   *
+   * @param p_clock - clock used to time the refill handler, defaults to
+   * std::chrono::steady_clock.
+   */
+  stream_dac(clock_function p_clock = steady_clock)
+    : m_clock(p_clock)
+  {}
+
+  /**
+   * @brief Reset spy information for configure(), start() and stop() along
+   * with the output samples and refill timing.
+   *
+   */
+  void reset()
+  {
+    spy_configure.reset();
+    spy_start.reset();
+    spy_stop.reset();
+    m_samples.clear();
+    m_underflows = 0;
+    m_refills = 0;
+    m_worst_refill = std::chrono::nanoseconds(0);
+  }
+
+  /**
+   * @brief Simulate the DAC outputting halves of the buffer
+   *
+   * @param p_halves - number of buffer halves to output
+   * @return boost::leaf::result<void> - `std::errc::operation_not_permitted`
+   * if the DAC has not been started or an error if the configured sample rate
+   * cannot express the duration of a half.
+   */
+  boost::leaf::result<void> output(size_t p_halves = 1)
+  {
+    if (m_buffer.empty()) {
+      return boost::leaf::new_error(std::errc::operation_not_permitted);
+    }
+
+    const auto period = BOOST_LEAF_CHECK(half_period());
+    const size_t half = m_buffer.size() / 2;
+
+    for (size_t i = 0; i < p_halves; i++) {
+      auto drained = m_buffer.subspan(m_half * half, half);
+      m_samples.insert(m_samples.end(), drained.begin(), drained.end());
+      m_half = (m_half + 1) % 2;
+
+      const auto start = m_clock();
+      m_refill(drained);
+      const auto elapsed = m_clock() - start;
+
+      m_refills++;
+      m_worst_refill = std::max(m_worst_refill, elapsed);
+      if (elapsed > period) {
+        m_underflows++;
+      }
+    }
+
+    return {};
+  }
+
+  /**
+   * @brief Get the time it takes the DAC to output half of the buffer, which
+   * is the deadline for the refill handler.
+   *
+   * @return boost::leaf::result<std::chrono::nanoseconds> - duration of half
+   * of the buffer at the configured sample rate.
+   */
+  boost::leaf::result<std::chrono::nanoseconds> half_period() const
+  {
+    return m_settings.sample_rate.duration_from_cycles(m_buffer.size() / 2);
+  }
+
+  /**
+   * @brief Get every sample output so far
+   *
+   * @return const std::vector<percent>& - samples in the order they were
+   * output.
+   */
+  const std::vector<percent>& samples() const { return m_samples; }
+
+  /**
+   * @brief Get the number of refills that missed their deadline
+   *
+   * @return size_t - number of underflows
+   */
+  size_t underflows() const { return m_underflows; }
+
+  /**
+   * @brief Get the number of times the refill handler has been called
+   *
+   * @return size_t - number of refills
+   */
+  size_t refills() const { return m_refills; }
+
+  /**
+   * @brief Get the longest time the refill handler has taken
+   *
+   * @return std::chrono::nanoseconds - longest refill duration
+   */
+  std::chrono::nanoseconds worst_refill() const { return m_worst_refill; }
+
+  /// Spy handler for embed::stream_dac::configure()
+  spy_handler<settings> spy_configure;
+  /// Spy handler for embed::stream_dac::start()
+  spy_handler<std::span<percent>, refill_handler> spy_start;
+  /// Spy handler for embed::stream_dac::stop()
+  spy_handler<bool> spy_stop;
+
+private:
+  static std::chrono::nanoseconds steady_clock()
+  {
+    return std::chrono::steady_clock::now().time_since_epoch();
+  }
+
+  boost::leaf::result<void> driver_configure(
+    const settings& p_settings) noexcept override
+  {
+    m_settings = p_settings;
+    return spy_configure.record(p_settings);
+  };
+  boost::leaf::result<void> driver_start(
+    std::span<percent> p_buffer,
+    refill_handler p_refill) noexcept override
+  {
+    m_buffer = p_buffer;
+    m_refill = p_refill;
+    m_half = 0;
+    return spy_start.record(p_buffer, p_refill);
+  };
+  boost::leaf::result<void> driver_stop() noexcept override
+  {
+    m_buffer = {};
+    m_refill = nullptr;
+    return spy_stop.record(true);
+  };
+
+  clock_function m_clock;
+  settings m_settings{};
+  std::span<percent> m_buffer{};
+  refill_handler m_refill{};
+  size_t m_half = 0;
+  std::vector<percent> m_samples{};
+  size_t m_underflows = 0;
+  size_t m_refills = 0;
+  std::chrono::nanoseconds m_worst_refill{ 0 };
+};
+}  // namespace embed::mock
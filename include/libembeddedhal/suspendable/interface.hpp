@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../error.hpp"
+
+namespace embed {
+/**
+ * @brief Optional power control interface for peripherals and devices that
+ * can stop their clocks or power between uses.
+ *
+ * Drivers implement this alongside their main interface, for example an spi
+ * driver that gates its peripheral clock would derive from both embed::spi and
+ * embed::suspendable. A suspended driver keeps its configuration, so resume()
+ * restores it to the state it was in before suspend() without calling
+ * configure() again.
+ *
+ * Other functions of a suspended driver must not be called. See
+ * embed::power_manager for suspending drivers automatically when idle.
+ */
+class suspendable
+{
+public:
+  /**
+   * @brief Enter the lowest power state that retains the configuration
+   *
+   * Suspending a suspended driver does nothing.
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation.
+   */
+  [[nodiscard]] boost::leaf::result<void> suspend() noexcept
+  {
+    return driver_suspend();
+  }
+
+  /**
+   * @brief Return to normal operation after suspend()
+   *
+   * Returns once the driver is ready to be used. Resuming a driver that is
+   * not suspended does nothing.
+   *
+   * @return boost::leaf::result<void> - any error that occurred during this
+   * operation.
+   */
+  [[nodiscard]] boost::leaf::result<void> resume() noexcept
+  {
+    return driver_resume();
+  }
+
+private:
+  virtual boost::leaf::result<void> driver_suspend() noexcept = 0;
+  virtual boost::leaf::result<void> driver_resume() noexcept = 0;
+};
+}  // namespace embed
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../testing.hpp"
+#include "interface.hpp"
+
+namespace embed::mock {
+/**
+ * @brief Mock suspendable implementation for use in unit tests and
+ * simulations with spy functions for suspend() and resume()
+ *
+ */
+struct suspendable : public embed::suspendable
+{
+  /**
+   * @brief Reset spy information for suspend() and resume()
+   *
+   */
+  void reset()
+  {
+    spy_suspend.reset();
+    spy_resume.reset();
+  }
+
+  /// Spy handler for embed::suspendable::suspend()
+  spy_handler<bool> spy_suspend;
+  /// Spy handler for embed::suspendable::resume()
+  spy_handler<bool> spy_resume;
+  /// Whether the last successful call was to suspend()
+  bool suspended = false;
+
+private:
+  boost::leaf::result<void> driver_suspend() noexcept override
+  {
+    BOOST_LEAF_CHECK(spy_suspend.record(true));
+    suspended = true;
+    return {};
+  };
+  boost::leaf::result<void> driver_resume() noexcept override
+  {
+    BOOST_LEAF_CHECK(spy_resume.record(true));
+    suspended = false;
+    return {};
+  };
+};
+}  // namespace embed::mock
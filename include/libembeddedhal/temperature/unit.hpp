@@ -2,8 +2,7 @@
 
 #include <cstdio>
 
-#include <units/isq/si/prefixes.h>
-#include <units/isq/si/thermodynamic_temperature.h>
+#include "../units.hpp"
 
 namespace embed {
 struct nanokelvin
@@ -0,0 +1,84 @@
+/**
+ * @file util.hpp
+ * @brief Provide utility functions for the temperature interface
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+#include "../conversion.hpp"
+#include "interface.hpp"
+
+namespace embed {
+/**
+ * @brief Convert embed::temperature into another unit of temperature
+ *
+ * Temperatures are converted with a multiply and shift computed at compile
+ * time, rather than an int64 division per value from units::quantity_cast.
+ *
+ * An optional zero point allows conversion to scales offset from absolute
+ * zero. For example, millidegrees Celsius:
+ *
+ * ```
+ * constexpr embed::temperature_conversion<embed::mK<std::int32_t>> to_celsius(
+ *   embed::mK<std::int32_t>(273'150));
+ * auto millidegrees = to_celsius(temperature).number();
+ * ```
+ *
+ * @tparam Quantity - temperature type to convert into. Its unit must be equal
+ * to or larger than nanokelvin.
+ */
+template<units::Quantity Quantity = mK<std::int32_t>>
+class temperature_conversion
+{
+public:
+  /**
+   * @brief Construct a conversion
+   *
+   * @param p_zero - temperature subtracted from each result
+   */
+  explicit constexpr temperature_conversion(
+    Quantity p_zero = Quantity(0)) noexcept
+    : m_scale(ratio[0], ratio[1], -static_cast<std::int64_t>(p_zero.number()))
+  {}
+
+  /**
+   * @brief Convert a temperature
+   *
+   * @param p_temperature - temperature to convert
+   * @return constexpr Quantity - converted temperature, rounded to nearest
+   */
+  [[nodiscard]] constexpr Quantity operator()(
+    embed::temperature p_temperature) const noexcept
+  {
+    return Quantity(static_cast<rep>(m_scale(p_temperature.number())));
+  }
+
+  /**
+   * @brief Convert a block of temperatures
+   *
+   * @param p_input - temperatures to convert
+   * @param p_output - destination for the converted temperatures
+   * @return std::span<Quantity> - the portion of p_output that was written to
+   */
+  constexpr std::span<Quantity> process(
+    std::span<const embed::temperature> p_input,
+    std::span<Quantity> p_output) const noexcept
+  {
+    const size_t length = std::min(p_input.size(), p_output.size());
+    for (size_t i = 0; i < length; i++) {
+      p_output[i] = (*this)(p_input[i]);
+    }
+    return p_output.first(length);
+  }
+
+private:
+  using rep = typename Quantity::rep;
+
+  static constexpr auto ratio = unit_ratio<Quantity, embed::temperature>();
+
+  scale_conversion m_scale;
+};
+}  // namespace embed
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace embed {
+/**
+ * @brief Publish/subscribe channel that fans out each message to any number
+ * of subscribers without copying it into a queue per subscriber
+ *
+ * Messages are written once into a fixed ring of slots allocated from a memory
+ * resource. Every message is numbered and each subscriber only holds the
+ * number of the next message it wants, so publishing costs the same no matter
+ * how many subscribers there are, and subscribers can be added at any time
+ * without registering with the topic. Subscribers copy a message out of its
+ * slot when they receive it.
+ *
+ * A topic never waits for its subscribers. When a subscriber falls more than
+ * the number of slots behind, the messages it has not received are
+ * overwritten; it skips to the oldest message still held and counts the
+ * messages it missed. Choose the number of slots to cover the longest time a
+ * subscriber may go without receiving. The number of slots is a power of two,
+ * so that message numbers keep mapping to the same slots when they wrap
+ * around.
+ *
+ * Each slot is protected by a sequence lock holding the number of the message
+ * in it, so publish() is wait-free and a subscriber detects a message that was
+ * overwritten while it was being copied, counting it as missed. Only one
+ * context may publish() to a topic, such as a sensor's interrupt or sampling
+ * loop. The lock holds the message number in 31 bits, so a subscriber must not
+ * be interrupted in the middle of receive() for 2^31 or more publishes, or it
+ * may take a message written in between for the one it was copying.
+ *
+ * USAGE:
+ *
+ *    embed::static_memory_resource<1024> memory;
+ *    embed::topic<imu_sample> imu(memory, 16);
+ *    auto logger = imu.subscribe();
+ *    auto controller = imu.subscribe();
+ *
+ *    imu.publish(sample);
+ *    while (auto sample = logger.receive()) { ... }
+ *
+ * @tparam T - type of the message, must be trivially copyable
+ */
+template<typename T>
+class topic
+{
+public:
+  static_assert(std::is_trivially_copyable_v<T>,
+                "T must be trivially copyable to be copied while written");
+
+  /// Number of a message, counting from 0 and wrapping around on overflow
+  using sequence_t = std::uint32_t;
+
+  /**
+   * @brief Receives the messages published to a topic after it subscribed
+   *
+   * Each subscriber must only be used by one context at a time.
+   */
+  class subscriber
+  {
+  public:
+    /**
+     * @brief Receive the oldest message not yet received
+     *
+     * @return std::optional<T> - a copy of the message or std::nullopt if
+     * there are no new messages.
+     */
+    [[nodiscard]] std::optional<T> receive() noexcept
+    {
+      while (true) {
+        const sequence_t published = m_topic->published();
+        const sequence_t behind = published - m_next;
+        if (behind == 0) {
+          return std::nullopt;
+        }
+        if (behind > m_topic->slots()) {
+          skip_to(published - static_cast<sequence_t>(m_topic->slots()));
+        }
+
+        if (auto message = m_topic->read(m_next)) {
+          m_next++;
+          return message;
+        }
+        // Overwritten by a newer message while being copied
+        skip_to(m_next + 1);
+      }
+    }
+
+    /**
+     * @brief Get the number of messages waiting to be received
+     *
+     * @return size_t - number of messages, at most the number of slots
+     */
+    [[nodiscard]] size_t pending() const noexcept
+    {
+      return std::min<size_t>(m_topic->published() - m_next, m_topic->slots());
+    }
+
+    /**
+     * @brief Get the number of messages that were overwritten before they
+     * were received
+     *
+     * @return sequence_t - number of messages missed
+     */
+    [[nodiscard]] sequence_t missed() const noexcept { return m_missed; }
+
+  private:
+    friend topic;
+
+    subscriber(const topic& p_topic, sequence_t p_next) noexcept
+      : m_topic(&p_topic)
+      , m_next(p_next)
+    {}
+
+    void skip_to(sequence_t p_next) noexcept
+    {
+      m_missed += p_next - m_next;
+      m_next = p_next;
+    }
+
+    const topic* m_topic;
+    sequence_t m_next;
+    sequence_t m_missed = 0;
+  };
+
+  /**
+   * @brief Construct a new topic
+   *
+   * @param p_memory_resource - memory resource used for the message slots
+   * @param p_slots - number of the most recent messages held for subscribers,
+   * rounded up to a power of two and at least 1
+   */
+  topic(std::pmr::memory_resource& p_memory_resource, size_t p_slots)
+    : m_slots(std::bit_ceil(std::max<size_t>(p_slots, 1)), &p_memory_resource)
+  {}
+
+  topic(const topic&) = delete;
+  topic& operator=(const topic&) = delete;
+
+  /**
+   * @brief Publish a message to all subscribers
+   *
+   * Wait-free. Must only be called by the publishing context.
+   *
+   * @param p_message - message to publish
+   */
+  void publish(const T& p_message) noexcept
+  {
+    const sequence_t number = m_published.load(std::memory_order_relaxed);
+    slot& destination = m_slots[index(number)];
+
+    destination.sequence.store(2 * number + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    destination.message = p_message;
+    destination.sequence.store(2 * number + 2, std::memory_order_release);
+
+    m_published.store(number + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Subscribe to the messages published from now on
+   *
+   * @return subscriber - receives messages published after this call
+   */
+  [[nodiscard]] subscriber subscribe() const noexcept
+  {
+    return subscriber(*this, published());
+  }
+
+  /**
+   * @brief Get the number of messages published
+   *
+   * @return sequence_t - number of messages published, wrapping around on
+   * overflow
+   */
+  [[nodiscard]] sequence_t published() const noexcept
+  {
+    return m_published.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Get the number of slots
+   *
+   * @return size_t - number of the most recent messages held for subscribers,
+   * a power of two
+   */
+  [[nodiscard]] size_t slots() const noexcept { return m_slots.size(); }
+
+private:
+  struct slot
+  {
+    // Twice the number of the message held plus two, or plus one while it is
+    // being written, so numbers 2^31 apart have the same tag
+    std::atomic<sequence_t> sequence = 0;
+    T message{};
+  };
+
+  size_t index(sequence_t p_number) const noexcept
+  {
+    // Power of two slots divide 2^32 evenly, so the index does not jump when
+    // the number wraps around
+    return p_number & (m_slots.size() - 1);
+  }
+
+  std::optional<T> read(sequence_t p_number) const noexcept
+  {
+    const slot& source = m_slots[index(p_number)];
+    const sequence_t expected = 2 * p_number + 2;
+
+    const sequence_t start = source.sequence.load(std::memory_order_acquire);
+    const T message = source.message;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const sequence_t finish = source.sequence.load(std::memory_order_relaxed);
+
+    if (start != expected || finish != expected) {
+      return std::nullopt;
+    }
+    return message;
+  }
+
+  std::pmr::vector<slot> m_slots;
+  std::atomic<sequence_t> m_published = 0;
+};
+}  // namespace embed
@@ -0,0 +1,22 @@
+/**
+ * @file units.hpp
+ * @brief The subset of the mp-units library used by libembeddedhal
+ *
+ * libembeddedhal headers include the units library through this header only.
+ * It pulls in the quantity core along with the ISQ/SI dimensions and prefixes
+ * needed for acceleration and temperature, and nothing from the other unit
+ * systems bundled with mp-units. Only the core, isq and si include
+ * directories of the units library are needed to use it.
+ *
+ * Because its contents rarely change, this header is a good candidate for a
+ * precompiled header. See the LIBEMBEDDEDHAL_PRECOMPILE_HEADERS option in
+ * CMakeLists.txt.
+ */
+#pragma once
+
+#include <units/quantity.h>
+#include <units/quantity_cast.h>
+
+#include <units/isq/si/acceleration.h>
+#include <units/isq/si/prefixes.h>
+#include <units/isq/si/thermodynamic_temperature.h>
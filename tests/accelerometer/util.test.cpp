@@ -0,0 +1,85 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/accelerometer/util.hpp>
+
+#include <cmath>
+
+namespace embed {
+boost::ut::suite accelerometer_util_test = []() {
+  using namespace boost::ut;
+
+  // 2g of acceleration
+  constexpr embed::acceleration full_scale(19'613'300'000);
+
+  // Generic conversion through quantity_cast, rounded to nearest
+  auto reference = [full_scale](percent p_axis) {
+    const auto scaled =
+      static_cast<double>(full_scale.number()) * p_axis.to<double>();
+    return std::llround(
+      units::quantity_cast<mm_per_s2<double>>(nm_per_s2<double>(scaled))
+        .number());
+  };
+
+  "[accelerometer] acceleration_conversion"_test = [full_scale]() {
+    constexpr acceleration_conversion to_mm_per_s2(full_scale);
+    constexpr acceleration_conversion<nm_per_s2<std::int64_t>> to_nm_per_s2(
+      full_scale);
+
+    static_assert(to_mm_per_s2(percent::from_ratio(1, 2)) ==
+                  mm_per_s2<std::int32_t>(9807));
+    static_assert(to_mm_per_s2(percent::from_ratio(-1, 1)) ==
+                  mm_per_s2<std::int32_t>(-19613));
+    // Results beyond 32-bits are accurate to within 2^-32 of the result
+    const auto difference =
+      full_scale - to_nm_per_s2(percent::from_ratio(1, 1));
+    expect(difference <= nm_per_s2<std::int64_t>(5));
+    expect(difference >= nm_per_s2<std::int64_t>(-5));
+    expect(nm_per_s2<std::int64_t>(0) == to_nm_per_s2(percent(0.0f)));
+  };
+
+  "[accelerometer] acceleration_conversion of sample"_test = [full_scale]() {
+    // Setup
+    const acceleration_conversion<um_per_s2<std::int32_t>> to_um_per_s2(
+      full_scale);
+    const accelerometer::sample sample{
+      .full_scale = full_scale,
+      .axis = {
+        .x = percent::from_ratio(1, 2),
+        .y = percent::from_ratio(-1, 4),
+        .z = percent::from_ratio(0, 1),
+      },
+    };
+
+    // Exercise
+    auto axis = to_um_per_s2(sample);
+
+    // Verify
+    expect(um_per_s2<std::int32_t>(9'806'650) == axis.x);
+    expect(um_per_s2<std::int32_t>(-4'903'325) == axis.y);
+    expect(um_per_s2<std::int32_t>(0) == axis.z);
+  };
+
+  "[accelerometer] acceleration_conversion matches quantity_cast"_test =
+    [full_scale, reference]() {
+      // Setup
+      const acceleration_conversion to_mm_per_s2(full_scale);
+      std::array<percent, 256> input{};
+      std::array<mm_per_s2<std::int32_t>, 256> output{};
+      std::uint32_t state = 12345;
+      for (auto& axis : input) {
+        state = state * 1103515245U + 12345U;
+        axis = percent::convert<32>(static_cast<std::int32_t>(state));
+      }
+
+      // Exercise
+      auto result = to_mm_per_s2.process(input, output);
+
+      // Verify
+      expect(that % input.size() == result.size());
+      for (size_t i = 0; i < input.size(); i++) {
+        const auto expected = reference(input[i]);
+        const auto actual = output[i].number();
+        expect(actual - expected <= 1 && expected - actual <= 1);
+      }
+    };
+};
+}  // namespace embed
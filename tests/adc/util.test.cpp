@@ -0,0 +1,68 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/adc/util.hpp>
+#include <libembeddedhal/fixed_point.hpp>
+
+namespace embed {
+boost::ut::suite adc_util_test = []() {
+  using namespace boost::ut;
+
+  class dummy_adc : public embed::adc
+  {
+  public:
+    boost::leaf::result<percent> driver_read() noexcept override
+    {
+      if (m_reads == m_fail_at) {
+        return boost::leaf::new_error(std::errc::io_error);
+      }
+      m_reads++;
+      return percent::from_ratio(m_reads, 4);
+    }
+
+    int m_reads = 0;
+    int m_fail_at = -1;
+  };
+
+  "[adc] read block of percent"_test = []() {
+    // Setup
+    dummy_adc adc;
+    std::array<percent, 4> samples{};
+
+    // Exercise
+    auto result = read(adc, samples);
+
+    // Verify
+    expect(bool{ result });
+    expect(that % 4 == result.value().size());
+    expect(percent::from_ratio(1, 4) == samples[0]);
+    expect(percent::from_ratio(4, 4) == samples[3]);
+  };
+
+  "[adc] read block of fixed point"_test = []() {
+    // Setup
+    dummy_adc adc;
+    std::array<q15, 2> samples{};
+
+    // Exercise
+    auto result = read<q15>(adc, samples);
+
+    // Verify
+    expect(bool{ result });
+    expect(q15(percent::from_ratio(1, 4)) == samples[0]);
+    expect(q15(percent::from_ratio(2, 4)) == samples[1]);
+  };
+
+  "[adc] read block error"_test = []() {
+    // Setup
+    dummy_adc adc;
+    adc.m_fail_at = 2;
+    std::array<percent, 4> samples{};
+
+    // Exercise
+    auto result = read(adc, samples);
+
+    // Verify
+    expect(!result);
+    expect(that % 2 == adc.m_reads);
+  };
+};
+}  // namespace embed
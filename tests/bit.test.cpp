@@ -0,0 +1,218 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/bit.hpp>
+
+#include <array>
+
+namespace embed {
+namespace {
+static_assert(generate_field_of_ones<1, std::uint8_t>() == 0x01);
+static_assert(generate_field_of_ones<8, std::uint8_t>() == 0xFF);
+static_assert(generate_field_of_ones<32, std::uint32_t>() == 0xFFFF'FFFF);
+static_assert(generate_field_of_ones<40, std::uint64_t>() == 0xFF'FFFF'FFFF);
+static_assert(generate_field_of_ones<64, std::uint64_t>() == UINT64_MAX);
+static_assert(bit_limits<12, std::int16_t>::max() == 2047);
+static_assert(bit_limits<12, std::int16_t>::min() == -2048);
+static_assert(bit_limits<12, std::uint16_t>::max() == 4095);
+static_assert(bit_limits<12, std::uint16_t>::min() == 0);
+static_assert(bit_limits<32, std::int32_t>::max() == INT32_MAX);
+static_assert(bit_limits<32, std::int32_t>::min() == INT32_MIN);
+static_assert(bit_limits<64, std::int64_t>::max() == INT64_MAX);
+static_assert(bit_limits<64, std::int64_t>::min() == INT64_MIN);
+static_assert(bit_limits<64, std::uint64_t>::max() == UINT64_MAX);
+
+static_assert(bit_mask<std::uint32_t>(0) == 0);
+static_assert(bit_mask<std::uint32_t>(12) == 0xFFF);
+static_assert(bit_mask<std::uint32_t>(32) == 0xFFFF'FFFF);
+
+static_assert(bit_extract<4, 8>(std::uint32_t{ 0x1234'5678 }) == 0x67);
+static_assert(bit_extract<0, 32>(std::uint32_t{ 0x1234'5678 }) == 0x1234'5678);
+static_assert(bit_extract(std::uint16_t{ 0xABCD }, 12, 4) == 0xA);
+static_assert(bit_insert<8, 4>(std::uint32_t{ 0xFFFF'FFFF }, 0x15) ==
+              0xFFFF'F5FF);
+static_assert(bit_insert(std::uint8_t{ 0x00 }, 0xFF, 2, 3) == 0b0001'1100);
+
+static_assert(sign_extend<12>(std::uint16_t{ 0x0FFF }) == -1);
+static_assert(sign_extend<12>(std::uint16_t{ 0x0800 }) == -2048);
+static_assert(sign_extend<12>(std::uint16_t{ 0x07FF }) == 2047);
+static_assert(sign_extend<12>(std::uint16_t{ 0xF07F }) == 127);
+static_assert(sign_extend<24>(std::uint32_t{ 0x80'0000 }) == -8'388'608);
+static_assert(sign_extend<64>(UINT64_MAX) == -1);
+
+static_assert(byteswap(std::uint8_t{ 0x12 }) == 0x12);
+static_assert(byteswap(std::uint16_t{ 0x1234 }) == 0x3412);
+static_assert(byteswap(std::uint32_t{ 0x1234'5678 }) == 0x7856'3412);
+static_assert(byteswap(std::uint64_t{ 0x0102'0304'0506'0708 }) ==
+              0x0807'0605'0403'0201);
+static_assert(byteswap(std::int16_t{ 0x00FF }) == std::int16_t{ -256 });
+static_assert(to_endian<std::endian::native>(std::uint32_t{ 0x1234 }) ==
+              0x1234);
+
+static_assert(reverse_bits(std::uint8_t{ 0b0000'0001 }) == 0b1000'0000);
+static_assert(reverse_bits(std::uint8_t{ 0b1100'1010 }) == 0b0101'0011);
+static_assert(reverse_bits(std::uint16_t{ 0x0001 }) == 0x8000);
+static_assert(reverse_bits(std::uint32_t{ 0x0000'00F1 }) == 0x8F00'0000);
+static_assert(reverse_bits(std::uint64_t{ 0x1 }) == 0x8000'0000'0000'0000);
+
+constexpr std::array<std::byte, 4> register_bytes{ std::byte{ 0x12 },
+                                                   std::byte{ 0x34 },
+                                                   std::byte{ 0x56 },
+                                                   std::byte{ 0x78 } };
+static_assert(from_bytes<std::uint32_t>(std::span(register_bytes)) ==
+              0x1234'5678);
+static_assert(from_bytes<std::uint32_t, std::endian::little>(
+                std::span(register_bytes)) == 0x7856'3412);
+static_assert(from_bytes<std::int16_t>(std::span(register_bytes).first<2>()) ==
+              0x1234);
+}  // namespace
+
+boost::ut::suite bit_test = []() {
+  using namespace boost::ut;
+
+  "[bit] runtime operations"_test = []() {
+    // Setup
+    volatile std::uint32_t value = 0x8765'4321;
+    volatile size_t position = 8;
+    volatile size_t width = 12;
+
+    // Exercise + Verify
+    expect(that % 0x543 ==
+           bit_extract(std::uint32_t{ value }, position, width));
+    expect(that % 0x876A'BC21 ==
+           bit_insert(std::uint32_t{ value }, 0xABC, position, width));
+    expect(that % 0x2143'6587 == byteswap(std::uint32_t{ value }));
+    expect(that % 0x84C2'A6E1 == reverse_bits(std::uint32_t{ value }));
+    expect(that % -1 == sign_extend<8>(std::uint32_t{ 0x1FF }));
+  };
+
+  "[bit] to_bytes"_test = []() {
+    // Setup
+    std::array<std::byte, 4> bytes{};
+
+    // Exercise
+    to_bytes(std::uint32_t{ 0x1234'5678 }, std::span(bytes));
+
+    // Verify
+    expect(bytes == register_bytes);
+
+    // Exercise
+    to_bytes<std::endian::little>(std::int16_t{ 0x1234 },
+                                  std::span(bytes).first<2>());
+
+    // Verify
+    expect(std::byte{ 0x34 } == bytes[0]);
+    expect(std::byte{ 0x12 } == bytes[1]);
+  };
+
+  "[bit] unpack 12-bit msb first"_test = []() {
+    // Setup
+    // 0x123, 0x456, 0x789, 0xABC, 0xDEF
+    const std::array<std::byte, 8> packed{
+      std::byte{ 0x12 }, std::byte{ 0x34 }, std::byte{ 0x56 },
+      std::byte{ 0x78 }, std::byte{ 0x9A }, std::byte{ 0xBC },
+      std::byte{ 0xDE }, std::byte{ 0xF0 },
+    };
+    std::array<std::uint16_t, 8> output{};
+
+    // Exercise
+    auto result = unpack_bits<12, std::uint16_t>(packed, output);
+
+    // Verify
+    expect(that % 5 == result.size());
+    expect(that % 0x123 == output[0]);
+    expect(that % 0x456 == output[1]);
+    expect(that % 0x789 == output[2]);
+    expect(that % 0xABC == output[3]);
+    expect(that % 0xDEF == output[4]);
+    expect(that % 0 == output[5]);
+  };
+
+  "[bit] unpack signed"_test = []() {
+    // Setup
+    // -1, 2047, -2048, 1
+    const std::array<std::byte, 6> packed{
+      std::byte{ 0xFF }, std::byte{ 0xF7 }, std::byte{ 0xFF },
+      std::byte{ 0x80 }, std::byte{ 0x00 }, std::byte{ 0x01 },
+    };
+    std::array<std::int16_t, 4> output{};
+
+    // Exercise
+    auto result = unpack_bits<12, std::int16_t>(packed, output);
+
+    // Verify
+    expect(that % 4 == result.size());
+    expect(that % -1 == output[0]);
+    expect(that % 2047 == output[1]);
+    expect(that % -2048 == output[2]);
+    expect(that % 1 == output[3]);
+  };
+
+  "[bit] unpack limited by output"_test = []() {
+    // Setup
+    const std::array<std::byte, 6> packed{};
+    std::array<std::uint16_t, 3> output{ 1, 1, 1 };
+
+    // Exercise
+    auto result = unpack_bits<12, std::uint16_t>(packed, output);
+
+    // Verify
+    expect(that % 3 == result.size());
+    expect(that % 0 == output[2]);
+  };
+
+  "[bit] pack and unpack round trip"_test = []() {
+    // Setup
+    constexpr size_t count = 23;
+    std::array<std::uint32_t, count> input{};
+    for (size_t i = 0; i < count; i++) {
+      input[i] = static_cast<std::uint32_t>(i * 0x9E37'79B9U);
+    }
+
+    auto round_trip = [&input]<size_t Width, bit_order Order>() {
+      std::array<std::byte, count * 4> packed{};
+      std::array<std::uint32_t, count> output{};
+      auto written = pack_bits<Width, std::uint32_t, Order>(input, packed);
+      auto unpacked =
+        unpack_bits<Width, std::uint32_t, Order>(written, output);
+
+      bool match = unpacked.size() == count;
+      for (size_t i = 0; i < count; i++) {
+        const auto expected = input[i] & bit_mask<std::uint32_t>(Width);
+        match = match && (output[i] == expected);
+      }
+      return match && written.size() == (count * Width + 7) / 8;
+    };
+
+    // Exercise + Verify
+    expect(round_trip.operator()<1, bit_order::msb_first>());
+    expect(round_trip.operator()<7, bit_order::msb_first>());
+    expect(round_trip.operator()<10, bit_order::msb_first>());
+    expect(round_trip.operator()<11, bit_order::msb_first>());
+    expect(round_trip.operator()<12, bit_order::msb_first>());
+    expect(round_trip.operator()<24, bit_order::msb_first>());
+    expect(round_trip.operator()<32, bit_order::msb_first>());
+    expect(round_trip.operator()<1, bit_order::lsb_first>());
+    expect(round_trip.operator()<7, bit_order::lsb_first>());
+    expect(round_trip.operator()<10, bit_order::lsb_first>());
+    expect(round_trip.operator()<11, bit_order::lsb_first>());
+    expect(round_trip.operator()<12, bit_order::lsb_first>());
+    expect(round_trip.operator()<24, bit_order::lsb_first>());
+    expect(round_trip.operator()<32, bit_order::lsb_first>());
+  };
+
+  "[bit] pack 12-bit lsb first"_test = []() {
+    // Setup
+    const std::array<std::uint16_t, 2> input{ 0x123, 0x456 };
+    std::array<std::byte, 4> packed{};
+
+    // Exercise
+    auto written = pack_bits<12, std::uint16_t, bit_order::lsb_first>(input,
+                                                                      packed);
+
+    // Verify
+    expect(that % 3 == written.size());
+    expect(std::byte{ 0x23 } == packed[0]);
+    expect(std::byte{ 0x61 } == packed[1]);
+    expect(std::byte{ 0x45 } == packed[2]);
+  };
+};
+}  // namespace embed
@@ -0,0 +1,70 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/block_device/file.hpp>
+
+#include <filesystem>
+#include <vector>
+
+namespace embed {
+boost::ut::suite file_block_device_test = []() {
+  using namespace boost::ut;
+
+  const auto path =
+    std::filesystem::temp_directory_path() / "libembeddedhal_block_device.img";
+
+  "[file_block_device] read, write and erase"_test = [&path]() {
+    // Setup
+    std::filesystem::remove(path);
+    std::vector<std::byte> data(3 * 512);
+    for (size_t i = 0; i < data.size(); i++) {
+      data[i] = static_cast<std::byte>(i);
+    }
+    std::vector<std::byte> read_back(6 * 512);
+
+    {
+      file_block_device device(path.c_str(), { .block_count = 16 });
+
+      // Exercise
+      expect(bool(device.write(2, data)));
+      expect(bool(device.erase(3, 1)));
+      expect(bool(device.read(0, read_back)));
+      expect(bool(device.flush()));
+
+      // Verify
+      expect(std::byte{ 0xFF } == read_back[0]);
+      expect(std::byte{ 0xFF } == read_back[2 * 512 - 1]);
+      expect(std::equal(data.begin(), data.begin() + 512, &read_back[1024]));
+      expect(std::byte{ 0xFF } == read_back[3 * 512]);
+      expect(std::byte{ 0xFF } == read_back[4 * 512 - 1]);
+      expect(std::equal(data.begin() + 1024, data.end(), &read_back[2048]));
+      expect(std::byte{ 0xFF } == read_back[5 * 512]);
+      expect(that % 1 == device.stats().writes);
+      expect(that % 3 == device.stats().blocks_written);
+      expect(that % 1 == device.stats().blocks_erased);
+      expect(that % 6 == device.stats().blocks_read);
+      expect(!device.write(15, data));
+    }
+
+    // Exercise
+    // Contents persist when the image is reopened
+    file_block_device reopened(path.c_str(), { .block_count = 16 });
+    std::vector<std::byte> persisted(512);
+    expect(bool(reopened.read(4, persisted)));
+
+    // Verify
+    expect(std::equal(persisted.begin(), persisted.end(), data.begin() + 1024));
+    std::filesystem::remove(path);
+  };
+
+  "[file_block_device] unopenable file"_test = []() {
+    // Setup
+    file_block_device device("/nonexistent/directory/image",
+                             { .block_count = 4 });
+    std::vector<std::byte> buffer(512);
+
+    // Exercise + Verify
+    expect(!device.read(0, buffer));
+    expect(!device.write(0, buffer));
+    expect(!device.flush());
+  };
+};
+}  // namespace embed
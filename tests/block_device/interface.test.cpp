@@ -0,0 +1 @@
+#include <libembeddedhal/block_device/interface.hpp>
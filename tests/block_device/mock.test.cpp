@@ -0,0 +1,80 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/block_device/mock.hpp>
+
+namespace embed {
+boost::ut::suite block_device_mock_test = []() {
+  using namespace boost::ut;
+
+  "[block_device] validation"_test = []() {
+    // Setup
+    embed::mock::block_device mock({ .block_size = 16,
+                                     .block_count = 8,
+                                     .erase_block_count = 4,
+                                     .erase_before_write = true });
+    std::array<std::byte, 32> buffer{};
+
+    // Exercise + Verify
+    expect(!mock.read(0, std::span(buffer).first(15)));
+    expect(!mock.read(7, buffer));
+    expect(!mock.write(9, std::span(buffer).first(16)));
+    expect(!mock.erase(2, 4));
+    expect(!mock.erase(0, 2));
+    expect(!mock.erase(4, 8));
+    expect(!mock.read_async(7, buffer, [](bool) {}));
+    expect(that % 0 == mock.spy_read.call_history().size());
+    expect(that % 0 == mock.spy_write.call_history().size());
+    expect(that % 0 == mock.spy_erase.call_history().size());
+
+    expect(bool(mock.read(6, buffer)));
+    expect(bool(mock.write(8, std::span(buffer).first(0))));
+    expect(bool(mock.erase(4, 4)));
+  };
+
+  "[block_device] read, write and erase"_test = []() {
+    // Setup
+    embed::mock::block_device mock({ .block_size = 4, .block_count = 4 });
+    const std::array<std::byte, 8> data{
+      std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 }, std::byte{ 4 },
+      std::byte{ 5 }, std::byte{ 6 }, std::byte{ 7 }, std::byte{ 8 },
+    };
+    std::array<std::byte, 12> read_back{};
+    bool completed = false;
+
+    // Exercise
+    expect(bool(mock.write(1, data)));
+    expect(bool(mock.read_async(0, read_back, [&completed](bool p_success) {
+      completed = p_success;
+    })));
+
+    // Verify
+    expect(completed);
+    expect(std::byte{ 0xFF } == read_back[0]);
+    expect(std::byte{ 1 } == read_back[4]);
+    expect(std::byte{ 8 } == read_back[11]);
+    expect(that % 1 == std::get<0>(mock.spy_write.call_history()[0]));
+    expect(that % 2 == std::get<1>(mock.spy_write.call_history()[0]));
+    expect(that % 3 == std::get<1>(mock.spy_read.call_history()[0]));
+
+    // Exercise
+    expect(bool(mock.erase(1, 1)));
+
+    // Verify
+    expect(std::byte{ 0xFF } == mock.storage[4]);
+    expect(std::byte{ 5 } == mock.storage[8]);
+  };
+
+  "[block_device] errors"_test = []() {
+    // Setup
+    embed::mock::block_device mock;
+    std::array<std::byte, 512> buffer{};
+    bool completed = true;
+    mock.spy_write.trigger_error_on_call(1);
+
+    // Exercise + Verify
+    expect(bool(mock.write_async(0, buffer, [&completed](bool p_success) {
+      completed = p_success;
+    })));
+    expect(!completed);
+  };
+};
+}  // namespace embed
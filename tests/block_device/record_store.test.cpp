@@ -0,0 +1,315 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/block_device/mock.hpp>
+#include <libembeddedhal/block_device/record_store.hpp>
+#include <libembeddedhal/static_memory_resource.hpp>
+
+#include <map>
+
+namespace embed {
+boost::ut::suite record_store_test = []() {
+  using namespace boost::ut;
+
+  static constexpr block_device::properties geometry{
+    .block_size = 128,
+    .block_count = 64,
+    .erase_block_count = 4,
+    .erase_before_write = true,
+  };
+  static constexpr record_store::settings settings{
+    .segment_blocks = 8,
+    .max_keys = 16,
+  };
+
+  auto value_of = [](std::uint8_t p_seed, size_t p_size) {
+    std::vector<std::byte> value(p_size);
+    for (size_t i = 0; i < p_size; i++) {
+      value[i] = std::byte(static_cast<std::uint8_t>(p_seed + i));
+    }
+    return value;
+  };
+
+  auto read = [](record_store& p_store, record_store::key_t p_key) {
+    std::array<std::byte, 128> buffer{};
+    auto value = p_store.get(p_key, buffer);
+    if (!value) {
+      return std::vector<std::byte>{};
+    }
+    return std::vector<std::byte>(value.value().begin(), value.value().end());
+  };
+
+  "[record_store] put, get and remount"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    static_memory_resource<2048> remount_memory;
+    record_store store(device, memory, settings);
+    record_store remounted(device, remount_memory, settings);
+    expect(bool(store.format()));
+
+    // Exercise
+    expect(bool(store.put(1, value_of(10, 4))));
+    expect(bool(store.put(2, value_of(20, 40))));
+    expect(bool(store.put(1, value_of(30, 8))));
+    expect(bool(store.put(3, {})));
+    expect(bool(store.commit()));
+    expect(bool(remounted.mount()));
+
+    // Verify
+    for (auto* instance : { &store, &remounted }) {
+      expect(that % 3 == instance->size());
+      expect(value_of(30, 8) == read(*instance, 1));
+      expect(value_of(20, 40) == read(*instance, 2));
+      expect(instance->contains(3));
+      expect(!instance->contains(4));
+    }
+    // Four records fit into a single block written by the commit
+    expect(that % 1 == store.stats().blocks_written);
+    expect(that % 4 == store.stats().records_written);
+    expect(that % 52 == store.stats().bytes_written);
+    expect(that % 1 == device.spy_flush.call_history().size());
+  };
+
+  "[record_store] remove"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    static_memory_resource<2048> remount_memory;
+    record_store store(device, memory, settings);
+    record_store remounted(device, remount_memory, settings);
+    expect(bool(store.format()));
+    expect(bool(store.put(1, value_of(10, 4))));
+    expect(bool(store.put(2, value_of(20, 4))));
+    expect(bool(store.commit()));
+
+    // Exercise
+    expect(bool(store.remove(1)));
+    expect(bool(store.remove(7)));
+    expect(bool(store.commit()));
+    expect(bool(remounted.mount()));
+
+    // Verify
+    expect(!store.contains(1));
+    expect(!remounted.contains(1));
+    expect(value_of(20, 4) == read(remounted, 2));
+    expect(that % 1 == remounted.size());
+  };
+
+  "[record_store] uncommitted batch is discarded"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    static_memory_resource<2048> remount_memory;
+    record_store store(device, memory, settings);
+    record_store remounted(device, remount_memory, settings);
+    expect(bool(store.format()));
+    expect(bool(store.put(1, value_of(10, 4))));
+    expect(bool(store.commit()));
+
+    // Exercise
+    // Large enough values that the batch spans several written blocks, then
+    // remount as if power was lost before the commit.
+    for (record_store::key_t key = 2; key < 8; key++) {
+      expect(bool(store.put(key, value_of(0, 100))));
+    }
+    expect(bool(store.put(1, value_of(50, 4))));
+    expect(bool(remounted.mount()));
+
+    // Verify
+    expect(store.stats().blocks_written > 5);
+    expect(that % 7 == store.size());
+    expect(value_of(50, 4) == read(store, 1));
+    expect(that % 1 == remounted.size());
+    expect(value_of(10, 4) == read(remounted, 1));
+  };
+
+  "[record_store] corrupted block ends the log"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    static_memory_resource<2048> remount_memory;
+    record_store store(device, memory, settings);
+    record_store remounted(device, remount_memory, settings);
+    expect(bool(store.format()));
+    expect(bool(store.put(1, value_of(10, 4))));
+    expect(bool(store.commit()));
+    expect(bool(store.put(1, value_of(20, 4))));
+    expect(bool(store.commit()));
+
+    // Exercise
+    // Flip a bit of the value in the second block, as a torn write would
+    const auto second_block = device.spy_write.call_history().at(1);
+    device.storage[std::get<0>(second_block) * geometry.block_size + 30] ^=
+      std::byte{ 0x01 };
+    expect(bool(remounted.mount()));
+
+    // Verify
+    expect(value_of(10, 4) == read(remounted, 1));
+  };
+
+  "[record_store] compaction reclaims superseded records"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    static_memory_resource<2048> remount_memory;
+    record_store store(device, memory, settings);
+    record_store remounted(device, remount_memory, settings);
+    std::map<record_store::key_t, std::vector<std::byte>> expected;
+    expect(bool(store.format()));
+    device.reset();
+
+    // Exercise
+    // Write 40 times the capacity of the device
+    for (std::uint32_t i = 0; i < 2000; i++) {
+      const record_store::key_t key = (i * 7) % 12;
+      auto value = value_of(static_cast<std::uint8_t>(i), 1 + (i % 60));
+      expect(bool(store.put(key, value)));
+      expected[key] = value;
+      if (i % 5 == 0) {
+        expect(bool(store.commit()));
+      }
+      if (i % 3 == 0) {
+        expect(bool(store.remove(static_cast<record_store::key_t>(i % 11))));
+        expected.erase(static_cast<record_store::key_t>(i % 11));
+      }
+    }
+    expect(bool(store.commit()));
+    expect(bool(remounted.mount()));
+
+    // Verify
+    expect(store.stats().compactions > 0);
+    expect(store.free_segments() >= 1);
+    for (auto* instance : { &store, &remounted }) {
+      expect(that % expected.size() == instance->size());
+      for (const auto& [key, value] : expected) {
+        expect(value == read(*instance, key));
+      }
+    }
+
+    // Segments are used in turn, so every segment is erased equally often
+    std::map<std::uint64_t, int> erases;
+    for (const auto& [block, count] : device.spy_erase.call_history()) {
+      expect(that % settings.segment_blocks == count);
+      erases[block]++;
+    }
+    expect(that % 8 == erases.size());
+    const auto [least, most] = std::minmax_element(
+      erases.begin(), erases.end(), [](const auto& p_a, const auto& p_b) {
+        return p_a.second < p_b.second;
+      });
+    expect(that % 1 >= most->second - least->second);
+  };
+
+  "[record_store] compaction never commits part of a batch"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    static_memory_resource<2048> remount_memory;
+    static_memory_resource<2048> crash_memory;
+    record_store store(device, memory, settings);
+    record_store remounted(device, remount_memory, settings);
+    record_store crashed(device, crash_memory, settings);
+    std::map<record_store::key_t, std::vector<std::byte>> committed;
+    expect(bool(store.format()));
+
+    // Fill the log with committed records until the next batch must compact
+    for (std::uint32_t i = 0; store.free_segments() > 1; i++) {
+      const record_store::key_t key = i % 5;
+      auto value = value_of(static_cast<std::uint8_t>(i), 60);
+      expect(bool(store.put(key, value)));
+      expect(bool(store.commit()));
+      committed[key] = value;
+    }
+    const auto compactions = store.stats().compactions;
+
+    // Exercise
+    // Lose power in the middle of a batch that runs out of free segments
+    for (std::uint32_t i = 0; i < 30; i++) {
+      const record_store::key_t key = 2 + (i % 3);
+      if (!store.put(key, value_of(200, 60))) {
+        break;
+      }
+    }
+    expect(bool(remounted.mount()));
+
+    // Lose power while compacting
+    device.spy_write.trigger_error_on_call(2);
+    expect(bool(crashed.mount()));
+    while (crashed.put(1, value_of(100, 60))) {
+    }
+    device.spy_write.trigger_error_on_call(0);
+    expect(bool(remounted.mount()));
+
+    // Verify
+    expect(store.stats().compactions > compactions);
+    expect(that % committed.size() == remounted.size());
+    for (const auto& [key, value] : committed) {
+      expect(value == read(remounted, key));
+    }
+  };
+
+  "[record_store] background compaction"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    record_store store(device, memory, settings);
+    expect(bool(store.format()));
+
+    // Exercise
+    auto idle = store.compact();
+    for (std::uint32_t i = 0; store.free_segments() > 2; i++) {
+      expect(bool(store.put(i % 4, value_of(0, 100))));
+    }
+    expect(bool(store.commit()));
+    const auto compactions = store.stats().compactions;
+    auto reclaimed = store.compact();
+
+    // Verify
+    expect(bool(idle));
+    expect(!idle.value());
+    expect(that % 0 == compactions);
+    expect(bool(reclaimed));
+    expect(reclaimed.value());
+    expect(that % 1 == store.stats().compactions);
+    expect(that % 3 == store.free_segments());
+    expect(that % 4 == store.size());
+  };
+
+  "[record_store] limits"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    record_store store(device, memory, { .max_keys = 2 });
+    std::array<std::byte, 2> small{};
+    expect(bool(store.format()));
+
+    // Exercise + Verify
+    expect(that % 100 == store.max_value_size());
+    expect(!store.put(1, value_of(0, 101)));
+    expect(bool(store.put(1, value_of(0, 100))));
+    expect(bool(store.put(2, value_of(0, 4))));
+    expect(!store.put(3, value_of(0, 4)));
+    expect(bool(store.put(2, value_of(0, 8))));
+    expect(!store.get(2, small));
+    expect(!store.get(3, small));
+    expect(that % 2 == store.size());
+  };
+
+  "[record_store] geometry"_test = [&]() {
+    // Setup
+    mock::block_device device(geometry);
+    static_memory_resource<2048> memory;
+    record_store misaligned(
+      device, memory, { .segment_blocks = 6, .max_keys = 4 });
+    record_store too_few(
+      device, memory, { .segment_blocks = 32, .max_keys = 4 });
+    record_store no_reserve(
+      device, memory, { .max_keys = 4, .reserve_segments = 0 });
+
+    // Exercise + Verify
+    expect(!misaligned.mount());
+    expect(!too_few.mount());
+    expect(!no_reserve.mount());
+    expect(!no_reserve.format());
+  };
+};
+}  // namespace embed
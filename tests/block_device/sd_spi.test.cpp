@@ -0,0 +1,484 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/block_device/sd_spi.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace embed {
+namespace {
+struct chip_select_pin : public embed::output_pin
+{
+  bool high = true;
+
+private:
+  boost::leaf::result<void> driver_configure(
+    [[maybe_unused]] const settings& p_settings) noexcept override
+  {
+    return {};
+  }
+  boost::leaf::result<void> driver_level(bool p_high) noexcept override
+  {
+    high = p_high;
+    return {};
+  }
+  boost::leaf::result<bool> driver_level() noexcept override { return high; }
+};
+
+/**
+ * @brief Byte level emulation of an SDHC or MMC card in SPI mode
+ *
+ */
+struct emulated_sd_card : public embed::spi
+{
+  static constexpr size_t block_size = 512;
+
+  emulated_sd_card(chip_select_pin& p_chip_select, std::uint32_t p_c_size)
+    : chip_select(&p_chip_select)
+    , storage((p_c_size + 1) * 1024 * block_size, std::byte{ 0 })
+  {
+    // CSD version 2.0 with C_SIZE in bits 69:48
+    csd[0] = 0x40;
+    csd[7] = static_cast<std::uint8_t>((p_c_size >> 16) & 0x3F);
+    csd[8] = static_cast<std::uint8_t>(p_c_size >> 8);
+    csd[9] = static_cast<std::uint8_t>(p_c_size);
+  }
+
+  /// Set bits p_msb to p_lsb of the 128-bit big endian CSD register
+  void csd_field(size_t p_msb, size_t p_lsb, std::uint32_t p_value)
+  {
+    for (size_t bit = p_lsb; bit <= p_msb; bit++) {
+      auto& byte = csd[15 - bit / 8];
+      const auto mask = static_cast<std::uint8_t>(1U << (bit % 8));
+      byte = static_cast<std::uint8_t>(byte & ~mask);
+      if (((p_value >> (bit - p_lsb)) & 1U) != 0) {
+        byte = static_cast<std::uint8_t>(byte | mask);
+      }
+    }
+  }
+
+  chip_select_pin* chip_select;
+  std::vector<std::byte> storage;
+  std::array<std::uint8_t, 16> csd{};
+  /// Every command received, in order
+  std::vector<std::uint8_t> commands;
+  /// Number of bytes clocked with the card selected
+  size_t bus_bytes = 0;
+  /// Number of ACMD41, or CMD1 for MMC, before the card leaves the idle state
+  int idle_attempts = 3;
+  /// An MMC card rejects the SD commands CMD8, CMD55 and ACMD41
+  bool mmc = false;
+  bool crc_error = false;
+  /// A missing card never drives its data out line
+  bool present = true;
+  std::vector<settings> configurations;
+
+private:
+  enum class mode
+  {
+    command,
+    read_multiple,
+    write_single,
+    write_multiple,
+  };
+
+  boost::leaf::result<void> driver_configure(
+    const settings& p_settings) noexcept override
+  {
+    configurations.push_back(p_settings);
+    return {};
+  }
+
+  boost::leaf::result<void> driver_transfer(
+    std::span<const std::byte> p_data_out,
+    std::span<std::byte> p_data_in,
+    std::byte p_filler) noexcept override
+  {
+    const size_t length = std::max(p_data_out.size(), p_data_in.size());
+    for (size_t i = 0; i < length; i++) {
+      const auto out = i < p_data_out.size() ? p_data_out[i] : p_filler;
+      const auto in = exchange(std::to_integer<std::uint8_t>(out));
+      if (i < p_data_in.size()) {
+        p_data_in[i] = std::byte{ in };
+      }
+    }
+    return {};
+  }
+
+  std::uint8_t exchange(std::uint8_t p_out)
+  {
+    if (chip_select->high || !present) {
+      return 0xFF;
+    }
+    bus_bytes++;
+
+    if (m_responses.empty() && m_mode == mode::read_multiple) {
+      queue_block(m_block++);
+    }
+    std::uint8_t in = 0xFF;
+    if (!m_responses.empty()) {
+      in = m_responses.front();
+      m_responses.pop_front();
+    }
+
+    if (m_mode == mode::write_single || m_mode == mode::write_multiple) {
+      receive_write(p_out);
+    } else if (!m_frame.empty() || (p_out & 0xC0) == 0x40) {
+      m_frame.push_back(p_out);
+      if (m_frame.size() == 6) {
+        handle_command();
+        m_frame.clear();
+      }
+    }
+    return in;
+  }
+
+  void receive_write(std::uint8_t p_out)
+  {
+    if (!m_receiving) {
+      if (p_out == 0xFE || (p_out == 0xFC && m_mode == mode::write_multiple)) {
+        m_receiving = true;
+        m_data.clear();
+      } else if (p_out == 0xFD && m_mode == mode::write_multiple) {
+        m_responses.insert(m_responses.end(), { 0xFF, 0x00, 0x00, 0xFF });
+        m_mode = mode::command;
+      }
+      return;
+    }
+
+    m_data.push_back(std::byte{ p_out });
+    if (m_data.size() == block_size + 2) {
+      std::copy_n(m_data.begin(), block_size, block(m_block++));
+      m_receiving = false;
+      // Data accepted, then busy while programming
+      m_responses.insert(m_responses.end(), { 0xE5, 0x00, 0x00, 0xFF });
+      if (m_mode == mode::write_single) {
+        m_mode = mode::command;
+      }
+    }
+  }
+
+  void handle_command()
+  {
+    const std::uint8_t command = m_frame[0] & 0x3F;
+    const std::uint32_t argument = static_cast<std::uint32_t>(
+      m_frame[1] << 24 | m_frame[2] << 16 | m_frame[3] << 8 | m_frame[4]);
+    commands.push_back(command);
+
+    if ((command == 0 && m_frame[5] != 0x95) ||
+        (command == 8 && m_frame[5] != 0x87)) {
+      crc_error = true;
+    }
+
+    // Responses are delayed by a byte to exercise polling
+    m_responses.push_back(0xFF);
+    const std::uint8_t r1 = m_idle ? 0x01 : 0x00;
+
+    if (mmc && (command == 8 || command == 41 || command == 55)) {
+      m_responses.push_back(0x04 | r1);
+      return;
+    }
+
+    switch (command) {
+      case 0:
+        m_idle = true;
+        m_responses.push_back(0x01);
+        break;
+      case 1:
+        if (!mmc) {
+          m_responses.push_back(0x04 | r1);
+          break;
+        }
+        if (--idle_attempts <= 0) {
+          m_idle = false;
+        }
+        m_responses.push_back(m_idle ? 0x01 : 0x00);
+        break;
+      case 8:
+        m_responses.insert(m_responses.end(),
+                           { r1, 0x00, 0x00, 0x01, m_frame[4] });
+        break;
+      case 9:
+        m_responses.insert(m_responses.end(), { r1, 0xFF, 0xFE });
+        m_responses.insert(m_responses.end(), csd.begin(), csd.end());
+        m_responses.insert(m_responses.end(), { 0x00, 0x00 });
+        break;
+      case 12:
+        m_mode = mode::command;
+        m_responses.clear();
+        // Stuff byte, R1 and busy
+        m_responses.insert(m_responses.end(), { 0x3C, 0x00, 0x00, 0xFF });
+        break;
+      case 16:
+        m_responses.push_back(r1);
+        break;
+      case 17:
+        m_responses.push_back(r1);
+        queue_block(argument);
+        break;
+      case 18:
+        m_responses.push_back(r1);
+        m_block = argument;
+        m_mode = mode::read_multiple;
+        break;
+      case 24:
+        m_responses.push_back(r1);
+        m_block = argument;
+        m_mode = mode::write_single;
+        break;
+      case 25:
+        m_responses.push_back(r1);
+        m_block = argument;
+        m_mode = mode::write_multiple;
+        break;
+      case 32:
+        m_erase_start = argument;
+        m_responses.push_back(r1);
+        break;
+      case 33:
+        m_erase_end = argument;
+        m_responses.push_back(r1);
+        break;
+      case 38:
+        std::fill(block(m_erase_start), block(m_erase_end + 1), std::byte{ 0 });
+        m_responses.insert(m_responses.end(), { r1, 0x00, 0x00, 0xFF });
+        break;
+      case 41:
+        if (m_app_command && --idle_attempts <= 0) {
+          m_idle = false;
+        }
+        m_responses.push_back(m_idle ? 0x01 : 0x00);
+        break;
+      case 55:
+        m_responses.push_back(r1);
+        break;
+      case 58:
+        m_responses.insert(m_responses.end(), { r1, 0xC0, 0xFF, 0x80, 0x00 });
+        break;
+      default:
+        m_responses.push_back(0x04 | r1);
+        break;
+    }
+    m_app_command = command == 55;
+  }
+
+  void queue_block(std::uint32_t p_block)
+  {
+    if ((p_block + 1) * block_size > storage.size()) {
+      p_block = 0;
+    }
+    m_responses.insert(m_responses.end(), { 0xFF, 0xFE });
+    for (auto* byte = block(p_block); byte != block(p_block + 1); byte++) {
+      m_responses.push_back(std::to_integer<std::uint8_t>(*byte));
+    }
+    m_responses.insert(m_responses.end(), { 0x00, 0x00 });
+  }
+
+  std::byte* block(std::uint32_t p_block)
+  {
+    return storage.data() + p_block * block_size;
+  }
+
+  mode m_mode = mode::command;
+  std::vector<std::uint8_t> m_frame;
+  std::deque<std::uint8_t> m_responses;
+  std::vector<std::byte> m_data;
+  bool m_receiving = false;
+  bool m_idle = true;
+  bool m_app_command = false;
+  std::uint32_t m_block = 0;
+  std::uint32_t m_erase_start = 0;
+  std::uint32_t m_erase_end = 0;
+};
+
+std::vector<std::byte> pattern(size_t p_blocks, std::uint8_t p_seed)
+{
+  std::vector<std::byte> data(p_blocks * 512);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<std::byte>(i * 7 + p_seed);
+  }
+  return data;
+}
+
+size_t count(const std::vector<std::uint8_t>& p_commands, std::uint8_t p_id)
+{
+  return static_cast<size_t>(
+    std::count(p_commands.begin(), p_commands.end(), p_id));
+}
+}  // namespace
+
+boost::ut::suite sd_spi_test = []() {
+  using namespace boost::ut;
+
+  "[sd_spi] initialize"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 1);
+    sd_spi sd(card, chip_select);
+
+    // Exercise
+    expect(that % 0 == sd.info().value().block_count);
+    expect(bool(sd.initialize()));
+
+    // Verify
+    auto info = sd.info().value();
+    expect(that % 512 == info.block_size);
+    expect(that % 2048 == info.block_count);
+    expect(!info.erase_before_write);
+    expect(sd.high_capacity());
+    expect(!card.crc_error);
+    expect(chip_select.high);
+    expect(that % 2 == card.configurations.size());
+    expect(frequency(400'000) == card.configurations[0].clock_rate);
+    expect(frequency(25'000'000) == card.configurations[1].clock_rate);
+    expect(that % 0 == card.commands[0]);
+    expect(that % 8 == card.commands[1]);
+    expect(that % 3 == count(card.commands, 41));
+  };
+
+  "[sd_spi] initialize MMC"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 1);
+    sd_spi sd(card, chip_select);
+    card.mmc = true;
+    // MMC CSD version 1.2 describing a 1MiB card:
+    // (511 + 1) * 2^(0 + 2) * 2^9 bytes
+    card.csd.fill(0);
+    card.csd_field(127, 126, 2);
+    card.csd_field(83, 80, 9);
+    card.csd_field(73, 62, 511);
+    card.csd_field(49, 47, 0);
+
+    // Exercise
+    expect(bool(sd.initialize()));
+
+    // Verify
+    expect(that % 2048 == sd.info().value().block_count);
+    expect(!sd.high_capacity());
+    expect(that % 1 == count(card.commands, 41));
+    expect(that % 3 == count(card.commands, 1));
+    expect(that % 0 == count(card.commands, 58));
+    expect(that % 1 == count(card.commands, 16));
+    expect(chip_select.high);
+
+    // Cards over 2GB are not supported
+    card.csd_field(73, 62, 0xFFF);
+    card.idle_attempts = 1;
+    expect(!sd.initialize());
+    expect(that % 2 == count(card.commands, 9));
+  };
+
+  "[sd_spi] no card"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 0);
+    sd_spi sd(card, chip_select);
+    card.present = false;
+
+    // Exercise + Verify
+    expect(!sd.initialize());
+    expect(chip_select.high);
+  };
+
+  "[sd_spi] card stuck in idle"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 0);
+    sd_spi sd(card, chip_select, { .initialization_attempts = 5 });
+    card.idle_attempts = 100;
+
+    // Exercise + Verify
+    expect(!sd.initialize());
+    expect(that % 5 == count(card.commands, 41));
+    expect(chip_select.high);
+  };
+
+  "[sd_spi] single and multi-block read"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 0);
+    sd_spi sd(card, chip_select);
+    expect(bool(sd.initialize()));
+    const auto expected = pattern(8, 3);
+    std::copy(expected.begin(), expected.end(), card.storage.begin() + 512);
+    std::vector<std::byte> data(8 * 512);
+    card.commands.clear();
+
+    // Exercise + Verify
+    expect(bool(sd.read(1, std::span(data).first(512))));
+    expect(std::equal(data.begin(), data.begin() + 512, expected.begin()));
+    expect(bool(sd.read(1, data)));
+    expect(data == expected);
+    expect(card.commands == std::vector<std::uint8_t>{ 17, 18, 12 });
+    expect(chip_select.high);
+  };
+
+  "[sd_spi] streamed writes"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 0);
+    sd_spi sd(card, chip_select);
+    expect(bool(sd.initialize()));
+    const auto data = pattern(12, 9);
+    card.commands.clear();
+
+    // Exercise
+    // Appending one block at a time continues the same multi-block write
+    for (size_t block = 0; block < 8; block++) {
+      expect(bool(sd.write(
+        100 + block, std::span(data).subspan(block * 512, 512))));
+    }
+    expect(bool(sd.write(108, std::span(data).subspan(8 * 512))));
+    expect(bool(sd.flush()));
+
+    // Verify
+    expect(card.commands == std::vector<std::uint8_t>{ 25 });
+    expect(std::equal(data.begin(), data.end(), card.storage.begin() + 51200));
+    expect(chip_select.high);
+  };
+
+  "[sd_spi] non-consecutive write restarts stream"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 0);
+    sd_spi sd(card, chip_select);
+    expect(bool(sd.initialize()));
+    const auto first = pattern(1, 1);
+    const auto second = pattern(1, 2);
+    std::vector<std::byte> read_back(512);
+    card.commands.clear();
+
+    // Exercise
+    expect(bool(sd.write(10, first)));
+    expect(bool(sd.write(20, second)));
+    // A read stops the open write before reading
+    expect(bool(sd.read(10, read_back)));
+
+    // Verify
+    expect(card.commands == std::vector<std::uint8_t>{ 25, 25, 17 });
+    expect(read_back == first);
+    expect(std::equal(
+      second.begin(), second.end(), card.storage.begin() + 20 * 512));
+  };
+
+  "[sd_spi] erase"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_sd_card card(chip_select, 0);
+    sd_spi sd(card, chip_select);
+    expect(bool(sd.initialize()));
+    std::fill(card.storage.begin(), card.storage.end(), std::byte{ 0xAA });
+    card.commands.clear();
+
+    // Exercise
+    expect(bool(sd.erase(2, 3)));
+
+    // Verify
+    expect(card.commands == std::vector<std::uint8_t>{ 32, 33, 38 });
+    expect(std::byte{ 0xAA } == card.storage[2 * 512 - 1]);
+    expect(std::byte{ 0x00 } == card.storage[2 * 512]);
+    expect(std::byte{ 0x00 } == card.storage[5 * 512 - 1]);
+    expect(std::byte{ 0xAA } == card.storage[5 * 512]);
+  };
+};
+}  // namespace embed
@@ -0,0 +1,566 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/block_device/record_store.hpp>
+#include <libembeddedhal/block_device/spi_nor.hpp>
+#include <libembeddedhal/static_memory_resource.hpp>
+
+#include <vector>
+
+namespace embed {
+namespace {
+struct chip_select_pin : public embed::output_pin
+{
+  bool high = true;
+  /// Number of times chip select has been driven low
+  int selections = 0;
+
+private:
+  boost::leaf::result<void> driver_configure(
+    [[maybe_unused]] const settings& p_settings) noexcept override
+  {
+    return {};
+  }
+  boost::leaf::result<void> driver_level(bool p_high) noexcept override
+  {
+    if (high && !p_high) {
+      selections++;
+    }
+    high = p_high;
+    return {};
+  }
+  boost::leaf::result<bool> driver_level() noexcept override { return high; }
+};
+
+/**
+ * @brief Byte level emulation of a JEDEC serial NOR flash
+ *
+ * Time is measured in bytes clocked on the bus while the flash is selected,
+ * programs and erases keep the flash busy for a number of bytes. Commands
+ * other than read status sent while busy, and programs or erases without
+ * write enable, are counted as violations and ignored.
+ *
+ * Setting max_lanes above a single lane makes the emulation act as multi-lane
+ * spi hardware, recording each command transfer and memory mapping.
+ */
+struct emulated_nor_flash : public embed::spi
+{
+  emulated_nor_flash(chip_select_pin& p_chip_select,
+                     std::uint8_t p_capacity = 0x15)
+    : chip_select(&p_chip_select)
+    , storage(size_t{ 1 } << p_capacity, std::byte{ 0xFF })
+    , id{ 0xEF, 0x40, p_capacity }
+  {}
+
+  bool busy() const { return bus_bytes < m_busy_until; }
+
+  chip_select_pin* chip_select;
+  std::vector<std::byte> storage;
+  std::array<std::uint8_t, 3> id;
+  /// Opcode of every command received, in order
+  std::vector<std::uint8_t> commands;
+  /// Number of bytes clocked with the flash selected
+  size_t bus_bytes = 0;
+  /// Number of status register bytes read
+  size_t status_reads = 0;
+  /// Number of commands rejected by the flash
+  int violations = 0;
+  /// Bus bytes spent programming a page
+  size_t program_time = 64;
+  /// Bus bytes spent erasing
+  size_t erase_time = 256;
+  /// A missing flash never drives its data out line
+  bool present = true;
+  std::vector<settings> configurations;
+  /// Lanes reported by capabilities(), multi-lane transfers are recorded
+  lanes max_lanes = lanes::single;
+  std::vector<command_phases> command_transfers;
+  std::vector<command_phases> memory_maps;
+
+private:
+  capabilities_t driver_capabilities() noexcept override
+  {
+    return { .max_lanes = max_lanes,
+             .memory_mapped = max_lanes != lanes::single };
+  }
+
+  boost::leaf::result<void> driver_command_transfer(
+    const command_phases& p_phases,
+    std::span<const std::byte> p_data_out,
+    std::span<std::byte> p_data_in) noexcept override
+  {
+    command_transfers.push_back(p_phases);
+    for (size_t i = p_phases.command_bytes; i > 0; i--) {
+      exchange(static_cast<std::uint8_t>(p_phases.command >> (8 * (i - 1))));
+    }
+    for (size_t i = p_phases.address_bytes; i > 0; i--) {
+      exchange(static_cast<std::uint8_t>(p_phases.address >> (8 * (i - 1))));
+    }
+    for (size_t i = 0; i < p_phases.dummy_cycles / 8U; i++) {
+      exchange(0xFF);
+    }
+    return driver_transfer(p_data_out, p_data_in, std::byte{ 0xFF });
+  }
+
+  boost::leaf::result<std::span<const std::byte>> driver_memory_map(
+    const command_phases& p_read_phases) noexcept override
+  {
+    if (max_lanes == lanes::single) {
+      return boost::leaf::new_error(std::errc::not_supported);
+    }
+    memory_maps.push_back(p_read_phases);
+    return std::span<const std::byte>(storage);
+  }
+
+  boost::leaf::result<void> driver_configure(
+    const settings& p_settings) noexcept override
+  {
+    configurations.push_back(p_settings);
+    return {};
+  }
+
+  boost::leaf::result<void> driver_transfer(
+    std::span<const std::byte> p_data_out,
+    std::span<std::byte> p_data_in,
+    std::byte p_filler) noexcept override
+  {
+    const size_t length = std::max(p_data_out.size(), p_data_in.size());
+    for (size_t i = 0; i < length; i++) {
+      const auto out = i < p_data_out.size() ? p_data_out[i] : p_filler;
+      const auto in = exchange(std::to_integer<std::uint8_t>(out));
+      if (i < p_data_in.size()) {
+        p_data_in[i] = std::byte{ in };
+      }
+    }
+    return {};
+  }
+
+  std::uint8_t exchange(std::uint8_t p_out)
+  {
+    if (chip_select->high || !present) {
+      return 0xFF;
+    }
+    if (chip_select->selections != m_selection) {
+      m_selection = chip_select->selections;
+      m_index = 0;
+    }
+    bus_bytes++;
+    const size_t index = m_index++;
+    if (index == 0) {
+      start(p_out);
+      return 0xFF;
+    }
+    if (m_ignore) {
+      return 0xFF;
+    }
+    return respond(index, p_out);
+  }
+
+  void start(std::uint8_t p_opcode)
+  {
+    commands.push_back(p_opcode);
+    m_opcode = p_opcode;
+    m_address = 0;
+    m_ignore = busy() && p_opcode != 0x05;
+    if (m_ignore) {
+      violations++;
+    } else if (p_opcode == 0x06) {
+      m_write_enabled = true;
+    }
+  }
+
+  size_t address_bytes() const
+  {
+    switch (m_opcode) {
+      case 0x13:
+      case 0x0C:
+      case 0x3C:
+      case 0x6C:
+      case 0x12:
+      case 0x21:
+      case 0xDC:
+        return 4;
+      default:
+        return 3;
+    }
+  }
+
+  std::uint8_t respond(size_t p_index, std::uint8_t p_out)
+  {
+    const size_t header = 1 + address_bytes();
+    if (p_index < header) {
+      m_address = (m_address << 8U) | p_out;
+    }
+
+    switch (m_opcode) {
+      case 0x05:
+        status_reads++;
+        return static_cast<std::uint8_t>((busy() ? 0x01 : 0x00) |
+                                         (m_write_enabled ? 0x02 : 0x00));
+      case 0x9F:
+        return p_index <= id.size() ? id[p_index - 1] : 0xFF;
+      case 0x03:
+      case 0x13:
+        return data_out(p_index, header);
+      case 0x0B:
+      case 0x0C:
+      case 0x3B:
+      case 0x3C:
+      case 0x6B:
+      case 0x6C:
+        return data_out(p_index, header + 1);
+      case 0x02:
+      case 0x12:
+        if (p_index >= header) {
+          program(p_index - header, p_out);
+        }
+        return 0xFF;
+      case 0x20:
+      case 0x21:
+        erase_at(p_index, header, 4096);
+        return 0xFF;
+      case 0xD8:
+      case 0xDC:
+        erase_at(p_index, header, 65536);
+        return 0xFF;
+      default:
+        return 0xFF;
+    }
+  }
+
+  std::uint8_t data_out(size_t p_index, size_t p_header)
+  {
+    if (p_index < p_header) {
+      return 0xFF;
+    }
+    const size_t address = (m_address + p_index - p_header) % storage.size();
+    return std::to_integer<std::uint8_t>(storage[address]);
+  }
+
+  void program(size_t p_offset, std::uint8_t p_out)
+  {
+    if (p_offset == 0) {
+      if (!m_write_enabled) {
+        violations++;
+        m_ignore = true;
+        return;
+      }
+      m_write_enabled = false;
+    }
+    // Programming wraps within the page and can only clear bits
+    const size_t page = m_address & ~size_t{ 0xFF };
+    const size_t address = page | ((m_address + p_offset) & 0xFF);
+    storage[address % storage.size()] &= std::byte{ p_out };
+    m_busy_until = bus_bytes + program_time;
+  }
+
+  void erase_at(size_t p_index, size_t p_header, size_t p_size)
+  {
+    if (p_index != p_header - 1) {
+      return;
+    }
+    if (!m_write_enabled) {
+      violations++;
+      return;
+    }
+    m_write_enabled = false;
+    const size_t start = (m_address & ~(p_size - 1)) % storage.size();
+    std::fill_n(storage.begin() + static_cast<std::ptrdiff_t>(start),
+                p_size,
+                std::byte{ 0xFF });
+    m_busy_until = bus_bytes + erase_time;
+  }
+
+  int m_selection = 0;
+  size_t m_index = 0;
+  std::uint8_t m_opcode = 0;
+  size_t m_address = 0;
+  bool m_ignore = false;
+  bool m_write_enabled = false;
+  size_t m_busy_until = 0;
+};
+
+std::vector<std::byte> pattern(size_t p_size, std::uint8_t p_seed)
+{
+  std::vector<std::byte> data(p_size);
+  for (size_t i = 0; i < p_size; i++) {
+    data[i] = std::byte(static_cast<std::uint8_t>(p_seed + i * 7));
+  }
+  return data;
+}
+}  // namespace
+
+boost::ut::suite spi_nor_test = []() {
+  using namespace boost::ut;
+
+  "[spi_nor] initialize"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(flash, chip_select);
+
+    // Exercise
+    auto result = driver.initialize();
+    auto info = driver.info();
+
+    // Verify
+    expect(bool(result));
+    expect(chip_select.high);
+    expect(std::vector<std::uint8_t>{ 0xAB, 0x9F } == flash.commands);
+    expect(that % 1 == flash.configurations.size());
+    expect(frequency(50'000'000) == flash.configurations[0].clock_rate);
+    expect((std::array<std::byte, 3>{
+             std::byte{ 0xEF }, std::byte{ 0x40 }, std::byte{ 0x15 } }) ==
+           driver.jedec_id());
+    expect(that % (2 * 1024 * 1024) == driver.size());
+    expect(block_device::properties{ .block_size = 256,
+                                     .block_count = 8192,
+                                     .erase_block_count = 16,
+                                     .erase_before_write = true } ==
+           info.value());
+  };
+
+  "[spi_nor] missing or unknown flash"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash missing(chip_select);
+    emulated_nor_flash unknown(chip_select, 0x08);
+    missing.present = false;
+    spi_nor_flash missing_driver(missing, chip_select);
+    spi_nor_flash unknown_driver(unknown, chip_select);
+
+    // Exercise + Verify
+    expect(!missing_driver.initialize());
+    expect(!unknown_driver.initialize());
+    expect(that % 0 == missing_driver.size());
+  };
+
+  "[spi_nor] pipelined page programs"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(flash, chip_select);
+    const auto data = pattern(3 * 256, 1);
+    std::vector<std::byte> readback(data.size());
+    expect(bool(driver.initialize()));
+    flash.commands.clear();
+
+    // Exercise
+    auto write = driver.write(4, data);
+    const bool busy_after_write = flash.busy();
+    auto read = driver.read(4, readback);
+
+    // Verify
+    expect(bool(write));
+    expect(bool(read));
+    // The driver returns while the last page is being programmed and only
+    // waits before the next command.
+    expect(busy_after_write);
+    expect(that % 0 == flash.violations);
+    expect(std::vector<std::uint8_t>{
+             0x06, 0x02, 0x05, 0x06, 0x02, 0x05, 0x06, 0x02, 0x05, 0x0B } ==
+           flash.commands);
+    expect(data == readback);
+    expect(std::equal(data.begin(), data.end(), flash.storage.begin() + 1024));
+    // Every program is polled with a single read status command
+    expect(flash.status_reads <= 3 * flash.program_time);
+  };
+
+  "[spi_nor] read_at"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(flash, chip_select);
+    std::vector<std::byte> data(300);
+    std::array<std::byte, 2> tail{};
+    expect(bool(driver.initialize()));
+    const auto expected = pattern(flash.storage.size(), 3);
+    std::copy(expected.begin(), expected.end(), flash.storage.begin());
+    flash.commands.clear();
+    flash.bus_bytes = 0;
+
+    // Exercise
+    auto result = driver.read_at(1000, data);
+    auto beyond = driver.read_at(driver.size() - 1, tail);
+
+    // Verify
+    expect(bool(result));
+    expect(!beyond);
+    expect(std::equal(data.begin(), data.end(), expected.begin() + 1000));
+    // A single command: opcode, 3 address bytes, a dummy byte and the data
+    expect(std::vector<std::uint8_t>{ 0x0B } == flash.commands);
+    expect(that % (5 + data.size()) == flash.bus_bytes);
+  };
+
+  "[spi_nor] read without dummy cycles"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(flash,
+                         chip_select,
+                         { .clock_rate = frequency(33'000'000),
+                           .read = spi_nor_flash::read_mode::standard });
+    std::vector<std::byte> data(256);
+    expect(bool(driver.initialize()));
+    const auto expected = pattern(256, 9);
+    std::copy(expected.begin(), expected.end(), flash.storage.begin() + 512);
+    flash.commands.clear();
+
+    // Exercise
+    auto result = driver.read(2, data);
+
+    // Verify
+    expect(bool(result));
+    expect(expected == data);
+    expect(std::vector<std::uint8_t>{ 0x03 } == flash.commands);
+    expect(frequency(33'000'000) == flash.configurations[0].clock_rate);
+  };
+
+  "[spi_nor] quad output read"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    flash.max_lanes = spi::lanes::quad;
+    spi_nor_flash driver(
+      flash, chip_select, { .read = spi_nor_flash::read_mode::quad_output });
+    std::vector<std::byte> data(64);
+    expect(bool(driver.initialize()));
+    const auto expected = pattern(64, 4);
+    std::copy(expected.begin(), expected.end(), flash.storage.begin() + 0x300);
+    flash.commands.clear();
+
+    // Exercise
+    auto result = driver.read_at(0x300, data);
+    auto mapped = driver.memory_map();
+
+    // Verify
+    expect(bool(result));
+    expect(expected == data);
+    expect(spi_nor_flash::read_mode::quad_output == driver.active_read_mode());
+    expect(std::vector<std::uint8_t>{ 0x6B } == flash.commands);
+    const spi::command_phases quad_read{ .command = 0x6B,
+                                         .address = 0x300,
+                                         .address_bytes = 3,
+                                         .dummy_cycles = 8,
+                                         .data_lanes = spi::lanes::quad };
+    expect(quad_read == flash.command_transfers.back());
+    expect(bool(mapped));
+    expect(that % flash.storage.size() == mapped.value().size());
+    expect(that % 1 == flash.memory_maps.size());
+    expect(that % 0 == flash.memory_maps[0].address);
+    expect(spi::lanes::quad == flash.memory_maps[0].data_lanes);
+  };
+
+  "[spi_nor] multi-lane reads fall back on single lane spi"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(
+      flash, chip_select, { .read = spi_nor_flash::read_mode::dual_output });
+    std::vector<std::byte> data(16);
+    expect(bool(driver.initialize()));
+    flash.commands.clear();
+
+    // Exercise
+    auto result = driver.read_at(0, data);
+    auto mapped = driver.memory_map();
+
+    // Verify
+    expect(bool(result));
+    expect(!mapped);
+    expect(spi_nor_flash::read_mode::fast == driver.active_read_mode());
+    expect(std::vector<std::uint8_t>{ 0x0B } == flash.commands);
+  };
+
+  "[spi_nor] erase uses the largest erase command"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(flash, chip_select);
+    expect(bool(driver.initialize()));
+    std::fill(flash.storage.begin(), flash.storage.end(), std::byte{ 0 });
+    flash.commands.clear();
+
+    // Exercise
+    // One sector, then a whole 64kB block followed by a sector
+    auto sector = driver.erase(16, 16);
+    auto mixed = driver.erase(256, 272);
+    auto flush = driver.flush();
+
+    // Verify
+    expect(bool(sector));
+    expect(bool(mixed));
+    expect(bool(flush));
+    expect(!flash.busy());
+    expect(that % 0 == flash.violations);
+    expect(std::vector<std::uint8_t>{
+             0x06, 0x20, 0x05, 0x06, 0xD8, 0x05, 0x06, 0x20, 0x05 } ==
+           flash.commands);
+    auto erased = [&flash](size_t p_first, size_t p_last) {
+      return std::all_of(
+        flash.storage.begin() + p_first,
+        flash.storage.begin() + p_last,
+        [](std::byte p_byte) { return p_byte == std::byte{ 0xFF }; });
+    };
+    expect(erased(4096, 8192));
+    expect(erased(65536, 65536 + 69632));
+    expect(flash.storage[4095] == std::byte{ 0 });
+    expect(flash.storage[8192] == std::byte{ 0 });
+    expect(flash.storage[65536 + 69632] == std::byte{ 0 });
+  };
+
+  "[spi_nor] 4 byte addressing"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select, 0x19);
+    spi_nor_flash driver(flash, chip_select);
+    const auto data = pattern(256, 5);
+    std::vector<std::byte> readback(256);
+    expect(bool(driver.initialize()));
+    const std::uint64_t block = (std::uint64_t{ 24 } << 20U) / 256;
+    flash.commands.clear();
+
+    // Exercise
+    expect(bool(driver.erase(block, 16)));
+    expect(bool(driver.write(block, data)));
+    expect(bool(driver.read(block, readback)));
+
+    // Verify
+    expect(that % (32 * 1024 * 1024) == driver.size());
+    expect(that % 0 == flash.violations);
+    expect(std::vector<std::uint8_t>{
+             0x06, 0x21, 0x05, 0x06, 0x12, 0x05, 0x0C } == flash.commands);
+    expect(data == readback);
+    expect(std::equal(
+      data.begin(), data.end(), flash.storage.begin() + (24 << 20)));
+  };
+
+  "[spi_nor] record store on flash"_test = []() {
+    // Setup
+    chip_select_pin chip_select;
+    emulated_nor_flash flash(chip_select);
+    spi_nor_flash driver(flash, chip_select);
+    static_memory_resource<4096> memory;
+    static_memory_resource<4096> remount_memory;
+    record_store store(driver, memory, { .segment_blocks = 16, .max_keys = 8 });
+    record_store remounted(
+      driver, remount_memory, { .segment_blocks = 16, .max_keys = 8 });
+    const auto value = pattern(40, 11);
+    std::array<std::byte, 64> readback{};
+    expect(bool(driver.initialize()));
+
+    // Exercise
+    expect(bool(store.format()));
+    for (std::uint32_t i = 0; i < 100; i++) {
+      expect(bool(store.put(i % 8, value)));
+    }
+    expect(bool(store.commit()));
+    expect(bool(remounted.mount()));
+    auto result = remounted.get(5, readback);
+
+    // Verify
+    expect(that % 0 == flash.violations);
+    expect(that % 8 == remounted.size());
+    expect(bool(result));
+    expect(std::equal(value.begin(), value.end(), readback.begin()));
+  };
+};
+}  // namespace embed
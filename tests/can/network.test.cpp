@@ -1 +1,59 @@
+#include <boost/ut.hpp>
 #include <libembeddedhal/can/network.hpp>
+
+#include <array>
+
+namespace embed {
+namespace {
+struct fake_can : public embed::can
+{
+  boost::leaf::result<void> driver_configure(const settings&) noexcept override
+  {
+    return {};
+  }
+  boost::leaf::result<void> driver_send(const message_t&) noexcept override
+  {
+    return {};
+  }
+  boost::leaf::result<void> driver_attach_interrupt(
+    std::function<void(const message_t& p_message)> p_handler) noexcept
+    override
+  {
+    handler = p_handler;
+    return {};
+  }
+
+  std::function<void(const message_t& p_message)> handler{};
+};
+}  // namespace
+
+boost::ut::suite can_network_test = []() {
+  using namespace boost::ut;
+
+  "[can_network] routes messages to nodes"_test = []() {
+    // Setup
+    std::array<std::byte, 1024> buffer;
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+    fake_can can;
+    can_network network(can, resource);
+    auto* motor = network.register_message_id(0x140).value();
+    auto* encoder = network.register_message_id(0x561).value();
+    const auto version = encoder->version();
+
+    // Exercise
+    can.handler({ .id = 0x140, .length = 1, .payload = { std::byte{ 0xAA } } });
+    can.handler({ .id = 0x7AA, .length = 1, .payload = { std::byte{ 0xBB } } });
+
+    // Verify
+    expect(that % 0x140 == motor->secure_get().id);
+    expect(std::byte{ 0xAA } == motor->secure_get().payload[0]);
+    expect(that % 1 == motor->version());
+    expect(!encoder->updated_since(version));
+    expect(that % 2 == network.get_internal_map().size());
+
+    can.handler({ .id = 0x561, .length = 2 });
+    expect(encoder->updated_since(version));
+    expect(that % 2 == encoder->secure_get().length);
+  };
+};
+}  // namespace embed
@@ -0,0 +1,106 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/accelerometer/unit.hpp>
+#include <libembeddedhal/conversion.hpp>
+#include <libembeddedhal/temperature/unit.hpp>
+
+namespace embed {
+boost::ut::suite conversion_test = []() {
+  using namespace boost::ut;
+
+  // Exactly rounded (half away from negative infinity) reference result
+  auto reference = [](std::int64_t p_value,
+                      std::uint64_t p_numerator,
+                      std::uint64_t p_denominator) {
+    const __int128 product = __int128{ p_value } * p_numerator;
+    const __int128 denominator = p_denominator;
+    __int128 quotient = product / denominator;
+    __int128 remainder = product % denominator;
+    if (remainder < 0) {
+      quotient--;
+      remainder += denominator;
+    }
+    if (2 * remainder >= denominator) {
+      quotient++;
+    }
+    return static_cast<std::int64_t>(quotient);
+  };
+
+  "[conversion] scale_conversion is folded at compile time"_test = []() {
+    constexpr scale_conversion nano_to_milli(1, 1'000'000);
+    static_assert(nano_to_milli(1'500'000) == 2);
+    static_assert(nano_to_milli(-1'600'000) == -2);
+    static_assert(nano_to_milli(299'999'999'999) == 300'000);
+    static_assert(nano_to_milli.multiplier() >= (std::uint64_t{ 1 } << 31));
+    static_assert(nano_to_milli.multiplier() < (std::uint64_t{ 1 } << 32));
+
+    constexpr scale_conversion identity(1, 1);
+    static_assert(identity(-12345) == -12345);
+    static_assert(identity.shift() == 31);
+  };
+
+  "[conversion] scale_conversion matches exact division"_test =
+    [reference]() {
+      const std::array<std::array<std::uint64_t, 2>, 6> ratios{ {
+        { 1, 1'000 },
+        { 1, 1'000'000 },
+        { 3, 7 },
+        { 19'613'300'000, 1'000'000ULL * 2'147'483'647ULL },
+        { 5, 2 },
+        { 999'983, 1'000'003 },
+      } };
+
+      for (const auto& ratio : ratios) {
+        const scale_conversion conversion(ratio[0], ratio[1]);
+        std::uint32_t state = 987654321;
+        for (int i = 0; i < 2000; i++) {
+          state = state * 1103515245U + 12345U;
+          const auto value =
+            static_cast<std::int32_t>(state) / ((i % 3 == 0) ? 1 : 256);
+          const auto expected = reference(value, ratio[0], ratio[1]);
+          const auto actual = conversion(value);
+          expect(actual - expected <= 1 && expected - actual <= 1);
+        }
+      }
+    };
+
+  "[conversion] scale_conversion of 64-bit values"_test = [reference]() {
+    const scale_conversion conversion(1, 1'000'000);
+    // Every result fits within 32-bits
+    const std::array<std::int64_t, 6> values{
+      0,
+      999'999,
+      1'000'000'000'000,
+      -1'000'000'000'000,
+      2'147'483'647'000'000,
+      -2'147'483'648'000'000,
+    };
+    for (const auto value : values) {
+      const auto expected = reference(value, 1, 1'000'000);
+      const auto actual = conversion(value);
+      expect(actual - expected <= 1 && expected - actual <= 1);
+    }
+  };
+
+  "[conversion] scale_conversion offset and saturation"_test = []() {
+    const scale_conversion offset(1, 1'000, -273'150);
+    expect(that % 0 == offset(273'150'000));
+
+    const scale_conversion saturated(std::uint64_t{ 1 } << 40, 1);
+    expect(that % 0xFFFF'FFFF == saturated.multiplier());
+    expect(that % 0 == saturated.shift());
+  };
+
+  "[conversion] unit_ratio"_test = []() {
+    constexpr auto nm_to_mm = unit_ratio<mm_per_s2<>, nm_per_s2<>>();
+    constexpr auto nm_to_nm = unit_ratio<nm_per_s2<>, nm_per_s2<>>();
+    constexpr auto nk_to_uk = unit_ratio<uK<>, nK<>>();
+
+    expect(that % 1 == nm_to_mm[0]);
+    expect(that % 1'000'000 == nm_to_mm[1]);
+    expect(that % 1 == nm_to_nm[0]);
+    expect(that % 1 == nm_to_nm[1]);
+    expect(that % 1 == nk_to_uk[0]);
+    expect(that % 1'000 == nk_to_uk[1]);
+  };
+};
+}  // namespace embed
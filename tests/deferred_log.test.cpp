@@ -0,0 +1,228 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/deferred_log.hpp>
+
+#include <vector>
+
+namespace embed {
+boost::ut::suite deferred_log_test = []() {
+  using namespace boost::ut;
+
+  class dummy_serial : public embed::serial
+  {
+  public:
+    boost::leaf::result<void> driver_configure(
+      const settings&) noexcept override
+    {
+      return {};
+    }
+    boost::leaf::result<void> driver_write(
+      std::span<const std::byte> p_data) noexcept override
+    {
+      m_write_calls++;
+      if (m_write_calls == m_fail_on_call) {
+        return boost::leaf::new_error(std::errc::io_error);
+      }
+      m_written.insert(m_written.end(), p_data.begin(), p_data.end());
+      return {};
+    }
+    boost::leaf::result<size_t> driver_bytes_available() noexcept override
+    {
+      return 0;
+    }
+    boost::leaf::result<std::span<const std::byte>> driver_read(
+      std::span<std::byte> p_data) noexcept override
+    {
+      return p_data.first(0);
+    }
+    boost::leaf::result<void> driver_flush() noexcept override { return {}; }
+
+    std::vector<std::byte> m_written{};
+    int m_write_calls = 0;
+    int m_fail_on_call = 0;
+  };
+
+  enum class state : std::uint8_t
+  {
+    idle = 0,
+    running = 7,
+  };
+
+  "[deferred_log] log_format_id"_test = []() {
+    static_assert(log_format_id("") == 2166136261U);
+    static_assert(log_format_id("a") == 0xE40C292CU);
+    static_assert(log_format_id("x={}") != log_format_id("y={}"));
+  };
+
+  "[deferred_log] record format"_test = []() {
+    // Setup
+    deferred_log<64> log;
+    dummy_serial serial;
+    constexpr auto id = log_format_id("x={}");
+
+    // Exercise
+    expect(log.log<"x={}">(std::int16_t{ -2 }));
+    expect(that % 8 == log.size());
+    auto written = log.drain(serial);
+
+    // Verify
+    const std::vector<std::byte> expected{
+      std::byte{ 7 },
+      std::byte{ id & 0xFF },
+      std::byte{ (id >> 8) & 0xFF },
+      std::byte{ (id >> 16) & 0xFF },
+      std::byte{ (id >> 24) & 0xFF },
+      std::byte{ static_cast<std::uint8_t>(log_argument::int16) },
+      std::byte{ 0xFE },
+      std::byte{ 0xFF },
+    };
+    expect(that % 8 == written.value());
+    expect(that % 0 == log.size());
+    expect(that % 8 == serial.m_written.size());
+    expect(
+      std::equal(expected.begin(), expected.end(), serial.m_written.begin()));
+  };
+
+  "[deferred_log] round trip"_test = []() {
+    // Setup
+    deferred_log<128> log;
+    dummy_serial serial;
+    log_decoder<4> decoder;
+    std::array<char, 128> text{};
+    expect(bool{ decoder.add("adc={} ok={}") });
+    expect(bool{ decoder.add("state={} temp={}C big={}") });
+    expect(bool{ decoder.add("no arguments") });
+
+    // Exercise
+    expect(log.log<"adc={} ok={}">(std::uint16_t{ 4095 }, true));
+    expect(log.log<"state={} temp={}C big={}">(
+      state::running, 21.5f, std::int64_t{ -5000000000 }));
+    expect(log.log<"no arguments">());
+    expect(bool{ log.drain(serial) });
+
+    // Verify
+    auto stream = std::span<const std::byte>(serial.m_written);
+    auto first = decoder.decode(stream, text).value();
+    expect(std::string_view("adc=4095 ok=true") == first.text);
+    stream = stream.subspan(first.consumed);
+
+    auto second = decoder.decode(stream, text).value();
+    expect(std::string_view("state=7 temp=21.5C big=-5000000000") ==
+           second.text);
+    stream = stream.subspan(second.consumed);
+
+    auto third = decoder.decode(stream, text).value();
+    expect(std::string_view("no arguments") == third.text);
+    stream = stream.subspan(third.consumed);
+
+    expect(that % 0 == stream.size());
+  };
+
+  "[deferred_log] decoder truncates and rejects"_test = []() {
+    // Setup
+    deferred_log<64> log;
+    dummy_serial serial;
+    log_decoder<2> decoder;
+    std::array<char, 6> small{};
+    std::array<char, 64> text{};
+    static constexpr log_format value_format = "value={}";
+
+    // Exercise
+    expect(bool{ decoder.add(value_format.view()) });
+    expect(bool{ decoder.add("unused") });
+    expect(!decoder.add("full"));
+    expect(log.log<value_format>(123456));
+    expect(log.log<"unknown">());
+    expect(bool{ log.drain(serial) });
+    auto stream = std::span<const std::byte>(serial.m_written);
+    auto truncated = decoder.decode(stream, small);
+    auto partial = decoder.decode(stream.first(3), text);
+    auto unknown = decoder.decode(stream.subspan(truncated.value().consumed),
+                                  text);
+
+    // Verify
+    expect(std::string_view("value=") == truncated.value().text);
+    expect(!partial);
+    expect(!unknown);
+  };
+
+  "[deferred_log] decoder rejects unknown tags and id collisions"_test = []() {
+    // Setup
+    log_decoder<4> decoder;
+    std::array<char, 64> text{};
+    constexpr auto id = log_format_id("v={}");
+    // Record for "v={}" with an unknown argument tag followed by 8 bytes
+    std::array<std::byte, 1 + 4 + 1 + 8> stream{};
+    stream[0] = std::byte{ stream.size() - 1 };
+    for (size_t i = 0; i < 4; i++) {
+      stream[1 + i] = static_cast<std::byte>(id >> (i * 8));
+    }
+    stream[5] = std::byte{ 0xFF };
+    static_assert(log_format_id("costarring") == log_format_id("liquid"));
+
+    // Exercise + Verify
+    expect(that % 0 == log_argument_size(static_cast<log_argument>(0xFF)));
+    expect(that % 8 == log_argument_size(log_argument::float64));
+    expect(bool{ decoder.add("v={}") });
+    expect(!decoder.decode(stream, text));
+
+    expect(bool{ decoder.add("costarring") });
+    expect(bool{ decoder.add("costarring") });
+    expect(!decoder.add("liquid"));
+  };
+
+  "[deferred_log] wrap around and drop"_test = []() {
+    // Setup
+    deferred_log<16> log;
+    dummy_serial serial;
+    log_decoder<1> decoder;
+    std::array<char, 32> text{};
+    expect(bool{ decoder.add("v={}") });
+
+    // Exercise
+    // Each record is 1 + 4 + 1 + 4 = 10 bytes
+    expect(log.log<"v={}">(std::uint32_t{ 1 }));
+    expect(!log.log<"v={}">(std::uint32_t{ 2 }));
+    expect(bool{ log.drain(serial) });
+    expect(log.log<"v={}">(std::uint32_t{ 3 }));
+    serial.m_write_calls = 0;
+    expect(bool{ log.drain(serial) });
+
+    // Verify
+    expect(that % 1 == log.dropped());
+    expect(that % 2 == serial.m_write_calls);
+    auto stream = std::span<const std::byte>(serial.m_written);
+    auto first = decoder.decode(stream, text).value();
+    expect(std::string_view("v=1") == first.text);
+    auto second = decoder.decode(stream.subspan(first.consumed), text).value();
+    expect(std::string_view("v=3") == second.text);
+  };
+
+  "[deferred_log] failed drain does not repeat written bytes"_test = []() {
+    // Setup
+    deferred_log<16> log;
+    dummy_serial serial;
+    log_decoder<1> decoder;
+    std::array<char, 32> text{};
+    expect(bool{ decoder.add("v={}") });
+    expect(log.log<"v={}">(std::uint32_t{ 1 }));
+    expect(bool{ log.drain(serial) });
+    serial.m_written.clear();
+    serial.m_write_calls = 0;
+    // Wraps around the end of the buffer, needing two writes
+    expect(log.log<"v={}">(std::uint32_t{ 2 }));
+
+    // Exercise
+    serial.m_fail_on_call = 2;
+    expect(!log.drain(serial));
+    const auto after_failure = log.size();
+    expect(bool{ log.drain(serial) });
+
+    // Verify
+    expect(that % 4 == after_failure);
+    expect(that % 0 == log.size());
+    expect(that % 10 == serial.m_written.size());
+    auto record = decoder.decode(serial.m_written, text).value();
+    expect(std::string_view("v=2") == record.text);
+  };
+};
+}  // namespace embed
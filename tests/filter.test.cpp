@@ -0,0 +1,273 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/filter.hpp>
+
+#include <vector>
+
+namespace embed {
+boost::ut::suite filter_test = []() {
+  using namespace boost::ut;
+
+  // Deterministic pseudo random samples covering the full q15 range
+  auto samples = []() {
+    std::array<q15, 64> result{};
+    std::uint32_t state = 12345;
+    for (auto& sample : result) {
+      state = state * 1103515245U + 12345U;
+      sample = q15::from_raw(static_cast<std::int16_t>(state >> 16));
+    }
+    return result;
+  }();
+
+  "[filter] moving_average"_test = []() {
+    // Setup
+    moving_average<float, 4> average;
+    moving_average<q15, 4> fixed_average;
+    const std::array<float, 6> input{ 4, 8, 12, 16, 20, 24 };
+    std::array<float, 6> output{};
+
+    // Exercise
+    auto result = average.process(input, output);
+    fixed_average.update(q15(0.5));
+    fixed_average.update(q15(0.25));
+
+    // Verify
+    expect(that % 6 == result.size());
+    expect(that % 1.0f == output[0]);
+    expect(that % 3.0f == output[1]);
+    expect(that % 6.0f == output[2]);
+    expect(that % 10.0f == output[3]);
+    expect(that % 14.0f == output[4]);
+    expect(that % 18.0f == output[5]);
+    expect(q15(0.1875) == fixed_average.value());
+
+    average.reset();
+    expect(that % 0.0f == average.value());
+    expect(that % 2.0f == average.update(8.0f));
+  };
+
+  "[filter] moving_average saturated window"_test = []() {
+    moving_average<q15, 8> average;
+    for (int i = 0; i < 20; i++) {
+      average.update(q15::max());
+    }
+    expect(q15::max() == average.value());
+    for (int i = 0; i < 20; i++) {
+      average.update(q15::min());
+    }
+    expect(q15::min() == average.value());
+  };
+
+  "[filter] fir impulse response"_test = []() {
+    // Setup
+    const std::array<float, 3> coefficients{ 0.5f, 0.25f, 0.125f };
+    fir<float, 3> filter(coefficients);
+    const std::array<float, 5> impulse{ 1, 0, 0, 0, 0 };
+    std::array<float, 5> output{};
+
+    // Exercise
+    filter.process(impulse, output);
+
+    // Verify
+    expect(that % 0.5f == output[0]);
+    expect(that % 0.25f == output[1]);
+    expect(that % 0.125f == output[2]);
+    expect(that % 0.0f == output[3]);
+    expect(that % 0.0f == output[4]);
+  };
+
+  "[filter] fir bit exact q15"_test = [samples]() {
+    // Setup
+    const std::array<q15, 5> coefficients{
+      q15(0.1), q15(-0.2), q15(0.4), q15(-0.2), q15(0.1),
+    };
+    fir<q15, 5> filter(coefficients);
+    std::array<q15, samples.size()> output{};
+
+    // Exercise
+    filter.process(samples, output);
+
+    // Verify
+    // Reference: full precision sum of products, rounded and saturated once
+    for (size_t n = 0; n < samples.size(); n++) {
+      std::int64_t sum = 0;
+      for (size_t k = 0; k < coefficients.size() && k <= n; k++) {
+        sum += std::int64_t{ coefficients[k].raw_value() } *
+               samples[n - k].raw_value();
+      }
+      sum = std::clamp<std::int64_t>((sum + (1 << 14)) >> 15, -32768, 32767);
+      expect(that % sum == output[n].raw_value());
+    }
+  };
+
+  "[filter] fir bit exact q31"_test = []() {
+    // Setup
+    const std::array<q31, 3> coefficients{ q31(0.5), q31(-0.3), q31(0.7) };
+    const std::array<q31, 6> input{
+      q31(0.9), q31(-0.9), q31(0.9), q31(0.123), q31::min(), q31::max(),
+    };
+    fir<q31, 3> filter(coefficients);
+    std::array<q31, 6> output{};
+
+    // Exercise
+    filter.process(input, output);
+
+    // Verify
+    // Reference: each product rounded, sum saturated once
+    for (size_t n = 0; n < input.size(); n++) {
+      std::int64_t sum = 0;
+      for (size_t k = 0; k < coefficients.size() && k <= n; k++) {
+        const std::int64_t product =
+          std::int64_t{ coefficients[k].raw_value() } *
+          input[n - k].raw_value();
+        sum += (product + (std::int64_t{ 1 } << 30)) >> 31;
+      }
+      sum = std::clamp<std::int64_t>(sum, INT32_MIN, INT32_MAX);
+      expect(that % sum == output[n].raw_value());
+    }
+  };
+
+  "[filter] biquad"_test = []() {
+    // Setup
+    // First order low pass y[n] = 0.25 * x[n] + 0.75 * y[n - 1]
+    using q3_28 = fixed_point<std::int32_t, 28>;
+    biquad<double> filter({ .b0 = 0.25, .a1 = -0.75 });
+    biquad<q3_28> fixed_filter({ .b0 = q3_28(0.25), .a1 = q3_28(-0.75) });
+    biquad<float> passthrough;
+    biquad<q15> fixed_passthrough;
+
+    // Exercise
+    double output = 0;
+    q3_28 fixed_output{};
+    for (int i = 0; i < 100; i++) {
+      output = filter.update(1.0);
+      fixed_output = fixed_filter.update(q3_28(1.0));
+    }
+
+    // Verify
+    expect(absolute_value(output - 1.0) < 1e-9);
+    expect(absolute_value(fixed_output.to<double>() - 1.0) < 1e-6);
+    expect(that % 0.75f == passthrough.update(0.75f));
+    // b0 saturates to just under 1.0 in q15
+    const auto passed = fixed_passthrough.update(q15(-0.75)).raw_value();
+    expect(absolute_value(passed - q15(-0.75).raw_value()) <= 1);
+    expect(that % q15::max().raw_value() ==
+           fixed_passthrough.update(q15::max()).raw_value() + 1);
+  };
+
+  "[filter] biquad matches difference equation"_test = [samples]() {
+    // Setup
+    const biquad<q15>::coefficients coefficients{
+      .b0 = q15(0.2), .b1 = q15(0.3), .b2 = q15(0.2),
+      .a1 = q15(-0.4), .a2 = q15(0.1),
+    };
+    biquad<q15> filter(coefficients);
+
+    // Exercise + Verify
+    std::int64_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    for (const auto sample : samples) {
+      const std::int64_t x = sample.raw_value();
+      std::int64_t sum = coefficients.b0.raw_value() * x +
+                         coefficients.b1.raw_value() * x1 +
+                         coefficients.b2.raw_value() * x2 -
+                         coefficients.a1.raw_value() * y1 -
+                         coefficients.a2.raw_value() * y2;
+      sum = std::clamp<std::int64_t>((sum + (1 << 14)) >> 15, -32768, 32767);
+      expect(that % sum == filter.update(sample).raw_value());
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = sum;
+    }
+  };
+
+  "[filter] biquad_cascade"_test = []() {
+    // Setup
+    const std::array<biquad_cascade<float, 2>::coefficients, 2> coefficients{
+      biquad_cascade<float, 2>::coefficients{ .b0 = 0.5f },
+      biquad_cascade<float, 2>::coefficients{ .b0 = 0.5f, .b1 = 0.5f },
+    };
+    biquad_cascade<float, 2> filter(coefficients);
+    std::array<float, 3> block{ 1, 0, 0 };
+
+    // Exercise
+    auto output = filter.process(block, block);
+
+    // Verify
+    expect(that % 3 == output.size());
+    expect(that % 0.25f == block[0]);
+    expect(that % 0.25f == block[1]);
+    expect(that % 0.0f == block[2]);
+    filter.reset();
+    expect(that % 0.25f == filter.update(1.0f));
+  };
+
+  "[filter] cic_decimator"_test = []() {
+    // Setup
+    cic_decimator<3, 4> filter;
+    std::vector<std::int32_t> constant(40, 1000);
+    std::array<std::int64_t, 16> output{};
+
+    // Exercise
+    auto [consumed, result] = filter.process(constant, output);
+
+    // Verify
+    static_assert(cic_decimator<3, 4>::gain() == 64);
+    expect(that % 40 == consumed);
+    expect(that % 10 == result.size());
+    // Settles after Order output samples to the input times the gain
+    expect(that % 64000 == result[3]);
+    expect(that % 64000 == result.back());
+  };
+
+  "[filter] cic_decimator matches moving sum"_test = [samples]() {
+    // Setup
+    // A first order CIC is a moving sum of Decimation samples
+    cic_decimator<1, 8> filter;
+    std::array<std::int64_t, 8> output{};
+    std::array<std::int32_t, samples.size()> input{};
+    for (size_t i = 0; i < samples.size(); i++) {
+      input[i] = samples[i].raw_value();
+    }
+
+    // Exercise
+    auto result = filter.process(input, output).output;
+
+    // Verify
+    expect(that % 8 == result.size());
+    for (size_t block = 0; block < result.size(); block++) {
+      std::int64_t sum = 0;
+      for (size_t i = 0; i < 8; i++) {
+        sum += input[block * 8 + i];
+      }
+      expect(that % sum == result[block]);
+    }
+  };
+
+  "[filter] cic_decimator stops when output is full"_test = []() {
+    // Setup
+    cic_decimator<1, 2> filter;
+    const std::array<std::int32_t, 9> input{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::array<std::int64_t, 2> output{};
+
+    // Exercise
+    auto first = filter.process(input, output);
+    const std::vector<std::int64_t> first_output(first.output.begin(),
+                                                 first.output.end());
+    auto rest = std::span(input).subspan(first.consumed);
+    auto second = filter.process(rest, output);
+    auto none = filter.process(input, std::span<std::int64_t>{});
+
+    // Verify
+    // Stops right after the sample that produced the last output
+    expect(that % 4 == first.consumed);
+    expect(first_output == std::vector<std::int64_t>{ 3, 7 });
+    // The remaining samples continue where the first call stopped
+    expect(that % 4 == second.consumed);
+    expect(that % 2 == second.output.size());
+    expect(that % 11 == second.output[0]);
+    expect(that % 15 == second.output[1]);
+    expect(that % 0 == none.consumed);
+    expect(that % 0 == none.output.size());
+  };
+};
+}  // namespace embed
@@ -0,0 +1,192 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/accelerometer/unit.hpp>
+#include <libembeddedhal/fixed_point.hpp>
+#include <libembeddedhal/temperature/unit.hpp>
+
+#include <functional>
+#include <limits>
+
+#include <units/isq/si/length.h>
+
+namespace embed {
+boost::ut::suite fixed_point_test = []() {
+  using namespace boost::ut;
+
+  "[fixed_point] construction"_test = []() {
+    static_assert(sizeof(q15) == 2);
+    static_assert(sizeof(q31) == 4);
+    static_assert(q15::integer_bits == 0);
+    static_assert(q16_16::integer_bits == 15);
+
+    expect(that % 16384 == q15(0.5).raw_value());
+    expect(that % -8192 == q15(-0.25).raw_value());
+    expect(that % 32767 == q15(1.0).raw_value());
+    expect(that % -32768 == q15(-3.0).raw_value());
+    expect(that % 0x40000000 == q31(0.5).raw_value());
+    expect(that % 0x00018000 == q16_16(1.5).raw_value());
+    expect(that % 0x00030000 == q16_16::from_integer(3).raw_value());
+    expect(that % -0x00030000 == q16_16::from_integer(-3).raw_value());
+    expect(q16_16::from_integer(32767) == q16_16::from_integer(100000U));
+    expect(q16_16::min() == q16_16::from_integer(std::int64_t{ -100000 }));
+    expect(0.75_d == q15(0.75).to<float>());
+    expect(that % -2.25 == q16_16(-2.25).to<double>());
+  };
+
+  "[fixed_point] saturating add and subtract"_test = []() {
+    expect(q15(0.75) == q15(0.5) + q15(0.25));
+    expect(q15::max() == q15(0.75) + q15(0.5));
+    expect(q15::min() == q15(-0.75) - q15(0.5));
+    expect(q15::max() == -q15::min());
+    expect(q31::max() == q31(0.9) + q31(0.9));
+
+    auto value = q16_16(1.0);
+    value += q16_16(2.5);
+    value -= q16_16(0.5);
+    expect(q16_16(3.0) == value);
+  };
+
+  "[fixed_point] saturating multiply"_test = []() {
+    expect(q15(0.125) == q15(0.5) * q15(0.25));
+    expect(q15(-0.125) == q15(-0.5) * q15(0.25));
+    expect(q15::max() == q15::min() * q15::min());
+    expect(q31::max() == q31::min() * q31::min());
+    expect(q31(0.25) == q31(0.5) * q31(0.5));
+    expect(q16_16(-7.5) == q16_16(2.5) * q16_16(-3.0));
+    expect(q16_16::max() == q16_16(300.0) * q16_16(300.0));
+
+    auto value = q16_16(1.5);
+    value *= q16_16(4.0);
+    expect(q16_16(6.0) == value);
+  };
+
+  "[fixed_point] integer scaling"_test = []() {
+    expect(that % 250 == 1000 * q15(0.25));
+    expect(that % -500 == q15(-0.5) * 1000);
+    expect(that % 3000 == 1000 * q16_16(3.0));
+    expect(that % 1000000 == std::int32_t{ 4000000 } * q31(0.25));
+
+    // Results saturate to the range of the integer type
+    constexpr auto int32_max = std::numeric_limits<std::int32_t>::max();
+    constexpr auto uint32_max = std::numeric_limits<std::uint32_t>::max();
+    expect(that % int32_max == int32_max * q16_16(2.0));
+    expect(that % uint32_max == std::uint32_t{ 4'000'000'000 } * q16_16(2.0));
+    expect(that % 0U == std::uint32_t{ 10 } * q15(-0.5));
+    expect(that % -128 == std::int8_t{ 100 } * q16_16(-2.0));
+
+    // 64-bit integers are multiplied in 128 bits
+    constexpr auto int64_max = std::numeric_limits<std::int64_t>::max();
+    constexpr auto int64_min = std::numeric_limits<std::int64_t>::min();
+    constexpr auto uint64_max = std::numeric_limits<std::uint64_t>::max();
+    expect(that % 250'000'000'000 ==
+           std::int64_t{ 1'000'000'000'000 } * q31(0.25));
+    expect(that % -6'917'529'027'641'081'855 == int64_max * q16_16(-0.75));
+    expect(that % int64_max == int64_max * q16_16(2.0));
+    expect(that % int64_min == int64_max * q16_16(-2.0));
+    expect(that % int64_max == int64_min * q15(-1.0));
+    expect(that % uint64_max == uint64_max * q16_16(1.5));
+    expect(that % 0U == std::uint64_t{ 10 } * q31(-0.5));
+    // Rounded the same way as narrower integers, with halves rounding up
+    for (int value = -9; value <= 9; value++) {
+      expect(that % (value * q15(0.5)) ==
+             static_cast<int>(std::int64_t{ value } * q15(0.5)));
+      expect(that % (value * q16_16(-1.25)) ==
+             static_cast<int>(q16_16(-1.25) * std::int64_t{ value }));
+    }
+  };
+
+  "[fixed_point] reciprocal"_test = []() {
+    expect(q16_16(0.25) == reciprocal(q16_16(4.0)));
+    expect(q16_16(-0.5) == reciprocal(q16_16(-2.0)));
+    expect(that % 21845 == reciprocal(q16_16(3.0)).raw_value());
+    expect(q16_16(8.0) == reciprocal(q16_16(0.125)));
+    expect(q16_16::max() == reciprocal(q16_16{}));
+    expect(q16_16::max() == reciprocal(q16_16::from_raw(1)));
+    expect(q15::max() == reciprocal(q15(0.5)));
+
+    // Compare against a floating point reference across the range
+    for (int i = 1; i < 2000; i += 7) {
+      const auto value = q16_16::from_raw(i * 997);
+      const double expected = 1.0 / value.to<double>();
+      const double actual = reciprocal(value).to<double>();
+      expect(absolute_value(expected - actual) < 1.0 / 65536.0);
+    }
+  };
+
+  "[fixed_point] square_root"_test = []() {
+    expect(q16_16(2.0) == square_root(q16_16(4.0)));
+    expect(q16_16(12.0) == square_root(q16_16(144.0)));
+    expect(q15(0.5) == square_root(q15(0.25)));
+    expect(q31(0.5) == square_root(q31(0.25)));
+    expect(q15{} == square_root(q15(-0.25)));
+    expect(that % 92682 == square_root(q16_16(2.0)).raw_value());
+    expect(q31::max() == square_root(q31::max()));
+  };
+
+  "[fixed_point] percent interop"_test = []() {
+    expect(that % 16383 == q15(percent16::from_ratio(1, 2)).raw_value());
+    expect(that % 32767 == q15(percent::from_ratio(1, 1)).raw_value());
+    expect(that % 0x10000 == q16_16(percent::from_ratio(1, 1)).raw_value());
+    expect(that % -0x8000 == q16_16(percent::from_ratio(-1, 2)).raw_value());
+
+    expect(that % percent::raw_max() ==
+           q16_16::from_integer(2).to_percent().raw_value());
+    expect(that % percent16::raw_min() ==
+           q15::min().to_percent<std::int16_t>().raw_value());
+    expect(that % 0x40000000 == q31(0.5).to_percent().raw_value());
+    expect(that % 64 == q15(0.5).to_percent<std::int8_t>().raw_value());
+  };
+
+  "[fixed_point] span kernels"_test = []() {
+    const std::array<q15, 4> a{ q15(0.5), q15(-0.5), q15(0.75), q15(0.125) };
+    const std::array<q15, 4> b{ q15(0.25), q15(0.25), q15(0.5), q15(-0.5) };
+    std::array<q15, 4> output{};
+
+    auto sum = add<q15>(a, b, output);
+    expect(that % 4 == sum.size());
+    expect(q15(0.75) == output[0]);
+    expect(q15(-0.25) == output[1]);
+    expect(q15::max() == output[2]);
+    expect(q15(-0.375) == output[3]);
+
+    auto product = multiply<q15>(a, std::span(b).first(2), output);
+    expect(that % 2 == product.size());
+    expect(q15(0.125) == output[0]);
+    expect(q15(-0.125) == output[1]);
+
+    auto scaled = scale<q15>(a, q15(0.5), output);
+    expect(that % 4 == scaled.size());
+    expect(q15(0.25) == output[0]);
+    expect(q15(-0.25) == output[1]);
+    expect(q15(0.375) == output[2]);
+    expect(q15(0.0625) == output[3]);
+
+    // 0.125 - 0.125 + 0.375 - 0.0625 = 0.3125
+    expect(q15(0.3125) == dot_product<q15>(a, b));
+    expect(q31(0.3125) ==
+           dot_product<q31>(
+             std::array{ q31(0.5), q31(-0.5), q31(0.75), q31(0.125) },
+             std::array{ q31(0.25), q31(0.25), q31(0.5), q31(-0.5) }));
+
+    const std::array<q15, 4> full{ q15::max(), q15::max(), q15::max(),
+                                   q15::max() };
+    expect(q15::max() == dot_product<q15>(full, full));
+  };
+
+  "[fixed_point] units interop"_test = []() {
+    using namespace units::isq::si::references;
+    const auto distance = 1000 * mm;
+    expect(that % 250 == scale(distance, q15(0.25)).number());
+    expect(that % -1500 == scale(distance, q16_16(-1.5)).number());
+    expect(0.5_d == scale(2.0 * mm, q15(0.25)).number());
+
+    // 64-bit representations
+    expect(that % 500 == scale(acceleration(1000), q15(0.5)).number());
+    expect(that % -4'500'000'000'000 ==
+           scale(temperature(3'000'000'000'000), q16_16(-1.5)).number());
+    expect(that % std::numeric_limits<std::int64_t>::max() ==
+           scale(temperature(std::numeric_limits<std::int64_t>::max()),
+                 q16_16(100.0))
+             .number());
+  };
+};
+}  // namespace embed
@@ -206,5 +206,51 @@ boost::ut::suite frequency_user_defined_literals_test = []() {
                             std::numeric_limits<std::int32_t>::max() }),
               percent(0.50)));
   };
+
+  "frequency::solve_divider"_test = []() {
+    constexpr divider_limits timer16{ .max_prescaler = 65'536 };
+    constexpr divider_limits avr{ .max_prescaler = 1'024,
+                                  .power_of_two_prescaler = true };
+
+    // Evaluated at compile time
+    static_assert(divider_pair{ 1, 48'000 } ==
+                  solve_divider(48_MHz, 1_kHz, timer16));
+    static_assert(divider_pair{ 24, 60'000 } ==
+                  solve_divider(72_MHz, 50_Hz, timer16));
+    static_assert(divider_pair{ 8, 40'000 } ==
+                  solve_divider(16_MHz, 50_Hz, avr));
+
+    // 1000003 is prime so no pair is exact
+    expect(eq(divider_pair{ 53, 18'868 },
+              solve_divider(frequency(1'000'003), 1_Hz, timer16)));
+    expect(eq(divider_pair{ 256, 62'500 }, solve_divider(16_MHz, 1_Hz, avr)));
+    // Unreachable
+    expect(eq(divider_pair{}, solve_divider(160_MHz, 1_Hz, avr)));
+    expect(eq(divider_pair{}, solve_divider(16_MHz, 32_MHz, timer16)));
+    expect(eq(divider_pair{},
+              solve_divider(16_MHz, 50_Hz, { .max_period = 0 })));
+
+    // Matches an exhaustive search over every reachable pair
+    constexpr divider_limits small{ .max_prescaler = 24, .max_period = 200 };
+    for (std::uint32_t target = 2'500; target < 200'000; target += 997) {
+      const auto input = 12_MHz;
+      const std::uint64_t divide = input.divide(frequency(target));
+      std::uint64_t best_error = std::numeric_limits<std::uint64_t>::max();
+      divider_pair best{};
+      for (std::uint32_t prescaler = 1; prescaler <= small.max_prescaler;
+           prescaler++) {
+        for (std::uint32_t period = small.max_period; period > 0; period--) {
+          const std::uint64_t product = prescaler * period;
+          const std::uint64_t error =
+            product > divide ? product - divide : divide - product;
+          if (error < best_error) {
+            best_error = error;
+            best = { prescaler, period };
+          }
+        }
+      }
+      expect(best == solve_divider(input, frequency(target), small));
+    }
+  };
 };
 }  // namespace embed
@@ -0,0 +1 @@
+#include <libembeddedhal/input_capture/interface.hpp>
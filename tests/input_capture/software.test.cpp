@@ -0,0 +1,282 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/input_capture/software.hpp>
+
+#include <cmath>
+
+namespace embed {
+namespace {
+/**
+ * Simulates a square wave on an interrupt pin along with the counter used to
+ * timestamp it. Time is measured in counter cycles. Each interrupt keeps the
+ * processor busy for `isr_cycles`, during which further edges set a single
+ * pending flag, as an interrupt controller would.
+ */
+struct simulated_signal
+{
+  struct pin : public embed::interrupt_pin
+  {
+    boost::leaf::result<void> driver_configure(
+      const settings&) noexcept override
+    {
+      return {};
+    }
+    boost::leaf::result<bool> driver_level() noexcept override
+    {
+      return signal->level_at(signal->now);
+    }
+    boost::leaf::result<void> driver_attach_interrupt(
+      std::function<void(void)> p_callback,
+      trigger_edge p_trigger) noexcept override
+    {
+      callback = p_callback;
+      trigger = p_trigger;
+      return {};
+    }
+    boost::leaf::result<void> driver_detach_interrupt() noexcept override
+    {
+      callback = nullptr;
+      return {};
+    }
+
+    simulated_signal* signal = nullptr;
+    std::function<void(void)> callback{};
+    trigger_edge trigger = trigger_edge::falling;
+  };
+
+  struct clock : public embed::counter
+  {
+    boost::leaf::result<uptime_t> driver_uptime() noexcept override
+    {
+      return uptime_t{
+        .frequency = signal->frequency,
+        .count = static_cast<std::uint32_t>(
+          static_cast<std::uint64_t>(std::floor(signal->now))),
+      };
+    }
+
+    simulated_signal* signal = nullptr;
+  };
+
+  simulated_signal(embed::frequency p_frequency,
+                   double p_signal_hz,
+                   double p_duty)
+    : frequency(p_frequency)
+  {
+    set_signal(p_signal_hz, p_duty);
+    input.signal = this;
+    counter.signal = this;
+  }
+
+  void set_signal(double p_signal_hz, double p_duty)
+  {
+    period = p_signal_hz > 0 ? frequency.cycles_per_second() / p_signal_hz : 0;
+    high = period * p_duty;
+  }
+
+  [[nodiscard]] bool level_at(double p_time) const
+  {
+    if (period <= 0) {
+      return idle_level;
+    }
+    return p_time >= offset && std::fmod(p_time - offset, period) < high;
+  }
+
+  void interrupt(double p_time)
+  {
+    now = p_time + latency_cycles;
+    if (input.callback) {
+      input.callback();
+    }
+    busy_until = p_time + isr_cycles;
+  }
+
+  /// Advance time, raising interrupts on each edge that matches the trigger
+  void run_until(double p_end)
+  {
+    const bool both = input.trigger == pin::trigger_edge::both;
+    while (period > 0) {
+      const double cycle_start =
+        offset + static_cast<double>(edge_index / 2) * period;
+      const bool rising = edge_index % 2 == 0;
+      const double edge = rising ? cycle_start : cycle_start + high;
+      if (edge >= p_end) {
+        break;
+      }
+      edge_index++;
+
+      if (!rising && !both) {
+        continue;
+      }
+      if (pending && busy_until <= edge) {
+        pending = false;
+        interrupt(busy_until);
+      }
+      if (edge >= busy_until) {
+        interrupt(edge);
+      } else {
+        pending = true;
+      }
+    }
+    if (pending && busy_until <= p_end) {
+      pending = false;
+      interrupt(busy_until);
+    }
+    now = std::max(now, p_end);
+  }
+
+  embed::frequency frequency;
+  double period = 0;
+  double high = 0;
+  bool idle_level = false;
+  double offset = 100;
+  double latency_cycles = 1;
+  double isr_cycles = 1;
+  double now = 0;
+  std::uint64_t edge_index = 0;
+  double busy_until = 0;
+  bool pending = false;
+  pin input{};
+  clock counter{};
+};
+}  // namespace
+
+boost::ut::suite software_input_capture_test = []() {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+  using namespace embed::literals;
+
+  "[software_input_capture] frequency, period and duty cycle"_test = []() {
+    // Setup
+    simulated_signal signal(48_MHz, 10'000.0, 0.25);
+    software_input_capture capture(signal.input, signal.counter);
+
+    // Exercise
+    expect(bool{ capture.configure({ .gate_time = 10ms }) });
+    expect(interrupt_pin::trigger_edge::both == signal.input.trigger);
+    signal.run_until(48'000 * 25);
+    auto result = capture.measure();
+
+    // Verify
+    expect(bool{ result });
+    expect(10'000_Hz == result.value().frequency);
+    expect(100us == result.value().period);
+    expect(that % 100 == result.value().pulses);
+    expect(that % 120'000 == result.value().duty_cycle.high);
+    expect(that % 360'000 == result.value().duty_cycle.low);
+    expect(percent::from_ratio(1, 4) ==
+           static_cast<percent>(result.value().duty_cycle));
+  };
+
+  "[software_input_capture] reciprocal counting resolves the period"_test =
+    []() {
+      // Setup
+      simulated_signal signal(1_MHz, 1000.0 / 7.0, 0.5);
+      software_input_capture capture(signal.input, signal.counter);
+
+      // Exercise
+      expect(bool{ capture.configure({ .gate_time = 100ms }) });
+      signal.run_until(300'000);
+      auto result = capture.measure();
+
+      // Verify
+      // Counting edges over 100ms could only give a multiple of 10Hz, while
+      // a 1MHz counter over 15 periods resolves 7ms to within 1us
+      expect(bool{ result });
+      expect(143_Hz == result.value().frequency);
+      expect(7ms == result.value().period);
+      expect(that % 15 == result.value().pulses);
+    };
+
+  "[software_input_capture] frequency only"_test = []() {
+    // Setup
+    simulated_signal signal(48_MHz, 2'000.0, 0.1);
+    software_input_capture capture(signal.input, signal.counter);
+
+    // Exercise
+    expect(
+      bool{ capture.configure({ .gate_time = 1ms, .duty_cycle = false }) });
+    expect(interrupt_pin::trigger_edge::rising == signal.input.trigger);
+    signal.run_until(48'000 * 3);
+    auto result = capture.measure();
+
+    // Verify
+    expect(bool{ result });
+    expect(2'000_Hz == result.value().frequency);
+    expect(500us == result.value().period);
+    expect(that % 2 == result.value().pulses);
+    expect(that % 0 == result.value().duty_cycle.high);
+    expect(that % 0 == result.value().duty_cycle.low);
+  };
+
+  "[software_input_capture] no measurement yet and stopped signal"_test =
+    []() {
+      // Setup
+      simulated_signal signal(48_MHz, 1'000.0, 0.5);
+      software_input_capture capture(signal.input, signal.counter);
+      expect(bool{ capture.configure({ .gate_time = 10ms }) });
+
+      // Exercise + Verify
+      signal.run_until(48'000 * 5);
+      expect(!capture.measure());
+
+      signal.run_until(48'000 * 12);
+      expect(bool{ capture.measure() });
+
+      // Signal stops while HIGH
+      signal.set_signal(0.0, 0.0);
+      signal.idle_level = true;
+      signal.now += 48'000 * 11;
+      auto result = capture.measure();
+      expect(bool{ result });
+      expect(0_Hz == result.value().frequency);
+      expect(0ns == result.value().period);
+      expect(that % 0 == result.value().pulses);
+      expect(that % 1 == result.value().duty_cycle.high);
+      expect(that % 0 == result.value().duty_cycle.low);
+    };
+
+  "[software_input_capture] configure errors"_test = []() {
+    // Setup
+    simulated_signal signal(48_MHz, 1'000.0, 0.5);
+    software_input_capture capture(signal.input, signal.counter);
+
+    // Exercise + Verify
+    expect(!capture.configure({ .gate_time = 0ns }));
+    expect(!capture.configure({ .gate_time = 50s }));
+    expect(bool{ capture.configure({ .gate_time = 40s }) });
+  };
+
+  "[software_input_capture] highest measurable frequency"_test = []() {
+    // A 2us interrupt handler at 48MHz allows an edge every 96 cycles: one
+    // edge per period when capturing frequency only and two with duty cycle
+    auto measure = [](double p_signal_hz, bool p_duty_cycle) {
+      simulated_signal signal(48_MHz, p_signal_hz, 0.5);
+      signal.latency_cycles = 12;
+      signal.isr_cycles = 96;
+      software_input_capture capture(signal.input, signal.counter);
+      expect(bool{ capture.configure(
+        { .gate_time = 1ms, .duty_cycle = p_duty_cycle }) });
+      signal.run_until(48'000 * 20);
+      return capture.measure();
+    };
+
+    auto duty_below = measure(240'000.0, true);
+    expect(bool{ duty_below });
+    expect(240_kHz == duty_below.value().frequency);
+    expect(percent::from_ratio(1, 2) ==
+           static_cast<percent>(duty_below.value().duty_cycle));
+
+    auto duty_above = measure(260'000.0, true);
+    expect(!duty_above || 260_kHz != duty_above.value().frequency);
+
+    auto frequency_below = measure(480'000.0, false);
+    expect(bool{ frequency_below });
+    expect(480_kHz == frequency_below.value().frequency);
+
+    // Above the limit, edges are merged and the handler's own rate is read
+    auto frequency_above = measure(520'000.0, false);
+    expect(bool{ frequency_above });
+    expect(500_kHz == frequency_above.value().frequency);
+  };
+};
+}  // namespace embed
@@ -0,0 +1,85 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/latest_value.hpp>
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace embed {
+boost::ut::suite latest_value_test = []() {
+  using namespace boost::ut;
+
+  "[latest_value] store and read"_test = []() {
+    // Setup
+    latest_value<int> value(5);
+
+    // Exercise + Verify
+    expect(that % 5 == value.load());
+    expect(that % 0 == value.version());
+
+    value.store(7);
+    const auto [latest, version] = value.read();
+    expect(that % 7 == latest);
+    expect(that % 1 == version);
+    expect(!value.updated_since(version));
+
+    value.store(9);
+    expect(value.updated_since(version));
+    expect(that % 9 == value.load());
+    expect(that % 2 == value.version());
+  };
+
+  "[latest_value] copy"_test = []() {
+    // Setup
+    latest_value<int> value;
+    value.store(3);
+    latest_value<int> other(11);
+
+    // Exercise
+    latest_value<int> copy(value);
+    other = value;
+
+    // Verify
+    expect(that % 3 == copy.load());
+    expect(that % 0 == copy.version());
+    expect(that % 3 == other.load());
+    expect(that % 1 == other.version());
+  };
+
+  "[latest_value] concurrent writer and reader"_test = []() {
+    // Setup
+    constexpr std::uint64_t count = 100'000;
+    latest_value<std::array<std::uint64_t, 8>> value;
+    std::atomic<bool> done = false;
+    bool consistent = true;
+    bool in_order = true;
+
+    // Exercise
+    std::thread writer([&value, &done]() {
+      for (std::uint64_t i = 1; i <= count; i++) {
+        std::array<std::uint64_t, 8> sample;
+        sample.fill(i);
+        value.store(sample);
+      }
+      done = true;
+    });
+
+    std::uint64_t previous = 0;
+    while (!done) {
+      const auto [sample, version] = value.read();
+      for (const auto element : sample) {
+        consistent = consistent && element == sample[0];
+      }
+      in_order = in_order && sample[0] >= previous && sample[0] == version;
+      previous = sample[0];
+    }
+    writer.join();
+
+    // Verify
+    expect(consistent);
+    expect(in_order);
+    expect(that % count == value.load()[7]);
+    expect(that % count == value.version());
+  };
+};
+}  // namespace embed
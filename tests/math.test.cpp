@@ -0,0 +1,107 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/math.hpp>
+
+#define WIDE_INTEGER_DISABLE_IOSTREAM
+#include <libembeddedhal/internal/third_party/uintwide_t.h>
+#undef WIDE_INTEGER_DISABLE_IOSTREAM
+
+#include <cstdint>
+#include <limits>
+
+namespace embed {
+boost::ut::suite math_test = []() {
+  using namespace boost::ut;
+
+  "[math] multiply_with_overflow_detection builtin integers"_test = []() {
+    constexpr auto u32_max = std::numeric_limits<std::uint32_t>::max();
+    constexpr auto i64_max = std::numeric_limits<std::int64_t>::max();
+    constexpr auto i64_min = std::numeric_limits<std::int64_t>::min();
+
+    expect(that % 0 ==
+           multiply_with_overflow_detection(std::uint32_t{ 0 }, u32_max)
+             .value());
+    expect(that % u32_max ==
+           multiply_with_overflow_detection(std::uint32_t{ 65535 },
+                                            std::uint32_t{ 65537 })
+             .value());
+    expect(!multiply_with_overflow_detection(std::uint32_t{ 65536 },
+                                             std::uint32_t{ 65536 }));
+    expect(that % -120 ==
+           multiply_with_overflow_detection(std::int8_t{ -10 },
+                                            std::int8_t{ 12 })
+             .value());
+    expect(!multiply_with_overflow_detection(std::int8_t{ -10 },
+                                             std::int8_t{ 20 }));
+    expect(!multiply_with_overflow_detection(std::int8_t{ -16 },
+                                             std::int8_t{ 9 }));
+    expect(that % -128 == multiply_with_overflow_detection(std::int8_t{ -16 },
+                                                           std::int8_t{ 8 })
+                            .value());
+    expect(that % i64_max ==
+           multiply_with_overflow_detection(i64_max, std::int64_t{ 1 })
+             .value());
+    expect(!multiply_with_overflow_detection(i64_min, std::int64_t{ -1 }));
+    expect(!multiply_with_overflow_detection(i64_max, std::int64_t{ 2 }));
+  };
+
+  "[math] multiply_with_overflow_detection uint128_t"_test = []() {
+    const uint128_t u64_max = std::numeric_limits<std::uint64_t>::max();
+    const uint128_t half = uint128_t{ 1 } << 64;
+
+    auto small = multiply_with_overflow_detection(u64_max, u64_max);
+    auto large = multiply_with_overflow_detection(half, uint128_t{ 255 });
+    auto overflow = multiply_with_overflow_detection(half, half);
+    auto zero = multiply_with_overflow_detection(uint128_t{ 0 }, half);
+
+    expect(bool{ small });
+    expect(small.value() == (u64_max * u64_max));
+    expect(small.value() / u64_max == u64_max);
+    expect(bool{ large });
+    expect(large.value() == (half * 255));
+    expect(!overflow);
+    expect(zero.value() == 0);
+  };
+
+  "[math] multiply_with_overflow_detection wide integers"_test = []() {
+    using wide_uint128_t = math::wide_integer::uint128_t;
+    const wide_uint128_t u64_max = std::numeric_limits<std::uint64_t>::max();
+    const wide_uint128_t half = wide_uint128_t{ 1 } << 64;
+
+    auto small = multiply_with_overflow_detection(u64_max, u64_max);
+    auto large = multiply_with_overflow_detection(half, wide_uint128_t{ 255 });
+    auto overflow = multiply_with_overflow_detection(half, half);
+    auto zero = multiply_with_overflow_detection(wide_uint128_t{ 0 }, half);
+
+    expect(bool{ small });
+    expect(small.value() == (u64_max * u64_max));
+    expect(small.value() / u64_max == u64_max);
+    expect(bool{ large });
+    expect(large.value() == (half * 255));
+    expect(!overflow);
+    expect(zero.value() == 0);
+  };
+
+  "[math] uint128_t backends agree"_test = []() {
+    using wide_uint128_t = math::wide_integer::uint128_t;
+    std::uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < 1000; i++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      const std::uint64_t lhs = state;
+      const std::uint64_t rhs = state >> (i % 64);
+      const std::uint64_t divisor = (state >> 34) | 1;
+
+      const uint128_t native =
+        rounding_division(uint128_t{ lhs } * rhs, uint128_t{ divisor });
+      const wide_uint128_t wide = rounding_division(
+        wide_uint128_t{ lhs } * rhs, wide_uint128_t{ divisor });
+
+      expect(static_cast<std::uint64_t>(native) ==
+             static_cast<std::uint64_t>(wide));
+      expect(static_cast<std::uint64_t>(native >> 64) ==
+             static_cast<std::uint64_t>(wide >> 64));
+    }
+  };
+};
+}  // namespace embed
@@ -0,0 +1,115 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/mmio.hpp>
+
+#include <array>
+
+namespace embed {
+namespace {
+struct control
+{
+  using enable = bit_field<0>;
+  using mode = bit_field<4, 2>;
+  using prescaler = bit_field<8, 8>;
+  using full = bit_field<0, 32>;
+};
+
+static_assert(control::enable::mask<std::uint32_t>() == 0x0000'0001);
+static_assert(control::mode::mask<std::uint32_t>() == 0x0000'0030);
+static_assert(control::prescaler::mask<std::uint32_t>() == 0x0000'FF00);
+static_assert(control::full::mask<std::uint32_t>() == 0xFFFF'FFFF);
+static_assert(bit_field<4, 4>::mask<std::uint8_t>() == 0xF0);
+static_assert(field_mask<std::uint32_t,
+                         control::enable,
+                         control::mode,
+                         control::prescaler>() == 0x0000'FF31);
+static_assert(insert<std::uint32_t, control::mode, control::prescaler>(
+                0xFFFF'0001,
+                control::mode::value(2),
+                control::prescaler::value(0x1AB)) == 0xFFFF'AB21);
+static_assert(extract<control::prescaler>(std::uint32_t{ 0x1234'5678 }) ==
+              0x56);
+}  // namespace
+
+boost::ut::suite mmio_test = []() {
+  using namespace boost::ut;
+
+  "[mmio] read and write"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 1> memory{ 0x1234'5678 };
+    mmio_register<std::uint32_t> reg(memory.data());
+
+    // Exercise + Verify
+    expect(that % 0x1234'5678 == reg.read());
+    expect(that % 0x56 == reg.get<control::prescaler>());
+    reg.write(0xAAAA'5555);
+    expect(that % 0xAAAA'5555 == memory[0]);
+    expect(memory.data() == reg.address());
+  };
+
+  "[mmio] write fields"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 1> memory{ 0xFFFF'FFFF };
+    mmio_register<std::uint32_t> reg(memory.data());
+
+    // Exercise
+    reg.write<control::enable, control::mode>(1, 2);
+
+    // Verify
+    expect(that % 0x0000'0021 == memory[0]);
+  };
+
+  "[mmio] modify fields"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 1> memory{ 0xFFFF'0000 };
+    mmio_register<std::uint32_t> reg(memory.data());
+
+    // Exercise
+    reg.modify<control::enable, control::mode, control::prescaler>(1, 3, 0x42);
+    reg.modify<control::mode>(0b101);
+
+    // Verify
+    expect(that % 0xFFFF'4211 == memory[0]);
+    expect(that % 1 == reg.get<control::mode>());
+  };
+
+  "[mmio] set and clear without aliases"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 1> memory{ 0x0000'0100 };
+    mmio_register<std::uint32_t> reg(memory.data());
+
+    // Exercise + Verify
+    reg.set<control::enable, control::mode>();
+    expect(that % 0x0000'0131 == memory[0]);
+    reg.clear<control::prescaler, control::enable>();
+    expect(that % 0x0000'0030 == memory[0]);
+  };
+
+  "[mmio] set and clear with aliases"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 3> memory{ 0x0000'0100, 0, 0 };
+    mmio_register<std::uint32_t, register_aliases{ .set = 4, .clear = 8 }> reg(
+      memory.data());
+
+    // Exercise
+    reg.set<control::mode>();
+    reg.clear<control::enable>();
+
+    // Verify
+    expect(that % 0x0000'0100 == memory[0]);
+    expect(that % 0x0000'0030 == memory[1]);
+    expect(that % 0x0000'0001 == memory[2]);
+  };
+
+  "[mmio] 8-bit register"_test = []() {
+    // Setup
+    std::array<std::uint8_t, 1> memory{ 0x0F };
+    mmio_register<std::uint8_t> reg(memory.data());
+
+    // Exercise
+    reg.modify<bit_field<4, 4>>(0xA);
+
+    // Verify
+    expect(that % 0xAF == memory[0]);
+  };
+};
+}  // namespace embed
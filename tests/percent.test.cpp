@@ -1,6 +1,8 @@
 #include <boost/ut.hpp>
 #include <libembeddedhal/percent.hpp>
 
+#include <charconv>
+
 namespace embed {
 boost::ut::suite percent_ratio_and_cast_test = []() {
   using namespace boost::ut;
@@ -364,4 +366,184 @@ boost::ut::suite percent_to_string_test = []() {
   value = percent::from_ratio(-2147483644, 2147483647);
   expect(get_actual_string() == std::string_view{ "-0.999999999" });
 };
+
+boost::ut::suite percent_to_chars_test = []() {
+  using namespace boost::ut;
+
+  std::array<char, 16> buffer{};
+
+  auto format = [&buffer](percent p_value, size_t p_precision) {
+    auto result = p_value.to_chars(buffer, p_precision);
+    return std::string_view(result.data(), result.size());
+  };
+
+  "[percent] to_chars precision"_test = [&]() {
+    expect(format(0.25, 9) == std::string_view{ "+0.250000000" });
+    expect(format(0.25, 3) == std::string_view{ "+0.250" });
+    expect(format(0.25, 2) == std::string_view{ "+0.25" });
+    expect(format(0.26, 1) == std::string_view{ "+0.3" });
+    expect(format(0.25, 0) == std::string_view{ "+0" });
+    expect(format(-0.6666666667, 3) == std::string_view{ "-0.667" });
+    expect(format(-0.3333333333, 4) == std::string_view{ "-0.3333" });
+    expect(format(0.9999, 3) == std::string_view{ "+1.000" });
+    expect(format(-0.9999, 2) == std::string_view{ "-1.00" });
+    expect(format(1.0, 5) == std::string_view{ "+1.00000" });
+    expect(format(-1.0, 0) == std::string_view{ "-1" });
+    expect(format(0.0, 4) == std::string_view{ "+0.0000" });
+    expect(format(0.5, 20) == std::string_view{ "+0.500000000" });
+  };
+
+  "[percent] to_chars matches std::to_chars"_test = [&]() {
+    // Reference implementation using std::to_chars and zero padding
+    auto reference = [](percent p_value, std::span<char, 12> p_output) {
+      const std::int64_t magnitude = absolute_value(p_value.raw_value());
+      const auto decimal = rounding_division(magnitude * 1'000'000'000,
+                                             percent::raw_max());
+      std::array<char, 10> digits{};
+      auto end = std::to_chars(digits.begin(), digits.end(), decimal).ptr;
+      const auto length = static_cast<size_t>(end - digits.begin());
+      std::fill(p_output.begin(), p_output.end(), '0');
+      p_output[0] = (p_value.raw_value() < 0) ? '-' : '+';
+      p_output[2] = '.';
+      std::copy(digits.begin(), end, p_output.end() - length);
+      return std::string_view(p_output.data(), p_output.size());
+    };
+
+    std::array<char, 12> expected{};
+    for (int i = -1000; i <= 1000; i++) {
+      const auto value = percent::from_ratio(i * 2147, 2147483);
+      expect(format(value, percent::max_precision) ==
+             reference(value, expected));
+    }
+  };
+
+  "[percent] to_chars buffer too small"_test = []() {
+    std::array<char, 5> small{};
+    expect(that % 0 == percent(0.5).to_chars(small, 3).size());
+    expect(that % 5 == percent(0.5).to_chars(small, 2).size());
+    expect(that % 6 == percent::chars_length(3));
+    expect(that % 2 == percent::chars_length(0));
+  };
+
+  "[percent] to_chars span of percents"_test = []() {
+    std::array<char, 24> text{};
+    const std::array<percent, 4> values{ percent(0.5),
+                                         percent(-0.25),
+                                         percent(1.0),
+                                         percent(0.125) };
+
+    auto all = to_chars(values, text, 2);
+    expect(std::string_view(all.data(), all.size()) ==
+           std::string_view{ "+0.50,-0.25,+1.00,+0.12" });
+
+    auto some = to_chars(values, std::span(text).first(12), 2, ';');
+    expect(std::string_view(some.data(), some.size()) ==
+           std::string_view{ "+0.50;-0.25" });
+
+    auto none = to_chars(values, std::span(text).first(4), 2);
+    expect(that % 0 == none.size());
+  };
+};
+
+boost::ut::suite basic_percent_width_test = []() {
+  using namespace boost::ut;
+
+  "[percent] storage size"_test = []() {
+    static_assert(sizeof(percent) == 4);
+    static_assert(sizeof(percent16) == 2);
+    static_assert(sizeof(percent8) == 1);
+    static_assert(std::is_same_v<percent16::overflow_t, std::int32_t>);
+    static_assert(std::is_same_v<percent8::overflow_t, std::int32_t>);
+    static_assert(std::is_same_v<percent::overflow_t, std::int64_t>);
+    expect(that % 32767 == percent16::raw_max());
+    expect(that % -32767 == percent16::raw_min());
+    expect(that % 127 == percent8::raw_max());
+    expect(that % -127 == percent8::raw_min());
+  };
+
+  "[percent] 16-bit from_ratio and operator*"_test = []() {
+    expect(that % 16383 == percent16::from_ratio(1, 2).raw_value());
+    expect(that % -6553 == percent16::from_ratio(-1, 5).raw_value());
+    expect(that % 32767 == percent16::from_ratio(7, 5).raw_value());
+    expect(that % 32767 ==
+           percent16::from_ratio(std::uint16_t{ 65535 }, std::uint16_t{ 65535 })
+             .raw_value());
+    expect(that % 50 == 100 * percent16::from_ratio(1, 2));
+    expect(that % -20 == percent16::from_ratio(-1, 5) * 100);
+    expect(that % 999908 ==
+           std::int64_t{ 4000000 } * percent16::from_ratio(1, 4));
+    expect(0.25_d == percent16::from_ratio(1, 4).to<float>());
+    expect(0.5_d == percent16(0.5).to<double>());
+  };
+
+  "[percent] 8-bit from_ratio and operator*"_test = []() {
+    expect(that % 63 == percent8::from_ratio(1, 2).raw_value());
+    expect(that % -127 == percent8::from_ratio(-3, 2).raw_value());
+    expect(that % 2441 == 10000 * percent8::from_ratio(1, 4));
+    expect(that % 127 == percent8(1.0).raw_value());
+  };
+
+  "[percent] convert"_test = []() {
+    expect(that % 32767 ==
+           percent16::convert<12>(std::int16_t{ 2047 }).raw_value());
+    expect(that % 127 == percent8::convert<8>(std::uint8_t{ 255 }).raw_value());
+    // Wider than the representation goes through a 32-bit percent
+    expect(that % 32767 ==
+           percent16::convert<24>(std::uint32_t{ 0xFFFFFF }).raw_value());
+    expect(that % 16383 ==
+           percent16::convert<24>(std::uint32_t{ 0x7FFFFF }).raw_value());
+  };
+
+  "[percent] cross width conversions"_test = []() {
+    static_assert(std::is_convertible_v<percent8, percent16>);
+    static_assert(std::is_convertible_v<percent16, percent>);
+    static_assert(!std::is_convertible_v<percent, percent16>);
+    static_assert(!std::is_convertible_v<percent16, percent8>);
+
+    // Widening
+    percent full = percent16::from_ratio(1, 1);
+    percent negative_full = percent8::from_ratio(-1, 1);
+    percent half = percent16::from_ratio(1, 2);
+    percent16 eighth = percent8::from_ratio(1, 8);
+    expect(that % percent::raw_max() == full.raw_value());
+    expect(that % percent::raw_min() == negative_full.raw_value());
+    expect(that % 0x3FFF7FFE == half.raw_value());
+    expect(that % 0xF1E == eighth.raw_value());
+
+    // Narrowing
+    auto narrow_full = percent16(percent::from_ratio(1, 1));
+    auto narrow_negative = percent8(percent::from_ratio(-1, 1));
+    auto narrow_half = percent8(percent16::from_ratio(1, 2));
+    expect(that % 32767 == narrow_full.raw_value());
+    expect(that % -127 == narrow_negative.raw_value());
+    expect(that % 63 == narrow_half.raw_value());
+
+    // Round trip through a narrow type is within its resolution
+    percent quarter = percent16(percent::from_ratio(1, 4));
+    expect(0.25_d == quarter.to<double>());
+  };
+
+  "[percent] narrow to_string and to_chars"_test = []() {
+    static_assert(percent16::max_precision == 5);
+    static_assert(percent8::max_precision == 3);
+    expect(std::string_view{ "+0.49998" } ==
+           percent16::from_ratio(1, 2).to_string().data());
+    expect(std::string_view{ "-1.00000" } ==
+           percent16::from_ratio(-1, 1).to_string().data());
+    expect(std::string_view{ "-0.33332" } ==
+           percent16::from_ratio(-1, 3).to_string().data());
+    expect(std::string_view{ "+0.496" } ==
+           percent8::from_ratio(1, 2).to_string().data());
+    expect(std::string_view{ "+1.000" } ==
+           percent8::from_ratio(1, 1).to_string().data());
+
+    std::array<char, 24> text{};
+    const std::array<percent16, 3> values{ percent16(0.5),
+                                           percent16(-0.25),
+                                           percent16(1.0) };
+    auto all = to_chars<std::int16_t>(values, text, 2);
+    expect(std::string_view(all.data(), all.size()) ==
+           std::string_view{ "+0.50,-0.25,+1.00" });
+  };
+};
 }  // namespace embed
@@ -0,0 +1,191 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/power_manager.hpp>
+#include <libembeddedhal/suspendable/mock.hpp>
+
+namespace embed {
+boost::ut::suite power_manager_test = []() {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "[power_manager] suspends after the idle timeout"_test = []() {
+    // Setup
+    mock::suspendable spi_bus;
+    std::chrono::nanoseconds now = 1s;
+    std::array domains{
+      power_manager::domain{ .device = &spi_bus, .idle_timeout = 10ms },
+    };
+    power_manager manager(
+      domains, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+
+    // Exercise + Verify
+    expect(bool{ manager.use(0) });
+    expect(1s + 10ms == manager.next_due());
+
+    now += 5ms;
+    expect(bool{ manager.poll() });
+    expect(!spi_bus.suspended);
+
+    now += 5ms;
+    expect(bool{ manager.poll() });
+    expect(spi_bus.suspended);
+    expect(std::chrono::nanoseconds::max() == manager.next_due());
+
+    now += 20ms;
+    expect(bool{ manager.use(0) });
+    expect(!spi_bus.suspended);
+    expect(that % 1 == spi_bus.spy_suspend.call_history().size());
+    expect(that % 1 == spi_bus.spy_resume.call_history().size());
+
+    now += 1ms;
+    expect(bool{ manager.use(0) });
+    expect(that % 1 == spi_bus.spy_resume.call_history().size());
+
+    // Time before the first call is not counted
+    const auto& stats = domains[0].stats;
+    expect(11ms == stats.active);
+    expect(20ms == stats.suspended);
+    expect(that % 1 == stats.suspends);
+    expect(that % 1 == stats.resumes);
+  };
+
+  "[power_manager] resumes ahead of scheduled windows"_test = []() {
+    // Setup
+    mock::suspendable adc;
+    std::chrono::nanoseconds now = 0ns;
+    std::array domains{
+      power_manager::domain{ .device = &adc,
+                             .period = 100ms,
+                             .window = 10ms,
+                             .wake_lead = 2ms,
+                             .next_window = 50ms },
+    };
+    power_manager manager(
+      domains, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+    std::vector<std::chrono::nanoseconds> resumed_at;
+    std::vector<std::chrono::nanoseconds> suspended_at;
+
+    // Exercise
+    for (; now < 300ms; now += 1ms) {
+      const bool was_suspended = adc.suspended;
+      expect(bool{ manager.poll() });
+      if (was_suspended && !adc.suspended) {
+        resumed_at.push_back(now);
+      } else if (!was_suspended && adc.suspended) {
+        suspended_at.push_back(now);
+      }
+    }
+
+    // Verify
+    expect(std::vector<std::chrono::nanoseconds>{ 48ms, 148ms, 248ms } ==
+           resumed_at);
+    expect(std::vector<std::chrono::nanoseconds>{ 0ms, 60ms, 160ms, 260ms } ==
+           suspended_at);
+    expect(348ms == manager.next_due());
+    expect(36ms == domains[0].stats.active);
+    expect(263ms == domains[0].stats.suspended);
+  };
+
+  "[power_manager] next_due"_test = []() {
+    // Setup
+    mock::suspendable spi_bus;
+    mock::suspendable adc;
+    std::chrono::nanoseconds now = 0ns;
+    std::array domains{
+      power_manager::domain{ .device = &spi_bus, .idle_timeout = 30ms },
+      power_manager::domain{ .device = &adc,
+                             .idle_timeout = 1ms,
+                             .period = 100ms,
+                             .window = 10ms,
+                             .wake_lead = 5ms,
+                             .next_window = 20ms },
+    };
+    power_manager manager(
+      domains, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+
+    // Exercise + Verify
+    expect(bool{ manager.poll() });
+    expect(1ms == manager.next_due());
+
+    now = manager.next_due();
+    expect(bool{ manager.poll() });
+    expect(!spi_bus.suspended);
+    expect(adc.suspended);
+    expect(15ms == manager.next_due());
+
+    now = manager.next_due();
+    expect(bool{ manager.poll() });
+    expect(!adc.suspended);
+    expect(30ms == manager.next_due());
+
+    // The window ends at 30ms, so both are idle by then
+    now = manager.next_due();
+    expect(bool{ manager.poll() });
+    expect(spi_bus.suspended);
+    expect(adc.suspended);
+    expect(115ms == manager.next_due());
+  };
+
+  "[power_manager] missed windows are skipped"_test = []() {
+    // Setup
+    mock::suspendable adc;
+    std::chrono::nanoseconds now = 0ns;
+    std::array domains{
+      power_manager::domain{
+        .device = &adc, .period = 100ms, .window = 10ms, .next_window = 0ms },
+    };
+    power_manager manager(
+      domains, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+
+    // Exercise
+    expect(bool{ manager.poll() });
+    now = 1015ms;
+    expect(bool{ manager.poll() });
+
+    // Verify
+    expect(1100ms == domains[0].next_window);
+    expect(adc.suspended);
+    expect(that % 0 == adc.spy_resume.call_history().size());
+
+    // A window ends exactly at its length
+    now = 1110ms;
+    expect(bool{ manager.poll() });
+    expect(1200ms == domains[0].next_window);
+
+    // Days of missed windows are skipped at once
+    now = 1200ms + 72h + 50ms;
+    expect(bool{ manager.poll() });
+    expect(1300ms + 72h == domains[0].next_window);
+  };
+
+  "[power_manager] errors"_test = []() {
+    // Setup
+    mock::suspendable spi_bus;
+    std::chrono::nanoseconds now = 0ns;
+    std::array domains{
+      power_manager::domain{ .device = &spi_bus },
+    };
+    power_manager manager(
+      domains, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+    spi_bus.spy_suspend.trigger_error_on_call(1);
+
+    // Exercise + Verify
+    expect(!manager.poll());
+    expect(!domains[0].suspended);
+    expect(that % 0 == domains[0].stats.suspends);
+
+    expect(bool{ manager.poll() });
+    expect(domains[0].suspended);
+    expect(that % 1 == domains[0].stats.suspends);
+  };
+};
+}  // namespace embed
@@ -1 +1,38 @@
+#include <boost/ut.hpp>
 #include <libembeddedhal/pwm/interface.hpp>
+
+namespace embed {
+namespace {
+class test_pwm : public embed::pwm
+{
+public:
+  int m_configure_calls = 0;
+
+private:
+  boost::leaf::result<void> driver_configure(const settings&) noexcept override
+  {
+    m_configure_calls++;
+    return {};
+  }
+  boost::leaf::result<void> driver_duty_cycle(percent) noexcept override
+  {
+    return {};
+  }
+};
+}  // namespace
+
+boost::ut::suite pwm_test = []() {
+  using namespace boost::ut;
+  // Setup
+  test_pwm test;
+
+  // Exercise
+  auto result = test.frequency(frequency(2'000));
+
+  // Verify
+  // The default reports that the frequency cannot be changed while running
+  // rather than restarting the channel with configure()
+  expect(!result);
+  expect(that % 0 == test.m_configure_calls);
+};
+}  // namespace embed
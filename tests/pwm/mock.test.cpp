@@ -44,5 +44,24 @@ boost::ut::suite pwm_mock_test = []() {
     expect(!mock.duty_cycle(expected2));
     expect(expected2 == std::get<0>(mock.spy_duty_cycle.call_history().at(2)));
   };
+
+  "embed::mock::pwm::frequency()"_test = []() {
+    // Setup
+    constexpr auto expected1 = frequency(2'000);
+    constexpr auto expected2 = frequency(2'500);
+    embed::mock::pwm mock;
+    mock.spy_frequency.trigger_error_on_call(3);
+
+    // Exercise + Verify
+    expect(bool{ mock.frequency(expected1) });
+    expect(expected1 == std::get<0>(mock.spy_frequency.call_history().at(0)));
+
+    expect(bool{ mock.frequency(expected2) });
+    expect(expected2 == std::get<0>(mock.spy_frequency.call_history().at(1)));
+
+    expect(!mock.frequency(expected2));
+    expect(expected2 == std::get<0>(mock.spy_frequency.call_history().at(2)));
+    expect(that % 0 == mock.spy_configure.call_history().size());
+  };
 };
 }  // namespace embed
@@ -0,0 +1,357 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/accelerometer/interface.hpp>
+#include <libembeddedhal/adc/interface.hpp>
+#include <libembeddedhal/sampling_pipeline.hpp>
+#include <libembeddedhal/temperature/interface.hpp>
+
+#include <vector>
+
+namespace embed {
+namespace {
+/// Simulated bus that accumulates the time spent on it
+struct simulated_bus
+{
+  /// Time to arbitrate, address or select a device before a transaction
+  static constexpr std::chrono::microseconds overhead{ 50 };
+  /// Time to transfer a sample
+  static constexpr std::chrono::microseconds transfer{ 100 };
+
+  void acquire() { busy += overhead; }
+  void read() { busy += transfer; }
+
+  std::chrono::nanoseconds busy{ 0 };
+};
+
+/// Simulated sensor which, like a typical driver, acquires the bus for each
+/// read unless the bus has already been acquired by the pipeline.
+struct simulated_adc : public embed::adc
+{
+  simulated_adc(simulated_bus& p_bus)
+    : bus(&p_bus)
+  {}
+
+  boost::leaf::result<percent> driver_read() noexcept override
+  {
+    if (!batched) {
+      bus->acquire();
+    }
+    bus->read();
+    if (fail) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    return percent::from_ratio(++reads, 100);
+  }
+
+  simulated_bus* bus;
+  bool batched = false;
+  bool fail = false;
+  int reads = 0;
+};
+
+struct simulated_temperature : public embed::temperature_sensor
+{
+  simulated_temperature(simulated_bus& p_bus)
+    : bus(&p_bus)
+  {}
+
+  boost::leaf::result<temperature> driver_read() noexcept override
+  {
+    if (!batched) {
+      bus->acquire();
+    }
+    bus->read();
+    return temperature(298'150'000'000);
+  }
+
+  simulated_bus* bus;
+  bool batched = false;
+};
+}  // namespace
+
+boost::ut::suite sampling_pipeline_test = []() {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "[sampling_pipeline] samples each task at its rate"_test = []() {
+    // Setup
+    simulated_bus bus;
+    simulated_adc fast(bus);
+    simulated_adc slow(bus);
+    spsc_queue<timestamped<percent>, 32> fast_samples;
+    spsc_queue<timestamped<percent>, 32> slow_samples;
+    std::chrono::nanoseconds now = 0ns;
+    std::array schedule{
+      sampling_pipeline::task{ .bus = 0,
+                               .rate = frequency(1000),
+                               .read = sample_into(fast, fast_samples) },
+      sampling_pipeline::task{ .bus = 0,
+                               .rate = frequency(250),
+                               .read = sample_into(slow, slow_samples) },
+    };
+    sampling_pipeline pipeline(
+      schedule, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+
+    // Exercise
+    for (; now < 10ms; now += 500us) {
+      expect(bool{ pipeline.poll() });
+    }
+
+    // Verify
+    expect(that % 10 == fast_samples.size());
+    expect(that % 3 == slow_samples.size());
+    expect(that % 10 == schedule[0].reads);
+    expect(that % 3 == schedule[1].reads);
+    expect(that % 0 == fast_samples.pop().value().timestamp.count());
+    expect(that % 1'000'000 == fast_samples.pop().value().timestamp.count());
+    expect(percent::from_ratio(1, 100) == slow_samples.pop().value().value);
+    expect(that % 4'000'000 == slow_samples.pop().value().timestamp.count());
+    expect(10ms == pipeline.next_due());
+  };
+
+  "[sampling_pipeline] failures and full queues"_test = []() {
+    // Setup
+    simulated_bus bus;
+    simulated_adc failing(bus);
+    simulated_adc working(bus);
+    failing.fail = true;
+    spsc_queue<timestamped<percent>, 1> failing_samples;
+    spsc_queue<timestamped<percent>, 1> working_samples;
+    std::chrono::nanoseconds now = 0ns;
+    std::array schedule{
+      sampling_pipeline::task{ .bus = 0,
+                               .rate = frequency(1000),
+                               .read = sample_into(failing, failing_samples) },
+      sampling_pipeline::task{ .bus = 0,
+                               .rate = frequency(1000),
+                               .read = sample_into(working, working_samples) },
+    };
+    sampling_pipeline pipeline(
+      schedule, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+
+    // Exercise
+    for (; now < 3ms; now += 1ms) {
+      expect(that % 2 == pipeline.poll().value());
+    }
+
+    // Verify
+    expect(that % 0 == schedule[0].reads);
+    expect(that % 3 == schedule[0].failures);
+    // Only the first sample fits in the queue
+    expect(that % 1 == schedule[1].reads);
+    expect(that % 2 == schedule[1].failures);
+    expect(percent::from_ratio(1, 100) == working_samples.pop().value().value);
+  };
+
+  "[sampling_pipeline] skips missed periods"_test = []() {
+    // Setup
+    simulated_bus bus;
+    simulated_adc adc(bus);
+    spsc_queue<timestamped<percent>, 8> samples;
+    std::chrono::nanoseconds now = 0ns;
+    std::array schedule{
+      sampling_pipeline::task{ .rate = frequency(1000),
+                               .read = sample_into(adc, samples) },
+    };
+    sampling_pipeline pipeline(
+      schedule, [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      });
+
+    // Exercise
+    expect(that % 1 == pipeline.poll().value());
+    now = 5500us;
+    expect(that % 1 == pipeline.poll().value());
+    expect(that % 0 == pipeline.poll().value());
+
+    // Verify
+    expect(6500us == pipeline.next_due());
+  };
+
+  "[sampling_pipeline] groups reads per bus"_test = []() {
+    // Setup
+    std::vector<std::string_view> events;
+    std::chrono::nanoseconds now = 0ns;
+    auto read = [&events](std::string_view p_event) {
+      return [&events, p_event](
+               std::chrono::nanoseconds) -> boost::leaf::result<void> {
+        events.push_back(p_event);
+        return {};
+      };
+    };
+    auto handler = [&events](std::string_view p_event) {
+      return [&events, p_event]() -> boost::leaf::result<void> {
+        events.push_back(p_event);
+        return {};
+      };
+    };
+    std::array schedule{
+      sampling_pipeline::task{ .bus = 1, .read = read("b1") },
+      sampling_pipeline::task{ .bus = 0, .read = read("a1") },
+      sampling_pipeline::task{ .bus = 1, .read = read("b2") },
+      sampling_pipeline::task{ .bus = 2, .read = read("c1") },
+    };
+    std::array buses{
+      sampling_pipeline::bus_handlers{ .begin = handler("begin a"),
+                                       .end = handler("end a") },
+      sampling_pipeline::bus_handlers{ .begin = handler("begin b"),
+                                       .end = handler("end b") },
+    };
+    sampling_pipeline pipeline(
+      schedule,
+      [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      },
+      buses);
+
+    // Exercise
+    auto result = pipeline.poll();
+
+    // Verify
+    expect(that % 4 == result.value());
+    const std::vector<std::string_view> expected{
+      "begin a", "a1", "end a", "begin b", "b1", "b2", "end b", "c1",
+    };
+    expect(expected == events);
+  };
+
+  "[sampling_pipeline] ends the bus when a read cannot be timestamped"_test =
+    []() {
+      // Setup
+      std::vector<std::string_view> events;
+      int uptime_calls = 0;
+      auto handler = [&events](std::string_view p_event) {
+        return [&events, p_event]() -> boost::leaf::result<void> {
+          events.push_back(p_event);
+          return {};
+        };
+      };
+      std::array schedule{
+        sampling_pipeline::task{
+          .read = [&events](std::chrono::nanoseconds)
+            -> boost::leaf::result<void> {
+            events.push_back("read");
+            return {};
+          } },
+      };
+      std::array buses{
+        sampling_pipeline::bus_handlers{ .begin = handler("begin"),
+                                         .end = handler("end") },
+      };
+      // Succeeds for poll() and fails for the read's timestamp
+      sampling_pipeline pipeline(
+        schedule,
+        [&uptime_calls]() -> boost::leaf::result<std::chrono::nanoseconds> {
+          if (uptime_calls++ > 0) {
+            return boost::leaf::new_error(std::errc::io_error);
+          }
+          return 0ns;
+        },
+        buses);
+
+      // Exercise
+      auto result = pipeline.poll();
+
+      // Verify
+      expect(!result);
+      const std::vector<std::string_view> expected{ "begin", "end" };
+      expect(expected == events);
+    };
+
+  "[sampling_pipeline] bus utilization versus polling"_test = []() {
+    // Setup
+    // Two buses: an accelerometer-like adc at 800Hz and a temperature sensor
+    // at 10Hz on bus 0, and two adcs at 200Hz on bus 1. The application loop
+    // runs every 250us for 1 second.
+    constexpr auto loop_period = 250us;
+    constexpr auto duration = 1s;
+
+    std::array<simulated_bus, 2> naive_buses{};
+    {
+      simulated_adc accelerometer(naive_buses[0]);
+      simulated_temperature thermometer(naive_buses[0]);
+      simulated_adc adc0(naive_buses[1]);
+      simulated_adc adc1(naive_buses[1]);
+      for (auto now = 0us; now < duration; now += loop_period) {
+        (void)accelerometer.read();
+        (void)thermometer.read();
+        (void)adc0.read();
+        (void)adc1.read();
+      }
+    }
+
+    std::array<simulated_bus, 2> buses{};
+    simulated_adc accelerometer(buses[0]);
+    simulated_temperature thermometer(buses[0]);
+    simulated_adc adc0(buses[1]);
+    simulated_adc adc1(buses[1]);
+    accelerometer.batched = true;
+    thermometer.batched = true;
+    adc0.batched = true;
+    adc1.batched = true;
+
+    spsc_queue<timestamped<percent>, 1024> accelerometer_samples;
+    spsc_queue<timestamped<temperature>, 16> temperature_samples;
+    spsc_queue<timestamped<percent>, 256> adc0_samples;
+    spsc_queue<timestamped<percent>, 256> adc1_samples;
+    std::array schedule{
+      sampling_pipeline::task{
+        .bus = 0,
+        .rate = frequency(800),
+        .read = sample_into(accelerometer, accelerometer_samples) },
+      sampling_pipeline::task{
+        .bus = 0,
+        .rate = frequency(10),
+        .read = sample_into(thermometer, temperature_samples) },
+      sampling_pipeline::task{ .bus = 1,
+                               .rate = frequency(200),
+                               .read = sample_into(adc0, adc0_samples) },
+      sampling_pipeline::task{ .bus = 1,
+                               .rate = frequency(200),
+                               .read = sample_into(adc1, adc1_samples) },
+    };
+    std::array handlers{
+      sampling_pipeline::bus_handlers{
+        .begin = [&buses]() -> boost::leaf::result<void> {
+          buses[0].acquire();
+          return {};
+        } },
+      sampling_pipeline::bus_handlers{
+        .begin = [&buses]() -> boost::leaf::result<void> {
+          buses[1].acquire();
+          return {};
+        } },
+    };
+    std::chrono::nanoseconds now = 0ns;
+    sampling_pipeline pipeline(
+      schedule,
+      [&now]() -> boost::leaf::result<std::chrono::nanoseconds> {
+        return now;
+      },
+      handlers);
+
+    // Exercise
+    for (; now < duration; now += loop_period) {
+      expect(bool{ pipeline.poll() });
+    }
+
+    // Verify
+    expect(that % 800 == accelerometer_samples.size());
+    expect(that % 10 == temperature_samples.size());
+    expect(that % 200 == adc0_samples.size());
+    expect(that % 200 == adc1_samples.size());
+
+    // Naive polling: 4000 loops * 2 sensors * 150us per bus = 1.2s of
+    // traffic per second, more than either bus can carry.
+    expect(that % 1'200'000'000 == naive_buses[0].busy.count());
+    expect(that % 1'200'000'000 == naive_buses[1].busy.count());
+    // Pipeline: bus 0 has 800 acquisitions and 810 reads, bus 1 has 200
+    // acquisitions and 400 reads.
+    expect(that % 121'000'000 == buses[0].busy.count());
+    expect(that % 50'000'000 == buses[1].busy.count());
+  };
+};
+}  // namespace embed
@@ -0,0 +1,457 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/serial/baud_rate.hpp>
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace embed {
+boost::ut::suite serial_baud_rate_test = []() {
+  using namespace boost::ut;
+  using namespace embed::literals;
+
+  class dummy_pin : public embed::interrupt_pin
+  {
+  public:
+    boost::leaf::result<void> driver_configure(
+      const settings&) noexcept override
+    {
+      return {};
+    }
+    boost::leaf::result<bool> driver_level() noexcept override { return true; }
+    boost::leaf::result<void> driver_attach_interrupt(
+      std::function<void(void)> p_callback,
+      trigger_edge p_trigger) noexcept override
+    {
+      m_callback = p_callback;
+      m_trigger = p_trigger;
+      return {};
+    }
+    boost::leaf::result<void> driver_detach_interrupt() noexcept override
+    {
+      m_callback = nullptr;
+      return {};
+    }
+
+    std::function<void(void)> m_callback{};
+    trigger_edge m_trigger = trigger_edge::falling;
+  };
+
+  class dummy_counter : public embed::counter
+  {
+  public:
+    boost::leaf::result<uptime_t> driver_uptime() noexcept override
+    {
+      return uptime_t{ .frequency = 48_MHz, .count = m_count };
+    }
+
+    std::uint32_t m_count = 0;
+  };
+
+  class dummy_serial : public embed::serial
+  {
+  public:
+    boost::leaf::result<void> driver_configure(
+      const settings& p_settings) noexcept override
+    {
+      m_settings = p_settings;
+      m_configured.push_back(p_settings.baud_rate);
+      return {};
+    }
+    boost::leaf::result<void> driver_write(
+      std::span<const std::byte> p_data) noexcept override
+    {
+      if (m_settings.baud_rate == m_broken_baud_rate) {
+        return {};
+      }
+      m_written.insert(m_written.end(), p_data.begin(), p_data.end());
+      return {};
+    }
+    boost::leaf::result<size_t> driver_bytes_available() noexcept override
+    {
+      if (m_settings.baud_rate == m_broken_baud_rate) {
+        return 0;
+      }
+      return m_received.size();
+    }
+    boost::leaf::result<std::span<const std::byte>> driver_read(
+      std::span<std::byte> p_data) noexcept override
+    {
+      size_t count = std::min(p_data.size(), m_received.size());
+      for (size_t i = 0; i < count; i++) {
+        p_data[i] = m_received.front();
+        m_received.pop_front();
+      }
+      return p_data.first(count);
+    }
+    boost::leaf::result<void> driver_flush() noexcept override
+    {
+      m_flushes++;
+      return {};
+    }
+
+    void receive(std::span<const std::byte> p_data)
+    {
+      m_received.insert(m_received.end(), p_data.begin(), p_data.end());
+    }
+
+    settings m_settings{};
+    std::vector<std::byte> m_written{};
+    std::deque<std::byte> m_received{};
+    std::vector<std::uint32_t> m_configured{};
+    std::uint32_t m_broken_baud_rate = 0;
+    int m_flushes = 0;
+  };
+
+  // Every reading of the uptime advances it by 1ms
+  auto fake_uptime = []() {
+    return [now = std::chrono::nanoseconds(0)]() mutable
+           -> boost::leaf::result<std::chrono::nanoseconds> {
+      now += std::chrono::milliseconds(1);
+      return now;
+    };
+  };
+  constexpr auto timeout = std::chrono::milliseconds(10);
+
+  auto frame = [](std::uint32_t p_baud_rate) {
+    return std::array<std::byte, baud_rate_frame_size>{
+      baud_rate_frame_start,
+      static_cast<std::byte>(p_baud_rate >> 0),
+      static_cast<std::byte>(p_baud_rate >> 8),
+      static_cast<std::byte>(p_baud_rate >> 16),
+      static_cast<std::byte>(p_baud_rate >> 24),
+    };
+  };
+
+  "[baud_rate] nearest_standard_baud_rate"_test = []() {
+    expect(that % 115200 == nearest_standard_baud_rate(115200));
+    expect(that % 115200 == nearest_standard_baud_rate(113000));
+    expect(that % 115200 == nearest_standard_baud_rate(117500));
+    expect(that % 9600 == nearest_standard_baud_rate(9650));
+    expect(that % 921600 == nearest_standard_baud_rate(920000));
+    expect(that % 100000 == nearest_standard_baud_rate(100000));
+    expect(that % 250000 == nearest_standard_baud_rate(250000));
+  };
+
+  "[baud_rate] estimate_baud_rate"_test = []() {
+    // Setup
+    // 0x55 at 115200 baud sampled by a 48MHz counter is ~416.67 cycles per bit
+    constexpr std::array<std::uint32_t, 10> sync_byte{
+      1000, 1417, 1833, 2250, 2667, 3083, 3500, 3917, 4333, 4750,
+    };
+    // 0x0F at 9600 baud: start bit + four 1s, four 0s, stop bit
+    constexpr std::array<std::uint32_t, 4> multi_bit{ 0, 5000, 25000, 45000 };
+    // Counter overflow mid-byte
+    constexpr std::uint32_t max = std::numeric_limits<std::uint32_t>::max();
+    constexpr std::array<std::uint32_t, 3> overflow{
+      max - 200,
+      max - 200 + 417,
+      max - 200 + 834,
+    };
+
+    // Exercise + Verify
+    expect(that % 0 == estimate_baud_rate(48_MHz, {}));
+    expect(that % 0 ==
+           estimate_baud_rate(48_MHz, std::span(sync_byte).first(1)));
+    expect(that % 115200 ==
+           nearest_standard_baud_rate(estimate_baud_rate(48_MHz, sync_byte)));
+    expect(that % 9600 == estimate_baud_rate(48_MHz, multi_bit));
+    expect(that % 115108 == estimate_baud_rate(48_MHz, overflow));
+  };
+
+  "[baud_rate] baud_rate_detector"_test = []() {
+    // Setup
+    dummy_pin pin;
+    dummy_counter counter;
+    baud_rate_detector<4> detector(pin, counter);
+    constexpr std::array<std::uint32_t, 5> edges{ 100, 5100, 10100, 15100,
+                                                  20100 };
+
+    // Exercise
+    expect(bool{ detector.start() });
+    expect(!detector.baud_rate());
+    for (const auto edge : edges) {
+      counter.m_count = edge;
+      pin.m_callback();
+    }
+    auto baud_rate = detector.baud_rate();
+    expect(bool{ detector.stop() });
+
+    // Verify
+    expect(interrupt_pin::trigger_edge::both == pin.m_trigger);
+    expect(detector.done());
+    expect(that % 4 == detector.edges().size());
+    expect(that % 15100 == detector.edges().back());
+    expect(that % 9600 == baud_rate.value());
+    expect(!pin.m_callback);
+  };
+
+  "[baud_rate] negotiate_baud_rate accepted"_test = [frame,
+                                                      fake_uptime,
+                                                      timeout]() {
+    // Setup
+    dummy_serial serial;
+    constexpr std::array<std::uint32_t, 3> rates{ 921600, 460800, 115200 };
+    serial.receive(frame(0));
+    serial.receive(frame(460800));
+    serial.receive(frame(460800));
+
+    // Exercise
+    auto settings =
+      negotiate_baud_rate(serial, {}, rates, fake_uptime(), timeout).value();
+
+    // Verify
+    const auto first = frame(921600);
+    const auto second = frame(460800);
+    expect(that % 460800 == settings.baud_rate);
+    expect(that % 460800 == serial.m_settings.baud_rate);
+    expect(that % 1 == serial.m_configured.size());
+    expect(that % 15 == serial.m_written.size());
+    expect(std::equal(first.begin(), first.end(), serial.m_written.begin()));
+    // Proposal followed by its confirmation at the new baud rate
+    expect(
+      std::equal(second.begin(), second.end(), serial.m_written.begin() + 5));
+    expect(
+      std::equal(second.begin(), second.end(), serial.m_written.begin() + 10));
+  };
+
+  "[baud_rate] negotiate_baud_rate none accepted"_test = [frame,
+                                                          fake_uptime,
+                                                          timeout]() {
+    // Setup
+    dummy_serial serial;
+    constexpr std::array<std::uint32_t, 2> rates{ 921600, 115200 };
+    serial.receive(frame(0));
+    serial.receive(frame(115200));
+
+    // Exercise
+    auto settings =
+      negotiate_baud_rate(serial, {}, rates, fake_uptime(), timeout).value();
+
+    // Verify
+    // Ends with a proposal to stay at the current baud rate
+    const auto last = frame(115200);
+    expect(that % 115200 == settings.baud_rate);
+    expect(that % 10 == serial.m_written.size());
+    expect(serial.m_configured.empty());
+    expect(
+      std::equal(last.begin(), last.end(), serial.m_written.begin() + 5));
+
+    // The final proposal is rejected
+    serial.receive(frame(0));
+    serial.receive(frame(0));
+    expect(!negotiate_baud_rate(serial, {}, rates, fake_uptime(), timeout));
+  };
+
+  "[baud_rate] negotiate_baud_rate unconfirmed falls back"_test =
+    [frame, fake_uptime, timeout]() {
+      // Setup
+      dummy_serial serial;
+      serial.m_broken_baud_rate = 921600;
+      constexpr std::array<std::uint32_t, 2> rates{ 921600, 460800 };
+      serial.receive(frame(921600));
+      serial.receive(frame(460800));
+      serial.receive(frame(460800));
+
+      // Exercise
+      auto settings =
+        negotiate_baud_rate(serial, {}, rates, fake_uptime(), timeout).value();
+
+      // Verify
+      const std::vector<std::uint32_t> configured{ 921600, 115200, 460800 };
+      expect(that % 460800 == settings.baud_rate);
+      expect(configured == serial.m_configured);
+      expect(that % 1 == serial.m_flushes);
+      // The confirmation at 921600 never left the port
+      expect(that % 15 == serial.m_written.size());
+      expect(serial.m_received.empty());
+    };
+
+  "[baud_rate] negotiate_baud_rate times out"_test = [fake_uptime, timeout]() {
+    // Setup
+    dummy_serial serial;
+    constexpr std::array<std::uint32_t, 1> rates{ 921600 };
+
+    // Exercise
+    auto settings =
+      negotiate_baud_rate(serial, {}, rates, fake_uptime(), timeout);
+
+    // Verify
+    expect(!settings);
+    expect(serial.m_configured.empty());
+  };
+
+  "[baud_rate] accept_baud_rate"_test = [frame, fake_uptime, timeout]() {
+    // Setup
+    dummy_serial serial;
+    constexpr std::array<std::uint32_t, 2> rates{ 115200, 460800 };
+    const auto unsupported = frame(921600);
+    const auto supported = frame(460800);
+    serial.receive(unsupported);
+    serial.receive(supported);
+    serial.receive(supported);
+
+    // Exercise
+    auto accepted =
+      accept_baud_rate(serial, {}, rates, fake_uptime(), timeout).value();
+
+    // Verify
+    const auto reject = frame(0);
+    expect(that % 460800 == accepted.baud_rate);
+    expect(that % 460800 == serial.m_settings.baud_rate);
+    expect(that % 15 == serial.m_written.size());
+    expect(std::equal(reject.begin(), reject.end(), serial.m_written.begin()));
+    expect(std::equal(
+      supported.begin(), supported.end(), serial.m_written.begin() + 5));
+    expect(std::equal(
+      supported.begin(), supported.end(), serial.m_written.begin() + 10));
+  };
+
+  "[baud_rate] accept_baud_rate unconfirmed falls back"_test =
+    [frame, fake_uptime, timeout]() {
+      // Setup
+      dummy_serial serial;
+      serial.m_broken_baud_rate = 460800;
+      constexpr std::array<std::uint32_t, 2> rates{ 115200, 460800 };
+      serial.receive(frame(460800));
+      serial.receive(frame(115200));
+
+      // Exercise
+      auto accepted =
+        accept_baud_rate(serial, {}, rates, fake_uptime(), timeout).value();
+
+      // Verify
+      const std::vector<std::uint32_t> configured{ 460800, 115200 };
+      const auto last = frame(115200);
+      expect(that % 115200 == accepted.baud_rate);
+      expect(configured == serial.m_configured);
+      expect(that % 1 == serial.m_flushes);
+      expect(that % 10 == serial.m_written.size());
+      expect(
+        std::equal(last.begin(), last.end(), serial.m_written.begin() + 5));
+    };
+
+  "[baud_rate] accept_baud_rate times out"_test = [fake_uptime, timeout]() {
+    // Setup
+    dummy_serial serial;
+    constexpr std::array<std::uint32_t, 1> rates{ 921600 };
+
+    // Exercise + Verify
+    expect(!accept_baud_rate(serial, {}, rates, fake_uptime(), timeout));
+  };
+
+  "[baud_rate] negotiate and accept between two ports"_test = []() {
+    // Setup
+    // Bytes written at the broken baud rate never reach the other end
+    struct link
+    {
+      std::mutex mutex;
+      std::deque<std::byte> to_acceptor;
+      std::deque<std::byte> to_negotiator;
+      std::uint32_t broken_baud_rate = 0;
+    };
+
+    class linked_serial : public embed::serial
+    {
+    public:
+      linked_serial(link& p_link, bool p_negotiator)
+        : m_link(&p_link)
+        , m_out(p_negotiator ? &p_link.to_acceptor : &p_link.to_negotiator)
+        , m_in(p_negotiator ? &p_link.to_negotiator : &p_link.to_acceptor)
+      {}
+      boost::leaf::result<void> driver_configure(
+        const settings& p_settings) noexcept override
+      {
+        m_settings = p_settings;
+        return {};
+      }
+      boost::leaf::result<void> driver_write(
+        std::span<const std::byte> p_data) noexcept override
+      {
+        std::lock_guard lock(m_link->mutex);
+        if (m_settings.baud_rate == m_link->broken_baud_rate) {
+          return {};
+        }
+        m_out->insert(m_out->end(), p_data.begin(), p_data.end());
+        return {};
+      }
+      boost::leaf::result<size_t> driver_bytes_available() noexcept override
+      {
+        std::lock_guard lock(m_link->mutex);
+        return m_in->size();
+      }
+      boost::leaf::result<std::span<const std::byte>> driver_read(
+        std::span<std::byte> p_data) noexcept override
+      {
+        std::lock_guard lock(m_link->mutex);
+        size_t count = std::min(p_data.size(), m_in->size());
+        for (size_t i = 0; i < count; i++) {
+          p_data[i] = m_in->front();
+          m_in->pop_front();
+        }
+        return p_data.first(count);
+      }
+      boost::leaf::result<void> driver_flush() noexcept override
+      {
+        std::lock_guard lock(m_link->mutex);
+        m_in->clear();
+        return {};
+      }
+
+      settings m_settings{};
+
+    private:
+      link* m_link;
+      std::deque<std::byte>* m_out;
+      std::deque<std::byte>* m_in;
+    };
+
+    auto uptime = []() -> boost::leaf::result<std::chrono::nanoseconds> {
+      return std::chrono::steady_clock::now().time_since_epoch();
+    };
+
+    auto negotiate = [uptime](std::span<const std::uint32_t> p_proposed,
+                              std::span<const std::uint32_t> p_supported,
+                              std::uint32_t p_broken_baud_rate = 0) {
+      constexpr auto link_timeout = std::chrono::milliseconds(50);
+      link wire;
+      wire.broken_baud_rate = p_broken_baud_rate;
+      linked_serial negotiator(wire, true);
+      linked_serial acceptor(wire, false);
+      serial::settings accepted{};
+      std::thread other_end([&]() {
+        accepted =
+          accept_baud_rate(acceptor, {}, p_supported, uptime, link_timeout)
+            .value();
+      });
+      auto negotiated =
+        negotiate_baud_rate(negotiator, {}, p_proposed, uptime, link_timeout);
+      other_end.join();
+      expect(bool{ negotiated });
+      expect(negotiated.value().baud_rate == accepted.baud_rate);
+      expect(acceptor.m_settings.baud_rate == negotiator.m_settings.baud_rate);
+      return accepted.baud_rate;
+    };
+
+    constexpr std::array<std::uint32_t, 4> proposed{
+      921600, 460800, 230400, 115200
+    };
+    constexpr std::array<std::uint32_t, 2> slow{ 9600, 115200 };
+    constexpr std::array<std::uint32_t, 2> medium{ 115200, 230400 };
+    constexpr std::array<std::uint32_t, 1> fastest{ 921600 };
+    constexpr std::array<std::uint32_t, 2> fast{ 460800, 921600 };
+
+    // Exercise + Verify
+    // Every faster rate is rejected
+    expect(that % 115200 == negotiate(proposed, slow));
+    expect(that % 230400 == negotiate(proposed, medium));
+    expect(that % 921600 == negotiate(proposed, fastest));
+    // Neither end lists the current rate
+    expect(that % 115200 == negotiate(fastest, slow));
+    // The link does not work at the highest common rate
+    expect(that % 460800 == negotiate(proposed, fast, 921600));
+    expect(that % 115200 == negotiate(fastest, fastest, 921600));
+  };
+};
+}  // namespace embed
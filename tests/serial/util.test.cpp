@@ -219,6 +219,63 @@ boost::ut::suite serial_util_test = []() {
     expect(that % 5 == serial.m_bytes_available);
   };
 
+  // Every reading of the uptime advances it by 1ms
+  auto fake_uptime = []() {
+    return [now = std::chrono::nanoseconds(0)]() mutable
+           -> boost::leaf::result<std::chrono::nanoseconds> {
+      now += 1ms;
+      return now;
+    };
+  };
+
+  "[success] read<Length> with timeout"_test = [fake_uptime]() {
+    // Setup
+    dummy serial;
+    std::array<std::byte, 5> expected_buffer;
+    expected_buffer.fill(filler_byte);
+
+    // Exercise
+    auto result = read<expected_buffer.size()>(serial, fake_uptime(), 10ms);
+    bool successful = static_cast<bool>(result);
+
+    // Verify
+    expect(successful);
+    expect(std::equal(
+      expected_buffer.begin(), expected_buffer.end(), result.value().begin()));
+    expect(that % 5 == serial.m_bytes_available);
+  };
+
+  "[failure timeout] read<Length> with timeout"_test = [fake_uptime]() {
+    // Setup
+    dummy serial;
+
+    // Exercise
+    auto result = read<5>(serial, fake_uptime(), 2ms);
+    bool successful = static_cast<bool>(result);
+
+    // Verify
+    expect(!successful);
+    expect(that % nullptr == serial.m_in.data());
+    expect(that % 0 == serial.m_in.size());
+    expect(that % 2 == serial.m_bytes_available);
+  };
+
+  "[failure bytes_available] read<Length> with timeout"_test =
+    [fake_uptime]() {
+      // Setup
+      dummy serial;
+      serial.m_bytes_available_fails = true;
+
+      // Exercise
+      auto result = read<5>(serial, fake_uptime(), 10ms);
+      bool successful = static_cast<bool>(result);
+
+      // Verify
+      expect(!successful);
+      expect(that % nullptr == serial.m_in.data());
+      expect(that % 0 == serial.m_bytes_available);
+    };
+
   "[success] write_then_read"_test = []() {
     // Setup
     dummy serial;
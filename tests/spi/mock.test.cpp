@@ -54,5 +54,60 @@ boost::ut::suite spi_mock_test = []() {
     mock.reset();
     expect(mock.write_record.size() == 0);
   };
+
+  "embed::mock::write_only_spi single lane command transfer"_test = []() {
+    // Setup
+    constexpr std::array<const std::byte, 2> data{ std::byte{ 0xDD },
+                                                   std::byte{ 0xCC } };
+    constexpr embed::spi::command_phases fast_read{ .command = 0x0B,
+                                                    .address = 0x123456,
+                                                    .address_bytes = 3,
+                                                    .dummy_cycles = 8 };
+    constexpr embed::spi::command_phases octal_command{ .command = 0x05FA,
+                                                        .command_bytes = 2 };
+    embed::mock::write_only_spi mock;
+
+    // Exercise
+    auto capabilities = mock.capabilities();
+    auto with_data = mock.transfer(fast_read, data, {});
+    auto command_only = mock.transfer(octal_command, {}, {});
+
+    // Verify
+    expect(embed::spi::capabilities_t{} == capabilities);
+    expect(embed::spi::lanes::single == capabilities.max_lanes);
+    expect(!capabilities.memory_mapped);
+    expect(bool{ with_data });
+    expect(bool{ command_only });
+    expect(that % 3 == mock.write_record.size());
+    expect(std::ranges::equal(std::array{ std::byte{ 0x0B },
+                                          std::byte{ 0x12 },
+                                          std::byte{ 0x34 },
+                                          std::byte{ 0x56 },
+                                          std::byte{ 0xFF } },
+                              mock.write_record.at(0)));
+    expect(std::ranges::equal(data, mock.write_record.at(1)));
+    expect(std::ranges::equal(
+      std::array{ std::byte{ 0x05 }, std::byte{ 0xFA } },
+      mock.write_record.at(2)));
+  };
+
+  "embed::mock::write_only_spi unsupported command transfers"_test = []() {
+    // Setup
+    std::array<std::byte, 4> buffer{};
+    embed::mock::write_only_spi mock;
+
+    // Exercise + Verify
+    expect(!mock.transfer({ .command = 0xEB,
+                            .address_lanes = embed::spi::lanes::quad,
+                            .data_lanes = embed::spi::lanes::quad },
+                          {},
+                          buffer));
+    expect(!mock.transfer({ .command = 0x0B, .dummy_cycles = 6 }, {}, buffer));
+    expect(!mock.transfer({ .address_bytes = 5 }, {}, buffer));
+    expect(!mock.transfer(
+      { .data_lanes = embed::spi::lanes::dual }, buffer, buffer));
+    expect(!mock.memory_map({ .command = 0x0B }));
+    expect(that % 0 == mock.write_record.size());
+  };
 };
 }  // namespace embed
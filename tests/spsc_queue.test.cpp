@@ -0,0 +1,63 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/spsc_queue.hpp>
+
+#include <thread>
+
+namespace embed {
+boost::ut::suite spsc_queue_test = []() {
+  using namespace boost::ut;
+
+  "[spsc_queue] push and pop"_test = []() {
+    // Setup
+    spsc_queue<int, 3> queue;
+
+    // Exercise + Verify
+    expect(queue.empty());
+    expect(that % 3 == queue.capacity());
+    expect(!queue.pop().has_value());
+
+    expect(queue.push(1));
+    expect(queue.push(2));
+    expect(queue.push(3));
+    expect(!queue.push(4));
+    expect(that % 3 == queue.size());
+
+    expect(that % 1 == queue.pop().value());
+    expect(queue.push(5));
+    expect(that % 2 == queue.pop().value());
+    expect(that % 3 == queue.pop().value());
+    expect(that % 5 == queue.pop().value());
+    expect(!queue.pop().has_value());
+    expect(queue.empty());
+  };
+
+  "[spsc_queue] concurrent producer and consumer"_test = []() {
+    // Setup
+    constexpr int count = 100'000;
+    spsc_queue<int, 16> queue;
+    int expected = 0;
+    bool in_order = true;
+
+    // Exercise
+    std::thread producer([&queue]() {
+      for (int i = 0; i < count; i++) {
+        while (!queue.push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    while (expected < count) {
+      if (auto value = queue.pop()) {
+        in_order = in_order && (*value == expected);
+        expected++;
+      }
+    }
+    producer.join();
+
+    // Verify
+    expect(in_order);
+    expect(queue.empty());
+  };
+};
+}  // namespace embed
@@ -0,0 +1,382 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/stepper.hpp>
+#include <libembeddedhal/timer/mock.hpp>
+
+#include <array>
+#include <vector>
+
+namespace embed {
+namespace {
+struct step_pin : public embed::output_pin
+{
+  boost::leaf::result<void> driver_configure(const settings&) noexcept override
+  {
+    return {};
+  }
+  boost::leaf::result<void> driver_level(bool p_high) noexcept override
+  {
+    if (p_high ? fail_high : fail_low) {
+      return boost::leaf::new_error(std::errc::io_error);
+    }
+    if (p_high && !high) {
+      pulses++;
+    }
+    high = p_high;
+    return {};
+  }
+  boost::leaf::result<bool> driver_level() noexcept override { return high; }
+
+  bool high = false;
+  int pulses = 0;
+  bool fail_high = false;
+  bool fail_low = false;
+};
+
+std::vector<std::int64_t> intervals_of(const step_profile& p_profile)
+{
+  std::vector<std::int64_t> intervals;
+  auto cursor = p_profile.begin();
+  for (std::uint32_t i = 0; i < p_profile.steps(); i++) {
+    intervals.push_back(cursor.next().count());
+  }
+  return intervals;
+}
+
+/// Acceleration between consecutive intervals in steps per second squared.
+/// The average rate over an interval is the rate at its midpoint, so this is
+/// exact for a constant acceleration.
+std::vector<double> accelerations_of(const std::vector<std::int64_t>& p_steps)
+{
+  std::vector<double> accelerations;
+  for (size_t i = 1; i < p_steps.size(); i++) {
+    const double previous = 1e9 / static_cast<double>(p_steps[i - 1]);
+    const double current = 1e9 / static_cast<double>(p_steps[i]);
+    const double time =
+      static_cast<double>(p_steps[i - 1] + p_steps[i]) / 2e9;
+    accelerations.push_back((current - previous) / time);
+  }
+  return accelerations;
+}
+}  // namespace
+
+boost::ut::suite stepper_test = []() {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "[step_profile] trapezoidal"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 600> ramp;
+    step_profile profile(ramp);
+
+    // Exercise
+    expect(bool{ profile.plan({ .max_rate = 1'000, .acceleration = 1'000 },
+                              2'000) });
+    const auto intervals = intervals_of(profile);
+    const auto accelerations = accelerations_of(intervals);
+
+    // Verify
+    expect(that % 2'000 == profile.steps());
+    expect(that % 500 == profile.ramp_steps());
+    expect(that % 1'000 == profile.peak_rate());
+    // Steps at sqrt(2 * n / acceleration)
+    expect(that % 44'721'360 == intervals[0]);
+    expect(that % 447'213'596 == ramp[99]);
+    expect(that % 1'000'000'000 == ramp[499]);
+    expect(that % 1'000'000 == intervals[1'000]);
+
+    std::int64_t total = 0;
+    for (size_t i = 0; i < intervals.size(); i++) {
+      total += intervals[i];
+      expect(intervals[i] == intervals[intervals.size() - 1 - i]);
+      expect(intervals[i] == profile.interval(static_cast<std::uint32_t>(i))
+                               .count());
+    }
+    expect(std::abs(total - 3'000'000'000) <= 2);
+
+    for (size_t i = 0; i < 499; i++) {
+      expect(std::abs(accelerations[i] - 1'000.0) < 10.0);
+    }
+    for (size_t i = 500; i < 1'499; i++) {
+      expect(std::abs(accelerations[i]) < 10.0);
+    }
+  };
+
+  "[step_profile] S-curve"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 3'000> ramp;
+    step_profile profile(ramp);
+
+    // Exercise
+    expect(bool{ profile.plan(
+      { .max_rate = 10'000, .acceleration = 20'000, .jerk = 200'000 },
+      8'000) });
+    const auto intervals = intervals_of(profile);
+    const auto accelerations = accelerations_of(intervals);
+
+    // Verify
+    // 100ms of jerk, 400ms of constant acceleration and 100ms of jerk
+    // covers 10000 steps/s * 0.6s / 2
+    expect(that % 3'000 == profile.ramp_steps());
+    expect(that % 10'000 == profile.peak_rate());
+    // First step at cbrt(6 / jerk)
+    expect(that % 31'072'326 == intervals[0]);
+    expect(that % 100'000 == intervals[4'000]);
+
+    // Rounding two ~110us intervals to 1ns changes the rate between them by
+    // up to ~0.16 steps/s, which is ~1500 steps/s^2
+    double peak = 0;
+    for (const auto acceleration : accelerations) {
+      peak = std::max(peak, std::abs(acceleration));
+    }
+    expect(peak < 21'500.0);
+    expect(peak > 19'500.0);
+    // Acceleration builds up over the first 100ms, 33 steps, and falls off
+    // over the last 100ms
+    expect(accelerations[0] < 5'000.0);
+    expect(accelerations[10] < 14'000.0);
+    expect(accelerations[40] > 19'500.0);
+    expect(accelerations[2'500] < 11'000.0);
+    expect(accelerations[2'980] < 2'500.0);
+
+    for (size_t i = 0; i < intervals.size(); i++) {
+      expect(intervals[i] == intervals[intervals.size() - 1 - i]);
+      expect(intervals[i] == profile.interval(static_cast<std::uint32_t>(i))
+                               .count());
+    }
+  };
+
+  "[step_profile] short moves peak early"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 600> ramp;
+    step_profile profile(ramp);
+
+    // Exercise + Verify
+    expect(bool{ profile.plan({ .max_rate = 1'000, .acceleration = 1'000 },
+                              200) });
+    // sqrt(acceleration * steps)
+    expect(that % 447 == profile.peak_rate());
+    expect(that % 99 == profile.ramp_steps());
+
+    expect(bool{ profile.plan(
+      { .max_rate = 1'000, .acceleration = 1'000, .jerk = 10'000 }, 200) });
+    expect(profile.peak_rate() < 447);
+    expect(2 * profile.ramp_steps() <= 200);
+
+    expect(bool{ profile.plan({ .max_rate = 1'000, .acceleration = 1'000 },
+                              1) });
+    expect(that % 1 == profile.steps());
+    expect(profile.interval(0) > 0ns);
+  };
+
+  "[step_profile] start rate and cruise"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 600> ramp;
+    step_profile profile(ramp);
+
+    // Exercise
+    expect(bool{ profile.plan(
+      { .start_rate = 300, .max_rate = 300, .acceleration = 1 }, 10) });
+    const auto intervals = intervals_of(profile);
+
+    // Verify
+    expect(that % 0 == profile.ramp_steps());
+    std::int64_t total = 0;
+    for (const auto interval : intervals) {
+      expect(interval == 3'333'333 || interval == 3'333'334);
+      total += interval;
+    }
+    expect(that % 33'333'333 == total);
+  };
+
+  "[step_profile] errors"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 100> ramp;
+    step_profile profile(ramp);
+
+    // Exercise + Verify
+    expect(!profile.plan({ .max_rate = 0 }, 10));
+    expect(!profile.plan({ .acceleration = 0 }, 10));
+    expect(!profile.plan({ .start_rate = 2'000, .max_rate = 1'000 }, 10));
+    expect(!profile.plan({ .max_rate = step_profile::max_rate_limit + 1 }, 10));
+    // 5 seconds to accelerate
+    expect(!profile.plan({ .max_rate = 5'000, .acceleration = 1'000 }, 1));
+    // 500 steps to accelerate
+    expect(!profile.plan({ .max_rate = 1'000, .acceleration = 1'000 }, 2'000));
+    expect(that % 0 == profile.steps());
+    expect(bool{ profile.plan({ .max_rate = 1'000, .acceleration = 1'000 },
+                              200) });
+  };
+
+  "[step_generator] coordinated axes"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 600> ramp;
+    step_profile profile(ramp);
+    mock::timer timer;
+    std::array<step_pin, 3> steps{};
+    std::array<step_pin, 3> directions{};
+    std::array axes{
+      step_generator::axis{ .step = &steps[0], .direction = &directions[0] },
+      step_generator::axis{ .step = &steps[1],
+                            .direction = &directions[1],
+                            .positive_level = false },
+      step_generator::axis{ .step = &steps[2], .direction = &directions[2] },
+    };
+    step_generator generator(axes, timer, profile);
+    const step_profile::settings settings{ .start_rate = 100,
+                                           .max_rate = 4'000,
+                                           .acceleration = 20'000 };
+
+    // Exercise
+    expect(bool{ generator.move(std::array{ 1'600, -400, 0 }, settings) });
+    expect(!generator.move(std::array{ 1, 1, 1 }, settings));
+    expect(false == generator.done().value());
+
+    std::vector<std::int64_t> scheduled;
+    std::vector<std::int64_t> y_steps_at;
+    for (int i = 0; i < 1'600; i++) {
+      // Raise the step pins, holding them for the pulse width
+      const auto [raise, delay] = timer.spy_schedule.call_history().back();
+      scheduled.push_back(
+        (i == 0 ? delay : delay + step_generator::default_pulse_width).count());
+      const int y_pulses = steps[1].pulses;
+      raise();
+      if (steps[1].pulses != y_pulses) {
+        y_steps_at.push_back(i);
+      }
+      expect(steps[0].high);
+      expect(step_generator::default_pulse_width ==
+             std::get<1>(timer.spy_schedule.call_history().back()));
+
+      // Lower them
+      std::get<0>(timer.spy_schedule.call_history().back())();
+      expect(!steps[0].high && !steps[1].high);
+    }
+
+    // Verify
+    expect(true == generator.done().value());
+    expect(that % 3'200 == timer.spy_schedule.call_history().size());
+    expect(scheduled == intervals_of(profile));
+    expect(that % 1'600 == steps[0].pulses);
+    expect(that % 400 == steps[1].pulses);
+    expect(that % 0 == steps[2].pulses);
+    expect(that % 1'600 == axes[0].position);
+    expect(that % -400 == axes[1].position);
+    expect(that % 0 == axes[2].position);
+    expect(directions[0].high);
+    expect(directions[1].high);
+    for (size_t i = 1; i < y_steps_at.size(); i++) {
+      expect(that % 4 == y_steps_at[i] - y_steps_at[i - 1]);
+    }
+
+    // Moving back returns to zero
+    expect(bool{ generator.move(std::array{ -1'600, 400, 0 }, settings) });
+    while (!generator.done().value()) {
+      std::get<0>(timer.spy_schedule.call_history().back())();
+    }
+    expect(that % 0 == axes[0].position);
+    expect(that % 0 == axes[1].position);
+    expect(!directions[0].high);
+    expect(!directions[1].high);
+  };
+
+  "[step_generator] stop and errors"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 600> ramp;
+    step_profile profile(ramp);
+    mock::timer timer;
+    step_pin step;
+    step_pin direction;
+    std::array axes{
+      step_generator::axis{ .step = &step, .direction = &direction },
+    };
+    step_generator generator(axes, timer, profile);
+    const step_profile::settings settings{ .max_rate = 1'000,
+                                           .acceleration = 1'000 };
+
+    // Exercise + Verify
+    expect(!generator.move(std::array{ 1, 2 }, settings));
+    expect(bool{ generator.move(std::array{ 0 }, settings) });
+    expect(true == generator.done().value());
+
+    // Stop in the middle of a step pulse
+    expect(bool{ generator.move(std::array{ 100 }, settings) });
+    for (int i = 0; i < 21; i++) {
+      std::get<0>(timer.spy_schedule.call_history().back())();
+    }
+    expect(step.high);
+    expect(bool{ generator.stop() });
+    expect(!step.high);
+    expect(true == generator.done().value());
+    expect(that % 11 == axes[0].position);
+    expect(that % 1 == timer.spy_clear.call_history().size());
+
+    // Fail the schedule() that would raise the second step, so it is never
+    // output
+    timer.spy_schedule.trigger_error_on_call(4);
+    expect(bool{ generator.move(std::array{ 100 }, settings) });
+    for (int i = 0; i < 3; i++) {
+      std::get<0>(timer.spy_schedule.call_history().back())();
+    }
+    expect(!generator.done());
+    expect(!step.high);
+    expect(that % 12 == axes[0].position);
+
+    // Pulses too wide for the rate
+    step_generator wide(axes, timer, profile, std::chrono::milliseconds(1));
+    expect(!wide.move(std::array{ 100 }, settings));
+    expect(bool{ wide.move(std::array{ 100 },
+                           { .max_rate = 500, .acceleration = 1'000 }) });
+  };
+
+  "[step_generator] step pin errors"_test = []() {
+    // Setup
+    std::array<std::uint32_t, 600> ramp;
+    step_profile profile(ramp);
+    mock::timer timer;
+    std::array<step_pin, 3> steps{};
+    std::array<step_pin, 3> directions{};
+    std::array axes{
+      step_generator::axis{ .step = &steps[0], .direction = &directions[0] },
+      step_generator::axis{ .step = &steps[1], .direction = &directions[1] },
+      step_generator::axis{ .step = &steps[2], .direction = &directions[2] },
+    };
+    step_generator generator(axes, timer, profile);
+    const step_profile::settings settings{ .max_rate = 1'000,
+                                           .acceleration = 1'000 };
+    auto next = [&timer]() {
+      std::get<0>(timer.spy_schedule.call_history().back())();
+    };
+
+    // Exercise + Verify
+    // A pin that cannot be raised does not step, the others still do
+    steps[1].fail_high = true;
+    expect(bool{ generator.move(std::array{ 10, 10, 10 }, settings) });
+    next();
+    expect(!generator.done());
+    expect(that % 1 == axes[0].position);
+    expect(that % 0 == axes[1].position);
+    expect(that % 1 == axes[2].position);
+    expect(!steps[0].high && !steps[2].high);
+    steps[1].fail_high = false;
+
+    // A pin that cannot be lowered does not stop the others being lowered
+    // and is lowered again by stop()
+    steps[0].fail_low = true;
+    expect(bool{ generator.move(std::array{ 10, 10, 10 }, settings) });
+    next();
+    next();
+    expect(!generator.done());
+    expect(steps[0].high);
+    expect(!steps[1].high && !steps[2].high);
+    expect(axes[0].stepped);
+    expect(!generator.stop());
+    steps[0].fail_low = false;
+    expect(bool{ generator.stop() });
+    expect(!steps[0].high);
+    expect(!axes[0].stepped);
+    expect(that % 2 == axes[0].position);
+    expect(that % 1 == axes[1].position);
+    expect(that % 2 == axes[2].position);
+  };
+};
+}  // namespace embed
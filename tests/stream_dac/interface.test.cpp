@@ -0,0 +1 @@
+#include <libembeddedhal/stream_dac/interface.hpp>
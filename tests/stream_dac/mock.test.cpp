@@ -0,0 +1,87 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/stream_dac/mock.hpp>
+
+namespace embed {
+boost::ut::suite stream_dac_mock_test = []() {
+  using namespace boost::ut;
+  using namespace std::chrono_literals;
+
+  "[stream_dac] start validation"_test = []() {
+    // Setup
+    embed::mock::stream_dac mock;
+    std::array<percent, 3> odd{};
+    auto refill = [](std::span<percent>) {};
+
+    // Exercise + Verify
+    expect(!mock.start(odd, refill));
+    expect(!mock.start(std::span(odd).first(0), refill));
+    expect(that % 0 == mock.spy_start.call_history().size());
+    expect(!mock.output());
+  };
+
+  "[stream_dac] double buffered output"_test = []() {
+    // Setup
+    std::chrono::nanoseconds now = 0ns;
+    embed::mock::stream_dac mock([&now]() { return now; });
+    std::array<percent, 4> buffer{ percent(0.1), percent(0.2), percent(0.3),
+                                   percent(0.4) };
+    int refill_count = 0;
+    auto refill = [&refill_count](std::span<percent> p_drained) {
+      refill_count++;
+      for (auto& sample : p_drained) {
+        sample = percent(-0.5);
+      }
+    };
+
+    // Exercise
+    expect(bool{ mock.configure({ .sample_rate = frequency(1'000) }) });
+    expect(bool{ mock.start(buffer, refill) });
+    expect(bool{ mock.output(3) });
+    auto half_period = mock.half_period();
+    expect(bool{ mock.stop() });
+
+    // Verify
+    const auto& samples = mock.samples();
+    expect(that % 6 == samples.size());
+    expect(percent(0.1) == samples[0]);
+    expect(percent(0.2) == samples[1]);
+    expect(percent(0.3) == samples[2]);
+    expect(percent(0.4) == samples[3]);
+    expect(percent(-0.5) == samples[4]);
+    expect(percent(-0.5) == samples[5]);
+    expect(that % 3 == refill_count);
+    expect(that % 3 == mock.refills());
+    expect(that % 0 == mock.underflows());
+    expect(2ms == half_period.value());
+    expect(that % 1 == mock.spy_stop.call_history().size());
+    expect(!mock.output());
+  };
+
+  "[stream_dac] underflow"_test = []() {
+    // Setup
+    std::chrono::nanoseconds now = 0ns;
+    std::chrono::nanoseconds refill_time = 1ms;
+    embed::mock::stream_dac mock([&now]() { return now; });
+    std::array<percent, 8> buffer{};
+    auto slow_refill = [&now, &refill_time](std::span<percent>) {
+      now += refill_time;
+    };
+
+    // Exercise
+    expect(bool{ mock.configure({ .sample_rate = frequency(4'000) }) });
+    expect(bool{ mock.start(buffer, slow_refill) });
+    expect(bool{ mock.output(2) });
+    refill_time = 1500us;
+    expect(bool{ mock.output(1) });
+
+    // Verify
+    expect(1ms == mock.half_period().value());
+    expect(that % 1 == mock.underflows());
+    expect(1500us == mock.worst_refill());
+
+    mock.reset();
+    expect(that % 0 == mock.underflows());
+    expect(that % 0 == mock.samples().size());
+  };
+};
+}  // namespace embed
@@ -0,0 +1 @@
+#include <libembeddedhal/suspendable/interface.hpp>
@@ -0,0 +1,28 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/suspendable/mock.hpp>
+
+namespace embed {
+boost::ut::suite suspendable_mock_test = []() {
+  using namespace boost::ut;
+
+  // Setup
+  embed::mock::suspendable mock;
+  mock.spy_resume.trigger_error_on_call(2);
+
+  // Exercise + Verify
+  expect(bool{ mock.suspend() });
+  expect(mock.suspended);
+  expect(bool{ mock.resume() });
+  expect(!mock.suspended);
+
+  expect(bool{ mock.suspend() });
+  expect(!mock.resume());
+  expect(mock.suspended);
+  expect(that % 2 == mock.spy_suspend.call_history().size());
+  expect(that % 2 == mock.spy_resume.call_history().size());
+
+  mock.reset();
+  expect(that % 0 == mock.spy_suspend.call_history().size());
+  expect(that % 0 == mock.spy_resume.call_history().size());
+};
+}  // namespace embed
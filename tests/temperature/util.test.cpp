@@ -0,0 +1,49 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/temperature/util.hpp>
+
+namespace embed {
+boost::ut::suite temperature_util_test = []() {
+  using namespace boost::ut;
+
+  "[temperature] temperature_conversion"_test = []() {
+    constexpr temperature_conversion to_millikelvin;
+    constexpr temperature_conversion<mK<std::int32_t>> to_millicelsius(
+      mK<std::int32_t>(273'150));
+
+    static_assert(to_millikelvin(temperature(298'150'000'000)) ==
+                  mK<std::int32_t>(298'150));
+    static_assert(to_millicelsius(temperature(298'150'000'000)) ==
+                  mK<std::int32_t>(25'000));
+    static_assert(to_millicelsius(temperature(0)) ==
+                  mK<std::int32_t>(-273'150));
+    expect(mK<std::int32_t>(1) == to_millikelvin(temperature(500'000)));
+    expect(mK<std::int32_t>(0) == to_millikelvin(temperature(499'999)));
+  };
+
+  "[temperature] temperature_conversion matches quantity_cast"_test = []() {
+    // Setup
+    const temperature_conversion<uK<std::int64_t>> to_microkelvin;
+    std::array<temperature, 256> input{};
+    std::array<uK<std::int64_t>, 256> output{};
+    std::uint64_t state = 12345;
+    for (auto& value : input) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      // Up to ~2147 K
+      value = temperature(static_cast<std::int64_t>(state >> 23));
+    }
+
+    // Exercise
+    auto result = to_microkelvin.process(input, output);
+
+    // Verify
+    expect(that % input.size() == result.size());
+    for (size_t i = 0; i < input.size(); i++) {
+      // quantity_cast truncates, compare against the result rounded to nearest
+      const auto expected =
+        units::quantity_cast<uK<std::int64_t>>(input[i] + nK<>(500)).number();
+      const auto actual = output[i].number();
+      expect(actual - expected <= 1 && expected - actual <= 1);
+    }
+  };
+};
+}  // namespace embed
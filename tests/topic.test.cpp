@@ -0,0 +1,128 @@
+#include <boost/ut.hpp>
+#include <libembeddedhal/static_memory_resource.hpp>
+#include <libembeddedhal/topic.hpp>
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace embed {
+boost::ut::suite topic_test = []() {
+  using namespace boost::ut;
+
+  "[topic] fan out to subscribers"_test = []() {
+    // Setup
+    static_memory_resource<256> memory;
+    topic<int> numbers(memory, 4);
+    auto first = numbers.subscribe();
+    auto second = numbers.subscribe();
+
+    // Exercise
+    numbers.publish(1);
+    numbers.publish(2);
+    auto late = numbers.subscribe();
+    numbers.publish(3);
+
+    // Verify
+    expect(that % 4 == numbers.slots());
+    expect(that % 3 == numbers.published());
+    expect(that % 3 == first.pending());
+    expect(that % 1 == first.receive().value());
+    expect(that % 2 == first.receive().value());
+    expect(that % 3 == first.receive().value());
+    expect(!first.receive().has_value());
+    expect(that % 0 == first.pending());
+
+    expect(that % 1 == second.receive().value());
+    expect(that % 2 == second.receive().value());
+    expect(that % 3 == late.receive().value());
+    expect(!late.receive().has_value());
+
+    numbers.publish(4);
+    expect(that % 3 == second.receive().value());
+    expect(that % 4 == second.receive().value());
+    expect(that % 4 == first.receive().value());
+    expect(that % 0 == first.missed());
+  };
+
+  "[topic] slow subscribers skip overwritten messages"_test = []() {
+    // Setup
+    static_memory_resource<256> memory;
+    topic<int> numbers(memory, 4);
+    auto slow = numbers.subscribe();
+
+    // Exercise
+    for (int i = 0; i < 10; i++) {
+      numbers.publish(i);
+    }
+
+    // Verify
+    expect(that % 4 == slow.pending());
+    expect(that % 6 == slow.receive().value());
+    expect(that % 6 == slow.missed());
+    expect(that % 7 == slow.receive().value());
+    expect(that % 8 == slow.receive().value());
+    expect(that % 9 == slow.receive().value());
+    expect(!slow.receive().has_value());
+  };
+
+  "[topic] slots are a power of two, at least one"_test = []() {
+    // Setup
+    static_memory_resource<64> memory;
+    topic<int> numbers(memory, 0);
+    static_memory_resource<128> rounded_memory;
+    topic<int> rounded(rounded_memory, 5);
+    auto subscriber = numbers.subscribe();
+
+    // Exercise
+    numbers.publish(5);
+    numbers.publish(6);
+
+    // Verify
+    expect(that % 1 == numbers.slots());
+    expect(that % 8 == rounded.slots());
+    expect(that % 6 == subscriber.receive().value());
+    expect(that % 1 == subscriber.missed());
+  };
+
+  "[topic] concurrent publisher and subscribers"_test = []() {
+    // Setup
+    constexpr std::uint64_t count = 100'000;
+    static_memory_resource<4096> memory;
+    topic<std::array<std::uint64_t, 4>> samples(memory, 8);
+    std::atomic<bool> done = false;
+    std::array subscribers{ samples.subscribe(), samples.subscribe() };
+    std::array<bool, 2> consistent{ true, true };
+    std::array<std::uint64_t, 2> received{};
+
+    // Exercise
+    std::thread publisher([&samples, &done]() {
+      for (std::uint64_t i = 0; i < count; i++) {
+        std::array<std::uint64_t, 4> sample;
+        sample.fill(i);
+        samples.publish(sample);
+      }
+      done = true;
+    });
+
+    while (!done || subscribers[0].pending() || subscribers[1].pending()) {
+      for (size_t i = 0; i < subscribers.size(); i++) {
+        if (auto sample = subscribers[i].receive()) {
+          const auto expected = received[i] + subscribers[i].missed();
+          for (const auto element : *sample) {
+            consistent[i] = consistent[i] && element == expected;
+          }
+          received[i]++;
+        }
+      }
+    }
+    publisher.join();
+
+    // Verify
+    for (size_t i = 0; i < subscribers.size(); i++) {
+      expect(consistent[i]);
+      expect(count == received[i] + subscribers[i].missed());
+    }
+  };
+};
+}  // namespace embed